@@ -33,8 +33,7 @@
 #include "ns3/traced-value.h"
 #include "ns3/ndnSIM/utils/batches.h"
 #include "a-ndn-tag.h"
-#include "ndn-netdeviceface.h"
-#include "a-ndn-simple-test.h"
+#include "ndn-vanet-face.h"
 
 using namespace std;
 
@@ -181,19 +180,12 @@ MyConsumer::RertransmitPacket()
   FwHopCountTag hopCountTag;
   interest->GetPayload ()->AddPacketTag (hopCountTag);
 
-  HopTag hopTag;
-  hopTag.SetHop(0);
-  hopTag.SetOverHead(0);
-  interest->GetPayload ()->AddPacketTag (hopTag);
-
-  IndexTag indexTag;
-  indexTag.SetIndex(seq);
-//  cout<<"Index"<<indexTag.GetIndex()<<endl;
-  interest->GetPayload ()->AddPacketTag (indexTag);
-
-  SourceTag sourceTag;
-  sourceTag.SetSource(m_node->GetObject<MobilityModel>()->GetPosition().x);
-  interest->GetPayload ()->AddPacketTag (sourceTag);
+  VehicleContextTag context;
+  context.SetHop(0);
+  context.SetOverHead(0);
+  context.SetIndex(seq);
+  context.SetSource(m_node->GetObject<MobilityModel>()->GetPosition().x);
+  interest->GetPayload ()->AddPacketTag (context);
 
 
   m_transmittedInterests (interest, this, m_face);
@@ -227,22 +219,15 @@ MyConsumer::SendPacket ()
   FwHopCountTag hopCountTag;
   interest->GetPayload ()->AddPacketTag (hopCountTag);
 
-  HopTag hopTag;
-  hopTag.SetHop(0);
-  hopTag.SetOverHead(0);
-  interest->GetPayload ()->AddPacketTag (hopTag);
-
-  IndexTag indexTag;
-  indexTag.SetIndex(seq);
-//  cout<<"Index"<<indexTag.GetIndex()<<endl;
-  interest->GetPayload ()->AddPacketTag (indexTag);
-
-  SourceTag sourceTag;
-  sourceTag.SetSource(m_node->GetObject<MobilityModel>()->GetPosition().x);
-  interest->GetPayload ()->AddPacketTag (sourceTag);
+  VehicleContextTag context;
+  context.SetHop(0);
+  context.SetOverHead(0);
+  context.SetIndex(seq);
+  context.SetSource(m_node->GetObject<MobilityModel>()->GetPosition().x);
+  interest->GetPayload ()->AddPacketTag (context);
   retrans = 0;
-  m_node->GetObject<ns3::ndn::NewNetDeviceFace>()->totalnterestNum = 0;
-  m_node->GetObject<ns3::ndn::NewNetDeviceFace>()->duplicte = 0;
+  ns3::ndn::VanetNetDeviceFace::totalInterestNum = 0;
+  ns3::ndn::VanetNetDeviceFace::duplicate = 0;
   m_transmittedInterests (interest, this, m_face);
   t1 = Simulator::Now().GetSeconds();
   cout<<"Send"<<"\t"<<t1<<"\t";
@@ -271,14 +256,14 @@ MyConsumer::OnData (Ptr<const Data> data)
   cout<<"Index"<<"\t"<<m_numData<<"\t";
   FwHopCountTag hopCountTag;
   data->GetPayload ()->PeekPacketTag (hopCountTag);
-  HopTag hopTag;
-  data->GetPayload ()->PeekPacketTag (hopTag);
+  VehicleContextTag context;
+  data->GetPayload ()->PeekPacketTag (context);
 //new  cout<<(t2-t1)<<"\t"<<m_node->GetObject<NewNetDeviceFace>()->duplicte<<endl;//new
-  cout<<"OverHead"<<"\t"<<m_node->GetObject<NewNetDeviceFace>()->totalnterestNum<<"\t";
+  cout<<"OverHead"<<"\t"<<ns3::ndn::VanetNetDeviceFace::totalInterestNum<<"\t";
   cout<<"Hop"<<"\t"<<hopCountTag.Get()<<"\t"<<"retrans"<<"\t"<<retrans<<"\t";
-//  if(hopTag.GetHop()>hopTag.GetOverHead())
+//  if(context.GetHop()>context.GetOverHead())
 //    {
-//    cout<<"Retransmit"<<hopTag.GetHop()<<" "<<hopTag.GetOverHead()<<" "<<(hopTag.GetHop()-hopTag.GetOverHead());
+//    cout<<"Retransmit"<<context.GetHop()<<" "<<context.GetOverHead()<<" "<<(context.GetHop()-context.GetOverHead());
 //    }
   cout<<endl;
 
@@ -286,11 +271,11 @@ MyConsumer::OnData (Ptr<const Data> data)
 
 
 
-      //"total"<<"\t"<<hopTag.GetHop()<<"\t";
+      //"total"<<"\t"<<context.GetHop()<<"\t";
 
 
-//  if(hopCountTag.Get()<hopTag.GetHop())
-//    cout<<"Retransmit"<<"\t"<<(hopTag.GetHop()-hopCountTag.Get());
+//  if(hopCountTag.Get()<context.GetHop())
+//    cout<<"Retransmit"<<"\t"<<(context.GetHop()-hopCountTag.Get());
 //  cout<<endl;
 
 
@@ -0,0 +1,292 @@
+#ifndef A_NDN_DEFERRAL_TIMER_H_
+#define A_NDN_DEFERRAL_TIMER_H_
+
+#include <string>
+#include <vector>
+
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+
+namespace ns3{
+namespace ndn{
+
+/**
+ * \brief Distance-based deferral timers of one face, sharing a single scheduler event.
+ *
+ * A face defers the rebroadcast of an overheard Interest or Data by a delay
+ * which depends on the distance to the sender, and cancels it as soon as a
+ * better placed vehicle forwards the packet first.  Scheduling one ns-3 event
+ * per deferral leaves a cancelled event in the scheduler for every overheard
+ * frame; here each deferral is a named slot holding its deadline and packet,
+ * and only the earliest deadline of the face is scheduled.  Resetting a slot
+ * to a later deadline or cancelling it does not touch the scheduler: the
+ * pending event wakes up, fires the slots which are due and goes back to sleep
+ * until the next deadline.
+ *
+ * The timer also counts, per slot, the deferrals which fired and the ones
+ * which were cancelled (or reset) before expiring.
+ */
+class DeferralTimer
+{
+public:
+  typedef Callback<void, Ptr<Packet> > Handler;
+
+  DeferralTimer ();
+  ~DeferralTimer ();
+
+  /**
+   * \param name the name of the new slot, used for the statistics.
+   * \param handler called with the deferred packet when the slot expires.
+   * \returns the key of the new slot.
+   */
+  uint32_t AddSlot (const std::string &name, Handler handler);
+  /**
+   * \returns the key of the slot with the given name, or GetNSlots() if there is none.
+   */
+  uint32_t GetSlot (const std::string &name) const;
+  uint32_t GetNSlots (void) const;
+  std::string GetName (uint32_t key) const;
+
+  /**
+   * Defers the packet by the given delay. A deferral still pending in the
+   * slot is replaced and counted as cancelled.
+   */
+  void Schedule (uint32_t key, Time delay, Ptr<Packet> packet);
+  /// Cancels the deferral pending in the slot, if any.
+  void Cancel (uint32_t key);
+  /// Cancels the deferrals pending in all the slots.
+  void CancelAll (void);
+  bool IsRunning (uint32_t key) const;
+
+  uint64_t GetFired (uint32_t key) const;
+  uint64_t GetCancelled (uint32_t key) const;
+  uint64_t GetTotalFired (void) const;
+  uint64_t GetTotalCancelled (void) const;
+
+private:
+  struct Slot
+  {
+    std::string name;
+    Handler handler;
+    Ptr<Packet> packet;   // the deferred packet, 0 when the slot is idle.
+    Time deadline;
+    uint64_t order;       // the order of Schedule() calls, for the slots with the same deadline.
+    bool running;
+    uint64_t fired;
+    uint64_t cancelled;
+  };
+
+  /// \returns the key of the running slot which expires first, or m_slots.size().
+  uint32_t GetNext (void) const;
+  /// Makes sure the scheduler event wakes the timer up before the next deadline.
+  void Reschedule (void);
+  void Expire (void);
+
+  std::vector<Slot> m_slots;
+  EventId m_event;        // the only scheduler event of the timer.
+  uint64_t m_order;
+  bool m_expiring;
+};
+
+DeferralTimer::DeferralTimer ()
+  : m_order (0),
+    m_expiring (false)
+{
+}
+
+DeferralTimer::~DeferralTimer ()
+{
+  Simulator::Remove (m_event);
+}
+
+uint32_t
+DeferralTimer::AddSlot (const std::string &name, Handler handler)
+{
+  Slot slot;
+  slot.name = name;
+  slot.handler = handler;
+  slot.order = 0;
+  slot.running = false;
+  slot.fired = 0;
+  slot.cancelled = 0;
+  m_slots.push_back (slot);
+  return m_slots.size () - 1;
+}
+
+uint32_t
+DeferralTimer::GetSlot (const std::string &name) const
+{
+  for (uint32_t key = 0; key < m_slots.size (); key++)
+    {
+      if (m_slots[key].name == name)
+        {
+          return key;
+        }
+    }
+  return m_slots.size ();
+}
+
+uint32_t
+DeferralTimer::GetNSlots (void) const
+{
+  return m_slots.size ();
+}
+
+std::string
+DeferralTimer::GetName (uint32_t key) const
+{
+  return m_slots[key].name;
+}
+
+void
+DeferralTimer::Schedule (uint32_t key, Time delay, Ptr<Packet> packet)
+{
+  Slot &slot = m_slots[key];
+  if (slot.running)
+    {
+      slot.cancelled++;
+    }
+  slot.packet = packet;
+  slot.deadline = Simulator::Now () + delay;
+  slot.order = m_order++;
+  slot.running = true;
+  Reschedule ();
+}
+
+void
+DeferralTimer::Cancel (uint32_t key)
+{
+  Slot &slot = m_slots[key];
+  if (!slot.running)
+    {
+      return;
+    }
+  slot.running = false;
+  slot.packet = 0;
+  slot.cancelled++;
+  if (GetNext () == m_slots.size ())
+    {
+      // nothing left to wake up for.
+      Simulator::Remove (m_event);
+    }
+}
+
+void
+DeferralTimer::CancelAll (void)
+{
+  for (uint32_t key = 0; key < m_slots.size (); key++)
+    {
+      Cancel (key);
+    }
+}
+
+bool
+DeferralTimer::IsRunning (uint32_t key) const
+{
+  return m_slots[key].running;
+}
+
+uint64_t
+DeferralTimer::GetFired (uint32_t key) const
+{
+  return m_slots[key].fired;
+}
+
+uint64_t
+DeferralTimer::GetCancelled (uint32_t key) const
+{
+  return m_slots[key].cancelled;
+}
+
+uint64_t
+DeferralTimer::GetTotalFired (void) const
+{
+  uint64_t total = 0;
+  for (uint32_t key = 0; key < m_slots.size (); key++)
+    {
+      total += m_slots[key].fired;
+    }
+  return total;
+}
+
+uint64_t
+DeferralTimer::GetTotalCancelled (void) const
+{
+  uint64_t total = 0;
+  for (uint32_t key = 0; key < m_slots.size (); key++)
+    {
+      total += m_slots[key].cancelled;
+    }
+  return total;
+}
+
+uint32_t
+DeferralTimer::GetNext (void) const
+{
+  uint32_t next = m_slots.size ();
+  for (uint32_t key = 0; key < m_slots.size (); key++)
+    {
+      const Slot &slot = m_slots[key];
+      if (!slot.running)
+        {
+          continue;
+        }
+      if (next == m_slots.size ()
+          || slot.deadline < m_slots[next].deadline
+          || (slot.deadline == m_slots[next].deadline && slot.order < m_slots[next].order))
+        {
+          next = key;
+        }
+    }
+  return next;
+}
+
+void
+DeferralTimer::Reschedule (void)
+{
+  if (m_expiring)
+    {
+      // Expire() reschedules once all the due slots have fired.
+      return;
+    }
+  uint32_t next = GetNext ();
+  if (next == m_slots.size ())
+    {
+      return;
+    }
+  Time deadline = m_slots[next].deadline;
+  if (m_event.IsRunning () && TimeStep (m_event.GetTs ()) <= deadline)
+    {
+      // the pending event wakes the timer up early enough.
+      return;
+    }
+  Simulator::Remove (m_event);
+  m_event = Simulator::Schedule (deadline - Simulator::Now (), &DeferralTimer::Expire, this);
+}
+
+void
+DeferralTimer::Expire (void)
+{
+  m_expiring = true;
+  uint32_t next = GetNext ();
+  while (next != m_slots.size () && m_slots[next].deadline <= Simulator::Now ())
+    {
+      Slot &slot = m_slots[next];
+      Ptr<Packet> packet = slot.packet;
+      slot.packet = 0;
+      slot.running = false;
+      slot.fired++;
+      // the handler may schedule or cancel slots of this timer.
+      slot.handler (packet);
+      next = GetNext ();
+    }
+  m_expiring = false;
+  Reschedule ();
+}
+
+}
+}
+#endif
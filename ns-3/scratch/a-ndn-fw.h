@@ -4,7 +4,7 @@
 #include "ns3/ndnSIM/model/pit/ndn-pit-impl.h"
 #include <iomanip>
 #include <boost/foreach.hpp>
-#include "a-ndn-simple-test.h"
+#include "ndn-vanet-face.h"
 
 using namespace std;
 using namespace pit;
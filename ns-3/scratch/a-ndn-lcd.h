@@ -91,8 +91,8 @@ void
 ndnLcd::DoOnInterest (Ptr<Face> inFace,
                                 Ptr<Interest> interest)
 {
-  CacheTag cacheTag;
-  if (interest->GetPayload()->PeekPacketTag(cacheTag))
+  VehicleContextTag cacheContext;
+  if (interest->GetPayload()->PeekPacketTag(cacheContext) && cacheContext.IsCache())
       return;
 
 
@@ -133,19 +133,14 @@ ndnLcd::DoOnInterest (Ptr<Face> inFace,
           contentObject->GetPayload ()->AddPacketTag (hopCountTag);
         }
 
-    SourceTag sourceTag;
-   if (interest->GetPayload ()->PeekPacketTag (sourceTag))
+  VehicleContextTag interestContext;
+  VehicleContextTag context;
+  if (interest->GetPayload ()->PeekPacketTag (interestContext))
   {
-    contentObject->GetPayload ()->AddPacketTag (sourceTag);
+    context.SetRequest (interestContext);
   }
-
-   IndexTag indexTag;
-   if (interest->GetPayload ()->PeekPacketTag (indexTag) ){
-    contentObject->GetPayload ()->AddPacketTag (indexTag);
-  }
-  ProducerTag proTag;
-  proTag.SetHop(2);
-  contentObject->GetPayload ()->AddPacketTag (proTag);
+  context.SetProducerHop(2);
+  contentObject->GetPayload ()->AddPacketTag (context);
 
       pitEntry->AddIncoming (inFace/*, Seconds (1.0)*/);
 
@@ -253,8 +248,8 @@ ndnLcd::DidReceiveSolicitedData (Ptr<Face> inFace,
 void
 ndnLcd::OnData (Ptr<Face> inFace, Ptr<Data> data)
 {	
-  CacheTag cacheTag;
-  if (!data->GetPayload()->PeekPacketTag(cacheTag))
+  VehicleContextTag cacheContext;
+  if (!(data->GetPayload()->PeekPacketTag(cacheContext) && cacheContext.IsCache()))
   {
   Ptr<pit::Entry> pitEntry = m_pit->Lookup (*data);
   DidReceiveSolicitedData (inFace, data, true);
@@ -272,10 +267,9 @@ ndnLcd::OnData (Ptr<Face> inFace, Ptr<Data> data)
     }
   }else {
       Ptr<Packet> copy =  data->GetPayload()->Copy();
-      ProducerTag proTag;
-      if (copy->PeekPacketTag(proTag)) {
-        // cout<<"tagggggggggggggggggggggggggg--"<<proTag.GetHop()<<endl;
-          if (proTag.GetHop() > 0) {
+      if (cacheContext.Has(VehicleContextTag::PRODUCER)) {
+        // cout<<"tagggggggggggggggggggggggggg--"<<cacheContext.GetProducerHop()<<endl;
+          if (cacheContext.GetProducerHop() > 0) {
               copy->RemoveAllPacketTags();
               data->SetPayload(copy);
               bool cached = m_contentStore->Add (data);
@@ -91,8 +91,8 @@ void
 ndnLce::DoOnInterest (Ptr<Face> inFace,
                                 Ptr<Interest> interest)
 {
-  CacheTag cacheTag;
-  if (interest->GetPayload()->PeekPacketTag(cacheTag))
+  VehicleContextTag cacheContext;
+  if (interest->GetPayload()->PeekPacketTag(cacheContext) && cacheContext.IsCache())
       return;
 
 
@@ -133,16 +133,13 @@ ndnLce::DoOnInterest (Ptr<Face> inFace,
           contentObject->GetPayload ()->AddPacketTag (hopCountTag);
         }
 
-    SourceTag sourceTag;
-   if (interest->GetPayload ()->PeekPacketTag (sourceTag))
+  VehicleContextTag interestContext;
+  VehicleContextTag context;
+  if (interest->GetPayload ()->PeekPacketTag (interestContext))
   {
-    contentObject->GetPayload ()->AddPacketTag (sourceTag);
-  }
-
-   IndexTag indexTag;
-   if (interest->GetPayload ()->PeekPacketTag (indexTag) ){
-    contentObject->GetPayload ()->AddPacketTag (indexTag);
+    context.SetRequest (interestContext);
   }
+  contentObject->GetPayload ()->AddPacketTag (context);
 
       pitEntry->AddIncoming (inFace/*, Seconds (1.0)*/);
 
@@ -250,8 +247,8 @@ ndnLce::DidReceiveSolicitedData (Ptr<Face> inFace,
 void
 ndnLce::OnData (Ptr<Face> inFace, Ptr<Data> data)
 {	
-  CacheTag cacheTag;
-  if (!data->GetPayload()->PeekPacketTag(cacheTag))
+  VehicleContextTag cacheContext;
+  if (!(data->GetPayload()->PeekPacketTag(cacheContext) && cacheContext.IsCache()))
   {
   Ptr<pit::Entry> pitEntry = m_pit->Lookup (*data);
   DidReceiveSolicitedData (inFace, data, true);
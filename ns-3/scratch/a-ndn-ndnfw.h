@@ -125,16 +125,13 @@ ndnFw::DoOnInterest (Ptr<Face> inFace,
           contentObject->GetPayload ()->AddPacketTag (hopCountTag);
         }
 
-    SourceTag sourceTag;
-   if (interest->GetPayload ()->PeekPacketTag (sourceTag))
+  VehicleContextTag interestContext;
+  VehicleContextTag context;
+  if (interest->GetPayload ()->PeekPacketTag (interestContext))
   {
-    contentObject->GetPayload ()->AddPacketTag (sourceTag);
-  }
-
-   IndexTag indexTag;
-   if (interest->GetPayload ()->PeekPacketTag (indexTag) ){
-    contentObject->GetPayload ()->AddPacketTag (indexTag);
+    context.SetRequest (interestContext);
   }
+  contentObject->GetPayload ()->AddPacketTag (context);
 
       pitEntry->AddIncoming (inFace/*, Seconds (1.0)*/);
 
@@ -94,11 +94,10 @@ void
 ndnPpc::DoOnInterest (Ptr<Face> inFace,
                                 Ptr<Interest> interest)
 {
-  CacheTag cacheTag;
-  if (interest->GetPayload()->PeekPacketTag(cacheTag)) {
-        IndexTag indexTag;
-        if (interest->GetPayload ()->PeekPacketTag(indexTag)) {
-            int index = indexTag.GetIndex();
+  VehicleContextTag cacheContext;
+  if (interest->GetPayload()->PeekPacketTag(cacheContext) && cacheContext.IsCache()) {
+        if (cacheContext.Has(VehicleContextTag::INDEX)) {
+            int index = cacheContext.GetIndex();
             if (m_Queue.size() >= m_Queue_max)
               {
                       m_Queue.pop_front();
@@ -146,19 +145,14 @@ ndnPpc::DoOnInterest (Ptr<Face> inFace,
           contentObject->GetPayload ()->AddPacketTag (hopCountTag);
         }
 
-    SourceTag sourceTag;
-   if (interest->GetPayload ()->PeekPacketTag (sourceTag))
+  VehicleContextTag interestContext;
+  VehicleContextTag context;
+  if (interest->GetPayload ()->PeekPacketTag (interestContext))
   {
-    contentObject->GetPayload ()->AddPacketTag (sourceTag);
+    context.SetRequest (interestContext);
   }
-
-   IndexTag indexTag;
-   if (interest->GetPayload ()->PeekPacketTag (indexTag) ){
-    contentObject->GetPayload ()->AddPacketTag (indexTag);
-  }
-  ProducerTag proTag;
-  proTag.SetHop(2);
-  contentObject->GetPayload ()->AddPacketTag (proTag);
+  context.SetProducerHop(2);
+  contentObject->GetPayload ()->AddPacketTag (context);
 
       pitEntry->AddIncoming (inFace/*, Seconds (1.0)*/);
 
@@ -266,8 +260,8 @@ ndnPpc::DidReceiveSolicitedData (Ptr<Face> inFace,
 void
 ndnPpc::OnData (Ptr<Face> inFace, Ptr<Data> data)
 {	
-  CacheTag cacheTag;
-  if (!data->GetPayload()->PeekPacketTag(cacheTag))
+  VehicleContextTag cacheContext;
+  if (!(data->GetPayload()->PeekPacketTag(cacheContext) && cacheContext.IsCache()))
   {
         Ptr<pit::Entry> pitEntry = m_pit->Lookup (*data);
         DidReceiveSolicitedData (inFace, data, true);
@@ -285,11 +279,9 @@ ndnPpc::OnData (Ptr<Face> inFace, Ptr<Data> data)
           }
   }else {
        Ptr<Packet> copy =  data->GetPayload()->Copy();
-        IndexTag indexTag;
-        data->GetPayload ()->PeekPacketTag(indexTag);
         double pop = 0.5;
         if (m_Queue.size()>0)
-              pop = (double)count(m_Queue.begin() , m_Queue.end() , indexTag.GetIndex())/(double)m_Queue.size();
+              pop = (double)count(m_Queue.begin() , m_Queue.end() , cacheContext.GetIndex())/(double)m_Queue.size();
         if ( uv->GetValue() <= pop) {
             copy->RemoveAllPacketTags();
             data->SetPayload(copy);
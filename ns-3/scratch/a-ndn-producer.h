@@ -81,20 +81,14 @@ V2VProducer::OnInterest (Ptr<const Interest> interest)
       data->GetPayload ()->AddPacketTag (hopCountTag);
     }
 
-   SourceTag sourceTag;
-   if (interest->GetPayload ()->PeekPacketTag (sourceTag))
+  VehicleContextTag interestContext;
+  VehicleContextTag context;
+  if (interest->GetPayload ()->PeekPacketTag (interestContext))
   {
-    data->GetPayload ()->AddPacketTag (sourceTag);
+    context.SetRequest (interestContext);
   }
-
-   IndexTag indexTag;
-   if (interest->GetPayload ()->PeekPacketTag (indexTag))
-   {
-    data->GetPayload ()->AddPacketTag (indexTag);
-  }
-  ProducerTag proTag;
-  proTag.SetHop(2);
-  data->GetPayload ()->AddPacketTag (proTag);
+  context.SetProducerHop(2);
+  data->GetPayload ()->AddPacketTag (context);
 
   m_face->ReceiveData (data);
   m_transmittedDatas (data, this, m_face);
@@ -3,10 +3,11 @@
 
 #include "ns3/tag.h"
 #include "ns3/packet.h"
+#include <math.h>
 
 using namespace ns3;
 
-class MobilityTag : public Tag {
+class ObjectSizeTag : public Tag {
 public:
   static TypeId GetTypeId (void);
   virtual TypeId GetInstanceTypeId (void) const;
@@ -16,20 +17,45 @@ public:
   virtual void Deserialize (TagBuffer i);
 
   // these are our accessors to our tag structure
-  void SetMobility (double mobility);
-  double GetMobility (void) const;
+  void SetSize (double size);
+  double GetSize (void) const;
 
   void Print (std::ostream &os) const;
 
 private:
-  double m_mobility;
-
-  // end class 
+  double m_objectSize;
 };
 
 
-class SourceTag : public Tag {
+/**
+ * The vehicular context of an NDN packet, in a single packet tag.
+ *
+ * The fields used to be separate tags (MobilityTag, VelocityTag, SourceTag,
+ * HopTag, IndexTag, CacheTag and ProducerTag), each one allocated in the
+ * PacketTagList and found by its own linear scan.  Here they share one tag,
+ * read with a single PeekPacketTag and written back with Write(); a bitmap
+ * tells which fields are set, and only those are serialized.
+ *
+ * A packet tag is limited to 20 bytes (PacketTagList::TagData::MAX_SIZE), so
+ * the fields are packed: positions as float, the velocity in cm/s on 16 bits,
+ * the hop and overhead counters on 16 bits and the producer hop on 8 bits.
+ * The cache mark is a bit of the bitmap.
+ */
+class VehicleContextTag : public Tag {
 public:
+  enum Field
+  {
+    POSITION = 1,   // the position x of the sender.
+    VELOCITY = 2,   // the velocity x of the sender.
+    SOURCE = 4,     // the position x of the consumer.
+    HOP = 8,        // the hop and overhead counters.
+    INDEX = 16,     // the sequence number of the Interest.
+    CACHE = 32,     // overheard packet, passed up for caching only.
+    PRODUCER = 64   // the remaining hops to cache the Data.
+  };
+
+  VehicleContextTag ();
+
   static TypeId GetTypeId (void);
   virtual TypeId GetInstanceTypeId (void) const;
 
@@ -37,291 +63,57 @@ public:
   virtual void Serialize (TagBuffer i) const;
   virtual void Deserialize (TagBuffer i);
 
-  // these are our accessors to our tag structure
-  void SetSource (double mobility);
-  double GetSource (void) const;
-
-  void Print (std::ostream &os) const;
-
-private:
-  double m_source;
-
-  // end class
-};
-
-//
-class VelocityTag : public Tag {
-public:
-  static TypeId GetTypeId (void);
-  virtual TypeId GetInstanceTypeId (void) const;
+  /**
+   * Adds the tag to the packet, or replaces the one it already carries.
+   */
+  void Write (Ptr<const Packet> packet) const;
 
-  virtual uint32_t GetSerializedSize (void) const;
-  virtual void Serialize (TagBuffer i) const;
-  virtual void Deserialize (TagBuffer i);
+  bool Has (Field field) const;
+  /// Unsets the field.
+  void Clear (Field field);
 
-  // these are our accessors to our tag structure
+  void SetPosition (double position);
+  double GetPosition (void) const;
   void SetVelocity (double velocity);
   double GetVelocity (void) const;
+  void SetSource (double source);
+  double GetSource (void) const;
 
-  void Print (std::ostream &os) const;
-
-private:
-  double m_velocity;
-
-  // end class 
-};
-
-class ObjectSizeTag : public Tag {
-public:
-  static TypeId GetTypeId (void);
-  virtual TypeId GetInstanceTypeId (void) const;
-
-  virtual uint32_t GetSerializedSize (void) const;
-  virtual void Serialize (TagBuffer i) const;
-  virtual void Deserialize (TagBuffer i);
-
-  // these are our accessors to our tag structure
-  void SetSize (double size);
-  double GetSize (void) const;
-
-  void Print (std::ostream &os) const;
-
-private:
-  double m_objectSize;
-};
-
-
-class HopTag : public Tag {
-public:
-  static TypeId GetTypeId (void);
-  virtual TypeId GetInstanceTypeId (void) const;
-
-  virtual uint32_t GetSerializedSize (void) const;
-  virtual void Serialize (TagBuffer i) const;
-  virtual void Deserialize (TagBuffer i);
-
-  // these are our accessors to our tag structure
-  void UpdateHop ();
   void SetHop (uint32_t hop);
   uint32_t GetHop (void) const;
-
-  void UpdateOverHead ();
-  void SetOverHead (uint32_t hop);
+  void UpdateHop ();
+  void SetOverHead (uint32_t overHead);
   uint32_t GetOverHead (void) const;
+  void UpdateOverHead ();
 
-  void Print (std::ostream &os) const;
-
-private:
-  uint32_t m_hop;
-  uint32_t m_overHead;
-};
+  void SetIndex (uint32_t index);
+  uint32_t GetIndex (void) const;
 
+  void SetCache (bool cache);
+  bool IsCache (void) const;
 
-//------------------------------------------------
+  void SetProducerHop (uint32_t hop);
+  uint32_t GetProducerHop (void) const;
 
-class IndexTag : public Tag {
-public:
-  static TypeId GetTypeId (void);
-  virtual TypeId GetInstanceTypeId (void) const;
-
-  virtual uint32_t GetSerializedSize (void) const;
-  virtual void Serialize (TagBuffer i) const;
-  virtual void Deserialize (TagBuffer i);
-
-  // these are our accessors to our tag structure
-  void SetIndex (double mobility);
-  double GetIndex (void) const;
+  /**
+   * Copies the source and the index of the Interest, for the Data answering it.
+   */
+  void SetRequest (const VehicleContextTag &interest);
 
   void Print (std::ostream &os) const;
 
 private:
-  double m_index;
-
-  // end class
+  uint8_t m_fields;
+  float m_position;
+  float m_source;
+  int16_t m_velocity;   // cm/s.
+  uint16_t m_hop;
+  uint16_t m_overHead;
+  uint32_t m_index;
+  uint8_t m_producerHop;
 };
 
 ///////////////////////////////////////////////////////////
-TypeId 
-MobilityTag::GetTypeId (void)
-{
-  static TypeId tid = TypeId ("MobilityTag")
-    .SetParent<Tag> ()
-    .AddConstructor<MobilityTag> ()
-    // .AddAttribute ("Mobility",
-    //                "The Mobility",
-    //                EmptyAttributeValue (),
-    //                MakeTimeAccessor (&TimestampTag::GetTimestamp),
-    //                MakeTimeChecker ())
-  ;
-  return tid;
-}
-
-//--------------------------------------------------
-
-//--------------------------------------------------
-TypeId 
-MobilityTag::GetInstanceTypeId (void) const
-{
-  return GetTypeId ();
-}
-
-uint32_t 
-MobilityTag::GetSerializedSize (void) const
-{
-  return 8;
-}
-void 
-MobilityTag::Serialize (TagBuffer i) const
-{
-  double t = m_mobility;
-  i.Write ((const uint8_t *)&t, 8);
-}
-void 
-MobilityTag::Deserialize (TagBuffer i)
-{
-  double t;
-  i.Read ((uint8_t *)&t, 8);
-  m_mobility = t;
-}
-
-void
-MobilityTag::SetMobility (double mobility)
-{
-  m_mobility = mobility;
-}
-double
-MobilityTag::GetMobility (void) const
-{
-  return m_mobility;
-}
-
-void 
-MobilityTag::Print (std::ostream &os) const
-{
-  os << "v=" << m_mobility;
-}
-
-//------------------------------------------------
-
-
-TypeId
-SourceTag::GetTypeId (void)
-{
-  static TypeId tid = TypeId ("SourceTag")
-    .SetParent<Tag> ()
-    .AddConstructor<SourceTag> ()
-    // .AddAttribute ("Mobility",
-    //                "The Mobility",
-    //                EmptyAttributeValue (),
-    //                MakeTimeAccessor (&TimestampTag::GetTimestamp),
-    //                MakeTimeChecker ())
-  ;
-  return tid;
-}
-
-TypeId
-SourceTag::GetInstanceTypeId (void) const
-{
-  return GetTypeId ();
-}
-
-uint32_t
-SourceTag::GetSerializedSize (void) const
-{
-  return 8;
-}
-void
-SourceTag::Serialize (TagBuffer i) const
-{
-  double t = m_source;
-  i.Write ((const uint8_t *)&t, 8);
-}
-void
-SourceTag::Deserialize (TagBuffer i)
-{
-  double t;
-  i.Read ((uint8_t *)&t, 8);
-  m_source = t;
-}
-
-void
-SourceTag::SetSource (double mobility)
-{
-  m_source = mobility;
-}
-double
-SourceTag::GetSource (void) const
-{
-  return m_source;
-}
-
-void
-SourceTag::Print (std::ostream &os) const
-{
-  os << "v=" << m_source;
-}
-
-////////////////////////////////////////////////////////////////------------------------------------------------
-
-
-
-TypeId 
-VelocityTag::GetTypeId (void)
-{
-  static TypeId tid = TypeId ("VelocityTag")
-    .SetParent<Tag> ()
-    .AddConstructor<VelocityTag> ()
-    // .AddAttribute ("Mobility",
-    //                "The Mobility",
-    //                EmptyAttributeValue (),
-    //                MakeTimeAccessor (&TimestampTag::GetTimestamp),
-    //                MakeTimeChecker ())
-  ;
-  return tid;
-}
-TypeId 
-VelocityTag::GetInstanceTypeId (void) const
-{
-  return GetTypeId ();
-}
-
-uint32_t 
-VelocityTag::GetSerializedSize (void) const
-{
-  return 8;
-}
-void 
-VelocityTag::Serialize (TagBuffer i) const
-{
-  double t = m_velocity;
-  i.Write ((const uint8_t *)&t, 8);
-}
-void 
-VelocityTag::Deserialize (TagBuffer i)
-{
-  double t;
-  i.Read ((uint8_t *)&t, 8);
-  m_velocity = t;
-}
-
-void
-VelocityTag::SetVelocity (double velocity)
-{
-  m_velocity = velocity;
-}
-double
-VelocityTag::GetVelocity (void) const
-{
-  return m_velocity;
-}
-
-void 
-VelocityTag::Print (std::ostream &os) const
-{
-  os << "v=" << m_velocity;
-}
-
-
 //--------------------------------------------------
 TypeId 
 ObjectSizeTag::GetTypeId (void)
@@ -379,279 +171,296 @@ ObjectSizeTag::Print (std::ostream &os) const
   os << "v=" << m_objectSize;
 }
 
-//----------------------------------------------------------
-TypeId 
-HopTag::GetTypeId (void)
-{
-  static TypeId tid = TypeId ("HopTag")
-    .SetParent<Tag> ()
-    .AddConstructor<HopTag> ()
-    // .AddAttribute ("Mobility",
-    //                "The Mobility",
-    //                EmptyAttributeValue (),
-    //                MakeTimeAccessor (&TimestampTag::GetTimestamp),
-    //                MakeTimeChecker ())
-  ;
-  return tid;
-}
-
-//--------------------------------------------------
-
 //--------------------------------------------------
-TypeId 
-HopTag::GetInstanceTypeId (void) const
+VehicleContextTag::VehicleContextTag ()
+  : m_fields (0),
+    m_position (0),
+    m_source (0),
+    m_velocity (0),
+    m_hop (0),
+    m_overHead (0),
+    m_index (0),
+    m_producerHop (0)
 {
-  return GetTypeId ();
 }
 
-uint32_t 
-HopTag::GetSerializedSize (void) const
-{
-  return 8;
-}
-void 
-HopTag::Serialize (TagBuffer i) const
+TypeId
+VehicleContextTag::GetTypeId (void)
 {
-  i.WriteU32 (m_hop);
-  i.WriteU32(m_overHead);
+  static TypeId tid = TypeId ("VehicleContextTag")
+    .SetParent<Tag> ()
+    .AddConstructor<VehicleContextTag> ()
+  ;
+  return tid;
 }
-void 
-HopTag::Deserialize (TagBuffer i)
+TypeId
+VehicleContextTag::GetInstanceTypeId (void) const
 {
-  m_hop = i.ReadU32 ();
-  m_overHead = i.ReadU32 ();
+  return GetTypeId ();
 }
 
-void
-HopTag::UpdateHop ()
-{
-  m_hop++;
-}
-void
-HopTag::UpdateOverHead()
-{
-  m_overHead++;
+uint32_t
+VehicleContextTag::GetSerializedSize (void) const
+{
+  uint32_t size = 1;
+  if (m_fields & POSITION)
+    {
+      size += 4;
+    }
+  if (m_fields & VELOCITY)
+    {
+      size += 2;
+    }
+  if (m_fields & SOURCE)
+    {
+      size += 4;
+    }
+  if (m_fields & HOP)
+    {
+      size += 4;
+    }
+  if (m_fields & INDEX)
+    {
+      size += 4;
+    }
+  if (m_fields & PRODUCER)
+    {
+      size += 1;
+    }
+  return size;
 }
 void
-HopTag::SetHop(uint32_t hop)
-{
-  m_hop = hop;
+VehicleContextTag::Serialize (TagBuffer i) const
+{
+  i.WriteU8 (m_fields);
+  if (m_fields & POSITION)
+    {
+      i.Write ((const uint8_t *)&m_position, 4);
+    }
+  if (m_fields & VELOCITY)
+    {
+      i.WriteU16 ((uint16_t)m_velocity);
+    }
+  if (m_fields & SOURCE)
+    {
+      i.Write ((const uint8_t *)&m_source, 4);
+    }
+  if (m_fields & HOP)
+    {
+      i.WriteU16 (m_hop);
+      i.WriteU16 (m_overHead);
+    }
+  if (m_fields & INDEX)
+    {
+      i.WriteU32 (m_index);
+    }
+  if (m_fields & PRODUCER)
+    {
+      i.WriteU8 (m_producerHop);
+    }
 }
 void
-HopTag::SetOverHead (uint32_t hop)
-{
-  m_overHead = hop;
-}
-uint32_t
-HopTag::GetHop (void) const
-{
-  return m_hop;
-}
-uint32_t
-HopTag::GetOverHead (void) const
-{
-  return m_overHead;
+VehicleContextTag::Deserialize (TagBuffer i)
+{
+  m_fields = i.ReadU8 ();
+  if (m_fields & POSITION)
+    {
+      i.Read ((uint8_t *)&m_position, 4);
+    }
+  if (m_fields & VELOCITY)
+    {
+      m_velocity = (int16_t)i.ReadU16 ();
+    }
+  if (m_fields & SOURCE)
+    {
+      i.Read ((uint8_t *)&m_source, 4);
+    }
+  if (m_fields & HOP)
+    {
+      m_hop = i.ReadU16 ();
+      m_overHead = i.ReadU16 ();
+    }
+  if (m_fields & INDEX)
+    {
+      m_index = i.ReadU32 ();
+    }
+  if (m_fields & PRODUCER)
+    {
+      m_producerHop = i.ReadU8 ();
+    }
 }
 
-void 
-HopTag::Print (std::ostream &os) const
+void
+VehicleContextTag::Write (Ptr<const Packet> packet) const
 {
-  os <<m_hop;
+  // like AddPacketTag (), tags may be written on a const packet.
+  VehicleContextTag tag = *this;
+  ConstCast<Packet> (packet)->ReplacePacketTag (tag);
 }
 
-
-//--------------------------------------------------
-TypeId
-IndexTag::GetTypeId (void)
+bool
+VehicleContextTag::Has (Field field) const
 {
-  static TypeId tid = TypeId ("IndexTag")
-    .SetParent<Tag> ()
-    .AddConstructor<IndexTag> ()
-    // .AddAttribute ("Mobility",
-    //                "The Mobility",
-    //                EmptyAttributeValue (),
-    //                MakeTimeAccessor (&TimestampTag::GetTimestamp),
-    //                MakeTimeChecker ())
-  ;
-  return tid;
+  return (m_fields & field) != 0;
 }
-TypeId
-IndexTag::GetInstanceTypeId (void) const
+void
+VehicleContextTag::Clear (Field field)
 {
-  return GetTypeId ();
+  m_fields &= ~field;
 }
 
-uint32_t
-IndexTag::GetSerializedSize (void) const
-{
-  return 8;
-}
 void
-IndexTag::Serialize (TagBuffer i) const
+VehicleContextTag::SetPosition (double position)
 {
-  double t = m_index;
-  i.Write ((const uint8_t *)&t, 8);
+  m_position = position;
+  m_fields |= POSITION;
 }
-void
-IndexTag::Deserialize (TagBuffer i)
+double
+VehicleContextTag::GetPosition (void) const
 {
-  double t;
-  i.Read ((uint8_t *)&t, 8);
-  m_index = t;
+  return m_position;
 }
-
 void
-IndexTag::SetIndex (double mobility)
+VehicleContextTag::SetVelocity (double velocity)
 {
-  m_index = mobility;
+  m_velocity = (int16_t)floor (velocity * 100 + 0.5);
+  m_fields |= VELOCITY;
 }
 double
-IndexTag::GetIndex (void) const
+VehicleContextTag::GetVelocity (void) const
 {
-  return m_index;
+  return m_velocity / 100.0;
 }
-
 void
-IndexTag::Print (std::ostream &os) const
+VehicleContextTag::SetSource (double source)
 {
-  os << "v=" << m_index;
+  m_source = source;
+  m_fields |= SOURCE;
 }
-
-//------------------------------------------------
-class CacheTag : public Tag {
-public:
-  static TypeId GetTypeId (void);
-  virtual TypeId GetInstanceTypeId (void) const;
-
-  virtual uint32_t GetSerializedSize (void) const;
-  virtual void Serialize (TagBuffer i) const;
-  virtual void Deserialize (TagBuffer i);
-
-  // these are our accessors to our tag structure
-  void SetHop (uint32_t hop);
-  uint32_t GetHop (void) const;
-
-
-  void Print (std::ostream &os) const;
-
-private:
-  uint32_t m_hop;
-};
-
-TypeId 
-CacheTag::GetTypeId (void)
-{
-  static TypeId tid = TypeId ("CacheTag")
-    .SetParent<Tag> ()
-    .AddConstructor<CacheTag> ()
-  ;
-  return tid;
-}
-TypeId 
-CacheTag::GetInstanceTypeId (void) const
+double
+VehicleContextTag::GetSource (void) const
 {
-  return GetTypeId ();
+  return m_source;
 }
 
-uint32_t 
-CacheTag::GetSerializedSize (void) const
+void
+VehicleContextTag::SetHop (uint32_t hop)
 {
-  return 8;
+  m_hop = hop;
+  m_fields |= HOP;
 }
-void 
-CacheTag::Serialize (TagBuffer i) const
+uint32_t
+VehicleContextTag::GetHop (void) const
 {
-  i.WriteU32 (m_hop);
+  return m_hop;
 }
-void 
-CacheTag::Deserialize (TagBuffer i)
+void
+VehicleContextTag::UpdateHop ()
 {
-  m_hop = i.ReadU32 ();
+  m_hop++;
+  m_fields |= HOP;
 }
-
 void
-CacheTag::SetHop(uint32_t hop)
+VehicleContextTag::SetOverHead (uint32_t overHead)
 {
-  m_hop = hop;
+  m_overHead = overHead;
+  m_fields |= HOP;
 }
 uint32_t
-CacheTag::GetHop (void) const
+VehicleContextTag::GetOverHead (void) const
 {
-  return m_hop;
+  return m_overHead;
 }
-
-void 
-CacheTag::Print (std::ostream &os) const
+void
+VehicleContextTag::UpdateOverHead ()
 {
-  os <<m_hop;
+  m_overHead++;
+  m_fields |= HOP;
 }
 
-class ProducerTag : public Tag {
-public:
-  static TypeId GetTypeId (void);
-  virtual TypeId GetInstanceTypeId (void) const;
-
-  virtual uint32_t GetSerializedSize (void) const;
-  virtual void Serialize (TagBuffer i) const;
-  virtual void Deserialize (TagBuffer i);
-
-  // these are our accessors to our tag structure
-  void SetHop (uint32_t hop);
-  uint32_t GetHop (void) const;
-
-
-  void Print (std::ostream &os) const;
-
-private:
-  uint32_t m_hop;
-};
-
-TypeId 
-ProducerTag::GetTypeId (void)
+void
+VehicleContextTag::SetIndex (uint32_t index)
 {
-  static TypeId tid = TypeId ("ProducerTag")
-    .SetParent<Tag> ()
-    .AddConstructor<ProducerTag> ()
-  ;
-  return tid;
+  m_index = index;
+  m_fields |= INDEX;
 }
-TypeId 
-ProducerTag::GetInstanceTypeId (void) const
+uint32_t
+VehicleContextTag::GetIndex (void) const
 {
-  return GetTypeId ();
+  return m_index;
 }
 
-uint32_t 
-ProducerTag::GetSerializedSize (void) const
+void
+VehicleContextTag::SetRequest (const VehicleContextTag &interest)
 {
-  return 8;
+  if (interest.Has (SOURCE))
+    {
+      SetSource (interest.GetSource ());
+    }
+  if (interest.Has (INDEX))
+    {
+      SetIndex (interest.GetIndex ());
+    }
 }
-void 
-ProducerTag::Serialize (TagBuffer i) const
+
+void
+VehicleContextTag::SetCache (bool cache)
 {
-  i.WriteU32 (m_hop);
+  if (cache)
+    {
+      m_fields |= CACHE;
+    }
+  else
+    {
+      m_fields &= ~CACHE;
+    }
 }
-void 
-ProducerTag::Deserialize (TagBuffer i)
+bool
+VehicleContextTag::IsCache (void) const
 {
-  m_hop = i.ReadU32 ();
+  return (m_fields & CACHE) != 0;
 }
 
 void
-ProducerTag::SetHop(uint32_t hop)
+VehicleContextTag::SetProducerHop (uint32_t hop)
 {
-  m_hop = hop;
+  m_producerHop = hop;
+  m_fields |= PRODUCER;
 }
 uint32_t
-ProducerTag::GetHop (void) const
+VehicleContextTag::GetProducerHop (void) const
 {
-  return m_hop;
+  return m_producerHop;
 }
 
-void 
-ProducerTag::Print (std::ostream &os) const
-{
-  os <<m_hop;
+void
+VehicleContextTag::Print (std::ostream &os) const
+{
+  os << "fields=" << (uint32_t)m_fields;
+  if (m_fields & POSITION)
+    {
+      os << " x=" << m_position;
+    }
+  if (m_fields & VELOCITY)
+    {
+      os << " v=" << GetVelocity ();
+    }
+  if (m_fields & SOURCE)
+    {
+      os << " source=" << m_source;
+    }
+  if (m_fields & HOP)
+    {
+      os << " hop=" << m_hop << " overhead=" << m_overHead;
+    }
+  if (m_fields & INDEX)
+    {
+      os << " index=" << m_index;
+    }
+  if (m_fields & PRODUCER)
+    {
+      os << " producer=" << (uint32_t)m_producerHop;
+    }
 }
 
 #endif
@@ -31,7 +31,7 @@
 //#include "a-ndn-consumer.h"
 #include "a-ndn-fw.h" 
 #include "a-ndn-ndnfw.h"
-#include "a-ndn-simple-test.h"
+#include "ndn-vanet-face.h"
 #include "a-ndn-consumerbatches.h"
 
 #include "ns3/ns2-mobility-helper.h"
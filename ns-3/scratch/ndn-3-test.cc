@@ -30,9 +30,7 @@
 #include "a-ndn-app.h"
 //#include "a-ndn-consumer.h"
 #include "a-ndn-fw.h"
-#include "a-ndn-simple-test.h"
-#include "another-ndn-netdeviceface.h"
-#include "ndn-netdeviceface.h"
+#include "ndn-vanet-face.h"
 #include "a-ndn-consumerbatches.h"
 
 #include "ns3/ns2-mobility-helper.h"
@@ -43,7 +41,6 @@
 #include "ndn-3-consumer.h"
 
 #include "a-ndn-producer.h"
-#include "ndn-3-netdevice.h"
 
 
 using namespace std;
@@ -60,7 +57,13 @@ Ptr<ndn::NetDeviceFace>
 NdnNetDeviceFaceCallback (Ptr<Node> node, Ptr<ndn::L3Protocol> ndn, Ptr<NetDevice> device)
 {
   // NS_LOG_DEBUG ("Create custom network device " << node->GetId ());
- Ptr<ndn::NetDeviceFace> face = CreateObject<ThreeNetDeviceFace> (node, device,array,numProducer,p/10.0,Dec);
+ Ptr<ndn::VanetNetDeviceFace> face = CreateObject<ndn::VanetNetDeviceFace> (node, device);
+ face->SetAttribute ("Policy", EnumValue (ndn::VanetNetDeviceFace::PROBABILISTIC));
+ face->SetAttribute ("CacheOverheard", BooleanValue (false));
+ face->SetAttribute ("Probability", DoubleValue (p/10.0));
+ face->SetAttribute ("Decrease", DoubleValue (Dec));
+ face->SetAttribute ("ConsumerId", UintegerValue (array[0]));
+ face->SetProducers (std::vector<uint32_t> (array+1, array+1+numProducer));
  //Ptr<ndn::NetDeviceFace> face = CreateObject<NewNetDeviceFace> (node, device,nodeNumber);
   //Ptr<ndn::NetDeviceFace> face = CreateObject<NewNetDeviceFace> (node, device);
  // cout<<nodeNumber<<endl;
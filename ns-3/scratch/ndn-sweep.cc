@@ -0,0 +1,494 @@
+/* -*- Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Batch driver for the NDN parameter sweeps.
+ *
+ * Runs one scenario process (ndn-another-test by default) per point of the
+ * grid seed x num x p x dec x T, several at a time, and streams one row per
+ * finished run into a single tab separated results file:
+ *
+ *   ./build/scratch/ndn-sweep --program=./build/scratch/ndn-another-test \
+ *       --seed=1:10 --num=10 --p=2,4 --dec=0.1,1 --T=100 --jobs=8 \
+ *       --output=sweep.txt
+ *
+ * Each run is a separate process, so the simulator singletons and the
+ * global statistics of the faces are never shared between runs.  The
+ * rows are written in completion order and carry the parameters of their
+ * run; the metrics are parsed from the "Send", "Receive", "delay", "Hop"
+ * and "OverHead" fields printed by ns3::ndn::MyConsumer, the consumer of
+ * ndn-another-test (ns3::ndn::ThreeConsumer, in ndn-3-test, prints none of
+ * them).  The scenarios read the mobility of their nodes from
+ * scratch/<num>.tcl, relative to the working directory: the sweep must be
+ * run from the top-level directory, and each value of num needs its trace
+ * (only scratch/10.tcl is shipped).
+ *
+ * The scenarios are started without a shell: the words of --args are
+ * passed to them as is.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "ns3/core-module.h"
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+
+using namespace ns3;
+
+/// One point of the parameter grid.
+struct SweepRun
+{
+  uint32_t id;
+  uint32_t seed;
+  uint32_t num;
+  double p;
+  double dec;
+  double T;
+};
+
+/// The metrics of one finished run.
+struct SweepResult
+{
+  int status;             // the exit status of the scenario, -1 if it did not exit normally.
+  int64_t wallMs;         // the wall clock duration of the run.
+  uint32_t sent;          // the number of Interests sent by the consumer.
+  uint32_t received;      // the number of Data received by the consumer.
+  double delaySum;
+  double hopSum;
+  double overheadSum;
+};
+
+/**
+ * Parses a list of values: "a,b,c", or "first:last[:step]" for a range.
+ */
+static std::vector<double>
+ParseList (const std::string &list)
+{
+  std::vector<double> values;
+  std::istringstream items (list);
+  std::string item;
+  while (std::getline (items, item, ','))
+    {
+      if (item.empty ())
+        {
+          continue;
+        }
+      double first, last, step = 1;
+      char colon;
+      std::istringstream range (item);
+      range >> first;
+      if (range.fail ())
+        {
+          NS_FATAL_ERROR ("Invalid value \"" << item << "\" in \"" << list << "\"");
+        }
+      if (!(range >> colon))
+        {
+          values.push_back (first);
+          continue;
+        }
+      bool valid = colon == ':' && (range >> last);
+      if (valid && (range >> colon))
+        {
+          valid = colon == ':' && (range >> step);
+        }
+      if (!valid || step <= 0)
+        {
+          NS_FATAL_ERROR ("Invalid range \"" << item << "\" in \"" << list << "\"");
+        }
+      for (double v = first; v <= last + step * 1e-9; v += step)
+        {
+          values.push_back (v);
+        }
+    }
+  if (values.empty ())
+    {
+      NS_FATAL_ERROR ("Empty list \"" << list << "\"");
+    }
+  return values;
+}
+
+/// The extra arguments of every run, as given to --args.
+static std::string g_args;
+
+/**
+ * Keeps the whole value of --args: a string given to CommandLine::AddValue
+ * would stop at its first space.
+ */
+static bool
+SetArgs (std::string value)
+{
+  g_args = value;
+  return true;
+}
+
+/**
+ * Accumulates the fields printed by the consumer on one line of output,
+ * e.g. "Send 10 Receive 10.02 delay 0.02 Index 1 OverHead 12 Hop 3 retrans 0".
+ */
+static void
+ParseLine (const std::string &line, SweepResult &result)
+{
+  std::istringstream tokens (line);
+  std::string token;
+  while (tokens >> token)
+    {
+      double value;
+      if (token == "Send")
+        {
+          result.sent++;
+        }
+      else if (token == "Receive")
+        {
+          result.received++;
+        }
+      else if (token == "delay" && tokens >> value)
+        {
+          result.delaySum += value;
+        }
+      else if (token == "Hop" && tokens >> value)
+        {
+          result.hopSum += value;
+        }
+      else if (token == "OverHead" && tokens >> value)
+        {
+          result.overheadSum += value;
+        }
+    }
+}
+
+/**
+ * Runs the points of the grid on a pool of threads, each of which runs
+ * one scenario process at a time and appends its row to the results.
+ */
+class SweepDriver
+{
+public:
+  SweepDriver (const std::string &program, const std::string &args,
+               const std::string &logPrefix, std::ostream &output);
+
+  void Add (const SweepRun &run);
+  void Run (uint32_t jobs);
+
+private:
+  /// The loop of each worker thread: takes the next point until none is left.
+  void Work (void);
+  /// Runs the scenario for one point and parses its output.
+  SweepResult Execute (const SweepRun &run) const;
+  void Write (const SweepRun &run, const SweepResult &result);
+
+  std::string m_program;
+  std::string m_args;           // extra arguments of every run.
+  std::string m_logPrefix;      // when not empty, each run's output is kept in <prefix><id>.txt
+  std::ostream &m_output;
+  std::vector<SweepRun> m_runs;
+  uint32_t m_next;              // the next point to run, protected by m_lock.
+  uint32_t m_done;
+  uint32_t m_failed;
+  SystemMutex m_lock;           // protects m_next, the counters and m_output.
+};
+
+SweepDriver::SweepDriver (const std::string &program, const std::string &args,
+                          const std::string &logPrefix, std::ostream &output)
+  : m_program (program),
+    m_args (args),
+    m_logPrefix (logPrefix),
+    m_output (output),
+    m_next (0),
+    m_done (0),
+    m_failed (0)
+{
+}
+
+void
+SweepDriver::Add (const SweepRun &run)
+{
+  m_runs.push_back (run);
+}
+
+void
+SweepDriver::Run (uint32_t jobs)
+{
+  m_output << "run\tseed\tnum\tp\tdec\tT\tstatus\twallMs\tsent\treceived\tdeliveryRatio\tdelay\thop\toverhead"
+           << std::endl;
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 0; i < jobs && i < m_runs.size (); i++)
+    {
+      Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&SweepDriver::Work, this));
+      thread->Start ();
+      threads.push_back (thread);
+    }
+  for (uint32_t i = 0; i < threads.size (); i++)
+    {
+      threads[i]->Join ();
+    }
+  std::cerr << m_done << " runs done, " << m_failed << " failed" << std::endl;
+}
+
+void
+SweepDriver::Work (void)
+{
+  while (true)
+    {
+      uint32_t next;
+      {
+        CriticalSection cs (m_lock);
+        if (m_next == m_runs.size ())
+          {
+            return;
+          }
+        next = m_next++;
+      }
+      SweepResult result = Execute (m_runs[next]);
+      Write (m_runs[next], result);
+    }
+}
+
+SweepResult
+SweepDriver::Execute (const SweepRun &run) const
+{
+  SweepResult result;
+  result.status = -1;
+  result.sent = 0;
+  result.received = 0;
+  result.delaySum = 0;
+  result.hopSum = 0;
+  result.overheadSum = 0;
+
+  std::vector<std::string> words;
+  words.push_back (m_program);
+  std::stringstream parameters;
+  parameters << "--seed=" << run.seed
+             << " --num=" << run.num
+             << " --p=" << run.p
+             << " --dec=" << run.dec
+             << " --T=" << run.T
+             << " " << m_args;
+  std::string word;
+  while (parameters >> word)
+    {
+      words.push_back (word);
+    }
+  std::vector<char *> argv;
+  std::ostringstream command;
+  for (uint32_t i = 0; i < words.size (); i++)
+    {
+      argv.push_back (const_cast<char *> (words[i].c_str ()));
+      command << (i == 0 ? "" : " ") << words[i];
+    }
+  argv.push_back (0);
+  std::ofstream log;
+  if (!m_logPrefix.empty ())
+    {
+      std::ostringstream name;
+      name << m_logPrefix << run.id << ".txt";
+      log.open (name.str ().c_str ());
+      log << "# " << command.str () << std::endl;
+    }
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  // the pipe must not leak into the scenarios started by the other threads,
+  // which would keep it open after this scenario exits.
+  int fds[2];
+  if (pipe2 (fds, O_CLOEXEC) != 0)
+    {
+      result.wallMs = clock.End ();
+      return result;
+    }
+  pid_t pid = fork ();
+  if (pid == 0)
+    {
+      dup2 (fds[1], STDOUT_FILENO);
+      execvp (argv[0], &argv[0]);
+      _exit (127);
+    }
+  close (fds[1]);
+  FILE *pipe = fdopen (fds[0], "r");
+  if (pid < 0 || pipe == 0)
+    {
+      if (pipe != 0)
+        {
+          std::fclose (pipe);
+        }
+      else
+        {
+          close (fds[0]);
+        }
+      if (pid > 0)
+        {
+          waitpid (pid, 0, 0);
+        }
+      result.wallMs = clock.End ();
+      return result;
+    }
+  std::string line;
+  char buffer[4096];
+  while (std::fgets (buffer, sizeof (buffer), pipe) != 0)
+    {
+      line += buffer;
+      if (line[line.size () - 1] != '\n' && !std::feof (pipe))
+        {
+          // the line is longer than the buffer.
+          continue;
+        }
+      ParseLine (line, result);
+      if (log.is_open ())
+        {
+          log << line;
+        }
+      line.clear ();
+    }
+  if (!line.empty ())
+    {
+      ParseLine (line, result);
+      if (log.is_open ())
+        {
+          log << line;
+        }
+    }
+  std::fclose (pipe);
+  int status;
+  pid_t done = waitpid (pid, &status, 0);
+  result.wallMs = clock.End ();
+  if (done == pid && WIFEXITED (status))
+    {
+      result.status = WEXITSTATUS (status);
+    }
+  return result;
+}
+
+void
+SweepDriver::Write (const SweepRun &run, const SweepResult &result)
+{
+  CriticalSection cs (m_lock);
+  m_done++;
+  if (result.status != 0)
+    {
+      m_failed++;
+    }
+  m_output << run.id << "\t" << run.seed << "\t" << run.num << "\t" << run.p
+           << "\t" << run.dec << "\t" << run.T
+           << "\t" << result.status << "\t" << result.wallMs
+           << "\t" << result.sent << "\t" << result.received;
+  if (result.sent > 0)
+    {
+      m_output << "\t" << (double)result.received / result.sent;
+    }
+  else
+    {
+      m_output << "\tNA";
+    }
+  if (result.received > 0)
+    {
+      m_output << "\t" << result.delaySum / result.received
+               << "\t" << result.hopSum / result.received
+               << "\t" << result.overheadSum / result.received;
+    }
+  else
+    {
+      m_output << "\tNA\tNA\tNA";
+    }
+  // flushed per row, so that an interrupted sweep keeps its finished runs.
+  m_output << std::endl;
+  std::cerr << "[" << m_done << "/" << m_runs.size () << "] run " << run.id
+            << " exited with " << result.status << " after " << result.wallMs << "ms" << std::endl;
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string program = "./build/scratch/ndn-another-test";
+  std::string seeds = "1";
+  std::string nums = "10";
+  std::string ps = "3";
+  std::string decs = "0.2";
+  std::string Ts = "10";
+  std::string output = "sweep.txt";
+  std::string logPrefix = "";
+  uint32_t jobs = sysconf (_SC_NPROCESSORS_ONLN);
+
+  CommandLine cmd;
+  cmd.AddValue ("program", "the scenario to run for each point of the grid", program);
+  cmd.AddValue ("args", "extra arguments given to every run, split on spaces, without a shell",
+                MakeCallback (&SetArgs));
+  cmd.AddValue ("seed", "the seeds, as a list a,b,c or a range first:last[:step]", seeds);
+  cmd.AddValue ("num", "the numbers of nodes (list or range), each of which needs scratch/<num>.tcl", nums);
+  cmd.AddValue ("p", "the forwarding probabilities x10 (list or range)", ps);
+  cmd.AddValue ("dec", "the probability decreases (list or range)", decs);
+  cmd.AddValue ("T", "the start times of the consumer (list or range)", Ts);
+  cmd.AddValue ("jobs", "the number of runs executed at the same time", jobs);
+  cmd.AddValue ("output", "the results file", output);
+  cmd.AddValue ("logs", "when set, the output of each run is kept in <logs><run>.txt", logPrefix);
+  cmd.Parse (argc, argv);
+
+  if (jobs == 0)
+    {
+      jobs = 1;
+    }
+  std::vector<double> seedList = ParseList (seeds);
+  std::vector<double> numList = ParseList (nums);
+  std::vector<double> pList = ParseList (ps);
+  std::vector<double> decList = ParseList (decs);
+  std::vector<double> TList = ParseList (Ts);
+
+  std::ofstream out (output.c_str ());
+  if (!out)
+    {
+      NS_FATAL_ERROR ("Cannot open " << output);
+    }
+  // the metadata of the sweep, as comment lines above the header.
+  time_t now = time (0);
+  out << "# program=" << program << " args=" << g_args << std::endl;
+  out << "# seed=" << seeds << " num=" << nums << " p=" << ps << " dec=" << decs << " T=" << Ts << std::endl;
+  out << "# jobs=" << jobs << " started=" << ctime (&now);
+
+  SweepDriver driver (program, g_args, logPrefix, out);
+  SweepRun run;
+  run.id = 0;
+  for (uint32_t n = 0; n < numList.size (); n++)
+    {
+      for (uint32_t i = 0; i < pList.size (); i++)
+        {
+          for (uint32_t d = 0; d < decList.size (); d++)
+            {
+              for (uint32_t t = 0; t < TList.size (); t++)
+                {
+                  for (uint32_t s = 0; s < seedList.size (); s++)
+                    {
+                      run.seed = seedList[s];
+                      run.num = numList[n];
+                      run.p = pList[i];
+                      run.dec = decList[d];
+                      run.T = TList[t];
+                      driver.Add (run);
+                      run.id++;
+                    }
+                }
+            }
+        }
+    }
+  driver.Run (jobs);
+  return 0;
+}
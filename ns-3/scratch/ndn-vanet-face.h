@@ -0,0 +1,631 @@
+#ifndef NDN_VANET_FACE_H
+#define NDN_VANET_FACE_H
+
+#include <vector>
+
+#include "math.h"
+
+#include "ns3/ndn-net-device-face.h"
+#include "ns3/ndnSIM/utils/ndn-fw-hop-count-tag.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/mobility-model.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable.h"
+#include "ns3/uinteger.h"
+
+#include "a-ndn-tag.h"
+#include "a-ndn-deferral-timer.h"
+
+using namespace std;
+
+
+namespace ns3{
+namespace ndn{
+
+/**
+ * \brief NetDeviceFace for vehicular NDN, forwarding overheard packets after a distance-based deferral.
+ *
+ * Every frame sent on the face carries the position and the velocity of the
+ * sender (VehicleContextTag).  A vehicle overhearing an Interest or
+ * a Data defers its rebroadcast by a delay which shrinks with the distance to
+ * the sender, (Range - min (|d|, Range)) / Range * MaxDelay, so that the
+ * farthest vehicle forwards first and the others cancel their deferral when
+ * they overhear it.
+ *
+ * The forwarding decision is selected by the Policy attribute:
+ *  - Distance: the Interest is forwarded by the vehicles behind the sender
+ *    which are between the consumer (source position) and SegmentEnd, the Data by
+ *    the vehicles in front of the sender; forwarded packets are rebroadcast
+ *    every ResendInterval until overheard from farther away.
+ *  - Probabilistic: the Interest is forwarded once per index with a
+ *    probability growing with the distance and the speed of the vehicle
+ *    (Probability, Decrease, ForwardThreshold, NearGate), the Data by the
+ *    vehicles between the sender and the consumer.
+ *
+ * All the parameters are attributes, so that they can be swept from the
+ * command line or with Config::SetDefault without rebuilding the scenario.
+ */
+class VanetNetDeviceFace : public NetDeviceFace
+{
+public:
+  enum Policy
+  {
+    DISTANCE,
+    PROBABILISTIC
+  };
+
+  static TypeId
+  GetTypeId ();
+
+  VanetNetDeviceFace (Ptr<Node> node, const Ptr<NetDevice> &netDevice);
+  virtual ~VanetNetDeviceFace ();
+
+  virtual void RegisterProtocolHandlers (const InterestHandler &interestHandler, const DataHandler &dataHandler);
+  bool Receive (Ptr<const Packet> p);
+  void DoSendData (Ptr<Packet> packet);
+  void DoSendInterest (Ptr<Packet> packet);
+
+  /**
+   * \param producers the ids of the nodes running a producer; replaces the ProducerId attribute.
+   */
+  void SetProducers (const std::vector<uint32_t> &producers);
+  void SetProducerId (uint32_t id);
+  uint32_t GetProducerId () const;
+  bool IsProducer () const;
+
+  const DeferralTimer &GetDeferralTimer () const;
+
+  static uint32_t totalInterestNum;   // the Interests broadcast by all the faces.
+  static uint32_t duplicate;          // totalInterestNum when the Interest reached a producer.
+
+protected:
+  virtual bool Send (Ptr<Packet> p);
+
+private:
+  void ReceiveFromNetDevice (Ptr<NetDevice> device,
+                             Ptr<const Packet> p,
+                             uint16_t protocol,
+                             const Address &from,
+                             const Address &to,
+                             NetDevice::PacketType packetType);
+  void ReceiveDistance (Ptr<Packet> packet, VehicleContextTag &context, HeaderHelper::Type type);
+  void ReceiveProbabilistic (Ptr<Packet> packet, VehicleContextTag &context, HeaderHelper::Type type);
+  /// Sets the current position and velocity of the node in the context.
+  void SetMobility (VehicleContextTag &context);
+  void DeferredReceive (Ptr<Packet> packet);
+  double GetDelay (double distance) const;
+  double GetDistance (double sourcePosition);
+  bool GetProbability (double distance);
+
+  // attributes.
+  Policy m_policy;
+  double m_range;               // the communication range (m).
+  Time m_maxDelay;              // the deferral of a packet overheard from the node itself.
+  Time m_resendInterval;        // the interval between the rebroadcasts of the Distance policy.
+  Time m_randomWait;            // the upper bound of the random delay added to the Data deferral.
+  Time m_interestJitter;        // the upper bound of the Interest deferral of the Probabilistic policy.
+  double m_probability;         // the weight of the distance against the velocity.
+  double m_decrease;            // the scale of the forwarding probability.
+  double m_forwardThreshold;    // the fraction of the range beyond which the Interest is always forwarded.
+  bool m_nearGate;              // do not forward Interests overheard from a node nearer to the consumer.
+  double m_segmentEnd;          // the end of the road segment of the Distance policy (m).
+  bool m_cacheOverheard;        // hand every overheard packet to the forwarding strategy for caching.
+  uint32_t m_consumerId;
+  std::vector<uint32_t> m_producers;
+
+  bool m_isProducer;
+  bool m_isBetween;
+  bool m_nearFlag;
+  bool m_receiveInterestFlag;
+  double m_currentIndex;
+  uint32_t m_tempTimes;         // the hop count of the last Interest received by the producer.
+  uint32_t m_overHead;          // the overhead of the last Interest received by the producer.
+
+  DeferralTimer m_deferral;     // the distance-based deferrals of the face, sharing one scheduler event.
+  uint32_t m_sendInterestSlot;  // the keys of the deferral slots in m_deferral.
+  uint32_t m_sendDataSlot;
+  uint32_t m_reSendInterestSlot;
+  uint32_t m_reSendDataSlot;
+
+  UniformVariable m_uniform;
+  Ptr<NetDevice> m_netDevice;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (VanetNetDeviceFace);
+
+uint32_t VanetNetDeviceFace::totalInterestNum = 0;
+uint32_t VanetNetDeviceFace::duplicate = 0;
+
+TypeId
+VanetNetDeviceFace::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::ndn::VanetNetDeviceFace")
+    .SetParent<NetDeviceFace> ()
+    .AddAttribute ("Policy", "The forwarding decision for overheard packets.",
+                   EnumValue (DISTANCE),
+                   MakeEnumAccessor (&VanetNetDeviceFace::m_policy),
+                   MakeEnumChecker (DISTANCE, "Distance",
+                                    PROBABILISTIC, "Probabilistic"))
+    .AddAttribute ("Range", "The communication range in meters.",
+                   DoubleValue (300.0),
+                   MakeDoubleAccessor (&VanetNetDeviceFace::m_range),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("MaxDelay", "The deferral of a packet overheard at distance zero.",
+                   TimeValue (Seconds (0.05)),
+                   MakeTimeAccessor (&VanetNetDeviceFace::m_maxDelay),
+                   MakeTimeChecker ())
+    .AddAttribute ("ResendInterval", "The interval between two rebroadcasts of a forwarded packet.",
+                   TimeValue (Seconds (0.05)),
+                   MakeTimeAccessor (&VanetNetDeviceFace::m_resendInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("RandomWait", "The upper bound of the random delay added to the Data deferral (Probabilistic).",
+                   TimeValue (Seconds (0.002)),
+                   MakeTimeAccessor (&VanetNetDeviceFace::m_randomWait),
+                   MakeTimeChecker ())
+    .AddAttribute ("InterestJitter", "The upper bound of the random Interest deferral (Probabilistic).",
+                   TimeValue (Seconds (0.002)),
+                   MakeTimeAccessor (&VanetNetDeviceFace::m_interestJitter),
+                   MakeTimeChecker ())
+    .AddAttribute ("Probability", "The weight of the distance against the velocity in the forwarding probability (Probabilistic).",
+                   DoubleValue (0.3),
+                   MakeDoubleAccessor (&VanetNetDeviceFace::m_probability),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("Decrease", "The scale of the forwarding probability (Probabilistic).",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&VanetNetDeviceFace::m_decrease),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("ForwardThreshold", "The fraction of the range beyond which an Interest is always forwarded (Probabilistic).",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&VanetNetDeviceFace::m_forwardThreshold),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("NearGate", "Do not forward the Interests overheard from a node nearer to the consumer (Probabilistic).",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&VanetNetDeviceFace::m_nearGate),
+                   MakeBooleanChecker ())
+    .AddAttribute ("SegmentEnd", "The position x of the end of the road segment (Distance).",
+                   DoubleValue (2010.0),
+                   MakeDoubleAccessor (&VanetNetDeviceFace::m_segmentEnd),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("CacheOverheard", "Pass every overheard packet to the forwarding strategy, marked as cached.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&VanetNetDeviceFace::m_cacheOverheard),
+                   MakeBooleanChecker ())
+    .AddAttribute ("ConsumerId", "The id of the node running the consumer.",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&VanetNetDeviceFace::m_consumerId),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ProducerId", "The id of the node running the producer.",
+                   UintegerValue (9),
+                   MakeUintegerAccessor (&VanetNetDeviceFace::SetProducerId,
+                                         &VanetNetDeviceFace::GetProducerId),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+VanetNetDeviceFace::VanetNetDeviceFace (Ptr<Node> node, const Ptr<NetDevice> &netDevice)
+  : NetDeviceFace (node, netDevice),
+    m_isProducer (false),
+    m_isBetween (false),
+    m_nearFlag (false),
+    m_receiveInterestFlag (false),
+    m_currentIndex (-1),
+    m_tempTimes (0),
+    m_overHead (0),
+    m_netDevice (netDevice)
+{
+  m_sendInterestSlot = m_deferral.AddSlot ("SendInterest", MakeCallback (&VanetNetDeviceFace::DeferredReceive, this));
+  m_sendDataSlot = m_deferral.AddSlot ("SendData", MakeCallback (&VanetNetDeviceFace::DeferredReceive, this));
+  m_reSendInterestSlot = m_deferral.AddSlot ("ReSendInterest", MakeCallback (&VanetNetDeviceFace::DoSendInterest, this));
+  m_reSendDataSlot = m_deferral.AddSlot ("ReSendData", MakeCallback (&VanetNetDeviceFace::DoSendData, this));
+}
+
+VanetNetDeviceFace::~VanetNetDeviceFace ()
+{
+}
+
+void
+VanetNetDeviceFace::SetProducers (const std::vector<uint32_t> &producers)
+{
+  m_producers = producers;
+  m_isProducer = false;
+  for (std::vector<uint32_t>::const_iterator i = m_producers.begin (); i != m_producers.end (); i++)
+    {
+      if (*i == m_node->GetId ())
+        {
+          m_isProducer = true;
+        }
+    }
+}
+
+void
+VanetNetDeviceFace::SetProducerId (uint32_t id)
+{
+  SetProducers (std::vector<uint32_t> (1, id));
+}
+
+uint32_t
+VanetNetDeviceFace::GetProducerId () const
+{
+  return m_producers.empty () ? 0 : m_producers.front ();
+}
+
+bool
+VanetNetDeviceFace::IsProducer () const
+{
+  return m_isProducer;
+}
+
+const DeferralTimer &
+VanetNetDeviceFace::GetDeferralTimer () const
+{
+  return m_deferral;
+}
+
+bool
+VanetNetDeviceFace::Send (Ptr<Packet> packet)
+{
+  if (!Face::Send (packet))
+    {
+      return false;
+    }
+
+  HeaderHelper::Type type = HeaderHelper::GetNdnHeaderType (packet);
+  switch (type)
+    {
+    case HeaderHelper::INTEREST_NDNSIM:
+    case HeaderHelper::INTEREST_CCNB:
+    case HeaderHelper::CONTENT_OBJECT_NDNSIM:
+    case HeaderHelper::CONTENT_OBJECT_CCNB:
+      break;
+    default:
+      return false;
+    }
+
+  VehicleContextTag context;
+  packet->PeekPacketTag (context);
+  SetMobility (context);
+
+  if (type == HeaderHelper::INTEREST_NDNSIM)
+    {
+      context.Write (packet);
+      DoSendInterest (packet);
+      return true;
+    }
+
+  if (m_policy == DISTANCE)
+    {
+      if (m_isProducer)
+        {
+          context.SetHop (m_tempTimes);
+          context.SetOverHead (m_overHead);
+        }
+    }
+  else if (m_isProducer)
+    {
+      context.SetHop (0);
+      context.SetOverHead (1);
+    }
+  else
+    {
+      context.UpdateOverHead ();
+    }
+  context.Write (packet);
+  DoSendData (packet);
+  return true;
+}
+
+void
+VanetNetDeviceFace::DoSendInterest (Ptr<Packet> packet)
+{
+  VehicleContextTag context;
+  packet->PeekPacketTag (context);
+  context.UpdateHop ();
+  if (m_policy == DISTANCE)
+    {
+      context.UpdateOverHead ();
+    }
+  context.Write (packet);
+
+  totalInterestNum++;
+  m_deferral.Cancel (m_reSendDataSlot);
+  m_deferral.Cancel (m_sendDataSlot);
+  m_netDevice->Send (packet->Copy (), m_netDevice->GetBroadcast (),
+                     L3Protocol::ETHERNET_FRAME_TYPE);
+
+  if (m_policy == DISTANCE)
+    {
+      Ptr<Packet> p = packet->Copy ();
+      SetMobility (context);
+      context.Write (p);
+      m_deferral.Schedule (m_reSendInterestSlot, m_resendInterval, p);
+    }
+}
+
+void
+VanetNetDeviceFace::DoSendData (Ptr<Packet> packet)
+{
+  VehicleContextTag context;
+  packet->PeekPacketTag (context);
+  context.UpdateHop ();
+  if (m_policy == DISTANCE && context.Has (VehicleContextTag::PRODUCER) && context.GetProducerHop () > 0)
+    {
+      context.SetProducerHop (context.GetProducerHop () - 1);
+    }
+  context.Write (packet);
+
+  m_deferral.Cancel (m_reSendInterestSlot);
+  m_deferral.Cancel (m_sendInterestSlot);
+  m_netDevice->Send (packet->Copy (), m_netDevice->GetBroadcast (),
+                     L3Protocol::ETHERNET_FRAME_TYPE);
+
+  Ptr<Packet> p = packet->Copy ();
+  SetMobility (context);
+  context.Write (p);
+  m_deferral.Schedule (m_reSendDataSlot, m_resendInterval, p);
+}
+
+void
+VanetNetDeviceFace::SetMobility (VehicleContextTag &context)
+{
+  Ptr<MobilityModel> mobility = m_node->GetObject<MobilityModel> ();
+  context.SetPosition (mobility->GetPosition ().x);
+  context.SetVelocity (mobility->GetVelocity ().x);
+}
+
+void
+VanetNetDeviceFace::RegisterProtocolHandlers (const InterestHandler &interestHandler, const DataHandler &dataHandler)
+{
+  Face::RegisterProtocolHandlers (interestHandler, dataHandler);
+
+  m_node->RegisterProtocolHandler (MakeCallback (&VanetNetDeviceFace::ReceiveFromNetDevice, this),
+                                   L3Protocol::ETHERNET_FRAME_TYPE, GetNetDevice (), true/*promiscuous mode*/);
+}
+
+void
+VanetNetDeviceFace::ReceiveFromNetDevice (Ptr<NetDevice> device,
+                                          Ptr<const Packet> p,
+                                          uint16_t protocol,
+                                          const Address &from,
+                                          const Address &to,
+                                          NetDevice::PacketType packetType)
+{
+  // the only copy of the frame: Receive () hands its own copy to the upper layers,
+  // so the same packet can be passed up for caching and then deferred.
+  Ptr<Packet> packet = p->Copy ();
+  HeaderHelper::Type type = HeaderHelper::GetNdnHeaderType (packet);
+
+  // one lookup for the whole vehicular context of the frame.
+  VehicleContextTag context;
+  packet->PeekPacketTag (context);
+  bool cache = context.IsCache ();
+
+  if (m_cacheOverheard)
+    {
+      context.SetCache (true);
+      context.Write (packet);
+      Receive (packet);
+      context.SetCache (cache);
+    }
+
+  if (m_policy == DISTANCE)
+    {
+      ReceiveDistance (packet, context, type);
+    }
+  else
+    {
+      ReceiveProbabilistic (packet, context, type);
+    }
+}
+
+void
+VanetNetDeviceFace::ReceiveDistance (Ptr<Packet> packet, VehicleContextTag &context, HeaderHelper::Type type)
+{
+  double position = m_node->GetObject<MobilityModel> ()->GetPosition ().x;
+
+  if (context.Has (VehicleContextTag::SOURCE))
+    {
+      m_isBetween = m_segmentEnd >= position && position >= context.GetSource ();
+    }
+
+  double distance = GetDistance (context.GetPosition ());
+  double delay = GetDelay (distance);
+  // the mobility of the sender is replaced by ours when the packet is sent again.
+  context.Clear (VehicleContextTag::POSITION);
+  context.Clear (VehicleContextTag::VELOCITY);
+
+  bool producer = type == HeaderHelper::INTEREST_NDNSIM && m_isProducer;
+  if (producer)
+    {
+      m_tempTimes = context.GetHop ();
+      m_overHead = context.GetOverHead ();
+      context.Clear (VehicleContextTag::HOP);
+    }
+  context.Write (packet);
+
+  if (producer)
+    {
+      Receive (packet);
+      m_receiveInterestFlag = true;
+    }
+  else if (type == HeaderHelper::INTEREST_NDNSIM && distance >= 0 && m_isBetween)
+    {
+      // behind the sender, toward the producer: forward the Interest.
+      m_isBetween = false;
+      m_receiveInterestFlag = true;
+      m_deferral.Cancel (m_sendDataSlot);
+      m_deferral.Cancel (m_reSendDataSlot);
+      m_deferral.Schedule (m_sendInterestSlot, Seconds (delay), packet);
+    }
+  else if (type == HeaderHelper::INTEREST_NDNSIM && distance <= 0)
+    {
+      // overheard from farther away: somebody else forwards it.
+      m_receiveInterestFlag = false;
+      m_deferral.Cancel (m_sendInterestSlot);
+      m_deferral.Cancel (m_reSendInterestSlot);
+    }
+  else if (type == HeaderHelper::CONTENT_OBJECT_NDNSIM && m_node->GetId () == m_consumerId)
+    {
+      Receive (packet);
+    }
+  else if (type == HeaderHelper::CONTENT_OBJECT_NDNSIM && distance <= 0 && m_isBetween)
+    {
+      m_isBetween = false;
+      m_deferral.Schedule (m_sendDataSlot, Seconds (delay), packet);
+      m_deferral.Cancel (m_sendInterestSlot);
+      m_deferral.Cancel (m_reSendInterestSlot);
+    }
+  else if (type == HeaderHelper::CONTENT_OBJECT_NDNSIM && distance >= 0)
+    {
+      m_deferral.CancelAll ();
+    }
+  else
+    {
+      m_deferral.Cancel (m_reSendInterestSlot);
+      m_deferral.Cancel (m_reSendDataSlot);
+    }
+}
+
+void
+VanetNetDeviceFace::ReceiveProbabilistic (Ptr<Packet> packet, VehicleContextTag &context, HeaderHelper::Type type)
+{
+  double position = m_node->GetObject<MobilityModel> ()->GetPosition ().x;
+
+  if (context.Has (VehicleContextTag::INDEX) && m_currentIndex != context.GetIndex ())
+    {
+      // a new Interest: forget the deferrals of the previous one.
+      m_receiveInterestFlag = false;
+      m_currentIndex = context.GetIndex ();
+      m_deferral.CancelAll ();
+    }
+
+  double sender = context.GetPosition ();
+  context.Clear (VehicleContextTag::POSITION);
+  context.Clear (VehicleContextTag::VELOCITY);
+
+  if (context.Has (VehicleContextTag::SOURCE))
+    {
+      double source = context.GetSource ();
+      m_nearFlag = abs (position - source) <= abs (sender - source)
+        && abs (position - sender) <= abs (sender - source);
+    }
+
+  double distance = GetDistance (sender);
+  double interestDelay = m_uniform.GetValue (0, m_interestJitter.GetSeconds ());
+  double delay = GetDelay (distance) + m_uniform.GetValue (0, m_randomWait.GetSeconds ());
+  bool receive = GetProbability (distance);
+
+  bool producer = type == HeaderHelper::INTEREST_NDNSIM && m_isProducer && !m_receiveInterestFlag;
+  if (producer)
+    {
+      m_tempTimes = context.GetHop ();
+      context.Clear (VehicleContextTag::HOP);
+    }
+  context.Write (packet);
+
+  if (producer)
+    {
+      duplicate = totalInterestNum;
+      Receive (packet);
+      m_receiveInterestFlag = true;
+    }
+  else if (type == HeaderHelper::INTEREST_NDNSIM && receive && !m_receiveInterestFlag
+           && !(m_nearGate && m_nearFlag))
+    {
+      m_receiveInterestFlag = true;
+      m_deferral.Cancel (m_sendDataSlot);
+      m_deferral.Cancel (m_reSendDataSlot);
+      m_deferral.Schedule (m_sendInterestSlot, Seconds (interestDelay), packet);
+    }
+  else if (type == HeaderHelper::CONTENT_OBJECT_NDNSIM && m_node->GetId () == m_consumerId)
+    {
+      Receive (packet);
+    }
+  else if (type == HeaderHelper::CONTENT_OBJECT_NDNSIM && m_nearFlag)
+    {
+      // between the sender and the consumer: forward the Data.
+      m_deferral.Schedule (m_sendDataSlot, Seconds (delay), packet);
+      m_deferral.Cancel (m_sendInterestSlot);
+      m_deferral.Cancel (m_reSendInterestSlot);
+    }
+  else if (type == HeaderHelper::CONTENT_OBJECT_NDNSIM)
+    {
+      m_deferral.CancelAll ();
+    }
+}
+
+void
+VanetNetDeviceFace::DeferredReceive (Ptr<Packet> packet)
+{
+  Receive (packet);
+}
+
+bool
+VanetNetDeviceFace::Receive (Ptr<const Packet> p)
+{
+  if (!IsUp ())
+    {
+      // no tracing here. If we were off while receiving, we shouldn't even know that something was there
+      return false;
+    }
+
+  Ptr<Packet> packet = p->Copy (); // give upper layers a rw copy of the packet
+  try
+    {
+      HeaderHelper::Type type = HeaderHelper::GetNdnHeaderType (packet);
+      switch (type)
+        {
+        case HeaderHelper::INTEREST_NDNSIM:
+          return ReceiveInterest (Wire::ToInterest (packet, Wire::WIRE_FORMAT_NDNSIM));
+        case HeaderHelper::INTEREST_CCNB:
+          return ReceiveInterest (Wire::ToInterest (packet, Wire::WIRE_FORMAT_CCNB));
+        case HeaderHelper::CONTENT_OBJECT_NDNSIM:
+          return ReceiveData (Wire::ToData (packet, Wire::WIRE_FORMAT_NDNSIM));
+        case HeaderHelper::CONTENT_OBJECT_CCNB:
+          return ReceiveData (Wire::ToData (packet, Wire::WIRE_FORMAT_CCNB));
+        default:
+          return false;
+        }
+
+      // exception will be thrown if packet is not recognized
+    }
+  catch (UnknownHeaderException)
+    {
+      return false;
+    }
+
+  return false;
+}
+
+double
+VanetNetDeviceFace::GetDelay (double distance) const
+{
+  return (m_range - min (abs (distance), m_range)) / m_range * m_maxDelay.GetSeconds ();
+}
+
+double
+VanetNetDeviceFace::GetDistance (double sourcePosition)
+{
+  Ptr<MobilityModel> mobility = m_node->GetObject<MobilityModel> ();
+  return mobility->GetPosition ().x - sourcePosition;
+}
+
+bool
+VanetNetDeviceFace::GetProbability (double distance)
+{
+  double i = m_uniform.GetValue (0.0, 1.0);
+  double velocity = abs (m_node->GetObject<MobilityModel> ()->GetVelocity ().x);
+  double p = abs (distance) / m_range * m_probability * m_decrease
+    + velocity / 60 * (1 - m_probability) * m_decrease;
+  if (abs (distance) > m_range * m_forwardThreshold)
+    {
+      return true;
+    }
+  return i <= p;
+}
+
+}
+}
+#endif
@@ -30,12 +30,11 @@
 #include "a-ndn-app.h"
 //#include "a-ndn-consumer.h"
 #include "a-ndn-fw.h" 
-#include "a-ndn-simple-test.h"
+#include "ndn-vanet-face.h"
 #include "a-ndn-consumerbatches.h"
 
 #include "ns3/ns2-mobility-helper.h"
 
-#include "a-ndn-simple-test.h"
  
 using namespace std;
 using namespace ns3;
@@ -44,7 +43,7 @@ Ptr<ndn::NetDeviceFace>
 MyNetDeviceFaceCallback (Ptr<Node> node, Ptr<ndn::L3Protocol> ndn, Ptr<NetDevice> device)
 {
   // NS_LOG_DEBUG ("Create custom network device " << node->GetId ());
-  Ptr<ndn::NetDeviceFace> face = CreateObject<MyNetDeviceFace> (node, device);
+  Ptr<ndn::NetDeviceFace> face = CreateObject<ndn::VanetNetDeviceFace> (node, device);
   ndn->AddFace (face);
   return face;
 }
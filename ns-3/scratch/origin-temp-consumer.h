@@ -33,8 +33,7 @@
 #include "ns3/traced-value.h"
 #include "ns3/ndnSIM/utils/batches.h"
 #include "a-ndn-tag.h"
-#include "ndn-netdeviceface.h"
-#include "a-ndn-simple-test.h"
+#include "ndn-vanet-face.h"
 
 using namespace std;
 
@@ -178,19 +177,12 @@ OriginConsumer::RertransmitPacket()
   FwHopCountTag hopCountTag;
   interest->GetPayload ()->AddPacketTag (hopCountTag);
 
-  HopTag hopTag;
-  hopTag.SetHop(0);
-  hopTag.SetOverHead(0);
-  interest->GetPayload ()->AddPacketTag (hopTag);
-
-  IndexTag indexTag;
-  indexTag.SetIndex(seq);
-//  cout<<"Index"<<indexTag.GetIndex()<<endl;
-  interest->GetPayload ()->AddPacketTag (indexTag);
-
-  SourceTag sourceTag;
-  sourceTag.SetSource(m_node->GetObject<MobilityModel>()->GetPosition().x);
-  interest->GetPayload ()->AddPacketTag (sourceTag);
+  VehicleContextTag context;
+  context.SetHop(0);
+  context.SetOverHead(0);
+  context.SetIndex(seq);
+  context.SetSource(m_node->GetObject<MobilityModel>()->GetPosition().x);
+  interest->GetPayload ()->AddPacketTag (context);
 
 
   m_transmittedInterests (interest, this, m_face);
@@ -269,19 +261,12 @@ OriginConsumer::SendPacket ()
   FwHopCountTag hopCountTag;
   interest->GetPayload ()->AddPacketTag (hopCountTag);
 
-  HopTag hopTag;
-  hopTag.SetHop(0);
-  hopTag.SetOverHead(0);
-  interest->GetPayload ()->AddPacketTag (hopTag);
-
-  IndexTag indexTag;
-  indexTag.SetIndex(seq);
-//  cout<<"Index"<<indexTag.GetIndex()<<endl;
-  interest->GetPayload ()->AddPacketTag (indexTag);
-
-  SourceTag sourceTag;
-  sourceTag.SetSource(m_node->GetObject<MobilityModel>()->GetPosition().x);
-  interest->GetPayload ()->AddPacketTag (sourceTag);
+  VehicleContextTag context;
+  context.SetHop(0);
+  context.SetOverHead(0);
+  context.SetIndex(seq);
+  context.SetSource(m_node->GetObject<MobilityModel>()->GetPosition().x);
+  interest->GetPayload ()->AddPacketTag (context);
 
 
   m_transmittedInterests (interest, this, m_face);
@@ -303,9 +288,9 @@ OriginConsumer::OnData (Ptr<const Data> data)
   if (!m_active) return;
 
  Simulator::Cancel (m_reSendEvent);
-  IndexTag indexTag;
-  data->GetPayload ()->PeekPacketTag (indexTag);
-  int receiveIndex = indexTag.GetIndex();
+  VehicleContextTag receiveContext;
+  data->GetPayload ()->PeekPacketTag (receiveContext);
+  int receiveIndex = receiveContext.GetIndex();
 //-----------------------
   t2 = Simulator::Now().GetSeconds();
   cout<<"Receive"<<"\t"<<t2<<"\t"<<"delay"<<"\t"<<(t2-t1)<<"\t";
@@ -313,14 +298,14 @@ OriginConsumer::OnData (Ptr<const Data> data)
   cout<<"Index"<<"\t"<<m_numData<<"\t";
   FwHopCountTag hopCountTag;
   data->GetPayload ()->PeekPacketTag (hopCountTag);
-  HopTag hopTag;
-  data->GetPayload ()->PeekPacketTag (hopTag);
+  VehicleContextTag context;
+  data->GetPayload ()->PeekPacketTag (context);
   cout<<"OverHead"<<"\t";
   cout<<"Hop"<<"\t"<<hopCountTag.Get()<<"\t";
 
 //  m_node->GetObject<ns3::ndn::MyNetDeviceFace>()->totalInterestNum = 0;
-  // if(hopCountTag.Get()<hopTag.GetHop())
-  //   cout<<"Retransmit"<<"\t"<<(hopTag.GetHop()-hopCountTag.Get());
+  // if(hopCountTag.Get()<context.GetHop())
+  //   cout<<"Retransmit"<<"\t"<<(context.GetHop()-hopCountTag.Get());
    cout<<endl;
 
 
@@ -30,7 +30,7 @@
 #include "a-ndn-app.h"
 //#include "a-ndn-consumer.h"
 #include "a-ndn-fw.h"
-#include "a-ndn-simple-test.h"
+#include "ndn-vanet-face.h"
 
 #include "a-ndn-consumerbatches.h"
 
@@ -52,7 +52,9 @@ Ptr<ndn::NetDeviceFace>
 MyNetDeviceFaceCallback (Ptr<Node> node, Ptr<ndn::L3Protocol> ndn, Ptr<NetDevice> device)
 {
   // NS_LOG_DEBUG ("Create custom network device " << node->GetId ());
- Ptr<ndn::NetDeviceFace> face = CreateObject<MyNetDeviceFace> (node, device,nodeNumber);
+ Ptr<ndn::VanetNetDeviceFace> face = CreateObject<ndn::VanetNetDeviceFace> (node, device);
+ face->SetAttribute ("ConsumerId", UintegerValue (nodeNumber-2));
+ face->SetAttribute ("ProducerId", UintegerValue (nodeNumber-1));
   //Ptr<ndn::NetDeviceFace> face = CreateObject<MyNetDeviceFace> (node, device);
  //cout<<nodeNumber<<endl;
   ndn->AddFace (face);
@@ -2142,6 +2142,19 @@ void Story::ReadAndScheduleStory (std::string filePath, uint32_t simulationDurat
                               NS_ABORT_MSG ("[line " << currentLine << "] Error: Can only fake \"data\" for the torrent.");
                             }
                         }
+                      else if (buffer == "mapped")
+                        {
+                          lineBuffer >> buffer;
+
+                          if (buffer == "data")
+                            {
+                              StorageManager::GetInstance ()->SetUseMemoryMapping (true);
+                            }
+                          else
+                            {
+                              NS_ABORT_MSG ("[line " << currentLine << "] Error: Can only map \"data\" for the torrent.");
+                            }
+                        }
                       else
                         {
                           NS_ABORT_MSG ("[line " << currentLine << "] Error: The path to the torrent file must not include whitespace characters.");
@@ -2150,7 +2163,7 @@ void Story::ReadAndScheduleStory (std::string filePath, uint32_t simulationDurat
 
                   if (!useFakeData)
                     {
-                      std::cout << "		Set shared torrent file to "<< m_torrentFile << "." << std::endl;
+                      std::cout << "		Set shared torrent file to "<< m_torrentFile << (StorageManager::GetInstance ()->GetUseMemoryMapping () ? " with mapped data." : ".") << std::endl;
                     }
                   else
                     {
@@ -124,8 +124,8 @@ void BitTorrentClient::StartApplication ()
   m_interface = GetNode() ->GetDevice (m_interfaceId);
 
   // Step 2: Check whether the needed torrent is loaded correctly and set the data retrieval pointer accordingly
-  StorageManager::GetInstance ()->EnsureFileLoaded (m_torrent->GetDataPath () + "/" + m_torrent->GetFileName ());
-  m_torrentDataPtr = StorageManager::GetInstance ()->GetBufferForFile (m_torrent->GetDataPath () + "/" + m_torrent->GetFileName ());
+  StorageManager::FileId fileId = StorageManager::GetInstance ()->EnsureFileLoaded (m_torrent->GetDataPath () + "/" + m_torrent->GetFileName ());
+  m_torrentDataPtr = StorageManager::GetInstance ()->GetBufferForFile (fileId);
 
   // Step 3: Set up the bitfield
   // Step 3a: Calculate its size
@@ -21,11 +21,15 @@
 #include "StorageManager.h"
 
 #include "ns3/abort.h"
+#include "ns3/assert.h"
 #include "ns3/log.h"
 
 #include <cstring> // for memset, memcpy
 #include <fstream>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace ns3 {
 namespace bittorrent {
@@ -36,15 +40,23 @@ StorageManager::StorageManager ()
 {
   m_useFakeData = false;
   m_fakeDataCounter = 0;
+  m_useMemoryMapping = false;
 }
 
 StorageManager::~StorageManager ()
 {
-  std::map<std::string,FileInfo>::iterator iter = m_fileMap.begin ();
+  std::vector<FileInfo>::iterator iter = m_files.begin ();
 
-  for (; iter != m_fileMap.end (); ++iter)
+  for (; iter != m_files.end (); ++iter)
     {
-      delete [] iter->second.m_dataBuffer;
+      if (iter->m_mapped)
+        {
+          munmap (iter->m_dataBuffer, iter->m_fileSize);
+        }
+      else
+        {
+          delete [] iter->m_dataBuffer;
+        }
     }
 }
 
@@ -63,8 +75,8 @@ void StorageManager::SetUseFakeData (bool useFakeData)
     {
       m_useFakeData = true;
 
-      std::map<std::string,FileInfo>::iterator iter = m_fileMap.begin ();
-      for (; iter != m_fileMap.end (); ++iter)
+      std::map<std::string,FileId>::iterator iter = m_fileIds.begin ();
+      for (; iter != m_fileIds.end (); ++iter)
         {
           // We do not delete the buffer here to allow direct access without having to deal with intermediate fake data situations
           // delete [] iter->second.m_dataBuffer;
@@ -74,8 +86,8 @@ void StorageManager::SetUseFakeData (bool useFakeData)
     {
       m_useFakeData = false;
 
-      std::map<std::string,FileInfo>::iterator iter = m_fileMap.begin ();
-      for (; iter != m_fileMap.end (); ++iter)
+      std::map<std::string,FileId>::iterator iter = m_fileIds.begin ();
+      for (; iter != m_fileIds.end (); ++iter)
         {
           EnsureFileLoaded (iter->first);
         }
@@ -87,19 +99,59 @@ uint64_t StorageManager::GetFakeDataCounter() const
   return m_fakeDataCounter;
 }
 
-void StorageManager::EnsureFileLoaded (const std::string &path)
+bool StorageManager::GetUseMemoryMapping () const
 {
-  std::map<std::string,FileInfo>::iterator iter = m_fileMap.find (path);
+  return m_useMemoryMapping;
+}
+
+void StorageManager::SetUseMemoryMapping (bool useMemoryMapping)
+{
+  m_useMemoryMapping = useMemoryMapping;
+}
+
+StorageManager::FileId StorageManager::EnsureFileLoaded (const std::string &path)
+{
+  std::map<std::string,FileId>::const_iterator iter = m_fileIds.find (path);
+
+  if (iter != m_fileIds.end ())
+    {
+      return iter->second;
+    }
+
+  // this file has to be loaded
+  // get information on its size
+
+  struct stat fileStat;
+  if (stat (path.c_str (),&fileStat) != 0)
+    {
+      NS_ABORT_MSG ("StorageManager: Could not open file with path \"" << path << "\".");
+    }
+  uint64_t fileSize = static_cast<uint64_t> (fileStat.st_size);
 
-  if (iter == m_fileMap.end ())
+  FileInfo fileInfoStruct;
+  fileInfoStruct.m_fileSize = fileSize;
+
+  // an empty file cannot be mapped, but there is nothing to read either
+  if (m_useMemoryMapping && fileSize > 0)
     {
-      // this file has to be loaded
-      // get information on its size
+      int fd = open (path.c_str (), O_RDONLY);
+      if (fd < 0)
+        {
+          NS_ABORT_MSG ("StorageManager: Could not open file with path \"" << path << "\".");
+        }
 
-      struct stat fileStat;
-      stat (path.c_str (),&fileStat);
-      uint32_t fileSize = static_cast<uint32_t> (fileStat.st_size);
+      void *mapping = mmap (0, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+      close (fd);  // the mapping keeps its own reference to the file
+      if (mapping == MAP_FAILED)
+        {
+          NS_ABORT_MSG ("StorageManager: Could not map " << fileSize << " bytes of file \"" << path << "\".");
+        }
 
+      fileInfoStruct.m_dataBuffer = static_cast<uint8_t*> (mapping);
+      fileInfoStruct.m_mapped = true;
+    }
+  else
+    {
       std::ifstream theFile (path.c_str (), std::ios_base::binary | std::ios_base::in);
 
       if (!theFile.is_open () || theFile.bad ())
@@ -118,16 +170,43 @@ void StorageManager::EnsureFileLoaded (const std::string &path)
         {
           NS_ABORT_MSG ("StorageManager: Could not read " << fileSize << " bytes from file \"" << path << "\".");
         }
-      
-      FileInfo fileInfoStruct;
-      fileInfoStruct.m_fileSize = fileSize;
+
       fileInfoStruct.m_dataBuffer = fileBuffer;
+      fileInfoStruct.m_mapped = false;
+    }
+
+  NS_LOG_INFO ("StorageManager: Loaded file \"" << path << "\" (" << fileSize << " bytes" << (fileInfoStruct.m_mapped ? ", mapped" : "") << ") as file " << m_files.size () << ".");
 
-      m_fileMap[path] = fileInfoStruct;
+  FileId fileId = m_files.size ();
+  m_files.push_back (fileInfoStruct);
+  m_fileIds[path] = fileId;
+  return fileId;
+}
+
+bool StorageManager::GetFileId (const std::string &path, FileId &fileId) const
+{
+  std::map<std::string,FileId>::const_iterator iter = m_fileIds.find (path);
+
+  if (iter == m_fileIds.end ())
+    {
+      NS_LOG_ERROR ("StorageManager: File \"" << path << "\" was not found amongst the loaded files.");
+      return false;
     }
+  fileId = iter->second;
+  return true;
 }
 
 void StorageManager::CopyFileIntoBuffer (const std::string &path,uint64_t offset, uint64_t length, uint8_t *buffer)
+{
+  FileId fileId = 0;
+  // With fake data, the file does not matter
+  if (m_useFakeData || GetFileId (path, fileId))
+    {
+      CopyFileIntoBuffer (fileId, offset, length, buffer);
+    }
+}
+
+void StorageManager::CopyFileIntoBuffer (FileId fileId,uint64_t offset, uint64_t length, uint8_t *buffer)
 {
   // If we use fake data, we simply fill the buffer with FF's and adjust the first 8 bytes to the value counting the number of calls to this function
   if (m_useFakeData)
@@ -138,54 +217,49 @@ void StorageManager::CopyFileIntoBuffer (const std::string &path,uint64_t offset
     }
   else       // We return the actual data
     {
-      std::map<std::string,FileInfo>::const_iterator iter = m_fileMap.find (path);
+      NS_ASSERT_MSG (fileId < m_files.size (), "StorageManager: Unknown file id " << fileId << ".");
 
-      if (iter == m_fileMap.end ())
+      const FileInfo &fileInfo = m_files[fileId];
+      if (offset + length > fileInfo.m_fileSize)
         {
-          NS_LOG_ERROR ("StorageManager: File \"" << path << "\" was not found amongst the loaded files.");
+          NS_LOG_ERROR ("StorageManager: CopyFileIntoBuffer: Requested data out of bounds. Offset: " << offset << "; length: " << length << "; filesize : " << fileInfo.m_fileSize << ".");
           return;
         }
 
-      const uint8_t *filePtr = iter->second.m_dataBuffer;
-      if (offset + length > iter->second.m_fileSize)
-        {
-          NS_LOG_ERROR ("StorageManager: CopyFileIntoBuffer: Requested data out of bounds. Offset: " << offset << "; length: " << length << "; filesize : " << iter->second.m_fileSize << ".");
-          return;
-        }
-
-      std::memcpy (buffer,filePtr + offset,length);
+      std::memcpy (buffer,fileInfo.m_dataBuffer + offset,length);
     }
 }
 
 const uint8_t* StorageManager::GetBufferForFile(const std::string &path) const
 {
-  std::map<std::string,FileInfo>::const_iterator iter = m_fileMap.find (path);
-
-  if (iter == m_fileMap.end ())
+  FileId fileId;
+  if (!GetFileId (path, fileId))
     {
-      NS_LOG_ERROR ("StorageManager: File \"" << path << "\" was not found amongst the loaded files.");
       return 0;
     }
-  else
-    {
-      return iter->second.m_dataBuffer;
-    }
+  return GetBufferForFile (fileId);
 }
 
+const uint8_t* StorageManager::GetBufferForFile(FileId fileId) const
+{
+  NS_ASSERT_MSG (fileId < m_files.size (), "StorageManager: Unknown file id " << fileId << ".");
+  return m_files[fileId].m_dataBuffer;
+}
 
 uint64_t StorageManager::GetBufferSizeForFile(const std::string &path) const
 {
-  std::map<std::string,FileInfo>::const_iterator iter = m_fileMap.find (path);
-
-  if (iter == m_fileMap.end ())
+  FileId fileId;
+  if (!GetFileId (path, fileId))
     {
-      NS_LOG_ERROR ("StorageManager: File \"" << path << "\" was not found amongst the loaded files.");
       return 0;
     }
-  else
-    {
-      return iter->second.m_fileSize;
-    }
+  return GetBufferSizeForFile (fileId);
+}
+
+uint64_t StorageManager::GetBufferSizeForFile(FileId fileId) const
+{
+  NS_ASSERT_MSG (fileId < m_files.size (), "StorageManager: Unknown file id " << fileId << ".");
+  return m_files[fileId].m_fileSize;
 }
 
 } // ns bittorrent
@@ -23,6 +23,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 #include <inttypes.h>
 
 namespace ns3 {
@@ -35,19 +36,31 @@ namespace bittorrent {
  *
  * This class provides centralized access to data shared over one or simulated BitTorrent swarms. Data is only held in memory once, and for each
  * operation which needs this data, it is copied into the desired location for local use. This avoids overly high memory usage by the model.
+ *
+ * Each loaded file is given a compact integer id by EnsureFileLoaded(). The methods taking such an id avoid looking up the path of the file.
+ *
+ * When memory mapping is enabled (see SetUseMemoryMapping()), the shared files are mapped read-only into memory instead of being read into
+ * the heap. Their contents are then only read from the disk when accessed and are shared with any other process mapping the same files,
+ * which keeps multi-gigabyte torrents from inflating the resident memory and the start-up time of the simulation.
  */
 class StorageManager
 {
+public:
+  typedef uint32_t FileId; // Identifies a loaded shared file
+
 // Fields
 private:
   struct FileInfo // Holds information about a shared file
   {
-    uint8_t  *m_dataBuffer;  // Pointer to the beginning of the array into which the shared file is loaded
+    uint8_t  *m_dataBuffer;  // Pointer to the beginning of the array into which the shared file is loaded or mapped
     uint64_t m_fileSize;     // The length of the shared file
+    bool     m_mapped;       // Whether m_dataBuffer is a memory mapping of the file or a heap array
   };
 
-  // RENE: Probably avoid the string indexing to make access to file easier
-  std::map<std::string, FileInfo> m_fileMap; // All loaded shared files
+  std::vector<FileInfo> m_files;                // All loaded shared files, by id
+  std::map<std::string, FileId> m_fileIds;      // The ids of all loaded shared files, by path
+
+  bool m_useMemoryMapping;        // Whether to map the files subsequently loaded instead of reading them
 
   // Fake data: If fake data is enabled, the actual file will not be loaded and deterministic contents for packets will be generated
   bool m_useFakeData;             // Whether to use fake data or not
@@ -100,14 +113,39 @@ public:
    */
   uint64_t GetFakeDataCounter () const;
 
+  bool GetUseMemoryMapping () const;
+
+  /**
+   * \brief Enable or disable the memory mapping of the shared files.
+   *
+   * When memory mapping is enabled, the files subsequently loaded by EnsureFileLoaded() are mapped read-only into memory instead of being
+   * read into an internal buffer. The buffers returned by GetBufferForFile() then point into these mappings. The files already loaded are
+   * not affected.
+   *
+   * @param useMemoryMapping whether or not to map the files subsequently loaded.
+   */
+  void SetUseMemoryMapping (bool useMemoryMapping);
+
 // Main methods
 public:
   /**
-   * \brief Read a file into the internal file buffer.
+   * \brief Read (or map, see SetUseMemoryMapping()) a file into the internal file buffer, unless it is already loaded.
    *
    * @param path the path (relative to the current execution directory) to the file to be loaded.
+   *
+   * @returns the id of the file, to be passed to the other methods of this class.
    */
-  void EnsureFileLoaded (const std::string &path);
+  FileId EnsureFileLoaded (const std::string &path);
+
+  /**
+   * \brief Retrieve the id of a loaded file.
+   *
+   * @param path the path (relative to the current execution directory) to the file. Should equal an argument once passed to the EnsureFileLoaded method.
+   * @param fileId the id of the file, if it is loaded.
+   *
+   * @returns true, if the file is loaded.
+   */
+  bool GetFileId (const std::string &path, FileId &fileId) const;
 
   /**
    * \brief Copy a part of a shared file into a supplied buffer.
@@ -129,6 +167,13 @@ public:
   */
   void CopyFileIntoBuffer (const std::string &path, uint64_t offset, uint64_t length, uint8_t *buffer);
 
+  /**
+   * \brief Copy a part of a shared file into a supplied buffer.
+   *
+   * Same as above, with a file id as returned by EnsureFileLoaded.
+   */
+  void CopyFileIntoBuffer (FileId fileId, uint64_t offset, uint64_t length, uint8_t *buffer);
+
   /**
    * \brief Directly access the internal data buffer for a shared file.
    *
@@ -146,6 +191,13 @@ public:
    */
   const uint8_t* GetBufferForFile (const std::string &path) const;
 
+  /**
+   * \brief Directly access the internal data buffer for a shared file.
+   *
+   * Same as above, with a file id as returned by EnsureFileLoaded.
+   */
+  const uint8_t* GetBufferForFile (FileId fileId) const;
+
   /**
    * \brief Return the size of the internal buffer for a shared file.
    *
@@ -154,6 +206,13 @@ public:
    * @returns the size of the internal buffer associated with a shared file (in bytes).
    */
   uint64_t GetBufferSizeForFile (const std::string &path) const;
+
+  /**
+   * \brief Return the size of the internal buffer for a shared file.
+   *
+   * Same as above, with a file id as returned by EnsureFileLoaded.
+   */
+  uint64_t GetBufferSizeForFile (FileId fileId) const;
 };
 
 } // ns bittorrent
@@ -0,0 +1,137 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "PieceRarityIndex.h"
+
+#include "ns3/assert.h"
+
+namespace ns3 {
+namespace bittorrent  {
+
+PieceRarityIndex::PieceRarityIndex ()
+{
+  m_bucketStarts.resize (2, 0);
+}
+
+void PieceRarityIndex::Assign (const std::vector<uint16_t> &rarities, uint16_t maxRarity)
+{
+  uint32_t pieces = rarities.size ();
+  m_rarities = rarities;
+  m_pieces.resize (pieces);
+  m_positions.resize (pieces);
+
+  // Step 1: Count the pieces of each rarity, shifted by one so that the sums below yield the starts of the buckets
+  m_bucketStarts.assign (maxRarity + 2, 0);
+  for (uint32_t i = 0; i < pieces; ++i)
+    {
+      NS_ASSERT (rarities[i] <= maxRarity);
+      ++m_bucketStarts[rarities[i] + 1];
+    }
+  for (uint32_t r = 1; r < m_bucketStarts.size (); ++r)
+    {
+      m_bucketStarts[r] += m_bucketStarts[r - 1];
+    }
+
+  // Step 2: Sort the pieces into their buckets, using the ends of the filled parts of the buckets as cursors
+  std::vector<uint32_t> cursors (m_bucketStarts.begin (), m_bucketStarts.end () - 1);
+  for (uint32_t i = 0; i < pieces; ++i)
+    {
+      uint32_t position = cursors[rarities[i]]++;
+      m_pieces[position] = i;
+      m_positions[i] = position;
+    }
+}
+
+uint32_t PieceRarityIndex::GetNumberOfPieces () const
+{
+  return m_pieces.size ();
+}
+
+uint16_t PieceRarityIndex::GetMaxRarity () const
+{
+  return m_bucketStarts.size () - 2;
+}
+
+uint16_t PieceRarityIndex::GetRarity (uint32_t pieceIndex) const
+{
+  return m_rarities[pieceIndex];
+}
+
+void PieceRarityIndex::Swap (uint32_t position1, uint32_t position2)
+{
+  uint32_t piece1 = m_pieces[position1];
+  uint32_t piece2 = m_pieces[position2];
+  m_pieces[position1] = piece2;
+  m_positions[piece2] = position1;
+  m_pieces[position2] = piece1;
+  m_positions[piece1] = position2;
+}
+
+void PieceRarityIndex::Increment (uint32_t pieceIndex)
+{
+  uint16_t rarity = m_rarities[pieceIndex];
+  NS_ASSERT (rarity < GetMaxRarity ());
+
+  // The piece becomes the first piece of the next bucket, which grows by one at the expense of this one
+  uint32_t last = m_bucketStarts[rarity + 1] - 1;
+  Swap (m_positions[pieceIndex], last);
+  m_bucketStarts[rarity + 1] = last;
+  m_rarities[pieceIndex] = rarity + 1;
+}
+
+void PieceRarityIndex::Decrement (uint32_t pieceIndex)
+{
+  uint16_t rarity = m_rarities[pieceIndex];
+  NS_ASSERT (rarity > 0);
+
+  // The piece becomes the last piece of the previous bucket
+  uint32_t first = m_bucketStarts[rarity];
+  Swap (m_positions[pieceIndex], first);
+  m_bucketStarts[rarity] = first + 1;
+  m_rarities[pieceIndex] = rarity - 1;
+}
+
+void PieceRarityIndex::SetRarity (uint32_t pieceIndex, uint16_t rarity)
+{
+  NS_ASSERT (rarity <= GetMaxRarity ());
+  while (m_rarities[pieceIndex] < rarity)
+    {
+      Increment (pieceIndex);
+    }
+  while (m_rarities[pieceIndex] > rarity)
+    {
+      Decrement (pieceIndex);
+    }
+}
+
+uint32_t PieceRarityIndex::GetBucketSize (uint16_t rarity) const
+{
+  return m_bucketStarts[rarity + 1] - m_bucketStarts[rarity];
+}
+
+PieceRarityIndex::Iterator PieceRarityIndex::BucketBegin (uint16_t rarity) const
+{
+  return m_pieces.begin () + m_bucketStarts[rarity];
+}
+
+PieceRarityIndex::Iterator PieceRarityIndex::BucketEnd (uint16_t rarity) const
+{
+  return m_pieces.begin () + m_bucketStarts[rarity + 1];
+}
+
+} // ns bittorrent
+} // ns ns3
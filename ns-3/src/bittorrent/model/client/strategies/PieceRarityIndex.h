@@ -0,0 +1,136 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef PIECERARITYINDEX_H_
+#define PIECERARITYINDEX_H_
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+namespace bittorrent {
+
+/**
+ * \ingroup BitTorrent
+ *
+ * \brief Keeps the pieces of a torrent sorted by rarity, with constant-time rarity changes.
+ *
+ * All the pieces are stored in a single array, sorted by rarity, so that the pieces of a given
+ * rarity (a "bucket") are contiguous. The position of each piece in that array and the start of
+ * each bucket are kept alongside. Shifting the rarity of a piece by one then swaps the piece with
+ * the last (or first) piece of its bucket and moves the border between the two buckets by one,
+ * which neither allocates nor depends on the number of pieces or peers.
+ *
+ * The order of the pieces within a bucket is unspecified: a user which depends on it, such as a
+ * random choice among the pieces of a bucket, has to sort them first.
+ */
+class PieceRarityIndex
+{
+public:
+  /**
+   * An iterator over the indices of the pieces of a bucket.
+   */
+  typedef std::vector<uint32_t>::const_iterator Iterator;
+
+  PieceRarityIndex ();
+
+  /**
+   * \brief Replace the content of the index.
+   *
+   * This method sorts the pieces into their buckets in O(pieces + maxRarity).
+   *
+   * @param rarities the rarity of each piece. Each rarity must not exceed maxRarity.
+   * @param maxRarity the highest rarity of the index.
+   */
+  void Assign (const std::vector<uint16_t> &rarities, uint16_t maxRarity);
+
+  /**
+   * @returns the number of pieces of the index.
+   */
+  uint32_t GetNumberOfPieces () const;
+
+  /**
+   * @returns the highest rarity of the index.
+   */
+  uint16_t GetMaxRarity () const;
+
+  /**
+   * @param pieceIndex the index of a piece.
+   *
+   * @returns the current rarity of the piece.
+   */
+  uint16_t GetRarity (uint32_t pieceIndex) const;
+
+  /**
+   * \brief Shift the rarity of a piece up by one, in constant time.
+   *
+   * @param pieceIndex the index of a piece whose rarity is lower than GetMaxRarity ().
+   */
+  void Increment (uint32_t pieceIndex);
+
+  /**
+   * \brief Shift the rarity of a piece down by one, in constant time.
+   *
+   * @param pieceIndex the index of a piece whose rarity is not zero.
+   */
+  void Decrement (uint32_t pieceIndex);
+
+  /**
+   * \brief Set the rarity of a piece, in time proportional to the difference between the old and the new rarity.
+   *
+   * @param pieceIndex the index of a piece.
+   * @param rarity the new rarity of the piece, at most GetMaxRarity ().
+   */
+  void SetRarity (uint32_t pieceIndex, uint16_t rarity);
+
+  /**
+   * @param rarity a rarity, at most GetMaxRarity ().
+   *
+   * @returns the number of pieces of that rarity.
+   */
+  uint32_t GetBucketSize (uint16_t rarity) const;
+
+  /**
+   * @param rarity a rarity, at most GetMaxRarity ().
+   *
+   * @returns an iterator to the first piece of that rarity.
+   */
+  Iterator BucketBegin (uint16_t rarity) const;
+
+  /**
+   * @param rarity a rarity, at most GetMaxRarity ().
+   *
+   * @returns an iterator past the last piece of that rarity.
+   */
+  Iterator BucketEnd (uint16_t rarity) const;
+
+private:
+  /**
+   * \brief Exchange the pieces stored at two positions of m_pieces.
+   */
+  void Swap (uint32_t position1, uint32_t position2);
+
+  std::vector<uint32_t> m_pieces;               // The indices of all the pieces, sorted by rarity
+  std::vector<uint32_t> m_positions;            // The position of each piece in m_pieces
+  std::vector<uint16_t> m_rarities;             // The rarity of each piece
+  std::vector<uint32_t> m_bucketStarts;         // The position in m_pieces of the first piece of each rarity, followed by the number of pieces
+};
+
+} // ns bittorrent
+} // ns ns3
+
+#endif /* PIECERARITYINDEX_H_ */
@@ -26,8 +26,7 @@
 #include "ns3/log.h"
 #include "ns3/random-variable.h"
 
-#include <list>
-#include <set>
+#include <algorithm>
 #include <utility>
 #include <vector>
 
@@ -39,36 +38,28 @@ NS_OBJECT_ENSURE_REGISTERED (RarestFirstPartSelectionStrategy);
 
 RarestFirstPartSelectionStrategy::RarestFirstPartSelectionStrategy (Ptr<BitTorrentClient> myClient) : PartSelectionStrategyBase (myClient)
 {
-  // Step 1: Initialize the data structures used to determine the entropy of the pieces in the swarm
-  m_piecesByRarity = new std::set<uint32_t>[m_myClient->GetMaxPeers () + 2];
-  m_raritiesByPiece.resize (m_myClient->GetTorrent ()->GetNumberOfPieces ());
-
-  // Step 2: Iterate through the pieces and see whether they are available locally (i.e., finished) or not
+  // Step 1: Iterate through the pieces and see whether they are available locally (i.e., finished) or not
+  std::vector<uint16_t> rarities (m_myClient->GetTorrent ()->GetNumberOfPieces ());
   for (uint32_t i = 0; i < m_myClient->GetTorrent ()->GetNumberOfPieces (); ++i)
     {
-      // Step 2a: If the piece is in the list of needed pieces, it is obviously not available locally and, hence, needed
+      // Step 1a: If the piece is in the list of needed pieces, it is obviously not available locally and, hence, needed
       if (m_neededPieces.find (i) != m_neededPieces.end ())
         {
-          m_piecesByRarity[0].insert (i);
-          m_raritiesByPiece[i] = 0;
+          rarities[i] = 0;
         }
-      // Step 2b: Else, it is available locally and nothing else has to be done
+      // Step 1b: Else, it is available locally and nothing else has to be done
       else
         {
-          m_piecesByRarity[m_myClient->GetMaxPeers () + 1].insert (i);
-          m_raritiesByPiece[i] = m_myClient->GetMaxPeers () + 1;
+          rarities[i] = m_myClient->GetMaxPeers () + 1;
         }
     }
+
+  // Step 2: Initialize the data structure used to determine the entropy of the pieces in the swarm
+  m_rarityIndex.Assign (rarities, m_myClient->GetMaxPeers () + 1);
 }
 
 RarestFirstPartSelectionStrategy::~RarestFirstPartSelectionStrategy ()
 {
-  for (uint16_t i = 0; i < m_myClient->GetMaxPeers () + 2; ++i)
-    {
-      m_piecesByRarity[i].clear ();
-    }
-  delete[] m_piecesByRarity;
-  m_raritiesByPiece.clear ();
 }
 
 void RarestFirstPartSelectionStrategy::DoInitialize ()
@@ -86,34 +77,14 @@ void RarestFirstPartSelectionStrategy::DoInitialize ()
 
 void RarestFirstPartSelectionStrategy::ProcessPeerBitfieldReceivedEvent (Ptr<Peer> peer)
 {
-  // Step 1: Gather all the pieces we have to move because the newly-connected peer has them
-  std::list<std::pair<uint16_t, std::set<uint32_t>::iterator > > *toMove = new std::list<std::pair<uint16_t, std::set<uint32_t>::iterator > >[m_myClient->GetMaxPeers ()];
-  for (uint16_t i = 0; i <= m_myClient->GetMaxPeers () - 1; ++i)
-    {
-      std::set<uint32_t>::iterator it = m_piecesByRarity[i].begin ();
-      for (; it != m_piecesByRarity[i].end (); ++it)
-        {
-          if (peer->HasPiece (*it))
-            {
-              toMove[i].push_back (std::pair<uint16_t, std::set<uint32_t>::iterator > (i, it));
-            }
-        }
-    }
-
-  // Step 2: Now, move the pieces to move
-  for (uint16_t i = 0; i <= m_myClient->GetMaxPeers () - 1; ++i)
+  // Step 1: Shift the availability of all the pieces the newly-connected peer has, unless they are already announced by each peer or completed
+  for (uint32_t i = 0; i < m_rarityIndex.GetNumberOfPieces (); ++i)
     {
-      std::list<std::pair<uint16_t, std::set<uint32_t>::iterator > >::const_iterator it2 = toMove[i].begin ();
-      for (; it2 != toMove[i].end (); ++it2)
+      if (m_rarityIndex.GetRarity (i) < m_myClient->GetMaxPeers () && peer->HasPiece (i))
         {
-          std::pair<uint16_t, std::set<uint32_t>::iterator > it3 = *it2;
-          m_piecesByRarity[it3.first + 1].insert (*(it3.second));
-          m_raritiesByPiece[*(it3.second)]++;
-          m_piecesByRarity[it3.first].erase (it3.second);
+          m_rarityIndex.Increment (i);
         }
-      toMove[i].clear ();
     }
-  delete[] toMove;
 
   // Step 3: Call the base class event handler (Note: This needs to be done at the end because it may cause a call to Schedule()!)
   PartSelectionStrategyBase::ProcessBitfieldReceivedEvent (peer);
@@ -128,7 +99,7 @@ void RarestFirstPartSelectionStrategy::ProcessPeerHaveEvent (Ptr<Peer> peer, uin
     }
 
   // Step 1: Get the rarity of the newly-announced piece, return if an error (= already announced by each peer, e.g., double announce) occurred
-  uint16_t currentRarity = m_raritiesByPiece[pieceIndex];
+  uint16_t currentRarity = m_rarityIndex.GetRarity (pieceIndex);
   if (currentRarity >= m_myClient->GetMaxPeers ())
     {
       return;
@@ -136,9 +107,7 @@ void RarestFirstPartSelectionStrategy::ProcessPeerHaveEvent (Ptr<Peer> peer, uin
   // Step 1a: Else, shift the availability of the respective piece
   else
     {
-      m_piecesByRarity[currentRarity].erase (pieceIndex);
-      m_piecesByRarity[currentRarity + 1].insert (pieceIndex);
-      m_raritiesByPiece[pieceIndex] = currentRarity + 1;           // m_raritiesByPiece[pieceIndex] + 1;
+      m_rarityIndex.Increment (pieceIndex);
     }
 
   // Step 3: Call the base class event handler, e.g., for invoking the scheduler
@@ -150,32 +119,14 @@ void RarestFirstPartSelectionStrategy::ProcessPeerConnectionCloseEvent (Ptr<Peer
   /*
    * NOTE: This function is more or less the "inverse" to ProcessBitfieldReceivedEvent, so no further annotations here
    */
-  std::list<std::pair<uint16_t, std::set<uint32_t>::iterator > > *toMove = new std::list<std::pair<uint16_t, std::set<uint32_t>::iterator > >[m_myClient->GetMaxPeers ()];
-  for (uint16_t i = 1; i <= m_myClient->GetMaxPeers (); ++i)
-    {
-      std::set<uint32_t>::iterator it = m_piecesByRarity[i].begin ();
-      for (; it != m_piecesByRarity[i].end (); ++it)
-        {
-          if (peer->HasPiece (*it))
-            {
-              toMove[i - 1].push_back (std::pair<uint16_t, std::set<uint32_t>::iterator > (i, it));
-            }
-        }
-    }
-
-  for (uint16_t i = 1; i <= m_myClient->GetMaxPeers (); ++i)
+  for (uint32_t i = 0; i < m_rarityIndex.GetNumberOfPieces (); ++i)
     {
-      std::list<std::pair<uint16_t, std::set<uint32_t>::iterator > >::const_iterator it2 = toMove[i - 1].begin ();
-      for (; it2 != toMove[i - 1].end (); ++it2)
+      uint16_t rarity = m_rarityIndex.GetRarity (i);
+      if (rarity >= 1 && rarity <= m_myClient->GetMaxPeers () && peer->HasPiece (i))
         {
-          std::pair<uint16_t, std::set<uint32_t>::iterator > it3 = *it2;
-          m_piecesByRarity[it3.first - 1].insert (*(it3.second));
-          m_raritiesByPiece[*(it3.second)]--;
-          m_piecesByRarity[it3.first].erase (it3.second);
+          m_rarityIndex.Decrement (i);
         }
-      toMove[i - 1].clear ();
     }
-  delete[] toMove;
 
   PartSelectionStrategyBase::ProcessPeerConnectionCloseEvent (peer);
 }
@@ -190,62 +141,42 @@ void RarestFirstPartSelectionStrategy::ProcessStrategyOptionsChangedEvent ()
       uint16_t oldMaxPeers = lexical_cast<uint16_t> (maxPeers.first);
       uint16_t newMaxPeers = lexical_cast<uint16_t> (maxPeers.second);
 
-      // Step 2: Now, we create a new array, assign the values accordingly, delete the old array and set the pointer to the new array start
-      // Step 2a: The easy case: newMaxPeers >= oldMaxPeers: Just enlarge the array
-      if (newMaxPeers >= oldMaxPeers)
+      // Step 2: Now, we compute the rarities of the pieces with respect to the new maximum and re-fill the index with them
+      std::vector<uint16_t> rarities (m_rarityIndex.GetNumberOfPieces ());
+      for (uint32_t i = 0; i < m_rarityIndex.GetNumberOfPieces (); ++i)
         {
-          std::set<uint32_t>* newPiecesByRarity = new std::set<uint32_t>[newMaxPeers + 2];
-          for (uint32_t i = 0; i < oldMaxPeers; ++i)
+          // Step 2a: The easy case: The piece is available locally
+          if (m_neededPieces.find (i) == m_neededPieces.end ())
             {
-              newPiecesByRarity[i] = m_piecesByRarity[i];
-              m_piecesByRarity[i].clear ();
+              rarities[i] = newMaxPeers + 1;
             }
-          delete[] m_piecesByRarity;
-          m_piecesByRarity = newPiecesByRarity;
-        }
-      /*
-       * Step 2b: The not-so-easy case: newMaxPeers < oldMaxPeers: Resize the array and re-fill it
-       * NOTE: This implementation DEMANDS that the surplus peers have already been correctly de-registered from the client!
-       *       Otherwise, the strategy is unable to determine the number of correctly-registered clients.
-       *       Note that this is normally guaranteed if any strategy responsible for peer connections is the first strategy
-       *       informed about this event. The standard implementation of the ProtocolFactory guarantees this.
-       */
-      else
-        {
-          // Step 2b1: Delete the array of old sets and create a new one
-          for (uint32_t i = 0; i < oldMaxPeers; ++i)
+          // Step 2b: The also-easy case: newMaxPeers >= oldMaxPeers: Keep the rarity of the piece
+          else if (newMaxPeers >= oldMaxPeers)
             {
-              m_piecesByRarity[i].clear ();
+              rarities[i] = m_rarityIndex.GetRarity (i);
             }
-          delete[] m_piecesByRarity;
-          m_piecesByRarity = new std::set<uint32_t>[newMaxPeers + 2];
-
-          // Step 2b2: Now, refill the buckets
-          for (uint32_t i = 0; i < m_myClient->GetTorrent ()->GetNumberOfPieces (); ++i)
+          /*
+           * Step 2c: The not-so-easy case: newMaxPeers < oldMaxPeers: Recount the rarity of the piece
+           * NOTE: This implementation DEMANDS that the surplus peers have already been correctly de-registered from the client!
+           *       Otherwise, the strategy is unable to determine the number of correctly-registered clients.
+           *       Note that this is normally guaranteed if any strategy responsible for peer connections is the first strategy
+           *       informed about this event. The standard implementation of the ProtocolFactory guarantees this.
+           */
+          else
             {
-              // Step 2b2a: The easy subcase: The piece is available locally
-              if (m_neededPieces.find (i) == m_neededPieces.end ())
-                {
-                  m_piecesByRarity[newMaxPeers + 1].insert (i);
-                  m_raritiesByPiece[i] = newMaxPeers + 1;
-                }
-              // Step 2b2b: The not-so.easy subcase: The piece is NOT available locally, so we have to recount its rarity
-              else
+              uint16_t rarity = 0;
+              for (std::vector<Ptr<Peer> >::const_iterator it = m_myClient->GetPeerListIterator (); it != m_myClient->GetPeerListEnd (); ++it)
                 {
-                  uint16_t rarity = 0;
-                  for (std::vector<Ptr<Peer> >::const_iterator it = m_myClient->GetPeerListIterator (); it != m_myClient->GetPeerListEnd (); ++it)
+                  if ((*it)->HasPiece (i))
                     {
-                      if ((*it)->HasPiece (i))
-                        {
-                          ++rarity;
-                        }
+                      ++rarity;
                     }
-
-                  m_piecesByRarity[rarity].insert (i);
-                  m_raritiesByPiece[i] = rarity;
                 }
+
+              rarities[i] = rarity;
             }
         }
+      m_rarityIndex.Assign (rarities, newMaxPeers + 1);
     }
 
   // Step 2: Call the base class event handler
@@ -255,22 +186,13 @@ void RarestFirstPartSelectionStrategy::ProcessStrategyOptionsChangedEvent ()
 void RarestFirstPartSelectionStrategy::ProcessCompletedPiece (uint32_t pieceIndex)
 {
   // Step 1: Get the current rarity of the newly-completed piece
-  uint16_t currentRarity = m_raritiesByPiece[pieceIndex];
+  uint16_t currentRarity = m_rarityIndex.GetRarity (pieceIndex);
 
   // Step 2: If the rarity was not the "maximum rarity" (i.e., it was missing), mark it as completed
+  // (this walks through the buckets above the piece, but happens only once per piece)
   if (currentRarity <= m_myClient->GetMaxPeers ())
     {
-      m_piecesByRarity[currentRarity].erase (pieceIndex);
-
-      // OLD
-      // m_piecesByRarity[m_myClient->GetMaxPeers () + 1].insert (pieceIndex);
-
-      // MEMORY
-      uint32_t newRarity = m_myClient->GetMaxPeers () + 1;
-      m_piecesByRarity[newRarity].insert (pieceIndex);
-      // /MEMORY
-
-      m_raritiesByPiece[pieceIndex] = m_myClient->GetMaxPeers () + 1;
+      m_rarityIndex.SetRarity (pieceIndex, m_myClient->GetMaxPeers () + 1);
     }
 
   // Step 3: Call the base class event handler
@@ -305,7 +227,7 @@ void RarestFirstPartSelectionStrategy::GetHighestPriorityBlockForPeer (Ptr<Peer>
               blockPtr.m_blockOffset = (*blockIt).first;
               blockPtr.m_blockLength = (*blockIt).second - (*blockIt).first;
 
-              NS_LOG_INFO ("Rarest First educated guess chose piece " << (*npmIt).second.m_pieceIndex << "@" << (*blockIt).first << "->" << (*blockIt).second - (*blockIt).first << " (rarity " <<  m_raritiesByPiece[(*npmIt).second.m_pieceIndex] << ").");
+              NS_LOG_INFO ("Rarest First educated guess chose piece " << (*npmIt).second.m_pieceIndex << "@" << (*blockIt).first << "->" << (*blockIt).second - (*blockIt).first << " (rarity " <<  m_rarityIndex.GetRarity ((*npmIt).second.m_pieceIndex) << ").");
 
               blockFound = true;
               break;
@@ -329,12 +251,12 @@ void RarestFirstPartSelectionStrategy::GetHighestPriorityBlockForPeer (Ptr<Peer>
   while (!blockFound && i <= m_myClient->GetMaxPeers ())
     {
       // Step 3b1a: Only if this bucket is nonempty, enter it
-      if (m_piecesByRarity[i].size () > 0)
+      if (m_rarityIndex.GetBucketSize (i) > 0)
         {
           // Step 3b1a1: Now, prepare a data structure which contains all pieces of the current availability bucket AT THE GIVEN PEER
           std::vector<std::pair<uint32_t, std::pair<uint32_t, uint32_t> > > possibleBlocks;
-          possibleBlocks.reserve (m_piecesByRarity[i].size ());
-          for (std::set<uint32_t>::const_iterator it = m_piecesByRarity[i].begin (); it != m_piecesByRarity[i].end (); ++it)
+          possibleBlocks.reserve (m_rarityIndex.GetBucketSize (i));
+          for (PieceRarityIndex::Iterator it = m_rarityIndex.BucketBegin (i); it != m_rarityIndex.BucketEnd (i); ++it)
             {
               // Step 3b1a1b: Find the first fitting block for each piece
               if (peer->HasPiece (*it))
@@ -359,13 +281,16 @@ void RarestFirstPartSelectionStrategy::GetHighestPriorityBlockForPeer (Ptr<Peer>
           // Step 3b1a2: If we have found any blocks, randomly choose one of them
           if (possibleBlocks.size () != 0)
             {
+              // The pieces of a bucket are not kept in order: sort the blocks by piece index, as the former
+              // std::set buckets listed them, so that the same random number chooses the same piece
+              std::sort (possibleBlocks.begin (), possibleBlocks.end ());
               UniformVariable uv;
               uint32_t index = uv.GetInteger (0, possibleBlocks.size () - 1);
               blockPtr.m_pieceIndex = possibleBlocks[index].first;
               blockPtr.m_blockOffset = possibleBlocks[index].second.first;
               blockPtr.m_blockLength = possibleBlocks[index].second.second - possibleBlocks[index].second.first;
 
-              NS_LOG_INFO ("Rarest First heuristic chose piece " << blockPtr.m_pieceIndex << "@" << blockPtr.m_blockOffset << "->" << blockPtr.m_blockOffset + blockPtr.m_blockLength << " (rarity " <<  m_raritiesByPiece[blockPtr.m_pieceIndex] << ").");
+              NS_LOG_INFO ("Rarest First heuristic chose piece " << blockPtr.m_pieceIndex << "@" << blockPtr.m_blockOffset << "->" << blockPtr.m_blockOffset + blockPtr.m_blockLength << " (rarity " <<  m_rarityIndex.GetRarity (blockPtr.m_pieceIndex) << ").");
 
               possibleBlocks.clear ();
               blockFound = true;
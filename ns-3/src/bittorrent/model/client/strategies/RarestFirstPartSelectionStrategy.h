@@ -22,9 +22,7 @@
 #define RFPARTSELECTIONSTRATEGY_H_
 
 #include "ns3/PartSelectionStrategyBase.h"
-
-#include <set>
-#include <vector>
+#include "ns3/PieceRarityIndex.h"
 
 namespace ns3 {
 namespace bittorrent {
@@ -44,12 +42,15 @@ class Peer;
  * that first tries to download missing blocks of a piece already requested from a peer (to complete that piece)
  * and only then selects the pieces for download according to the rarest-first scheme.
  *
+ * The rarities are kept in a PieceRarityIndex, so that a HAVE message costs a constant time whatever
+ * the size of the torrent and of the swarm. Rarity 0 to GetMaxPeers () count the peers announcing a
+ * missing piece; the completed pieces are kept at rarity GetMaxPeers () + 1.
+ *
  */
 class RarestFirstPartSelectionStrategy : public PartSelectionStrategyBase {
 // Fields
 protected:
-	std::set<uint32_t> *m_piecesByRarity;
-	std::vector<uint16_t> m_raritiesByPiece;
+	PieceRarityIndex m_rarityIndex;
 
 // Constructors etc.
 public:
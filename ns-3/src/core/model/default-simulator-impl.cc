@@ -25,6 +25,8 @@
 
 #include "ptr.h"
 #include "pointer.h"
+#include "boolean.h"
+#include "global-value.h"
 #include "assert.h"
 #include "log.h"
 
@@ -46,6 +48,19 @@ DefaultSimulatorImpl::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::DefaultSimulatorImpl")
     .SetParent<SimulatorImpl> ()
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("Scheduler",
+                   "The scheduler which holds the event list, for instance to read its statistics.",
+                   TypeId::ATTR_GET,
+                   PointerValue (),
+                   MakePointerAccessor (&DefaultSimulatorImpl::m_events),
+                   MakePointerChecker<Scheduler> ())
+    .AddAttribute ("EventPool",
+                   "The pool which recycles the storage of the events, null unless the "
+                   "global value EventPoolEnabled was true when the simulator was created.",
+                   TypeId::ATTR_GET,
+                   PointerValue (),
+                   MakePointerAccessor (&DefaultSimulatorImpl::m_pool),
+                   MakePointerChecker<EventPool> ())
   ;
   return tid;
 }
@@ -66,6 +81,13 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_unscheduledEvents = 0;
   m_eventsWithContextEmpty = true;
   m_main = SystemThread::Self();
+  BooleanValue poolEnabled;
+  GlobalValue::GetValueByName ("EventPoolEnabled", poolEnabled);
+  if (poolEnabled.Get ())
+    {
+      m_pool = CreateObject<EventPool> ();
+      m_pool->Install ();
+    }
 }
 
 DefaultSimulatorImpl::~DefaultSimulatorImpl ()
@@ -83,6 +105,11 @@ DefaultSimulatorImpl::DoDispose (void)
       next.impl->Unref ();
     }
   m_events = 0;
+  if (m_pool != 0)
+    {
+      m_pool->Dispose ();
+      m_pool = 0;
+    }
   SimulatorImpl::DoDispose ();
 }
 void
@@ -350,9 +377,26 @@ DefaultSimulatorImpl::Remove (const EventId &id)
 void
 DefaultSimulatorImpl::Cancel (const EventId &id)
 {
-  if (!IsExpired (id))
+  if (IsExpired (id))
+    {
+      return;
+    }
+  id.PeekEventImpl ()->Cancel ();
+  if (id.GetUid () == 2)
+    {
+      // destroy events are not in the event list.
+      return;
+    }
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  if (m_events->Cancel (event))
     {
-      id.PeekEventImpl ()->Cancel ();
+      // the scheduler dropped the event from the event list: unref it now.
+      event.impl->Unref ();
+      m_unscheduledEvents--;
     }
 }
 
@@ -24,6 +24,7 @@
 #include "simulator-impl.h"
 #include "scheduler.h"
 #include "event-impl.h"
+#include "event-pool.h"
 #include "system-thread.h"
 #include "ns3/system-mutex.h"
 
@@ -82,6 +83,7 @@ private:
   DestroyEvents m_destroyEvents;
   bool m_stop;
   Ptr<Scheduler> m_events;
+  Ptr<EventPool> m_pool;
 
   uint32_t m_uid;
   uint32_t m_currentUid;
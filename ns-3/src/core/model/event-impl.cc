@@ -19,6 +19,7 @@
  */
 
 #include "event-impl.h"
+#include "event-pool.h"
 #include "log.h"
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
@@ -31,7 +32,8 @@ EventImpl::~EventImpl ()
 }
 
 EventImpl::EventImpl ()
-  : m_cancel (false)
+  : m_cancel (false),
+    m_schedulerIndex (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -60,4 +62,30 @@ EventImpl::IsCancelled (void)
   return m_cancel;
 }
 
+void
+EventImpl::SetSchedulerIndex (uint32_t index)
+{
+  NS_LOG_FUNCTION (this << index);
+  m_schedulerIndex = index;
+}
+
+uint32_t
+EventImpl::GetSchedulerIndex (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_schedulerIndex;
+}
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+  return EventPool::Allocate (size);
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  EventPool::Deallocate (p, size);
+}
+
 } // namespace ns3
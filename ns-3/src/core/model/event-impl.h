@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
 
 namespace ns3 {
@@ -57,12 +58,31 @@ public:
    * Invoked by the simulation engine before calling Invoke.
    */
   bool IsCancelled (void);
+  /**
+   * \param index the position of the event in the event list
+   *
+   * Reserved to the Scheduler which holds the event, to find it in
+   * constant time when it is removed.
+   */
+  void SetSchedulerIndex (uint32_t index);
+  /**
+   * \returns the position set by the Scheduler which holds the event.
+   */
+  uint32_t GetSchedulerIndex (void) const;
+
+  /**
+   * The events are allocated by the EventPool installed in the calling
+   * thread, if any, and by the system otherwise.
+   */
+  static void *operator new (std::size_t size);
+  static void operator delete (void *p, std::size_t size);
 
 protected:
   virtual void Notify (void) = 0;
 
 private:
   bool m_cancel;
+  uint32_t m_schedulerIndex;
 };
 
 } // namespace ns3
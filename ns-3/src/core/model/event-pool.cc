@@ -0,0 +1,220 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-pool.h"
+#include "global-value.h"
+#include "boolean.h"
+#include "uinteger.h"
+#include "log.h"
+#include "ns3/core-config.h"
+#include <new>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif /* HAVE_PTHREAD_H */
+
+// Note: Allocate and Deallocate do not log, since they are called for
+// every event.
+
+NS_LOG_COMPONENT_DEFINE ("EventPool");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (EventPool);
+
+static GlobalValue g_eventPoolEnabled = GlobalValue ("EventPoolEnabled",
+                                                     "Whether the simulator recycles the storage of the events",
+                                                     BooleanValue (false),
+                                                     MakeBooleanChecker ());
+
+#ifdef HAVE_PTHREAD_H
+
+/// The pool installed in each thread, if any.
+static pthread_key_t g_currentKey;
+static pthread_once_t g_currentOnce = PTHREAD_ONCE_INIT;
+
+static void
+CreateCurrentKey (void)
+{
+  pthread_key_create (&g_currentKey, 0);
+}
+
+static EventPool *
+GetCurrent (void)
+{
+  pthread_once (&g_currentOnce, &CreateCurrentKey);
+  return static_cast<EventPool *> (pthread_getspecific (g_currentKey));
+}
+
+static void
+SetCurrent (EventPool *pool)
+{
+  pthread_once (&g_currentOnce, &CreateCurrentKey);
+  pthread_setspecific (g_currentKey, pool);
+}
+
+#else /* HAVE_PTHREAD_H */
+
+/// Without threads, the pool installed by the simulator, if any.
+static EventPool *g_current = 0;
+
+static EventPool *
+GetCurrent (void)
+{
+  return g_current;
+}
+
+static void
+SetCurrent (EventPool *pool)
+{
+  g_current = pool;
+}
+
+#endif /* HAVE_PTHREAD_H */
+
+TypeId
+EventPool::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::EventPool")
+    .SetParent<Object> ()
+    .AddConstructor<EventPool> ()
+    .AddAttribute ("Hits",
+                   "The number of events allocated from the free lists.",
+                   TypeId::ATTR_GET,
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&EventPool::GetNHits),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("Allocations",
+                   "The number of events allocated from the system.",
+                   TypeId::ATTR_GET,
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&EventPool::GetNAllocations),
+                   MakeUintegerChecker<uint64_t> ())
+  ;
+  return tid;
+}
+
+EventPool::EventPool ()
+  : m_installed (false),
+    m_nHits (0),
+    m_nAllocations (0)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < N_CLASSES; i++)
+    {
+      m_free[i] = 0;
+    }
+}
+
+EventPool::~EventPool ()
+{
+  NS_LOG_FUNCTION (this);
+  Release ();
+}
+
+void
+EventPool::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_installed)
+    {
+      NS_ASSERT_MSG (GetCurrent () == this, "An EventPool must be disposed by the thread which installed it");
+      // the events still alive are freed by the system from now on.
+      SetCurrent (0);
+      m_installed = false;
+    }
+  Release ();
+  Object::DoDispose ();
+}
+
+void
+EventPool::Release (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < N_CLASSES; i++)
+    {
+      while (m_free[i] != 0)
+        {
+          Block *block = m_free[i];
+          m_free[i] = block->next;
+          ::operator delete (block);
+        }
+    }
+}
+
+void
+EventPool::Install (void)
+{
+  NS_LOG_FUNCTION (this);
+  EventPool *previous = GetCurrent ();
+  if (previous != 0)
+    {
+      previous->m_installed = false;
+    }
+  SetCurrent (this);
+  m_installed = true;
+}
+
+void *
+EventPool::Allocate (std::size_t size)
+{
+  if (size > MAX_SIZE)
+    {
+      return ::operator new (size);
+    }
+  uint32_t c = (size - 1) / GRANULARITY;
+  EventPool *pool = GetCurrent ();
+  if (pool != 0)
+    {
+      Block *block = pool->m_free[c];
+      if (block != 0)
+        {
+          pool->m_free[c] = block->next;
+          pool->m_nHits++;
+          return block;
+        }
+      pool->m_nAllocations++;
+    }
+  return ::operator new ((c + 1) * GRANULARITY);
+}
+
+void
+EventPool::Deallocate (void *p, std::size_t size)
+{
+  EventPool *pool = GetCurrent ();
+  if (p == 0 || size > MAX_SIZE || pool == 0)
+    {
+      ::operator delete (p);
+      return;
+    }
+  uint32_t c = (size - 1) / GRANULARITY;
+  Block *block = static_cast<Block *> (p);
+  block->next = pool->m_free[c];
+  pool->m_free[c] = block;
+}
+
+uint64_t
+EventPool::GetNHits (void) const
+{
+  return m_nHits;
+}
+
+uint64_t
+EventPool::GetNAllocations (void) const
+{
+  return m_nAllocations;
+}
+
+} // namespace ns3
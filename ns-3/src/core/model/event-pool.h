@@ -0,0 +1,107 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_POOL_H
+#define EVENT_POOL_H
+
+#include "object.h"
+#include <stdint.h>
+#include <cstddef>
+
+namespace ns3 {
+
+/**
+ * \ingroup events
+ * \brief free lists for the storage of the events
+ *
+ * Each Simulator::Schedule allocates an EventImpl, which is freed when
+ * the event has run and its last EventId is gone. When the global value
+ * EventPoolEnabled is true, each DefaultSimulatorImpl creates its own pool
+ * and installs it: the EventImpl objects of up to MAX_SIZE bytes are then
+ * recycled through free lists, one per multiple of GRANULARITY bytes,
+ * instead of going back to the system allocator.
+ *
+ * A pool is installed in the calling thread only, and each thread has at
+ * most one pool, the last one installed there: the free lists are never
+ * shared between threads. The events allocated or freed by a thread
+ * without a pool, for instance through Simulator::ScheduleWithContext or
+ * by the workers of the MultithreadedSimulatorImpl, go through the system
+ * allocator. The sizes are rounded the same way in both cases, so that a
+ * block can be freed by either path.
+ *
+ * The Hits and Allocations attributes count the events served from the
+ * free lists and the ones which had to be allocated from the system.
+ */
+class EventPool : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  EventPool ();
+  virtual ~EventPool ();
+
+  /**
+   * Makes this pool serve the events allocated by the calling thread,
+   * until it is disposed or another pool is installed in that thread. An
+   * installed pool must be disposed by the thread which installed it.
+   */
+  void Install (void);
+  /**
+   * \param size the size of the object to allocate
+   * \returns a block of at least size bytes, from the pool of the calling
+   * thread if any.
+   */
+  static void *Allocate (std::size_t size);
+  /**
+   * \param p a block returned by Allocate
+   * \param size the size given to Allocate
+   */
+  static void Deallocate (void *p, std::size_t size);
+
+  /**
+   * \returns the number of blocks taken from the free lists.
+   */
+  uint64_t GetNHits (void) const;
+  /**
+   * \returns the number of blocks allocated from the system.
+   */
+  uint64_t GetNAllocations (void) const;
+
+private:
+  virtual void DoDispose (void);
+  /// Gives the blocks of the free lists back to the system.
+  void Release (void);
+
+  enum
+  {
+    GRANULARITY = 16,
+    MAX_SIZE = 256,
+    N_CLASSES = MAX_SIZE / GRANULARITY
+  };
+  struct Block
+  {
+    Block *next;
+  };
+
+  Block *m_free[N_CLASSES];
+  bool m_installed;
+  uint64_t m_nHits;
+  uint64_t m_nAllocations;
+};
+
+} // namespace ns3
+
+#endif /* EVENT_POOL_H */
@@ -0,0 +1,410 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-trace-simulator-impl.h"
+#include "string.h"
+#include "object-factory.h"
+#include "fatal-error.h"
+#include "assert.h"
+#include "log.h"
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("EventTraceSimulatorImpl");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (EventTraceSimulatorImpl);
+
+const char EventTraceSimulatorImpl::MAGIC[8] = { 'n', 's', '3', 'e', 'v', 't', 'r', 1 };
+
+EventTraceSimulatorImpl::TracedEvent::TracedEvent (EventTraceSimulatorImpl *recorder, uint64_t index,
+                                                   EventImpl *event)
+  : m_recorder (recorder),
+    m_index (index),
+    m_event (event)
+{
+}
+
+EventTraceSimulatorImpl::TracedEvent::~TracedEvent ()
+{
+  m_event->Unref ();
+}
+
+uint64_t
+EventTraceSimulatorImpl::TracedEvent::GetIndex (void) const
+{
+  return m_index;
+}
+
+void
+EventTraceSimulatorImpl::TracedEvent::Notify (void)
+{
+  m_recorder->RecordRun (m_index);
+  m_event->Invoke ();
+}
+
+EventTraceSimulatorImpl::ForeignEvent::ForeignEvent (EventTraceSimulatorImpl *recorder, uint32_t context,
+                                                     Time const &delay, EventImpl *event)
+  : m_recorder (recorder),
+    m_context (context),
+    m_delay (delay),
+    m_event (event)
+{
+}
+
+EventTraceSimulatorImpl::ForeignEvent::~ForeignEvent ()
+{
+  if (m_event != 0)
+    {
+      m_event->Unref ();
+    }
+}
+
+void
+EventTraceSimulatorImpl::ForeignEvent::Notify (void)
+{
+  // the event of the model now enters the event list, from the thread of the simulation.
+  m_recorder->ScheduleWithContext (m_context, m_delay, m_event);
+  m_event = 0;
+}
+
+TypeId
+EventTraceSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::EventTraceSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .AddConstructor<EventTraceSimulatorImpl> ()
+    .AddAttribute ("Implementation",
+                   "The type of the simulator implementation which runs the events.",
+                   StringValue ("ns3::DefaultSimulatorImpl"),
+                   MakeStringAccessor (&EventTraceSimulatorImpl::m_implementationType),
+                   MakeStringChecker ())
+    .AddAttribute ("FileName",
+                   "The file to which the events are recorded.",
+                   StringValue ("simulator.events"),
+                   MakeStringAccessor (&EventTraceSimulatorImpl::m_fileName),
+                   MakeStringChecker ())
+  ;
+  return tid;
+}
+
+EventTraceSimulatorImpl::EventTraceSimulatorImpl ()
+  : m_nInserted (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_main = SystemThread::Self ();
+}
+
+EventTraceSimulatorImpl::~EventTraceSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+EventTraceSimulatorImpl::NotifyConstructionCompleted (void)
+{
+  NS_LOG_FUNCTION (this);
+  ObjectFactory factory;
+  factory.SetTypeId (m_implementationType);
+  m_impl = factory.Create<SimulatorImpl> ();
+  m_file.open (m_fileName.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!m_file)
+    {
+      NS_FATAL_ERROR ("Could not open " << m_fileName << " to record the events");
+    }
+  m_file.write (MAGIC, sizeof (MAGIC));
+  SimulatorImpl::NotifyConstructionCompleted ();
+}
+
+void
+EventTraceSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_impl != 0)
+    {
+      m_impl->Dispose ();
+      m_impl = 0;
+    }
+  if (m_file.is_open ())
+    {
+      m_file.close ();
+    }
+  SimulatorImpl::DoDispose ();
+}
+
+void
+EventTraceSimulatorImpl::WriteNumber (uint64_t value)
+{
+  while (value >= 0x80)
+    {
+      m_file.put (static_cast<char> ((value & 0x7f) | 0x80));
+      value >>= 7;
+    }
+  m_file.put (static_cast<char> (value));
+}
+
+EventImpl *
+EventTraceSimulatorImpl::RecordInsert (uint64_t delay, uint32_t context, EventImpl *event)
+{
+  CriticalSection cs (m_mutex);
+  m_file.put (INSERT);
+  WriteNumber (delay);
+  WriteNumber (static_cast<uint32_t> (context + 1));
+  uint64_t index = m_nInserted;
+  m_nInserted++;
+  return new TracedEvent (this, index, event);
+}
+
+void
+EventTraceSimulatorImpl::Record (enum RecordType type, const EventId &id)
+{
+  if (id.GetUid () == 2 || m_impl->IsExpired (id))
+    {
+      // a destroy event, or an event which is not in the event list anymore.
+      return;
+    }
+  const TracedEvent *event = static_cast<const TracedEvent *> (id.PeekEventImpl ());
+  CriticalSection cs (m_mutex);
+  m_file.put (type);
+  WriteNumber (m_nInserted - 1 - event->GetIndex ());
+}
+
+void
+EventTraceSimulatorImpl::RecordRun (uint64_t index)
+{
+  CriticalSection cs (m_mutex);
+  m_file.put (RUN);
+  WriteNumber (m_nInserted - 1 - index);
+}
+
+void
+EventTraceSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  m_impl->Destroy ();
+  CriticalSection cs (m_mutex);
+  m_file.flush ();
+}
+
+bool
+EventTraceSimulatorImpl::IsFinished (void) const
+{
+  return m_impl->IsFinished ();
+}
+
+void
+EventTraceSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_impl->Stop ();
+}
+
+void
+EventTraceSimulatorImpl::Stop (Time const &time)
+{
+  NS_LOG_FUNCTION (this << time.GetTimeStep ());
+  m_impl->Stop (time);
+}
+
+EventId
+EventTraceSimulatorImpl::Schedule (Time const &time, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << time.GetTimeStep () << event);
+  return m_impl->Schedule (time, RecordInsert (time.GetTimeStep (), m_impl->GetContext (), event));
+}
+
+void
+EventTraceSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &time, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << time.GetTimeStep () << event);
+  if (SystemThread::Equals (m_main))
+    {
+      m_impl->ScheduleWithContext (context, time, RecordInsert (time.GetTimeStep (), context, event));
+    }
+  else
+    {
+      // the implementation inserts the events of the other threads between two events of the
+      // simulation, so they are recorded only then.
+      m_impl->ScheduleWithContext (context, Seconds (0), new ForeignEvent (this, context, time, event));
+    }
+}
+
+EventId
+EventTraceSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << event);
+  return m_impl->ScheduleNow (RecordInsert (0, m_impl->GetContext (), event));
+}
+
+EventId
+EventTraceSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << event);
+  return m_impl->ScheduleDestroy (event);
+}
+
+void
+EventTraceSimulatorImpl::Remove (const EventId &ev)
+{
+  NS_LOG_FUNCTION (this << &ev);
+  Record (REMOVE, ev);
+  m_impl->Remove (ev);
+}
+
+void
+EventTraceSimulatorImpl::Cancel (const EventId &ev)
+{
+  NS_LOG_FUNCTION (this << &ev);
+  Record (CANCEL, ev);
+  m_impl->Cancel (ev);
+}
+
+bool
+EventTraceSimulatorImpl::IsExpired (const EventId &ev) const
+{
+  return m_impl->IsExpired (ev);
+}
+
+void
+EventTraceSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_main = SystemThread::Self ();
+  m_impl->Run ();
+  CriticalSection cs (m_mutex);
+  m_file.flush ();
+}
+
+Time
+EventTraceSimulatorImpl::Now (void) const
+{
+  return m_impl->Now ();
+}
+
+Time
+EventTraceSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  return m_impl->GetDelayLeft (id);
+}
+
+Time
+EventTraceSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return m_impl->GetMaximumSimulationTime ();
+}
+
+void
+EventTraceSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  m_impl->SetScheduler (schedulerFactory);
+}
+
+uint32_t
+EventTraceSimulatorImpl::GetSystemId (void) const
+{
+  return m_impl->GetSystemId ();
+}
+
+uint32_t
+EventTraceSimulatorImpl::GetContext (void) const
+{
+  return m_impl->GetContext ();
+}
+
+EventTraceReader::EventTraceReader ()
+  : m_nInserted (0)
+{
+}
+
+bool
+EventTraceReader::Open (std::string fileName)
+{
+  NS_LOG_FUNCTION (this << fileName);
+  m_file.open (fileName.c_str (), std::ios::in | std::ios::binary);
+  char magic[sizeof (EventTraceSimulatorImpl::MAGIC)];
+  if (!m_file.read (magic, sizeof (magic)))
+    {
+      return false;
+    }
+  m_nInserted = 0;
+  return std::equal (magic, magic + sizeof (magic), EventTraceSimulatorImpl::MAGIC);
+}
+
+bool
+EventTraceReader::ReadNumber (uint64_t &value)
+{
+  value = 0;
+  for (uint32_t shift = 0; shift < 64; shift += 7)
+    {
+      int c = m_file.get ();
+      if (c == std::ifstream::traits_type::eof ())
+        {
+          return false;
+        }
+      value |= static_cast<uint64_t> (c & 0x7f) << shift;
+      if ((c & 0x80) == 0)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+bool
+EventTraceReader::Read (Record &record)
+{
+  int type = m_file.get ();
+  if (type == std::ifstream::traits_type::eof ())
+    {
+      return false;
+    }
+  record.type = static_cast<enum EventTraceSimulatorImpl::RecordType> (type);
+  switch (type)
+    {
+    case EventTraceSimulatorImpl::INSERT:
+      {
+        uint64_t context;
+        if (!ReadNumber (record.delay) || !ReadNumber (context))
+          {
+            return false;
+          }
+        record.context = static_cast<uint32_t> (context - 1);
+        record.index = m_nInserted;
+        m_nInserted++;
+        return true;
+      }
+    case EventTraceSimulatorImpl::REMOVE:
+    case EventTraceSimulatorImpl::CANCEL:
+    case EventTraceSimulatorImpl::RUN:
+      {
+        uint64_t distance;
+        if (!ReadNumber (distance) || distance >= m_nInserted)
+          {
+            return false;
+          }
+        record.delay = 0;
+        record.context = 0;
+        record.index = m_nInserted - 1 - distance;
+        return true;
+      }
+    default:
+      NS_LOG_WARN ("Unknown record type " << type);
+      return false;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,192 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_TRACE_SIMULATOR_IMPL_H
+#define EVENT_TRACE_SIMULATOR_IMPL_H
+
+#include "simulator-impl.h"
+#include "event-impl.h"
+#include "system-thread.h"
+#include "ns3/system-mutex.h"
+#include "ptr.h"
+#include <stdint.h>
+#include <string>
+#include <fstream>
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ * \brief a SimulatorImpl which records the stream of its events
+ *
+ * This implementation forwards every call to another SimulatorImpl,
+ * given by the Implementation attribute, and writes to the file given by
+ * the FileName attribute a record of each operation on the event list:
+ * the insertion of an event, its removal, its cancellation and its run.
+ * The file can then be replayed against any Scheduler without the
+ * models, for instance with utils/bench-event-trace, to compare the
+ * schedulers on the events of a real scenario.
+ *
+ * It is selected with:
+ * \code
+ *   GlobalValue::Bind ("SimulatorImplementationType",
+ *                      StringValue ("ns3::EventTraceSimulatorImpl"));
+ *   Config::SetDefault ("ns3::EventTraceSimulatorImpl::FileName",
+ *                       StringValue ("highway.events"));
+ * \endcode
+ *
+ * The file starts with the 8 bytes of MAGIC, followed by records made
+ * of a RecordType byte and of unsigned LEB128 integers:
+ *  - INSERT: the delay of the event, in time steps, and its context
+ *    plus one (so that the 0xffffffff context of the events scheduled
+ *    outside of a node fits in one byte);
+ *  - REMOVE, CANCEL and RUN: the distance of the event from the last
+ *    event inserted, 0 for the last one.
+ * The events are numbered in insertion order; the time of an insertion
+ * is the time of the last RUN.
+ *
+ * The events scheduled from another thread with
+ * Simulator::ScheduleWithContext are recorded when they enter the event
+ * list: the implementation is given an event without delay, which is not
+ * recorded and which inserts the event of the model from the thread of
+ * the simulation, with the same time as the implementation would have
+ * given it. The destroy events, which do not enter the event list, are
+ * not recorded.
+ */
+class EventTraceSimulatorImpl : public SimulatorImpl
+{
+public:
+  static TypeId GetTypeId (void);
+
+  /// The type of a record of the file.
+  enum RecordType
+  {
+    INSERT = 0,
+    REMOVE = 1,
+    CANCEL = 2,
+    RUN = 3
+  };
+  /// The first bytes of the file, the last one being the version of the format.
+  static const char MAGIC[8];
+
+  EventTraceSimulatorImpl ();
+  ~EventTraceSimulatorImpl ();
+
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &time);
+  virtual EventId Schedule (Time const &time, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &time, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &ev);
+  virtual void Cancel (const EventId &ev);
+  virtual bool IsExpired (const EventId &ev) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+
+private:
+  /// The event given to the implementation: it records its run, then runs the event of the model.
+  class TracedEvent : public EventImpl
+  {
+  public:
+    TracedEvent (EventTraceSimulatorImpl *recorder, uint64_t index, EventImpl *event);
+    virtual ~TracedEvent ();
+    uint64_t GetIndex (void) const;
+  protected:
+    virtual void Notify (void);
+  private:
+    EventTraceSimulatorImpl *m_recorder;
+    uint64_t m_index;     // the position of the event in insertion order.
+    EventImpl *m_event;
+  };
+  /// The event given to the implementation by another thread: it inserts the event of the model.
+  class ForeignEvent : public EventImpl
+  {
+  public:
+    ForeignEvent (EventTraceSimulatorImpl *recorder, uint32_t context, Time const &delay, EventImpl *event);
+    virtual ~ForeignEvent ();
+  protected:
+    virtual void Notify (void);
+  private:
+    EventTraceSimulatorImpl *m_recorder;
+    uint32_t m_context;
+    Time m_delay;
+    EventImpl *m_event;   // 0 once inserted.
+  };
+
+  virtual void NotifyConstructionCompleted (void);
+  virtual void DoDispose (void);
+  /// Records the insertion of the event, \returns the event to give to the implementation.
+  EventImpl *RecordInsert (uint64_t delay, uint32_t context, EventImpl *event);
+  /// Records an operation on an event already inserted.
+  void Record (enum RecordType type, const EventId &id);
+  void RecordRun (uint64_t index);
+  void WriteNumber (uint64_t value);
+
+  std::string m_implementationType;
+  std::string m_fileName;
+  Ptr<SimulatorImpl> m_impl;
+  std::ofstream m_file;
+  uint64_t m_nInserted;
+  SystemMutex m_mutex;              // protects m_file and m_nInserted.
+  SystemThread::ThreadId m_main;    // the thread of the simulation.
+};
+
+/**
+ * \ingroup simulator
+ * \brief reads the file written by the EventTraceSimulatorImpl
+ */
+class EventTraceReader
+{
+public:
+  /// A record of the file.
+  struct Record
+  {
+    enum EventTraceSimulatorImpl::RecordType type;
+    uint64_t delay;     // INSERT only.
+    uint32_t context;   // INSERT only.
+    uint64_t index;     // the position of the event in insertion order.
+  };
+
+  EventTraceReader ();
+  /**
+   * \param fileName the file to read
+   * \returns false if the file cannot be opened or is not an event trace.
+   */
+  bool Open (std::string fileName);
+  /**
+   * \param record the record read
+   * \returns false at the end of the file.
+   */
+  bool Read (Record &record);
+
+private:
+  bool ReadNumber (uint64_t &value);
+
+  std::ifstream m_file;
+  uint64_t m_nInserted;
+};
+
+} // namespace ns3
+
+#endif /* EVENT_TRACE_SIMULATOR_IMPL_H */
@@ -0,0 +1,240 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "indexed-heap-scheduler.h"
+#include "event-impl.h"
+#include "boolean.h"
+#include "uinteger.h"
+#include "assert.h"
+#include "log.h"
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("IndexedHeapScheduler");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (IndexedHeapScheduler);
+
+TypeId
+IndexedHeapScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::IndexedHeapScheduler")
+    .SetParent<Scheduler> ()
+    .AddConstructor<IndexedHeapScheduler> ()
+    .AddAttribute ("EagerRemoval",
+                   "Whether the cancelled events are removed from the heap at once, "
+                   "rather than when their time comes.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&IndexedHeapScheduler::m_eagerRemoval),
+                   MakeBooleanChecker ())
+    .AddAttribute ("LiveEvents",
+                   "The number of events in the heap which were not cancelled.",
+                   TypeId::ATTR_GET,
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&IndexedHeapScheduler::GetNLive),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("CancelledEvents",
+                   "The number of cancelled events which are still in the heap.",
+                   TypeId::ATTR_GET,
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&IndexedHeapScheduler::GetNCancelled),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+IndexedHeapScheduler::IndexedHeapScheduler ()
+  : m_eagerRemoval (true),
+    m_nCancelled (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+IndexedHeapScheduler::~IndexedHeapScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+bool
+IndexedHeapScheduler::IsLess (uint32_t a, uint32_t b) const
+{
+  return m_heap[a].key < m_heap[b].key;
+}
+
+void
+IndexedHeapScheduler::Set (uint32_t index, const Event &ev)
+{
+  m_heap[index] = ev;
+  ev.impl->SetSchedulerIndex (index);
+}
+
+void
+IndexedHeapScheduler::SiftUp (uint32_t index)
+{
+  NS_LOG_FUNCTION (this << index);
+  Event ev = m_heap[index];
+  while (index > 0)
+    {
+      uint32_t parent = (index - 1) / ARITY;
+      if (!(ev.key < m_heap[parent].key))
+        {
+          break;
+        }
+      Set (index, m_heap[parent]);
+      index = parent;
+    }
+  Set (index, ev);
+}
+
+void
+IndexedHeapScheduler::SiftDown (uint32_t index)
+{
+  NS_LOG_FUNCTION (this << index);
+  uint32_t size = m_heap.size ();
+  Event ev = m_heap[index];
+  while (true)
+    {
+      uint32_t first = index * ARITY + 1;
+      if (first >= size)
+        {
+          break;
+        }
+      uint32_t last = std::min (first + ARITY, size);
+      uint32_t smallest = first;
+      for (uint32_t child = first + 1; child < last; child++)
+        {
+          if (IsLess (child, smallest))
+            {
+              smallest = child;
+            }
+        }
+      if (!(m_heap[smallest].key < ev.key))
+        {
+          break;
+        }
+      Set (index, m_heap[smallest]);
+      index = smallest;
+    }
+  Set (index, ev);
+}
+
+void
+IndexedHeapScheduler::RemoveAt (uint32_t index)
+{
+  NS_LOG_FUNCTION (this << index);
+  uint32_t last = m_heap.size () - 1;
+  if (index != last)
+    {
+      Set (index, m_heap[last]);
+      m_heap.pop_back ();
+      if (index > 0 && IsLess (index, (index - 1) / ARITY))
+        {
+          SiftUp (index);
+        }
+      else
+        {
+          SiftDown (index);
+        }
+    }
+  else
+    {
+      m_heap.pop_back ();
+    }
+}
+
+bool
+IndexedHeapScheduler::Contains (const Event &ev) const
+{
+  uint32_t index = ev.impl->GetSchedulerIndex ();
+  return index < m_heap.size () && m_heap[index].impl == ev.impl;
+}
+
+void
+IndexedHeapScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << &ev);
+  m_heap.push_back (ev);
+  SiftUp (m_heap.size () - 1);
+}
+
+bool
+IndexedHeapScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_heap.empty ();
+}
+
+Scheduler::Event
+IndexedHeapScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!m_heap.empty ());
+  return m_heap.front ();
+}
+
+Scheduler::Event
+IndexedHeapScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!m_heap.empty ());
+  Event next = m_heap.front ();
+  RemoveAt (0);
+  if (next.impl->IsCancelled () && m_nCancelled > 0)
+    {
+      m_nCancelled--;
+    }
+  return next;
+}
+
+void
+IndexedHeapScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << &ev);
+  NS_ASSERT (Contains (ev));
+  RemoveAt (ev.impl->GetSchedulerIndex ());
+}
+
+bool
+IndexedHeapScheduler::Cancel (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << &ev);
+  if (!Contains (ev))
+    {
+      // not inserted yet, for instance an event scheduled from another thread.
+      return false;
+    }
+  if (!m_eagerRemoval)
+    {
+      m_nCancelled++;
+      return false;
+    }
+  RemoveAt (ev.impl->GetSchedulerIndex ());
+  return true;
+}
+
+uint32_t
+IndexedHeapScheduler::GetNLive (void) const
+{
+  return m_heap.size () - m_nCancelled;
+}
+
+uint32_t
+IndexedHeapScheduler::GetNCancelled (void) const
+{
+  return m_nCancelled;
+}
+
+} // namespace ns3
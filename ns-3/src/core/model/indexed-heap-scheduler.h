@@ -0,0 +1,97 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef INDEXED_HEAP_SCHEDULER_H
+#define INDEXED_HEAP_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a 4-ary heap event scheduler which removes the cancelled events
+ *
+ * The other schedulers keep a cancelled event in the event list until its
+ * time comes: the simulation engine only flags it, and drops it when
+ * RemoveNext returns it. Models which cancel and reschedule timers on
+ * every received packet fill these lists with dead events.
+ *
+ * This scheduler stores, in each EventImpl, the position of the event in
+ * the heap, and keeps it up to date whenever the event moves. Remove and
+ * Cancel find the event in constant time and take it out of the heap in
+ * O(log n), so that the heap only holds live events. Setting the
+ * EagerRemoval attribute to false restores the usual behavior, which is
+ * useful to measure how many dead events a scenario produces: the
+ * LiveEvents and CancelledEvents attributes count the events of the heap
+ * which will run and the ones which were cancelled.
+ *
+ * The RealtimeSimulatorImpl, which waits for the event at the head of the
+ * list outside of its lock, does not notify the cancellations: with it,
+ * the cancelled events stay in the heap and are not counted.
+ *
+ * A 4-ary heap is used rather than a binary one: it is half as deep, and
+ * the four children of a node are contiguous in memory.
+ */
+class IndexedHeapScheduler : public Scheduler
+{
+public:
+  static TypeId GetTypeId (void);
+
+  IndexedHeapScheduler ();
+  virtual ~IndexedHeapScheduler ();
+
+  virtual void Insert (const Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Event PeekNext (void) const;
+  virtual Event RemoveNext (void);
+  virtual void Remove (const Event &ev);
+  virtual bool Cancel (const Event &ev);
+
+  /**
+   * \returns the number of events in the heap which were not cancelled.
+   */
+  uint32_t GetNLive (void) const;
+  /**
+   * \returns the number of cancelled events still in the heap, always 0
+   *      when EagerRemoval is true.
+   */
+  uint32_t GetNCancelled (void) const;
+
+private:
+  enum { ARITY = 4 };
+
+  /// \returns true if the event at position a must run before the one at b.
+  inline bool IsLess (uint32_t a, uint32_t b) const;
+  /// Stores the event at the given position and updates its index.
+  inline void Set (uint32_t index, const Event &ev);
+  void SiftUp (uint32_t index);
+  void SiftDown (uint32_t index);
+  /// Removes the event at the given position.
+  void RemoveAt (uint32_t index);
+  /// \returns true if the event is stored in this heap.
+  bool Contains (const Event &ev) const;
+
+  std::vector<Event> m_heap;
+  bool m_eagerRemoval;
+  uint32_t m_nCancelled;   // cancelled events still in the heap.
+};
+
+} // namespace ns3
+
+#endif /* INDEXED_HEAP_SCHEDULER_H */
@@ -0,0 +1,269 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "fatal-error.h"
+#include "log.h"
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+/**
+ * The order of the Bottom heap: std::push_heap keeps the greatest element
+ * first, so the comparison is reversed to keep the earliest event first.
+ */
+static bool
+IsLater (const Scheduler::Event &a, const Scheduler::Event &b)
+{
+  return b.key < a.key;
+}
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .AddConstructor<LadderScheduler> ()
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topStart (0),
+    m_topMin (0),
+    m_topMax (0),
+    m_nRungs (0),
+    m_size (0)
+{
+  NS_LOG_FUNCTION (this);
+  // the rungs are never reallocated, so that Refill can spawn a rung while
+  // it holds a reference to a bucket of another rung.
+  m_rungs.resize (MAX_RUNGS);
+}
+
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+LadderScheduler::GetCurrentStart (const Rung &rung)
+{
+  return rung.start + rung.current * rung.width;
+}
+
+void
+LadderScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << &ev);
+  uint64_t ts = ev.key.m_ts;
+  m_size++;
+  if (ts >= m_topStart)
+    {
+      if (m_top.empty ())
+        {
+          m_topMin = ts;
+          m_topMax = ts;
+        }
+      m_topMin = std::min (m_topMin, ts);
+      m_topMax = std::max (m_topMax, ts);
+      m_top.push_back (ev);
+    }
+  else
+    {
+      InsertBelowTop (ev);
+    }
+  if (m_bottom.empty ())
+    {
+      Refill ();
+    }
+}
+
+void
+LadderScheduler::InsertBelowTop (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << &ev);
+  uint64_t ts = ev.key.m_ts;
+  for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+      Rung &rung = m_rungs[i];
+      if (ts >= GetCurrentStart (rung))
+        {
+          uint64_t bucket = (ts - rung.start) / rung.width;
+          NS_ASSERT (bucket < rung.buckets.size ());
+          rung.buckets[bucket].push_back (ev);
+          rung.count++;
+          return;
+        }
+    }
+  m_bottom.push_back (ev);
+  std::push_heap (m_bottom.begin (), m_bottom.end (), IsLater);
+}
+
+void
+LadderScheduler::Spawn (uint64_t start, uint64_t range, Bucket &events)
+{
+  NS_LOG_FUNCTION (this << start << range << events.size ());
+  NS_ASSERT (m_nRungs < MAX_RUNGS && range > 0 && !events.empty ());
+  Rung &rung = m_rungs[m_nRungs];
+  m_nRungs++;
+  uint64_t n = std::min<uint64_t> (events.size (), MAX_BUCKETS);
+  rung.start = start;
+  rung.width = range / n + (range % n != 0 ? 1 : 0);
+  rung.current = 0;
+  rung.count = events.size ();
+  // all the buckets of a consumed rung are empty: resizing keeps their storage.
+  rung.buckets.resize ((range + rung.width - 1) / rung.width);
+  for (Bucket::const_iterator i = events.begin (); i != events.end (); i++)
+    {
+      rung.buckets[(i->key.m_ts - start) / rung.width].push_back (*i);
+    }
+}
+
+void
+LadderScheduler::Refill (void)
+{
+  NS_LOG_FUNCTION (this);
+  while (m_size > 0 && m_bottom.empty ())
+    {
+      while (m_nRungs > 0 && m_rungs[m_nRungs - 1].count == 0)
+        {
+          m_nRungs--;
+        }
+      if (m_nRungs == 0)
+        {
+          // the ladder is empty: start a new epoch with the events of Top.
+          NS_ASSERT (!m_top.empty ());
+          Spawn (m_topMin, m_topMax - m_topMin + 1, m_top);
+          const Rung &rung = m_rungs[0];
+          m_topStart = rung.start + rung.buckets.size () * rung.width;
+          m_top.clear ();
+          continue;
+        }
+      Rung &rung = m_rungs[m_nRungs - 1];
+      while (rung.buckets[rung.current].empty ())
+        {
+          rung.current++;
+        }
+      Bucket &bucket = rung.buckets[rung.current];
+      uint64_t bucketStart = GetCurrentStart (rung);
+      rung.current++;
+      rung.count -= bucket.size ();
+      if (bucket.size () > THRESHOLD && m_nRungs < MAX_RUNGS && rung.width > 1)
+        {
+          Spawn (bucketStart, rung.width, bucket);
+          bucket.clear ();
+          continue;
+        }
+      m_bottom.swap (bucket);
+      std::make_heap (m_bottom.begin (), m_bottom.end (), IsLater);
+    }
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_size == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!m_bottom.empty ());
+  return m_bottom.front ();
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!m_bottom.empty ());
+  std::pop_heap (m_bottom.begin (), m_bottom.end (), IsLater);
+  Event next = m_bottom.back ();
+  m_bottom.pop_back ();
+  m_size--;
+  if (m_bottom.empty ())
+    {
+      Refill ();
+    }
+  return next;
+}
+
+bool
+LadderScheduler::RemoveFrom (Bucket &bucket, const Event &ev)
+{
+  for (Bucket::iterator i = bucket.begin (); i != bucket.end (); i++)
+    {
+      if (i->key.m_uid == ev.key.m_uid)
+        {
+          NS_ASSERT (i->impl == ev.impl);
+          *i = bucket.back ();
+          bucket.pop_back ();
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+LadderScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << &ev);
+  uint64_t ts = ev.key.m_ts;
+  bool found = false;
+  if (ts >= m_topStart)
+    {
+      found = RemoveFrom (m_top, ev);
+    }
+  else
+    {
+      uint32_t i;
+      for (i = 0; i < m_nRungs; i++)
+        {
+          Rung &rung = m_rungs[i];
+          if (ts >= GetCurrentStart (rung))
+            {
+              found = RemoveFrom (rung.buckets[(ts - rung.start) / rung.width], ev);
+              rung.count -= found ? 1 : 0;
+              break;
+            }
+        }
+      if (i == m_nRungs)
+        {
+          found = RemoveFrom (m_bottom, ev);
+          std::make_heap (m_bottom.begin (), m_bottom.end (), IsLater);
+        }
+    }
+  if (!found)
+    {
+      NS_FATAL_ERROR ("The event to remove is not in the list");
+    }
+  m_size--;
+  if (m_bottom.empty ())
+    {
+      Refill ();
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,107 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This class implements the Ladder Queue described in "Ladder Queue: An
+ * O(1) Priority Queue Structure for Large-Scale Discrete Event Simulation"
+ * by W.T. Tang, R.S.M. Goh and I.L.-J. Thng (ACM TOMACS, 2005).
+ *
+ * The events are spread over three tiers:
+ *  - Top: an unsorted array of the events which are later than any event
+ *    of the other tiers. Inserting there is a push_back.
+ *  - Ladder: up to MAX_RUNGS rungs of buckets. When the other tiers are
+ *    empty, Top is moved into a new rung whose bucket width is chosen from
+ *    the spread of its timestamps; a bucket which holds more than
+ *    THRESHOLD events when its turn comes is in turn split into a finer
+ *    rung. Inserting in the ladder is a division and a push_back.
+ *  - Bottom: a small binary heap which holds the events of the earliest
+ *    bucket, from which the events are dequeued.
+ *
+ * Unlike the CalendarScheduler, which rehashes all its events whenever its
+ * number of events doubles or halves, the ladder adapts its bucket widths
+ * lazily to each epoch of events, which suits distributions mixing
+ * sub-microsecond delays with timers of seconds. Remove scans the bucket
+ * (or the Top array) which holds the event, so it is linear in the size
+ * of that bucket.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  static TypeId GetTypeId (void);
+
+  LadderScheduler ();
+  virtual ~LadderScheduler ();
+
+  virtual void Insert (const Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Event PeekNext (void) const;
+  virtual Event RemoveNext (void);
+  virtual void Remove (const Event &ev);
+
+private:
+  enum
+  {
+    THRESHOLD = 50,       // the largest bucket sent to Bottom without being split.
+    MAX_RUNGS = 8,
+    MAX_BUCKETS = 4096    // the largest number of buckets of a rung.
+  };
+  typedef std::vector<Event> Bucket;
+  /// A rung of the ladder: nBuckets buckets of the given width, from start.
+  struct Rung
+  {
+    uint64_t start;
+    uint64_t width;
+    uint32_t current;     // the first bucket which was not consumed yet.
+    uint32_t count;       // the number of events in the rung.
+    std::vector<Bucket> buckets;
+  };
+
+  /// \returns the timestamp of the first bucket of the rung which was not consumed yet.
+  static uint64_t GetCurrentStart (const Rung &rung);
+  /// Inserts the event in the ladder or in Bottom, according to its timestamp.
+  void InsertBelowTop (const Event &ev);
+  /// Fills Bottom with the next bucket, after Top and the ladder if needed.
+  void Refill (void);
+  /// Creates a rung which covers [start, start + range) and moves the events into it.
+  void Spawn (uint64_t start, uint64_t range, Bucket &events);
+  /// Removes the event from the bucket, \returns false if it is not there.
+  static bool RemoveFrom (Bucket &bucket, const Event &ev);
+
+  Bucket m_top;
+  uint64_t m_topStart;              // the events at or after this time go to Top.
+  uint64_t m_topMin;
+  uint64_t m_topMax;
+  std::vector<Rung> m_rungs;        // the rungs in use are [0, m_nRungs), finer last.
+  uint32_t m_nRungs;
+  Bucket m_bottom;                  // a heap, earliest event first.
+  uint32_t m_size;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
@@ -0,0 +1,736 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-impl.h"
+#include "simulator.h"
+#include "scheduler.h"
+#include "event-impl.h"
+#include "uinteger.h"
+#include "fatal-error.h"
+#include "assert.h"
+#include "log.h"
+
+#include <algorithm>
+
+// Note:  Logging in this file is largely avoided due to the
+// number of calls that are made to these functions and the possibility
+// of causing recursions leading to stack overflow
+
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+/// The simulator whose workers are running, if any.
+static MultithreadedSimulatorImpl *g_running = 0;
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+    .AddAttribute ("Partitions",
+                   "The number of partitions, each of which runs on its own thread.",
+                   UintegerValue (2),
+                   MakeUintegerAccessor (&MultithreadedSimulatorImpl::m_nPartitions),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Lookahead",
+                   "The shortest delay of the events scheduled for another partition, "
+                   "which is the length of the windows run in parallel. With a zero value, "
+                   "the models which schedule events for other partitions derive it from "
+                   "their shortest delay, and the windows last one time step when none does.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&MultithreadedSimulatorImpl::SetLookahead,
+                                     &MultithreadedSimulatorImpl::GetLookahead),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+  : m_nPartitions (2),
+    m_limited (false),
+    m_stop (false),
+    m_running (false),
+    m_windowEnd (0),
+    m_generation (0),
+    m_nBusy (0),
+    m_exit (false)
+{
+  NS_LOG_FUNCTION (this);
+  m_main = SystemThread::Self ();
+  pthread_key_create (&m_currentKey, 0);
+  pthread_mutex_init (&m_barrierMutex, 0);
+  pthread_cond_init (&m_windowStart, 0);
+  pthread_cond_init (&m_windowDone, 0);
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+  pthread_cond_destroy (&m_windowDone);
+  pthread_cond_destroy (&m_windowStart);
+  pthread_mutex_destroy (&m_barrierMutex);
+  pthread_key_delete (m_currentKey);
+}
+
+void
+MultithreadedSimulatorImpl::NotifyConstructionCompleted (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_partitions.resize (m_nPartitions + 1);
+  for (uint32_t i = 0; i <= m_nPartitions; i++)
+    {
+      Partition &partition = m_partitions[i];
+      partition.currentTs = 0;
+      partition.currentUid = 0;
+      partition.currentContext = 0xffffffff;
+      // uids 0 to 3 are reserved: the partitions draw the others in turn,
+      // so that the uids stay unique when an event moves to another partition.
+      partition.uid = 4 + i;
+      partition.nEvents = 0;
+    }
+  SimulatorImpl::NotifyConstructionCompleted ();
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Partition>::iterator i = m_partitions.begin (); i != m_partitions.end (); i++)
+    {
+      while (i->events != 0 && !i->events->IsEmpty ())
+        {
+          Scheduler::Event next = i->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      i->events = 0;
+      for (std::vector<Pending>::iterator j = i->outbox.begin (); j != i->outbox.end (); j++)
+        {
+          j->event->Unref ();
+        }
+      i->outbox.clear ();
+    }
+  for (std::vector<Pending>::iterator j = m_foreign.begin (); j != m_foreign.end (); j++)
+    {
+      j->event->Unref ();
+    }
+  m_foreign.clear ();
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  for (std::vector<Partition>::iterator i = m_partitions.begin (); i != m_partitions.end (); i++)
+    {
+      Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+      if (i->events != 0)
+        {
+          while (!i->events->IsEmpty ())
+            {
+              scheduler->Insert (i->events->RemoveNext ());
+            }
+        }
+      i->events = scheduler;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetPartition (uint32_t context, uint32_t partition)
+{
+  NS_LOG_FUNCTION (this << context << partition);
+  NS_ASSERT_MSG (!m_running, "The partitions cannot change while they run");
+  NS_ASSERT (partition < m_nPartitions && context != 0xffffffff);
+  if (context >= m_partitionOf.size ())
+    {
+      m_partitionOf.resize (context + 1, m_nPartitions + 1);
+    }
+  m_partitionOf[context] = partition;
+  // move the events already scheduled for the context.
+  for (uint32_t i = 0; i < m_nPartitions; i++)
+    {
+      if (i == partition || m_partitions[i].events == 0)
+        {
+          continue;
+        }
+      std::vector<Scheduler::Event> kept;
+      Ptr<Scheduler> events = m_partitions[i].events;
+      while (!events->IsEmpty ())
+        {
+          Scheduler::Event ev = events->RemoveNext ();
+          if (ev.key.m_context == context)
+            {
+              m_partitions[partition].events->Insert (ev);
+            }
+          else
+            {
+              kept.push_back (ev);
+            }
+        }
+      for (std::vector<Scheduler::Event>::const_iterator j = kept.begin (); j != kept.end (); j++)
+        {
+          events->Insert (*j);
+        }
+    }
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartition (uint32_t context) const
+{
+  if (context == 0xffffffff)
+    {
+      return m_nPartitions;
+    }
+  if (context < m_partitionOf.size () && m_partitionOf[context] < m_nPartitions)
+    {
+      return m_partitionOf[context];
+    }
+  return context % m_nPartitions;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetNPartitions (void) const
+{
+  return m_nPartitions;
+}
+
+void
+MultithreadedSimulatorImpl::SetLookahead (Time lookahead)
+{
+  NS_LOG_FUNCTION (this << lookahead);
+  NS_ASSERT_MSG (!m_running, "The lookahead cannot change while the partitions run");
+  m_lookahead = lookahead;
+}
+
+void
+MultithreadedSimulatorImpl::LimitLookahead (const void *model, Time delay)
+{
+  NS_LOG_FUNCTION (this << model << delay);
+  NS_ASSERT_MSG (!m_running, "The lookahead cannot change while the partitions run");
+  m_limits[model] = delay;
+  UpdateLimit ();
+}
+
+void
+MultithreadedSimulatorImpl::UnlimitLookahead (const void *model)
+{
+  NS_LOG_FUNCTION (this << model);
+  NS_ASSERT_MSG (!m_running, "The lookahead cannot change while the partitions run");
+  m_limits.erase (model);
+  UpdateLimit ();
+}
+
+void
+MultithreadedSimulatorImpl::UpdateLimit (void)
+{
+  m_limited = false;
+  for (std::map<const void *, Time>::const_iterator i = m_limits.begin (); i != m_limits.end (); i++)
+    {
+      if (!m_limited || i->second < m_limit)
+        {
+          m_limit = i->second;
+          m_limited = true;
+        }
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookahead (void) const
+{
+  Time lookahead = m_lookahead;
+  if (m_limited && (lookahead.IsZero () || m_limit < lookahead))
+    {
+      lookahead = m_limit;
+    }
+  return std::max (lookahead, TimeStep (1));
+}
+
+MultithreadedSimulatorImpl *
+MultithreadedSimulatorImpl::PeekRunning (void)
+{
+  return g_running;
+}
+
+bool
+MultithreadedSimulatorImpl::IsParallel (void)
+{
+  return g_running != 0;
+}
+
+MultithreadedSimulatorImpl::Partition &
+MultithreadedSimulatorImpl::GetCurrent (void) const
+{
+  Partition *current = static_cast<Partition *> (pthread_getspecific (m_currentKey));
+  if (current == 0)
+    {
+      // the main thread runs the global partition.
+      return const_cast<Partition &> (m_partitions.back ());
+    }
+  return *current;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return &GetCurrent () - &m_partitions.front ();
+}
+
+void
+MultithreadedSimulatorImpl::Insert (uint32_t partition, uint64_t ts, uint32_t context, EventImpl *event)
+{
+  Partition &p = m_partitions[partition];
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  ev.key.m_uid = p.uid;
+  p.uid += m_nPartitions + 1;
+  p.events->Insert (ev);
+}
+
+void
+MultithreadedSimulatorImpl::ProcessEvents (Partition &partition, uint64_t end)
+{
+  Ptr<Scheduler> events = partition.events;
+  while (!events->IsEmpty () && events->PeekNext ().key.m_ts < end)
+    {
+      if (&partition == &m_partitions.back () && m_stop)
+        {
+          break;
+        }
+      Scheduler::Event next = events->RemoveNext ();
+      NS_ASSERT (next.key.m_ts >= partition.currentTs);
+      partition.currentTs = next.key.m_ts;
+      partition.currentContext = next.key.m_context;
+      partition.currentUid = next.key.m_uid;
+      next.impl->Invoke ();
+      next.impl->Unref ();
+      partition.nEvents++;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::MergePending (void)
+{
+  for (std::vector<Partition>::iterator i = m_partitions.begin (); i != m_partitions.end (); i++)
+    {
+      for (std::vector<Pending>::const_iterator j = i->outbox.begin (); j != i->outbox.end (); j++)
+        {
+          Insert (j->partition, j->ts, j->context, j->event);
+        }
+      i->outbox.clear ();
+    }
+  std::vector<Pending> foreign;
+  {
+    CriticalSection cs (m_foreignMutex);
+    m_foreign.swap (foreign);
+  }
+  // the delay of these events counts from the time the simulation reached.
+  uint64_t now = std::max (m_windowEnd, m_partitions.back ().currentTs);
+  for (std::vector<Pending>::const_iterator j = foreign.begin (); j != foreign.end (); j++)
+    {
+      Insert (j->partition, now + j->ts, j->context, j->event);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::RunWorker (std::pair<MultithreadedSimulatorImpl *, uint32_t> worker)
+{
+  MultithreadedSimulatorImpl *self = worker.first;
+  Partition &partition = self->m_partitions[worker.second];
+  pthread_setspecific (self->m_currentKey, &partition);
+  uint32_t generation = 0;
+  while (true)
+    {
+      pthread_mutex_lock (&self->m_barrierMutex);
+      while (self->m_generation == generation)
+        {
+          pthread_cond_wait (&self->m_windowStart, &self->m_barrierMutex);
+        }
+      generation = self->m_generation;
+      bool exit = self->m_exit;
+      pthread_mutex_unlock (&self->m_barrierMutex);
+      if (exit)
+        {
+          return;
+        }
+      self->ProcessEvents (partition, self->m_windowEnd);
+      pthread_mutex_lock (&self->m_barrierMutex);
+      self->m_nBusy--;
+      if (self->m_nBusy == 0)
+        {
+          pthread_cond_signal (&self->m_windowDone);
+        }
+      pthread_mutex_unlock (&self->m_barrierMutex);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::RunWindow (void)
+{
+  pthread_mutex_lock (&m_barrierMutex);
+  m_running = true;
+  m_nBusy = m_nPartitions;
+  m_generation++;
+  pthread_cond_broadcast (&m_windowStart);
+  while (m_nBusy > 0)
+    {
+      pthread_cond_wait (&m_windowDone, &m_barrierMutex);
+    }
+  m_running = false;
+  pthread_mutex_unlock (&m_barrierMutex);
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (g_running == 0, "Only one simulator can run at a time");
+  m_main = SystemThread::Self ();
+  m_stop = false;
+  m_exit = false;
+  m_generation = 0;
+  g_running = this;
+  for (uint32_t i = 0; i < m_nPartitions; i++)
+    {
+      Ptr<SystemThread> worker = Create<SystemThread> (MakeBoundCallback (&MultithreadedSimulatorImpl::RunWorker,
+                                                                          std::make_pair (this, i)));
+      worker->Start ();
+      m_workers.push_back (worker);
+    }
+
+  Partition &global = m_partitions.back ();
+  uint64_t nWindows = 0;
+  while (true)
+    {
+      MergePending ();
+      if (m_stop)
+        {
+          break;
+        }
+      // the time of the earliest event.
+      bool found = false;
+      uint64_t start = 0;
+      for (std::vector<Partition>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); i++)
+        {
+          if (!i->events->IsEmpty () && (!found || i->events->PeekNext ().key.m_ts < start))
+            {
+              start = i->events->PeekNext ().key.m_ts;
+              found = true;
+            }
+        }
+      if (!found)
+        {
+          break;
+        }
+      if (!global.events->IsEmpty () && global.events->PeekNext ().key.m_ts == start)
+        {
+          // the global events run alone.
+          ProcessEvents (global, start + 1);
+          continue;
+        }
+      // the global events may have lowered the lookahead.
+      m_windowEnd = start + GetLookahead ().GetTimeStep ();
+      if (!global.events->IsEmpty ())
+        {
+          m_windowEnd = std::min (m_windowEnd, global.events->PeekNext ().key.m_ts);
+        }
+      RunWindow ();
+      nWindows++;
+    }
+
+  pthread_mutex_lock (&m_barrierMutex);
+  m_exit = true;
+  m_generation++;
+  pthread_cond_broadcast (&m_windowStart);
+  pthread_mutex_unlock (&m_barrierMutex);
+  for (std::vector<Ptr<SystemThread> >::iterator i = m_workers.begin (); i != m_workers.end (); i++)
+    {
+      (*i)->Join ();
+    }
+  m_workers.clear ();
+  g_running = 0;
+  NS_LOG_LOGIC ("ran " << nWindows << " windows");
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  if (m_stop)
+    {
+      return true;
+    }
+  for (std::vector<Partition>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); i++)
+    {
+      if (!i->events->IsEmpty () || !i->outbox.empty ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_stop = true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &time)
+{
+  NS_LOG_FUNCTION (this << time.GetTimeStep ());
+  Simulator::Schedule (time, &Simulator::Stop);
+}
+
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &time, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << time.GetTimeStep () << event);
+  Partition &current = GetCurrent ();
+  NS_ASSERT_MSG (&current != &m_partitions.back () || SystemThread::Equals (m_main),
+                 "Simulator::Schedule Thread-unsafe invocation!");
+  NS_ASSERT (time.IsPositive ());
+  uint64_t ts = current.currentTs + time.GetTimeStep ();
+  Insert (&current - &m_partitions.front (), ts, current.currentContext, event);
+  return EventId (event, ts, current.currentContext, current.uid - (m_nPartitions + 1));
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &time, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << time.GetTimeStep () << event);
+  Partition &current = GetCurrent ();
+  uint32_t partition = GetPartition (context);
+  if (&current == &m_partitions.back () && !SystemThread::Equals (m_main))
+    {
+      // a thread which is not part of the simulation.
+      Pending pending;
+      pending.partition = partition;
+      pending.context = context;
+      pending.ts = time.GetTimeStep ();
+      pending.event = event;
+      CriticalSection cs (m_foreignMutex);
+      m_foreign.push_back (pending);
+      return;
+    }
+  uint64_t ts = current.currentTs + time.GetTimeStep ();
+  if (!m_running || partition == static_cast<uint32_t> (&current - &m_partitions.front ()))
+    {
+      Insert (partition, ts, context, event);
+      return;
+    }
+  if (ts < m_windowEnd)
+    {
+      NS_FATAL_ERROR ("An event scheduled for partition " << partition << " from partition " <<
+                      (&current - &m_partitions.front ()) << " is " << time.GetTimeStep () <<
+                      " time steps ahead, less than the lookahead of the simulator");
+    }
+  Pending pending;
+  pending.partition = partition;
+  pending.context = context;
+  pending.ts = ts;
+  pending.event = event;
+  current.outbox.push_back (pending);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  return Schedule (TimeStep (0), event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  CriticalSection cs (m_destroyMutex);
+  EventId id (Ptr<EventImpl> (event, false), GetCurrent ().currentTs, 0xffffffff, 2);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  // Do not add function logging here, to avoid stack overflow
+  return TimeStep (GetCurrent ().currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs () - GetCurrent ().currentTs);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      CriticalSection cs (m_destroyMutex);
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Partition &partition = m_partitions[GetPartition (id.GetContext ())];
+  NS_ASSERT_MSG (!m_running || &partition == &GetCurrent (),
+                 "An event can only be removed by its own partition");
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  partition.events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (IsExpired (id))
+    {
+      return;
+    }
+  if (id.GetUid () == 2)
+    {
+      // destroy events are not in the event list.
+      id.PeekEventImpl ()->Cancel ();
+      return;
+    }
+  Partition &partition = m_partitions[GetPartition (id.GetContext ())];
+  NS_ASSERT_MSG (!m_running || &partition == &GetCurrent (),
+                 "An event can only be cancelled by its own partition");
+  id.PeekEventImpl ()->Cancel ();
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  if (partition.events->Cancel (event))
+    {
+      // the scheduler dropped the event from the event list: unref it now.
+      event.impl->Unref ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &ev) const
+{
+  if (ev.GetUid () == 2)
+    {
+      if (ev.PeekEventImpl () == 0 ||
+          ev.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      CriticalSection cs (const_cast<SystemMutex &> (m_destroyMutex));
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == ev)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  const Partition &partition = m_partitions[GetPartition (ev.GetContext ())];
+  if (ev.PeekEventImpl () == 0 ||
+      ev.GetTs () < partition.currentTs ||
+      (ev.GetTs () == partition.currentTs &&
+       ev.GetUid () <= partition.currentUid) ||
+      ev.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  return GetCurrent ().currentContext;
+}
+
+ParallelCriticalSection::ParallelCriticalSection (SystemMutex &mutex)
+  : m_mutex (0)
+{
+  if (g_running != 0)
+    {
+      m_mutex = &mutex;
+      m_mutex->Lock ();
+    }
+}
+
+ParallelCriticalSection::~ParallelCriticalSection ()
+{
+  if (m_mutex != 0)
+    {
+      m_mutex->Unlock ();
+    }
+}
+
+} // namespace ns3
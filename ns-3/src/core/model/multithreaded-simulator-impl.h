@@ -0,0 +1,241 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MULTITHREADED_SIMULATOR_IMPL_H
+#define MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "simulator-impl.h"
+#include "scheduler.h"
+#include "event-impl.h"
+#include "system-thread.h"
+#include "system-mutex.h"
+#include "nstime.h"
+#include "ptr.h"
+
+#include <pthread.h>
+#include <list>
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ * \brief a conservative parallel simulator which runs the nodes on several threads
+ *
+ * The contexts, that is the nodes, are assigned to Partitions partitions
+ * with SetPartition; the contexts which were not assigned are spread
+ * over the partitions by their number. Each partition has its own event
+ * list and runs on its own thread. The events without a context, such as
+ * the ones scheduled by the main program, go to a global partition,
+ * which runs on the main thread while the other partitions wait.
+ *
+ * The simulation advances by windows. Each window starts at the time T
+ * of the earliest event and ends at T + Lookahead, or at the next
+ * global event if it comes first. The partitions run the events of the
+ * window in parallel and then wait for each other at a barrier, where
+ * the events which they scheduled for other partitions are inserted in
+ * a deterministic order. An event scheduled for another partition must
+ * therefore be at least Lookahead after the event which schedules it:
+ * a shorter delay is a fatal error. The Lookahead attribute is 0 by
+ * default: the models which schedule events for other partitions then
+ * derive the lookahead from their shortest delay, with LimitLookahead,
+ * and a window lasts one time step when none does. A model may update
+ * its delay between the windows, for example when its nodes move to
+ * other partitions. For wireless
+ * scenarios, the YansWifiChannel limits the lookahead to the shortest
+ * propagation delay between two PHYs of distinct partitions, and
+ * WifiPartitionHelper assigns the nodes to spatial regions.
+ *
+ * The models of the nodes of distinct partitions run at the same time:
+ * they must not share state, except for the packet free lists, which
+ * are locked while IsParallel returns true (see ParallelCriticalSection).
+ * An event may only be removed or cancelled by its own partition, or
+ * by the global partition. Simulator::Stop called by a partition stops
+ * the simulation at the end of the window.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  static TypeId GetTypeId (void);
+
+  MultithreadedSimulatorImpl ();
+  ~MultithreadedSimulatorImpl ();
+
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &time);
+  virtual EventId Schedule (Time const &time, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &time, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &ev);
+  virtual void Cancel (const EventId &ev);
+  virtual bool IsExpired (const EventId &ev) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  /**
+   * \returns the partition of the calling thread, GetNPartitions for
+   *      the global partition.
+   */
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+
+  /**
+   * \param context a context, usually a node id
+   * \param partition the partition which runs the events of the context
+   */
+  void SetPartition (uint32_t context, uint32_t partition);
+  /**
+   * \param context a context, usually a node id
+   * \returns the partition which runs the events of the context,
+   *      GetNPartitions for the events without a context.
+   */
+  uint32_t GetPartition (uint32_t context) const;
+  /**
+   * \returns the number of partitions, not counting the global one.
+   */
+  uint32_t GetNPartitions (void) const;
+  /**
+   * \param lookahead the shortest delay of the events scheduled for another
+   *      partition, 0 to let the models derive it (see LimitLookahead).
+   */
+  void SetLookahead (Time lookahead);
+  /**
+   * Set the shortest delay of the events that a model schedules for
+   * another partition. The lookahead is the smallest of the Lookahead
+   * attribute, when it is positive, and of the delays of the models: each
+   * call replaces the previous delay of the model, so that the lookahead
+   * grows again when the model gives a longer delay.
+   *
+   * \param model the model, which identifies its delay
+   * \param delay the shortest delay of the events scheduled by the model
+   */
+  void LimitLookahead (const void *model, Time delay);
+  /**
+   * Remove the delay of a model, which no longer schedules events for
+   * other partitions (see LimitLookahead).
+   *
+   * \param model the model
+   */
+  void UnlimitLookahead (const void *model);
+  /**
+   * \returns the length of the windows, at least one time step.
+   */
+  Time GetLookahead (void) const;
+
+  /**
+   * \returns the simulator whose partitions are running in parallel, 0
+   *      when no simulator runs on several threads.
+   */
+  static MultithreadedSimulatorImpl *PeekRunning (void);
+  /**
+   * \returns true while the partitions of a simulator run on several threads.
+   */
+  static bool IsParallel (void);
+
+private:
+  /// An event scheduled for another partition, inserted at the next barrier.
+  struct Pending
+  {
+    uint32_t partition;
+    uint32_t context;
+    uint64_t ts;
+    EventImpl *event;
+  };
+  /// The event list of a partition and the state of the event which runs.
+  struct Partition
+  {
+    Ptr<Scheduler> events;
+    uint64_t currentTs;
+    uint32_t currentUid;
+    uint32_t currentContext;
+    uint32_t uid;
+    std::vector<Pending> outbox;
+    uint64_t nEvents;
+  };
+  typedef std::list<EventId> DestroyEvents;
+
+  virtual void NotifyConstructionCompleted (void);
+  virtual void DoDispose (void);
+  /// \returns the partition of the calling thread.
+  Partition &GetCurrent (void) const;
+  /// Inserts the event in the event list of the partition.
+  void Insert (uint32_t partition, uint64_t ts, uint32_t context, EventImpl *event);
+  /// Runs the events of the partition which are earlier than end.
+  void ProcessEvents (Partition &partition, uint64_t end);
+  /// Inserts the events scheduled for other partitions during the last window.
+  void MergePending (void);
+  /// Waits for the windows and runs them for one partition.
+  static void RunWorker (std::pair<MultithreadedSimulatorImpl *, uint32_t> worker);
+  /// Lets the workers run the window which ends at m_windowEnd, and waits for them.
+  void RunWindow (void);
+  /// Sets m_limit to the shortest delay of m_limits.
+  void UpdateLimit (void);
+
+  uint32_t m_nPartitions;
+  Time m_lookahead;
+  std::map<const void *, Time> m_limits;  // the delay of each model, see LimitLookahead.
+  bool m_limited;                         // whether m_limits is not empty.
+  Time m_limit;                           // the shortest delay of m_limits.
+  std::vector<Partition> m_partitions;    // the global partition is the last one.
+  std::vector<uint32_t> m_partitionOf;    // by context, m_nPartitions + 1 when not assigned.
+  DestroyEvents m_destroyEvents;
+  bool m_stop;
+  bool m_running;                         // whether the workers run a window.
+  uint64_t m_windowEnd;
+  SystemThread::ThreadId m_main;
+  pthread_key_t m_currentKey;             // the Partition of the calling worker.
+
+  // events scheduled by the threads which are not part of the simulation.
+  std::vector<Pending> m_foreign;
+  SystemMutex m_foreignMutex;
+  SystemMutex m_destroyMutex;
+
+  // the barrier between the main thread and the workers.
+  std::vector<Ptr<SystemThread> > m_workers;
+  pthread_mutex_t m_barrierMutex;
+  pthread_cond_t m_windowStart;
+  pthread_cond_t m_windowDone;
+  uint32_t m_generation;                  // incremented at the start of each window.
+  uint32_t m_nBusy;                       // the workers which did not finish the window.
+  bool m_exit;
+};
+
+/**
+ * \ingroup simulator
+ * \brief locks a mutex while the partitions of a MultithreadedSimulatorImpl run in parallel
+ *
+ * The state shared by all the nodes, such as the free lists of the
+ * packets, is protected with this class: the mutex is not touched by the
+ * sequential simulations.
+ */
+class ParallelCriticalSection
+{
+public:
+  ParallelCriticalSection (SystemMutex &mutex);
+  ~ParallelCriticalSection ();
+private:
+  SystemMutex *m_mutex;
+};
+
+} // namespace ns3
+
+#endif /* MULTITHREADED_SIMULATOR_IMPL_H */
@@ -42,4 +42,11 @@ Scheduler::GetTypeId (void)
   return tid;
 }
 
+bool
+Scheduler::Cancel (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << &ev);
+  return false;
+}
+
 } // namespace ns3
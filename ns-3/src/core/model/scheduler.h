@@ -102,6 +102,17 @@ public:
    * This methods cannot be invoked if the list is empty.
    */
   virtual void Remove (const Event &ev) = 0;
+  /**
+   * \param ev the event which was just cancelled
+   * \returns true if the event was removed from the event list, in which
+   *      case the caller must release it, and false if the event stays in
+   *      the list until it is returned by RemoveNext.
+   *
+   * Invoked by the simulation engine after it cancelled an event which is
+   * still in the list. The default implementation keeps the event in the
+   * list.
+   */
+  virtual bool Cancel (const Event &ev);
 };
 
 /* Note the invariants which this function must provide:
@@ -19,10 +19,29 @@
  */
 #include "ns3/test.h"
 #include "ns3/simulator.h"
+#include "ns3/simulator-impl.h"
 #include "ns3/list-scheduler.h"
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/indexed-heap-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/make-event.h"
+#include "ns3/event-pool.h"
+#include "ns3/event-trace-simulator-impl.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/global-value.h"
+#include "ns3/boolean.h"
+#include "ns3/pointer.h"
+#include "ns3/uinteger.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif /* HAVE_PTHREAD_H */
+#include <algorithm>
+#include <set>
 
 using namespace ns3;
 
@@ -168,6 +187,459 @@ SimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_destroy, true, "Event should have run");
 }
 
+class SimulatorCancelTestCase : public TestCase
+{
+public:
+  SimulatorCancelTestCase (bool eagerRemoval);
+private:
+  virtual void DoRun (void);
+  void Event (uint32_t i);
+  uint32_t GetAttribute (std::string name);
+
+  bool m_eagerRemoval;
+  std::vector<EventId> m_ids;
+  Ptr<Scheduler> m_scheduler;
+  uint32_t m_nRun;
+  bool m_inOrder;
+  bool m_cancelledRun;
+  Time m_last;
+};
+
+SimulatorCancelTestCase::SimulatorCancelTestCase (bool eagerRemoval)
+  : TestCase (std::string ("Check that the IndexedHeapScheduler runs the events in order and counts the cancelled ones,") +
+              (eagerRemoval ? " with" : " without") + " eager removal"),
+    m_eagerRemoval (eagerRemoval)
+{
+}
+
+uint32_t
+SimulatorCancelTestCase::GetAttribute (std::string name)
+{
+  UintegerValue value;
+  m_scheduler->GetAttribute (name, value);
+  return value.Get ();
+}
+
+void
+SimulatorCancelTestCase::Event (uint32_t i)
+{
+  m_nRun++;
+  if (Simulator::Now () < m_last)
+    {
+      m_inOrder = false;
+    }
+  m_last = Simulator::Now ();
+  if (i % 3 == 0)
+    {
+      m_cancelledRun = true;
+    }
+  if (i % 10 == 1 && i + 10 < m_ids.size ())
+    {
+      // cancel, from an event, an event which is still in the heap.
+      m_ids[i + 10].Cancel ();
+    }
+}
+
+void
+SimulatorCancelTestCase::DoRun (void)
+{
+  m_nRun = 0;
+  m_inOrder = true;
+  m_cancelledRun = false;
+  m_last = Seconds (0);
+
+  ObjectFactory factory;
+  factory.SetTypeId (IndexedHeapScheduler::GetTypeId ());
+  factory.Set ("EagerRemoval", BooleanValue (m_eagerRemoval));
+  Simulator::SetScheduler (factory);
+  PointerValue scheduler;
+  Simulator::GetImplementation ()->GetAttribute ("Scheduler", scheduler);
+  m_scheduler = scheduler.Get<Scheduler> ();
+
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      // several events share the same time, the others are scattered.
+      m_ids.push_back (Simulator::Schedule (MicroSeconds ((i * 37) % 50), &SimulatorCancelTestCase::Event, this, i));
+    }
+  uint32_t nCancelled = 0;
+  for (uint32_t i = 0; i < 100; i += 3)
+    {
+      Simulator::Cancel (m_ids[i]);
+      NS_TEST_EXPECT_MSG_EQ (m_ids[i].IsExpired (), true, "A cancelled event must be expired");
+      nCancelled++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (GetAttribute ("LiveEvents"), 100 - nCancelled, "Unexpected number of live events");
+  NS_TEST_EXPECT_MSG_EQ (GetAttribute ("CancelledEvents"), (m_eagerRemoval ? 0 : nCancelled),
+                         "Unexpected number of cancelled events in the heap");
+
+  Simulator::Run ();
+  // replay the events in (time, uid) order to count the ones cancelled by Event.
+  std::vector<std::pair<uint64_t, uint32_t> > order;
+  std::vector<bool> cancelled (m_ids.size (), false);
+  for (uint32_t i = 0; i < m_ids.size (); i++)
+    {
+      order.push_back (std::make_pair (m_ids[i].GetTs (), i));
+      cancelled[i] = (i % 3 == 0);
+    }
+  std::sort (order.begin (), order.end ());
+  std::vector<bool> done (m_ids.size (), false);
+  uint32_t nCancelledDuringRun = 0;
+  for (uint32_t k = 0; k < order.size (); k++)
+    {
+      uint32_t i = order[k].second;
+      done[i] = true;
+      if (!cancelled[i] && i % 10 == 1 && i + 10 < m_ids.size () && !cancelled[i + 10] && !done[i + 10])
+        {
+          cancelled[i + 10] = true;
+          nCancelledDuringRun++;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_nRun, 100 - nCancelled - nCancelledDuringRun, "Unexpected number of events run");
+  NS_TEST_EXPECT_MSG_EQ (m_inOrder, true, "The events must run in time order");
+  NS_TEST_EXPECT_MSG_EQ (m_cancelledRun, false, "A cancelled event must not run");
+  NS_TEST_EXPECT_MSG_EQ (GetAttribute ("LiveEvents"), 0, "The heap must be empty");
+  NS_TEST_EXPECT_MSG_EQ (GetAttribute ("CancelledEvents"), 0, "The heap must be empty");
+
+  m_ids.clear ();
+  m_scheduler = 0;
+  Simulator::Destroy ();
+}
+
+class EventPoolTestCase : public TestCase
+{
+public:
+  EventPoolTestCase ();
+private:
+  virtual void DoRun (void);
+  void Event0 (void);
+  void Event3 (uint32_t a, uint64_t b, Ptr<EventPool> c);
+  uint64_t GetAttribute (std::string name);
+  static uint64_t GetAttribute (Ptr<EventPool> pool, std::string name);
+  void AllocateInThread (void);
+
+  Ptr<EventPool> m_pool;
+  uint32_t m_nRun;
+  uint64_t m_threadHits;
+  uint64_t m_threadAllocations;
+};
+
+EventPoolTestCase::EventPoolTestCase ()
+  : TestCase ("Check that the EventPool recycles the events of the simulator")
+{
+}
+
+uint64_t
+EventPoolTestCase::GetAttribute (std::string name)
+{
+  return GetAttribute (m_pool, name);
+}
+
+uint64_t
+EventPoolTestCase::GetAttribute (Ptr<EventPool> pool, std::string name)
+{
+  UintegerValue value;
+  pool->GetAttribute (name, value);
+  return value.Get ();
+}
+
+void
+EventPoolTestCase::AllocateInThread (void)
+{
+  Ptr<EventPool> pool = CreateObject<EventPool> ();
+  pool->Install ();
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      EventImpl *event = MakeEvent (&EventPoolTestCase::Event0, this);
+      event->Unref ();
+    }
+  m_threadHits = GetAttribute (pool, "Hits");
+  m_threadAllocations = GetAttribute (pool, "Allocations");
+  pool->Dispose ();
+}
+
+void
+EventPoolTestCase::Event0 (void)
+{
+  m_nRun++;
+  if (m_nRun < 1000)
+    {
+      // the next events are allocated while the current one is alive.
+      Simulator::Schedule (MicroSeconds (1), &EventPoolTestCase::Event3, this, m_nRun, 7, m_pool);
+    }
+}
+
+void
+EventPoolTestCase::Event3 (uint32_t a, uint64_t b, Ptr<EventPool> c)
+{
+  m_nRun++;
+  if (m_nRun < 1000)
+    {
+      Simulator::Schedule (MicroSeconds (1), &EventPoolTestCase::Event0, this);
+    }
+}
+
+void
+EventPoolTestCase::DoRun (void)
+{
+  Simulator::Destroy ();
+  PointerValue pool;
+  Simulator::GetImplementation ()->GetAttribute ("EventPool", pool);
+  NS_TEST_EXPECT_MSG_EQ ((pool.Get<EventPool> () == 0), true, "The pool must be disabled by default");
+  Simulator::Destroy ();
+
+  GlobalValue::Bind ("EventPoolEnabled", BooleanValue (true));
+  Simulator::GetImplementation ()->GetAttribute ("EventPool", pool);
+  m_pool = pool.Get<EventPool> ();
+  NS_TEST_ASSERT_MSG_NE (m_pool, 0, "The simulator must create a pool");
+
+  m_nRun = 0;
+  Simulator::Schedule (MicroSeconds (1), &EventPoolTestCase::Event0, this);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_nRun, 1000, "Unexpected number of events run");
+  // two events of each size are alive at most: the one which runs and the next one.
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (GetAttribute ("Allocations"), 4, "The events must be recycled");
+  NS_TEST_EXPECT_MSG_EQ (GetAttribute ("Hits") + GetAttribute ("Allocations"), 1000,
+                         "Each event must be allocated once");
+
+#ifdef HAVE_PTHREAD_H
+  // a pool installed by another thread serves that thread only.
+  Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&EventPoolTestCase::AllocateInThread, this));
+  thread->Start ();
+  thread->Join ();
+  NS_TEST_EXPECT_MSG_EQ (m_threadAllocations, 1, "The thread must recycle its events in its own pool");
+  NS_TEST_EXPECT_MSG_EQ (m_threadHits, 99, "The thread must recycle its events in its own pool");
+  NS_TEST_EXPECT_MSG_EQ (GetAttribute ("Hits") + GetAttribute ("Allocations"), 1000,
+                         "The events of another thread must not use the pool of the simulator");
+#endif /* HAVE_PTHREAD_H */
+
+  // an event which outlives the simulator is freed by the system.
+  EventId late = Simulator::Schedule (Seconds (1), &EventPoolTestCase::Event0, this);
+  m_pool = 0;
+  Simulator::Destroy ();
+  GlobalValue::Bind ("EventPoolEnabled", BooleanValue (false));
+  late = EventId ();
+}
+
+class EventTraceTestCase : public TestCase
+{
+public:
+  EventTraceTestCase ();
+private:
+  virtual void DoRun (void);
+  void Event (void);
+  void ScheduleFromThread (void);
+  void Check (const EventTraceReader::Record &record, enum EventTraceSimulatorImpl::RecordType type,
+              uint64_t index, uint64_t delay);
+  std::vector<EventTraceReader::Record> ReadRecords (std::string fileName);
+
+  uint32_t m_nRun;
+};
+
+EventTraceTestCase::EventTraceTestCase ()
+  : TestCase ("Check the records of the EventTraceSimulatorImpl")
+{
+}
+
+void
+EventTraceTestCase::Event (void)
+{
+  m_nRun++;
+  if (m_nRun == 2)
+    {
+      Simulator::Schedule (MicroSeconds (1), &EventTraceTestCase::Event, this);
+    }
+}
+
+void
+EventTraceTestCase::ScheduleFromThread (void)
+{
+  Simulator::ScheduleWithContext (7, MicroSeconds (2), &EventTraceTestCase::Event, this);
+}
+
+std::vector<EventTraceReader::Record>
+EventTraceTestCase::ReadRecords (std::string fileName)
+{
+  std::vector<EventTraceReader::Record> records;
+  EventTraceReader reader;
+  NS_TEST_EXPECT_MSG_EQ (reader.Open (fileName), true, "Could not open the event trace");
+  EventTraceReader::Record record;
+  while (reader.Read (record))
+    {
+      records.push_back (record);
+    }
+  return records;
+}
+
+void
+EventTraceTestCase::Check (const EventTraceReader::Record &record, enum EventTraceSimulatorImpl::RecordType type,
+                           uint64_t index, uint64_t delay)
+{
+  NS_TEST_EXPECT_MSG_EQ (record.type, type, "Unexpected type of record");
+  NS_TEST_EXPECT_MSG_EQ (record.index, index, "Unexpected event");
+  NS_TEST_EXPECT_MSG_EQ (record.delay, delay, "Unexpected delay");
+}
+
+void
+EventTraceTestCase::DoRun (void)
+{
+  std::string fileName = CreateTempDirFilename ("simulator.events");
+  Simulator::Destroy ();
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::EventTraceSimulatorImpl"));
+  Config::SetDefault ("ns3::EventTraceSimulatorImpl::FileName", StringValue (fileName));
+
+  m_nRun = 0;
+  Simulator::Schedule (MicroSeconds (1), &EventTraceTestCase::Event, this);
+  EventId removed = Simulator::Schedule (MicroSeconds (2), &EventTraceTestCase::Event, this);
+  EventId cancelled = Simulator::Schedule (MicroSeconds (3), &EventTraceTestCase::Event, this);
+  Simulator::Remove (removed);
+  cancelled.Cancel ();
+  Simulator::ScheduleNow (&EventTraceTestCase::Event, this);
+  Simulator::ScheduleDestroy (&EventTraceTestCase::Event, this);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_nRun, 3, "Unexpected number of events run");
+  Simulator::Destroy ();
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+
+  std::vector<EventTraceReader::Record> records = ReadRecords (fileName);
+  NS_TEST_ASSERT_MSG_EQ (records.size (), 10, "Unexpected number of records");
+  uint64_t us = MicroSeconds (1).GetTimeStep ();
+  Check (records[0], EventTraceSimulatorImpl::INSERT, 0, us);
+  NS_TEST_EXPECT_MSG_EQ (records[0].context, 0xffffffff, "Unexpected context");
+  Check (records[1], EventTraceSimulatorImpl::INSERT, 1, 2 * us);
+  Check (records[2], EventTraceSimulatorImpl::INSERT, 2, 3 * us);
+  Check (records[3], EventTraceSimulatorImpl::REMOVE, 1, 0);
+  Check (records[4], EventTraceSimulatorImpl::CANCEL, 2, 0);
+  Check (records[5], EventTraceSimulatorImpl::INSERT, 3, 0);
+  Check (records[6], EventTraceSimulatorImpl::RUN, 3, 0);
+  Check (records[7], EventTraceSimulatorImpl::RUN, 0, 0);
+  // the event scheduled by the second event which runs.
+  Check (records[8], EventTraceSimulatorImpl::INSERT, 4, us);
+  Check (records[9], EventTraceSimulatorImpl::RUN, 4, 0);
+
+#ifdef HAVE_PTHREAD_H
+  // an event scheduled by another thread is recorded when it enters the event list, at the
+  // start of the run, after the events scheduled later by the thread of the simulation.
+  fileName = CreateTempDirFilename ("foreign.events");
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::EventTraceSimulatorImpl"));
+  Config::SetDefault ("ns3::EventTraceSimulatorImpl::FileName", StringValue (fileName));
+  m_nRun = 10;
+  Simulator::Schedule (MicroSeconds (1), &EventTraceTestCase::Event, this);
+  Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&EventTraceTestCase::ScheduleFromThread, this));
+  thread->Start ();
+  thread->Join ();
+  Simulator::Schedule (MicroSeconds (3), &EventTraceTestCase::Event, this);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_nRun, 13, "Unexpected number of events run");
+  Simulator::Destroy ();
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+
+  records = ReadRecords (fileName);
+  NS_TEST_ASSERT_MSG_EQ (records.size (), 6, "Unexpected number of records");
+  Check (records[0], EventTraceSimulatorImpl::INSERT, 0, us);
+  Check (records[1], EventTraceSimulatorImpl::INSERT, 1, 3 * us);
+  Check (records[2], EventTraceSimulatorImpl::INSERT, 2, 2 * us);
+  NS_TEST_EXPECT_MSG_EQ (records[2].context, 7, "Unexpected context");
+  Check (records[3], EventTraceSimulatorImpl::RUN, 0, 0);
+  Check (records[4], EventTraceSimulatorImpl::RUN, 2, 0);
+  Check (records[5], EventTraceSimulatorImpl::RUN, 1, 0);
+#endif /* HAVE_PTHREAD_H */
+}
+
+static void
+SchedulerOrderNothing (void)
+{
+}
+
+class SchedulerOrderTestCase : public TestCase
+{
+public:
+  SchedulerOrderTestCase (ObjectFactory schedulerFactory);
+private:
+  virtual void DoRun (void);
+  uint32_t Random (uint32_t n);
+
+  ObjectFactory m_schedulerFactory;
+  uint32_t m_seed;
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check the order of the events of " + schedulerFactory.GetTypeId ().GetName () +
+              " with bursty delays, removals and equal timestamps"),
+    m_schedulerFactory (schedulerFactory),
+    m_seed (1)
+{
+}
+
+uint32_t
+SchedulerOrderTestCase::Random (uint32_t n)
+{
+  m_seed = m_seed * 1103515245 + 12345;
+  return (m_seed >> 8) % n;
+}
+
+void
+SchedulerOrderTestCase::DoRun (void)
+{
+  Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+  std::set<std::pair<uint64_t, uint32_t> > expected;
+  std::vector<Scheduler::Event> live;
+  uint64_t now = 0;
+  uint32_t uid = 4;
+  bool ordered = true;
+  for (uint32_t step = 0; step < 50000 || !live.empty (); step++)
+    {
+      uint32_t op = step < 50000 ? Random (100) : 99;
+      if (op < 50)
+        {
+          // sub-microsecond delays, with a few millisecond and second timers.
+          uint32_t kind = Random (100);
+          uint64_t delay = kind < 5 ? 0 : kind < 90 ? Random (1000) : kind < 99 ? Random (1000000) : Random (1000000000);
+          Scheduler::Event ev;
+          ev.impl = MakeEvent (&SchedulerOrderNothing);
+          ev.key.m_ts = now + delay;
+          ev.key.m_uid = uid++;
+          ev.key.m_context = 0;
+          scheduler->Insert (ev);
+          expected.insert (std::make_pair (ev.key.m_ts, ev.key.m_uid));
+          live.push_back (ev);
+        }
+      else if (op < 60 && !live.empty ())
+        {
+          uint32_t i = Random (live.size ());
+          Scheduler::Event ev = live[i];
+          live[i] = live.back ();
+          live.pop_back ();
+          scheduler->Remove (ev);
+          expected.erase (std::make_pair (ev.key.m_ts, ev.key.m_uid));
+          ev.impl->Unref ();
+        }
+      else if (!live.empty ())
+        {
+          Scheduler::Event peek = scheduler->PeekNext ();
+          Scheduler::Event next = scheduler->RemoveNext ();
+          if (peek.key.m_uid != next.key.m_uid
+              || std::make_pair (next.key.m_ts, next.key.m_uid) != *expected.begin ())
+            {
+              ordered = false;
+            }
+          expected.erase (expected.begin ());
+          for (uint32_t i = 0; i < live.size (); i++)
+            {
+              if (live[i].key.m_uid == next.key.m_uid)
+                {
+                  live[i] = live.back ();
+                  live.pop_back ();
+                  break;
+                }
+            }
+          now = next.key.m_ts;
+          next.impl->Unref ();
+        }
+      NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), live.empty (), "Unexpected IsEmpty at step " << step);
+    }
+  NS_TEST_EXPECT_MSG_EQ (ordered, true, "The events were not dequeued in (time, uid) order");
+}
+
 class SimulatorTemplateTestCase : public TestCase
 {
 public:
@@ -475,5 +947,21 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (IndexedHeapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SimulatorCancelTestCase (true), TestCase::QUICK);
+    AddTestCase (new SimulatorCancelTestCase (false), TestCase::QUICK);
+    AddTestCase (new EventPoolTestCase (), TestCase::QUICK);
+    AddTestCase (new EventTraceTestCase (), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+
+    const char *schedulers[] = { "ns3::ListScheduler", "ns3::MapScheduler", "ns3::HeapScheduler", "ns3::CalendarScheduler",
+                                 "ns3::IndexedHeapScheduler", "ns3::LadderScheduler" };
+    for (uint32_t i = 0; i < sizeof (schedulers) / sizeof (schedulers[0]); i++)
+      {
+        factory.SetTypeId (schedulers[i]);
+        AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+      }
   }
 } g_simulatorTestSuite;
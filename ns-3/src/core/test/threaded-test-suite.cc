@@ -26,10 +26,15 @@
 #include "ns3/config.h"
 #include "ns3/string.h"
 #include "ns3/system-thread.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/nstime.h"
+#include "ns3/uinteger.h"
 
 #include <ctime>
 #include <list>
 #include <utility>
+#include <vector>
+#include <algorithm>
 
 using namespace ns3;
 
@@ -225,6 +230,157 @@ ThreadedSimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_a, m_d, "Bad scheduling");
 }
 
+class MultithreadedSimulatorTestCase : public TestCase
+{
+public:
+  MultithreadedSimulatorTestCase (uint32_t partitions);
+private:
+  /// An event run by a node: its time and its tag.
+  typedef std::pair<uint64_t, uint32_t> Record;
+  typedef std::vector<std::vector<Record> > Logs;
+
+  void Local (uint32_t tag);
+  void Message (uint32_t tag);
+  void Global (void);
+  void RunScenario (std::string simulatorType, Logs &logs);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  uint32_t m_partitions;
+  Logs *m_logs;
+  std::vector<uint32_t> m_nGlobal;
+  std::vector<uint32_t> m_systemId;
+};
+
+static const uint32_t N_NODES = 16;
+static const uint32_t LOOKAHEAD_US = 50;
+
+MultithreadedSimulatorTestCase::MultithreadedSimulatorTestCase (uint32_t partitions)
+  : TestCase ("Check that the MultithreadedSimulatorImpl with " + 
+              std::string (1, '0' + partitions) + " partitions runs the events of a sequential simulation"),
+    m_partitions (partitions),
+    m_logs (0)
+{
+}
+
+void
+MultithreadedSimulatorTestCase::Local (uint32_t tag)
+{
+  uint32_t node = Simulator::GetContext ();
+  (*m_logs)[node].push_back (std::make_pair (Simulator::Now ().GetTimeStep (), tag));
+  m_systemId[node] = Simulator::GetSystemId ();
+  uint32_t hash = tag * 2654435761U;
+  if (Simulator::Now () > MilliSeconds (20))
+    {
+      return;
+    }
+  // the chain of the node goes on, with delays which are sometimes
+  // equal to the ones of the other chains.
+  Simulator::Schedule (MicroSeconds (1 + (hash >> 28)), &MultithreadedSimulatorTestCase::Local, this, tag + 1);
+  if ((hash >> 8) % 3 == 0)
+    {
+      uint32_t to = (node + 1 + (hash >> 4) % (N_NODES - 1)) % N_NODES;
+      Simulator::ScheduleWithContext (to, MicroSeconds (LOOKAHEAD_US + (hash >> 24) % 30),
+                                      &MultithreadedSimulatorTestCase::Message, this,
+                                      (node << 24) | tag);
+    }
+}
+
+void
+MultithreadedSimulatorTestCase::Message (uint32_t tag)
+{
+  uint32_t node = Simulator::GetContext ();
+  (*m_logs)[node].push_back (std::make_pair (Simulator::Now ().GetTimeStep (), tag | 0x80000000));
+}
+
+void
+MultithreadedSimulatorTestCase::Global (void)
+{
+  // the events without a context run alone: no node may run at the same time.
+  m_nGlobal.push_back (Simulator::GetContext ());
+  for (uint32_t i = 0; i < N_NODES; i++)
+    {
+      Simulator::ScheduleWithContext (i, MicroSeconds (3), &MultithreadedSimulatorTestCase::Message, this, 0xfff000 + i);
+    }
+}
+
+void
+MultithreadedSimulatorTestCase::RunScenario (std::string simulatorType, Logs &logs)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue (simulatorType));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::Partitions", UintegerValue (m_partitions));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::Lookahead", TimeValue (MicroSeconds (LOOKAHEAD_US)));
+  logs.clear ();
+  logs.resize (N_NODES);
+  m_logs = &logs;
+  m_systemId.assign (N_NODES, 0);
+  Ptr<MultithreadedSimulatorImpl> impl = DynamicCast<MultithreadedSimulatorImpl> (Simulator::GetImplementation ());
+  if (impl != 0)
+    {
+      // keep the default spread for the odd nodes.
+      for (uint32_t i = 0; i < N_NODES; i += 2)
+        {
+          impl->SetPartition (i, (i / 2) % m_partitions);
+        }
+    }
+  for (uint32_t i = 0; i < N_NODES; i++)
+    {
+      Simulator::ScheduleWithContext (i, MicroSeconds (i % 3), &MultithreadedSimulatorTestCase::Local, this, i * 1000);
+    }
+  for (uint32_t i = 1; i < 5; i++)
+    {
+      Simulator::Schedule (MicroSeconds (i * 3001), &MultithreadedSimulatorTestCase::Global, this);
+    }
+  Simulator::Run ();
+  if (impl != 0)
+    {
+      for (uint32_t i = 0; i < N_NODES; i++)
+        {
+          uint32_t partition = (i % 2 == 0) ? (i / 2) % m_partitions : i % m_partitions;
+          NS_TEST_EXPECT_MSG_EQ (impl->GetPartition (i), partition, "Bad partition for node " << i);
+          NS_TEST_EXPECT_MSG_EQ (m_systemId[i], partition, "Node " << i << " ran in the wrong partition");
+        }
+    }
+  Simulator::Destroy ();
+  // the events of a node which run at the same time may run in another order.
+  for (uint32_t i = 0; i < N_NODES; i++)
+    {
+      std::sort (logs[i].begin (), logs[i].end ());
+    }
+}
+
+void
+MultithreadedSimulatorTestCase::DoRun (void)
+{
+  Logs expected;
+  Logs logs;
+  RunScenario ("ns3::DefaultSimulatorImpl", expected);
+  m_nGlobal.clear ();
+  RunScenario ("ns3::MultithreadedSimulatorImpl", logs);
+  NS_TEST_EXPECT_MSG_EQ (m_nGlobal.size (), 4, "The global events did not run");
+  for (uint32_t i = 0; i < m_nGlobal.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_nGlobal[i], 0xffffffff, "Bad context of a global event");
+    }
+  for (uint32_t i = 0; i < N_NODES; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (logs[i].size (), expected[i].size (), "Bad number of events for node " << i);
+      NS_TEST_EXPECT_MSG_GT (logs[i].size (), 1000, "The scenario is too short");
+      for (uint32_t j = 0; j < logs[i].size (); j++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (logs[i][j].first, expected[i][j].first, "Bad time of event " << j << " of node " << i);
+          NS_TEST_ASSERT_MSG_EQ (logs[i][j].second, expected[i][j].second, "Bad event " << j << " of node " << i);
+        }
+    }
+}
+
+void
+MultithreadedSimulatorTestCase::DoTeardown (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+  Config::Reset ();
+}
+
 class ThreadedSimulatorTestSuite : public TestSuite
 {
 public:
@@ -235,7 +391,8 @@ public:
 #ifdef HAVE_RT
       "ns3::RealtimeSimulatorImpl",
 #endif
-      "ns3::DefaultSimulatorImpl"
+      "ns3::DefaultSimulatorImpl",
+      "ns3::MultithreadedSimulatorImpl"
     };
     std::string schedulerTypes[] = {
       "ns3::ListScheduler",
@@ -262,5 +419,7 @@ public:
               }
           }
       }
+    AddTestCase (new MultithreadedSimulatorTestCase (1), TestCase::QUICK);
+    AddTestCase (new MultithreadedSimulatorTestCase (4), TestCase::QUICK);
   }
 } g_threadedSimulatorTestSuite;
@@ -30,6 +30,11 @@
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/sgi-hashmap.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-mutex.h"
+#endif
 #include "global-router-interface.h"
 
 namespace ns3 {
@@ -37,7 +42,9 @@ namespace ns3 {
 const uint32_t SPF_INFINITY = 0xffffffff; //!< "infinite" distance between nodes
 
 class CandidateQueue;
+class Ipv4;
 class Ipv4GlobalRouting;
+class SPFVertexPool;
 
 /**
  * @brief Vertex used in shortest path first (SPF) computations. See \RFC{2328},
@@ -556,6 +563,16 @@ private:
   ListOfSPFVertex_t m_children; //!< Children list
   bool m_vertexProcessed; //!< Flag to note whether vertex has been processed in stage two of SPF computation
 
+/**
+ * @brief Bring the vertex back to the state it is constructed in.
+ *
+ * The vertex forgets its parents and children without deleting them.
+ *
+ * @param lsa The Link State Advertisement used for finding initial values,
+ * or 0 for an uninitialized vertex.
+ */
+  void Reset (GlobalRoutingLSA* lsa);
+
 /**
  * @brief The SPFVertex copy construction is disallowed.  There's no need for
  * it and a compiler provided shallow copy would be wrong.
@@ -579,6 +596,59 @@ private:
    * \returns the reference to the output stream
    */
   friend std::ostream& operator<< (std::ostream& os, const SPFVertex::ListOfSPFVertex_t& vs);
+
+  friend class SPFVertexPool;
+};
+
+/**
+ * @brief Storage of the SPFVertex objects of SPF calculations.
+ * @internal
+ *
+ * A calculation builds a tree with a vertex for each router and transit
+ * network it reaches, and one calculation runs for each router.  Rather
+ * than allocating and deleting every vertex of every tree, a calculation
+ * takes its vertices from the pool and gives them all back at once when it
+ * is over, to be reused by the next calculation.  A pool serves one
+ * calculation at a time.
+ */
+class SPFVertexPool
+{
+public:
+  SPFVertexPool ();
+  ~SPFVertexPool ();
+
+/**
+ * @brief Take a vertex from the pool.
+ *
+ * The vertex is initialized as by SPFVertex::SPFVertex (GlobalRoutingLSA*).
+ * It belongs to the pool and must not be deleted.
+ *
+ * @param lsa The Link State Advertisement used for finding initial values.
+ * @returns the vertex
+ */
+  SPFVertex* Allocate (GlobalRoutingLSA* lsa);
+
+/**
+ * @brief Give back all the vertices taken from the pool.
+ */
+  void Release (void);
+
+private:
+/**
+ * @brief SPFVertexPool copy construction is disallowed.
+ * @param pool object to copy from
+ */
+  SPFVertexPool (SPFVertexPool& pool);
+
+/**
+ * @brief SPFVertexPool copy assignment operator is disallowed.
+ * @param pool object to copy from
+ * @returns the copied object
+ */
+  SPFVertexPool& operator= (SPFVertexPool& pool);
+
+  std::vector<SPFVertex*> m_vertices; //!< all the vertices, the first m_nAllocated of which are in use
+  uint32_t m_nAllocated; //!< number of vertices in use
 };
 
 /**
@@ -622,7 +692,9 @@ public:
  * @internal
  *
  * The IPV4 address and the GlobalRoutingLSA given as parameters are converted
- * to an STL pair and are inserted into the database map.
+ * to an STL pair and are inserted into the database map.  The LSA is also
+ * indexed by address, and by the link data of its transit network link
+ * records, which must therefore be complete by the time it is inserted.
  *
  * @see GlobalRoutingLSA
  * @see Ipv4Address
@@ -655,6 +727,8 @@ public:
  * of the TransitNetwork link record.
  * @internal
  *
+ * If several LSAs match, the one with the lowest address is returned.
+ *
  * @see GetLSA
  * @param addr The IP address associated with the LSA.  Typically the Router 
  * @returns A pointer to the Link State Advertisement for the router specified
@@ -663,14 +737,39 @@ public:
  */
   GlobalRoutingLSA* GetLSAByLinkData (Ipv4Address addr) const;
 
+/**
+ * @brief Look up the index of the Link State Advertisement associated with
+ * the given address.
+ * @internal
+ *
+ * The LSAs of the database (but the external ones) are numbered from 0 to
+ * GetNLSAs () - 1 in the order they were inserted, so that an SPF
+ * calculation can keep its own state for each of them in a vector.
+ *
+ * @param addr The IP address associated with the LSA.  It must be in the
+ * database.
+ * @returns the index of the LSA
+ */
+  uint32_t GetLSAIndex (Ipv4Address addr) const;
+
+/**
+ * @brief Get the number of Link State Advertisements, not counting the
+ * external ones.
+ * @internal
+ *
+ * @returns the number of LSAs
+ */
+  uint32_t GetNLSAs (void) const;
+
 /**
  * @brief Set all LSA flags to an initialized state, for SPF computation
  * @internal
  *
  * This function walks the database and resets the status flags of all of the
- * contained Link State Advertisements to LSA_SPF_NOT_EXPLORED.  This is done
- * prior to each SPF calculation to reset the state of the SPFVertex structures
- * that will reference the LSAs during the calculation.
+ * contained Link State Advertisements to LSA_SPF_NOT_EXPLORED.  The SPF
+ * calculations of GlobalRouteManagerImpl do not use these flags: each one
+ * keeps the status of the LSAs on its own, by GetLSAIndex (), so that they
+ * may run concurrently over the same database.
  *
  * @see GlobalRoutingLSA
  * @see SPFVertex
@@ -704,8 +803,13 @@ private:
   typedef std::map<Ipv4Address, GlobalRoutingLSA*> LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
   typedef std::pair<Ipv4Address, GlobalRoutingLSA*> LSDBPair_t; //!< pair of IPv4 addresses / Link State Advertisements
 
+  typedef sgi::hash_map<Ipv4Address, uint32_t, Ipv4AddressHash> LSDBIndex_t; //!< index of the Link State Advertisements in m_lsas
+
   LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
   std::vector<GlobalRoutingLSA*> m_extdatabase; //!< database of External Link State Advertisements
+  std::vector<LSDBPair_t> m_lsas; //!< the entries of m_database, in insertion order
+  LSDBIndex_t m_index; //!< the entries of m_database, by address
+  LSDBIndex_t m_linkDataIndex; //!< the entries of m_database, by link data of their transit network link records
 
 /**
  * @brief GlobalRouteManagerLSDB copy construction is disallowed.  There's no 
@@ -797,8 +901,135 @@ private:
  */
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
-  SPFVertex* m_spfroot; //!< the root node
+  /**
+   * \brief A route found by an SPF calculation, to be added to the routing
+   * table of the root.
+   */
+  struct SPFRoute
+  {
+    /// The kind of route.
+    enum Type
+    {
+      HostRoute,       //!< host route, added by Ipv4GlobalRouting::AddHostRouteTo
+      NetworkRoute,    //!< network route, added by Ipv4GlobalRouting::AddNetworkRouteTo
+      ASExternalRoute  //!< external route, added by Ipv4GlobalRouting::AddASExternalRouteTo
+    };
+    Type type; //!< kind of route
+    Ipv4Address dest; //!< destination host or network
+    Ipv4Mask mask; //!< mask of the destination network
+    Ipv4Address nextHop; //!< next hop
+    uint32_t outIf; //!< outgoing interface
+  };
+
+  /**
+   * \brief The outgoing interface of the root of an SPF calculation toward
+   * an address and mask, as returned by FindOutgoingInterfaceId ().
+   */
+  struct SPFInterface
+  {
+    Ipv4Address address; //!< the target address
+    Ipv4Mask mask; //!< the target mask
+    int32_t interface; //!< the interface, or -1 if none
+  };
+
+  /**
+   * \brief The state of the SPF calculation rooted at one router.
+   *
+   * The calculations rooted at different routers share nothing but the
+   * LSDB, which they only read, so that they may run on different threads.
+   * Everything a calculation needs from the nodes is looked up beforehand
+   * by PrepareSPF (), and the routes it finds are kept here until ApplySPF ()
+   * adds them to the routing table of the root.
+   */
+  struct SPFRun
+  {
+    Ipv4Address rootId; //!< router ID of the root
+    SPFVertex* root; //!< root vertex of the SPF tree, during the calculation
+    Ipv4GlobalRouting* routing; //!< routing protocol of the root, or 0 if the root has no node
+    std::vector<SPFInterface> interfaces; //!< outgoing interfaces of the root toward its neighbors
+    std::vector<GlobalRoutingLSA::SPFStatus> status; //!< status of the LSAs, by LSDB index
+    std::vector<SPFRoute> routes; //!< routes found by the calculation
+    SPFVertexPool* pool; //!< storage of the vertices, during the calculation
+  };
+
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+#ifdef HAVE_PTHREAD_H
+  SystemMutex m_spfMutex; //!< protects m_nextSpfRun
+  std::vector<SPFRun>* m_spfRuns; //!< the calculations shared by the SPF threads
+  uint32_t m_nSpfRuns; //!< the number of calculations of m_spfRuns to run
+  uint32_t m_nextSpfRun; //!< the next calculation of m_spfRuns to run
+
+  /**
+   * \brief Run SPF calculations until there are none left.
+   *
+   * This is the body of the SPF threads of CalculateSPF ().
+   *
+   * \param impl the route manager
+   * \param pool the storage of the vertices of the thread
+   */
+  static void RunSPFWorker (GlobalRouteManagerImpl* impl, SPFVertexPool* pool);
+#endif
+
+  /**
+   * \brief Get the number of threads to run the SPF calculations on.
+   *
+   * It is given by the "GlobalRoutingSpfThreads" global value, but the
+   * calculations run on the calling thread when the logs of this component
+   * trace them in detail.
+   *
+   * \returns the number of threads
+   */
+  uint32_t GetNSPFThreads (void) const;
+
+  /**
+   * \brief Look up what the SPF calculation rooted at a router needs from
+   * the nodes, before it runs.
+   *
+   * A stub router gets its default route here, and needs no calculation.
+   *
+   * \param root the router ID of the root
+   * \param node the node of the root, 0 if no node has this router ID
+   * \param rtr the GlobalRouter of the node
+   * \param run the state of the calculation
+   * \returns true if the calculation must run
+   */
+  bool PrepareSPF (Ipv4Address root, Ptr<Node> node, Ptr<GlobalRouter> rtr, SPFRun& run);
+
+  /**
+   * \brief Run SPF calculations, in parallel when possible.
+   *
+   * \param runs the calculations, prepared by PrepareSPF ()
+   * \param nRuns the number of calculations of runs to run
+   * \param pools the storage of the vertices, one per thread
+   */
+  void CalculateSPF (std::vector<SPFRun>& runs, uint32_t nRuns,
+                     const std::vector<SPFVertexPool*>& pools);
+
+  /**
+   * \brief Add the routes found by an SPF calculation to the routing table
+   * of its root.
+   *
+   * \param run the state of the calculation
+   */
+  void ApplySPF (SPFRun& run);
+
+  /**
+   * \brief Get the status of an LSA in an SPF calculation.
+   *
+   * \param run the state of the calculation
+   * \param lsa the LSA
+   * \returns the status of the LSA
+   */
+  GlobalRoutingLSA::SPFStatus GetSPFStatus (const SPFRun& run, GlobalRoutingLSA* lsa) const;
+
+  /**
+   * \brief Set the status of an LSA in an SPF calculation.
+   *
+   * \param run the state of the calculation
+   * \param lsa the LSA
+   * \param status the status of the LSA
+   */
+  void SetSPFStatus (SPFRun& run, GlobalRoutingLSA* lsa, GlobalRoutingLSA::SPFStatus status) const;
 
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
@@ -807,18 +1038,18 @@ private:
    * can safely be added to the next-hop router and SPF does not need
    * to be run
    *
-   * \param root the root node
+   * \param run the state of the calculation rooted at the node
    * \returns true if the node is a stub
    */
-  bool CheckForStubNode (Ipv4Address root);
+  bool CheckForStubNode (SPFRun& run);
 
   /**
    * \brief Calculate the shortest path first (SPF) tree
    *
    * Equivalent to quagga ospf_spf_calculate
-   * \param root the root node
+   * \param run the state of the calculation, prepared by PrepareSPF ()
    */
-  void SPFCalculate (Ipv4Address root);
+  void SPFCalculate (SPFRun& run);
 
   /**
    * \brief Process Stub nodes
@@ -827,17 +1058,19 @@ private:
    * stub link records will exist for point-to-point interfaces and for
    * broadcast interfaces for which no neighboring router can be found
    *
+   * \param run the state of the calculation
    * \param v vertex to be processed
    */
-  void SPFProcessStubs (SPFVertex* v);
+  void SPFProcessStubs (SPFRun& run, SPFVertex* v);
 
   /**
    * \brief Process Autonomous Systems (AS) External LSA
    *
+   * \param run the state of the calculation
    * \param v vertex to be processed
    * \param extlsa external LSA
    */
-  void ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extlsa);
+  void ProcessASExternals (SPFRun& run, SPFVertex* v, GlobalRoutingLSA* extlsa);
 
   /**
    * \brief Examine the links in v's LSA and update the list of candidates with any
@@ -857,10 +1090,11 @@ private:
    * vertices not already on the list.  If a lower-cost path is found to a
    * vertex already on the candidate list, store the new (lower) cost.
    *
+   * \param run the state of the calculation
    * \param v the vertex
    * \param candidate the SPF candidate queue
    */
-  void SPFNext (SPFVertex* v, CandidateQueue& candidate);
+  void SPFNext (SPFRun& run, SPFVertex* v, CandidateQueue& candidate);
 
   /**
    * \brief Calculate nexthop from root through V (parent) to vertex W (destination)
@@ -869,13 +1103,14 @@ private:
    * This method is derived from quagga ospf_nexthop_calculation() 16.1.1.
    * For now, this is greatly simplified from the quagga code
    *
+   * \param run the state of the calculation
    * \param v the parent
    * \param w the destination
    * \param l the link record
    * \param distance the target distance
    * \returns 1 on success
    */
-  int SPFNexthopCalculation (SPFVertex* v, SPFVertex* w, 
+  int SPFNexthopCalculation (SPFRun& run, SPFVertex* v, SPFVertex* w, 
                              GlobalRoutingLinkRecord* l, uint32_t distance);
 
   /**
@@ -922,8 +1157,8 @@ private:
    *
    * This method is derived from quagga ospf_intra_add_router ()
    *
-   * This is where we are actually going to add the host routes to the routing
-   * tables of the individual nodes.
+   * This is where we find the host routes to add to the routing table of the
+   * root, once the calculation is over.
    *
    * The vertex passed as a parameter has just been added to the SPF tree.
    * This vertex must have a valid m_root_oid, corresponding to the outgoing
@@ -935,48 +1170,67 @@ private:
    * a destination IP address, reachable from the root, to which we add a host
    * route.
    *
+   * \param run the state of the calculation
    * \param v the vertex
    *
    */
-  void SPFIntraAddRouter (SPFVertex* v);
+  void SPFIntraAddRouter (SPFRun& run, SPFVertex* v);
 
   /**
    * \brief Add a transit to the routing tables
    *
+   * \param run the state of the calculation
    * \param v the vertex
    */
-  void SPFIntraAddTransit (SPFVertex* v);
+  void SPFIntraAddTransit (SPFRun& run, SPFVertex* v);
 
   /**
    * \brief Add a stub to the routing tables
    *
+   * \param run the state of the calculation
    * \param l the global routing link record
    * \param v the vertex
    */
-  void SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex* v);
+  void SPFIntraAddStub (SPFRun& run, GlobalRoutingLinkRecord *l, SPFVertex* v);
 
   /**
    * \brief Add an external route to the routing tables
    *
+   * \param run the state of the calculation
    * \param extlsa the external LSA
    * \param v the vertex
    */
-  void SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v);
+  void SPFAddASExternal (SPFRun& run, GlobalRoutingLSA *extlsa, SPFVertex *v);
+
+  /**
+   * \brief Look up the interface number of the root of an SPF calculation
+   * corresponding to a given IP address and mask, before the calculation runs
+   *
+   * This is a wrapper around GetInterfaceForPrefix(), called on the node
+   * of the root.  If no such interface is found, or the root has no node,
+   * the interface number is -1 (note:  unit test framework for routing
+   * assumes -1 to be a legal return value)
+   *
+   * \param run the state of the calculation
+   * \param ipv4 the Ipv4 of the node of the root, or 0 if it has none
+   * \param a the target IP address
+   * \param amask the target subnet mask
+   */
+  void CacheOutgoingInterfaceId (SPFRun& run, Ptr<Ipv4> ipv4, Ipv4Address a,
+                                 Ipv4Mask amask = Ipv4Mask::GetOnes ());
 
   /**
    * \brief Return the interface number corresponding to a given IP address and mask
    *
-   * This is a wrapper around GetInterfaceForPrefix(), but we first
-   * have to find the right node pointer to pass to that function.
-   * If no such interface is found, return -1 (note:  unit test framework
-   * for routing assumes -1 to be a legal return value)
+   * The interface must have been looked up by CacheOutgoingInterfaceId ().
    *
+   * \param run the state of the calculation
    * \param a the target IP address
    * \param amask the target subnet mask
    * \return the outgoing interface number
    */
-  int32_t FindOutgoingInterfaceId (Ipv4Address a, 
-                                   Ipv4Mask amask = Ipv4Mask ("255.255.255.255"));
+  int32_t FindOutgoingInterfaceId (const SPFRun& run, Ipv4Address a, 
+                                   Ipv4Mask amask = Ipv4Mask::GetOnes ()) const;
 };
 
 } // namespace ns3
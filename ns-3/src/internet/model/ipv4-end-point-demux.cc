@@ -26,8 +26,36 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Ipv4EndPointDemux");
 
+Ipv4EndPointDemux::EndPointKey::EndPointKey (Ipv4Address localAddress, uint16_t localPort,
+                                             Ipv4Address peerAddress, uint16_t peerPort)
+  : m_localAddress (localAddress),
+    m_localPort (localPort),
+    m_peerAddress (peerAddress),
+    m_peerPort (peerPort)
+{
+}
+
+bool
+Ipv4EndPointDemux::EndPointKey::operator == (const EndPointKey &other) const
+{
+  return m_localPort == other.m_localPort
+         && m_peerPort == other.m_peerPort
+         && m_localAddress == other.m_localAddress
+         && m_peerAddress == other.m_peerAddress;
+}
+
+size_t
+Ipv4EndPointDemux::EndPointKeyHash::operator() (const EndPointKey &key) const
+{
+  size_t hash = key.m_peerAddress.Get ();
+  hash = hash * 1000003 ^ key.m_localAddress.Get ();
+  hash = hash * 1000003 ^ ((key.m_peerPort << 16) | key.m_localPort);
+  return hash;
+}
+
 Ipv4EndPointDemux::Ipv4EndPointDemux ()
-  : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152)
+  : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152),
+    m_nextSequence (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -35,36 +63,81 @@ Ipv4EndPointDemux::Ipv4EndPointDemux ()
 Ipv4EndPointDemux::~Ipv4EndPointDemux ()
 {
   NS_LOG_FUNCTION (this);
+  m_ports.clear ();
+  m_tuples.clear ();
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
     {
       Ipv4EndPoint *endPoint = *i;
+      endPoint->m_demux = 0;
       delete endPoint;
     }
   m_endPoints.clear ();
 }
 
-bool
-Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+void
+Ipv4EndPointDemux::Insert (Ipv4EndPoint *endPoint)
 {
-  NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  endPoint->m_demux = this;
+  endPoint->m_sequence = m_nextSequence++;
+  m_endPoints.push_back (endPoint);
+  m_ports[endPoint->GetLocalPort ()].push_back (endPoint);
+  IndexTuple (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+}
+
+void
+Ipv4EndPointDemux::IndexTuple (Ipv4EndPoint *endPoint)
+{
+  EndPoints &endPoints = m_tuples[EndPointKey (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                                               endPoint->GetPeerAddress (), endPoint->GetPeerPort ())];
+  // an end point whose addresses changed may have been allocated before
+  // the others, which Lookup must then return after it.
+  EndPointsI i = endPoints.end ();
+  while (i != endPoints.begin ())
     {
-      if ((*i)->GetLocalPort  () == port) 
+      EndPointsI previous = i;
+      previous--;
+      if ((*previous)->m_sequence < endPoint->m_sequence)
         {
-          return true;
+          break;
         }
+      i = previous;
+    }
+  endPoints.insert (i, endPoint);
+}
+
+void
+Ipv4EndPointDemux::UnindexTuple (Ipv4EndPoint *endPoint)
+{
+  TupleIndex::iterator i = m_tuples.find (EndPointKey (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                                                       endPoint->GetPeerAddress (), endPoint->GetPeerPort ()));
+  NS_ASSERT (i != m_tuples.end ());
+  i->second.remove (endPoint);
+  if (i->second.empty ())
+    {
+      m_tuples.erase (i);
     }
-  return false;
+}
+
+bool
+Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  return m_ports.find (port) != m_ports.end ();
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal (Ipv4Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  PortIndex::iterator endPoints = m_ports.find (port);
+  if (endPoints == m_ports.end ())
     {
-      if ((*i)->GetLocalPort () == port &&
-          (*i)->GetLocalAddress () == addr) 
+      return false;
+    }
+  for (EndPointsI i = endPoints->second.begin (); i != endPoints->second.end (); i++) 
+    {
+      if ((*i)->GetLocalAddress () == addr) 
         {
           return true;
         }
@@ -83,8 +156,7 @@ Ipv4EndPointDemux::Allocate (void)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (Ipv4Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  Insert (endPoint);
   return endPoint;
 }
 
@@ -99,8 +171,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  Insert (endPoint);
   return endPoint;
 }
 
@@ -122,8 +193,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address, uint16_t port)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  Insert (endPoint);
   return endPoint;
 }
 
@@ -132,23 +202,15 @@ Ipv4EndPointDemux::Allocate (Ipv4Address localAddress, uint16_t localPort,
                              Ipv4Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  if (m_tuples.find (EndPointKey (localAddress, localPort, peerAddress, peerPort)) != m_tuples.end ())
     {
-      if ((*i)->GetLocalPort () == localPort &&
-          (*i)->GetLocalAddress () == localAddress &&
-          (*i)->GetPeerPort () == peerPort &&
-          (*i)->GetPeerAddress () == peerAddress) 
-        {
-          NS_LOG_WARN ("No way we can allocate this end-point.");
-          /* no way we can allocate this end-point. */
-          return 0;
-        }
+      NS_LOG_WARN ("No way we can allocate this end-point.");
+      /* no way we can allocate this end-point. */
+      return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
-
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  Insert (endPoint);
 
   return endPoint;
 }
@@ -161,6 +223,14 @@ Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
     {
       if (*i == endPoint)
         {
+          UnindexTuple (endPoint);
+          PortIndex::iterator port = m_ports.find (endPoint->GetLocalPort ());
+          port->second.remove (endPoint);
+          if (port->second.empty ())
+            {
+              m_ports.erase (port);
+            }
+          endPoint->m_demux = 0;
           delete endPoint;
           m_endPoints.erase (i);
           break;
@@ -197,28 +267,103 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
                            Ptr<Ipv4Interface> incomingInterface)
 {
   NS_LOG_FUNCTION (this << daddr << dport << saddr << sport << incomingInterface);
-  
+
+  NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
+  PortIndex::iterator endPoints = m_ports.find (dport);
+  if (endPoints == m_ports.end ())
+    {
+      NS_LOG_LOGIC ("No endpoint has dport " << dport);
+      return EndPoints ();
+    }
+
+  bool subnetDirected = false;
+  Ipv4Address incomingInterfaceAddr = daddr;  // may be a broadcast
+  for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
+    {
+      Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
+      if (addr.GetLocal ().CombineMask (addr.GetMask ()) == daddr.CombineMask (addr.GetMask ()) &&
+          daddr.IsSubnetDirectedBroadcast (addr.GetMask ()))
+        {
+          subnetDirected = true;
+          incomingInterfaceAddr = addr.GetLocal ();
+        }
+    }
+  bool isBroadcast = (daddr.IsBroadcast () || subnetDirected == true);
+  NS_LOG_DEBUG ("dest addr " << daddr << " broadcast? " << isBroadcast);
+
+  if (isBroadcast)
+    {
+      return ScanLookup (endPoints->second, daddr, dport, saddr, sport,
+                         incomingInterface, isBroadcast, incomingInterfaceAddr);
+    }
+
+  // Each class of match of ScanLookup is a single four-tuple, wildcards
+  // included, when the destination is not a broadcast address.
+  EndPoints retval;
+  retval = LookupTuple (EndPointKey (daddr, dport, saddr, sport), incomingInterface);
+  if (!retval.empty ())
+    { // All 4 match
+      return retval;
+    }
+  retval = LookupTuple (EndPointKey (Ipv4Address::GetAny (), dport, saddr, sport), incomingInterface);
+  if (!retval.empty ())
+    { // All but local address
+      return retval;
+    }
+  retval = LookupTuple (EndPointKey (daddr, dport, Ipv4Address::GetAny (), 0), incomingInterface);
+  if (!retval.empty ())
+    { // Only local port and local address matches exactly
+      return retval;
+    }
+  // Only local port matches exactly; might be empty if no matches
+  return LookupTuple (EndPointKey (Ipv4Address::GetAny (), dport, Ipv4Address::GetAny (), 0), incomingInterface);
+}
+
+Ipv4EndPointDemux::EndPoints
+Ipv4EndPointDemux::LookupTuple (const EndPointKey &key, Ptr<Ipv4Interface> incomingInterface)
+{
+  EndPoints retval;
+  TupleIndex::iterator endPoints = m_tuples.find (key);
+  if (endPoints == m_tuples.end ())
+    {
+      return retval;
+    }
+  for (EndPointsI i = endPoints->second.begin (); i != endPoints->second.end (); i++)
+    {
+      Ipv4EndPoint* endP = *i;
+      if (endP->GetBoundNetDevice () && endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
+        {
+          NS_LOG_LOGIC ("Skipping endpoint " << &endP
+                                             << " because endpoint is bound to specific device and"
+                                             << endP->GetBoundNetDevice ()
+                                             << " does not match packet device " << incomingInterface->GetDevice ());
+          continue;
+        }
+      retval.push_back (endP);
+    }
+  return retval;
+}
+
+Ipv4EndPointDemux::EndPoints
+Ipv4EndPointDemux::ScanLookup (const EndPoints &endPoints,
+                               Ipv4Address daddr, uint16_t dport,
+                               Ipv4Address saddr, uint16_t sport,
+                               Ptr<Ipv4Interface> incomingInterface,
+                               bool isBroadcast, Ipv4Address incomingInterfaceAddr)
+{
   EndPoints retval1; // Matches exact on local port, wildcards on others
   EndPoints retval2; // Matches exact on local port/adder, wildcards on others
   EndPoints retval3; // Matches all but local address
   EndPoints retval4; // Exact match on all 4
 
-  NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  for (EndPoints::const_iterator i = endPoints.begin (); i != endPoints.end (); i++) 
     {
       Ipv4EndPoint* endP = *i;
       NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
                                                  << " daddr=" << endP->GetLocalAddress ()
                                                  << " sport=" << endP->GetPeerPort ()
                                                  << " saddr=" << endP->GetPeerAddress ());
-      if (endP->GetLocalPort () != dport) 
-        {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                             << " because endpoint dport "
-                                             << endP->GetLocalPort ()
-                                             << " does not match packet dport " << dport);
-          continue;
-        }
+      NS_ASSERT (endP->GetLocalPort () == dport);
       if (endP->GetBoundNetDevice ())
         {
           if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
@@ -230,20 +375,6 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
               continue;
             }
         }
-      bool subnetDirected = false;
-      Ipv4Address incomingInterfaceAddr = daddr;  // may be a broadcast
-      for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
-        {
-          Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
-          if (addr.GetLocal ().CombineMask (addr.GetMask ()) == daddr.CombineMask (addr.GetMask ()) &&
-              daddr.IsSubnetDirectedBroadcast (addr.GetMask ()))
-            {
-              subnetDirected = true;
-              incomingInterfaceAddr = addr.GetLocal ();
-            }
-        }
-      bool isBroadcast = (daddr.IsBroadcast () || subnetDirected == true);
-      NS_LOG_DEBUG ("dest addr " << daddr << " broadcast? " << isBroadcast);
       bool localAddressMatchesWildCard = 
         endP->GetLocalAddress () == Ipv4Address::GetAny ();
       bool localAddressMatchesExact = endP->GetLocalAddress () == daddr;
@@ -315,23 +446,24 @@ Ipv4EndPointDemux::SimpleLookup (Ipv4Address daddr,
 {
   NS_LOG_FUNCTION (this << daddr << dport << saddr << sport);
 
+  TupleIndex::iterator exact = m_tuples.find (EndPointKey (daddr, dport, saddr, sport));
+  if (exact != m_tuples.end ())
+    {
+      /* this is an exact match. */
+      return exact->second.front ();
+    }
+
   // this code is a copy/paste version of an old BSD ip stack lookup
   // function.
+  PortIndex::iterator endPoints = m_ports.find (dport);
+  if (endPoints == m_ports.end ())
+    {
+      return 0;
+    }
   uint32_t genericity = 3;
   Ipv4EndPoint *generic = 0;
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  for (EndPointsI i = endPoints->second.begin (); i != endPoints->second.end (); i++) 
     {
-      if ((*i)->GetLocalPort () != dport) 
-        {
-          continue;
-        }
-      if ((*i)->GetLocalAddress () == daddr &&
-          (*i)->GetPeerPort () == sport &&
-          (*i)->GetPeerAddress () == saddr) 
-        {
-          /* this is an exact match. */
-          return *i;
-        }
       uint32_t tmp = 0;
       if ((*i)->GetLocalAddress () == Ipv4Address::GetAny ()) 
         {
@@ -24,6 +24,7 @@
 #include <stdint.h>
 #include <list>
 #include "ns3/ipv4-address.h"
+#include "ns3/sgi-hashmap.h"
 #include "ipv4-interface.h"
 
 namespace ns3 {
@@ -38,6 +39,11 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * The endpoints are indexed by local port, and by their full four-tuple
+ * (wildcards included), so that the lookup of a unicast packet only
+ * costs a few hash lookups, whatever the number of endpoints.  The
+ * endpoints notify their demux when their addresses change.
  */
 
 class Ipv4EndPointDemux {
@@ -152,6 +158,107 @@ public:
   void DeAllocate (Ipv4EndPoint *endPoint);
 
 private:
+  friend class Ipv4EndPoint;
+
+  /**
+   * \brief The four-tuple of an end point, wildcards included.
+   */
+  struct EndPointKey
+  {
+    /**
+     * \brief Constructor.
+     * \param localAddress local address
+     * \param localPort local port
+     * \param peerAddress peer address
+     * \param peerPort peer port
+     */
+    EndPointKey (Ipv4Address localAddress, uint16_t localPort,
+                 Ipv4Address peerAddress, uint16_t peerPort);
+    /**
+     * \param other the other key
+     * \return true if both keys are equal
+     */
+    bool operator == (const EndPointKey &other) const;
+
+    Ipv4Address m_localAddress; //!< the local address
+    uint16_t m_localPort;       //!< the local port
+    Ipv4Address m_peerAddress;  //!< the peer address
+    uint16_t m_peerPort;        //!< the peer port
+  };
+
+  /**
+   * \brief Hash of an EndPointKey.
+   */
+  class EndPointKeyHash : public std::unary_function<EndPointKey, size_t>
+  {
+public:
+    /**
+     * \param key the key
+     * \return the hash of the key
+     */
+    size_t operator() (const EndPointKey &key) const;
+  };
+
+  /**
+   * \brief Index of the end points, by local port.
+   */
+  typedef sgi::hash_map<uint16_t, EndPoints> PortIndex;
+
+  /**
+   * \brief Index of the end points, by four-tuple.
+   */
+  typedef sgi::hash_map<EndPointKey, EndPoints, EndPointKeyHash> TupleIndex;
+
+  /**
+   * \brief Add a new end point to the container and to the indexes.
+   * \param endPoint the end point
+   */
+  void Insert (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Add an end point to the four-tuple index.
+   *
+   * The end points of an entry are kept in the order of their allocation,
+   * which is the order in which Lookup returns them.
+   *
+   * \param endPoint the end point
+   */
+  void IndexTuple (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Remove an end point from the four-tuple index.
+   * \param endPoint the end point
+   */
+  void UnindexTuple (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Get the end points of a four-tuple which may receive packets from an interface.
+   * \param key the four-tuple
+   * \param incomingInterface the incoming interface
+   * \return the end points in the order of their allocation
+   */
+  EndPoints LookupTuple (const EndPointKey &key, Ptr<Ipv4Interface> incomingInterface);
+
+  /**
+   * \brief Lookup by a scan of the end points of a port.
+   *
+   * This is the reference algorithm, used for broadcast packets.
+   *
+   * \param endPoints the end points bound to the destination port
+   * \param daddr destination address to test
+   * \param dport destination port to test
+   * \param saddr source address to test
+   * \param sport source port to test
+   * \param incomingInterface the incoming interface
+   * \param isBroadcast whether the destination address is a broadcast address
+   * \param incomingInterfaceAddr the address of the interface, for subnet-directed broadcasts
+   * \return list of IPv4EndPoints (could be 0 element)
+   */
+  EndPoints ScanLookup (const EndPoints &endPoints,
+                        Ipv4Address daddr, uint16_t dport,
+                        Ipv4Address saddr, uint16_t sport,
+                        Ptr<Ipv4Interface> incomingInterface,
+                        bool isBroadcast, Ipv4Address incomingInterfaceAddr);
 
   /**
    * \brief Allocate an ephemeral port.
@@ -178,6 +285,21 @@ private:
    * \brief A list of IPv4 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief The IPv4 end points, by local port.
+   */
+  PortIndex m_ports;
+
+  /**
+   * \brief The IPv4 end points, by four-tuple.
+   */
+  TupleIndex m_tuples;
+
+  /**
+   * \brief The allocation number of the next end point.
+   */
+  uint64_t m_nextSequence;
 };
 
 } // namespace ns3
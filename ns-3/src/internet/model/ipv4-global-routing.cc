@@ -18,6 +18,7 @@
 
 #include <vector>
 #include <iomanip>
+#include <algorithm>
 #include "ns3/names.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
@@ -78,6 +79,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
   m_hostRoutes.push_back (route);
+  m_hostTrie.Insert (dest, Ipv4Mask::GetOnes (), route);
 }
 
 void 
@@ -88,6 +90,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
   m_hostRoutes.push_back (route);
+  m_hostTrie.Insert (dest, Ipv4Mask::GetOnes (), route);
 }
 
 void 
@@ -103,6 +106,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_networkTrie.Insert (network, networkMask, route);
 }
 
 void 
@@ -116,6 +120,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_networkTrie.Insert (network, networkMask, route);
 }
 
 void 
@@ -131,9 +136,22 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_ASexternalRoutes.push_back (route);
+  m_ASexternalTrie.Insert (network, networkMask, route);
 }
 
 
+/**
+ * \brief Compare the insertion order of two routes of an Ipv4PrefixTrie.
+ * \param a a route
+ * \param b another route
+ * \return true if a was inserted before b
+ */
+static bool
+RouteSequenceLess (const Ipv4PrefixTrie::Route *a, const Ipv4PrefixTrie::Route *b)
+{
+  return a->sequence < b->sequence;
+}
+
 Ptr<Ipv4Route>
 Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
 {
@@ -144,73 +162,86 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
   typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
   RouteVec_t allRoutes;
 
+  // the routes of each list are considered in the order of the list,
+  // whatever the length of their prefix.
+  Ipv4PrefixTrie::Matches matches;
   NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
-  for (HostRoutesCI i = m_hostRoutes.begin (); 
-       i != m_hostRoutes.end (); 
-       i++) 
+  m_hostTrie.Lookup (dest, matches);
+  for (Ipv4PrefixTrie::Matches::const_iterator i = matches.begin (); i != matches.end (); i++)
     {
-      NS_ASSERT ((*i)->IsHost ());
-      if ((*i)->GetDest ().IsEqual (dest)) 
+      for (Ipv4PrefixTrie::Routes::const_iterator j = (*i)->begin (); j != (*i)->end (); j++)
         {
+          NS_ASSERT (j->entry->IsHost ());
           if (oif != 0)
             {
-              if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
+              if (oif != m_ipv4->GetNetDevice (j->entry->GetInterface ()))
                 {
                   NS_LOG_LOGIC ("Not on requested interface, skipping");
                   continue;
                 }
             }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
+          allRoutes.push_back (j->entry);
+          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << j->entry); 
         }
     }
   if (allRoutes.size () == 0) // if no host route is found
     {
       NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin (); 
-           j != m_networkRoutes.end (); 
-           j++) 
+      std::vector<const Ipv4PrefixTrie::Route *> networkRoutes;
+      m_networkTrie.Lookup (dest, matches);
+      for (Ipv4PrefixTrie::Matches::const_iterator i = matches.begin (); i != matches.end (); i++)
         {
-          Ipv4Mask mask = (*j)->GetDestNetworkMask ();
-          Ipv4Address entry = (*j)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry)) 
+          for (Ipv4PrefixTrie::Routes::const_iterator j = (*i)->begin (); j != (*i)->end (); j++)
             {
               if (oif != 0)
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
+                  if (oif != m_ipv4->GetNetDevice (j->entry->GetInterface ()))
                     {
                       NS_LOG_LOGIC ("Not on requested interface, skipping");
                       continue;
                     }
                 }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
+              networkRoutes.push_back (&*j);
             }
         }
+      std::sort (networkRoutes.begin (), networkRoutes.end (), RouteSequenceLess);
+      for (std::vector<const Ipv4PrefixTrie::Route *>::const_iterator j = networkRoutes.begin ();
+           j != networkRoutes.end ();
+           j++)
+        {
+          allRoutes.push_back ((*j)->entry);
+          NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << (*j)->entry);
+        }
     }
   if (allRoutes.size () == 0)  // consider external if no host/network found
     {
-      for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
-           k != m_ASexternalRoutes.end ();
-           k++)
+      const Ipv4PrefixTrie::Route *external = 0;
+      m_ASexternalTrie.Lookup (dest, matches);
+      for (Ipv4PrefixTrie::Matches::const_iterator i = matches.begin (); i != matches.end (); i++)
         {
-          Ipv4Mask mask = (*k)->GetDestNetworkMask ();
-          Ipv4Address entry = (*k)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry))
+          for (Ipv4PrefixTrie::Routes::const_iterator k = (*i)->begin (); k != (*i)->end (); k++)
             {
-              NS_LOG_LOGIC ("Found external route" << *k);
+              if (external != 0 && external->sequence < k->sequence)
+                {
+                  break;
+                }
+              NS_LOG_LOGIC ("Found external route" << k->entry);
               if (oif != 0)
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
+                  if (oif != m_ipv4->GetNetDevice (k->entry->GetInterface ()))
                     {
                       NS_LOG_LOGIC ("Not on requested interface, skipping");
                       continue;
                     }
                 }
-              allRoutes.push_back (*k);
+              external = &*k;
               break;
             }
         }
+      if (external != 0)
+        {
+          allRoutes.push_back (external->entry);
+        }
     }
   if (allRoutes.size () > 0 ) // if route(s) is found
     {
@@ -317,6 +348,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
           if (tmp  == index)
             {
               NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_hostRoutes.size ());
+              m_hostTrie.Remove ((*i)->GetDest (), Ipv4Mask::GetOnes (), *i);
               delete *i;
               m_hostRoutes.erase (i);
               NS_LOG_LOGIC ("Done removing host route " << index << "; host route remaining size = " << m_hostRoutes.size ());
@@ -334,6 +366,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_networkRoutes.size ());
+          m_networkTrie.Remove ((*j)->GetDestNetwork (), (*j)->GetDestNetworkMask (), *j);
           delete *j;
           m_networkRoutes.erase (j);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -350,6 +383,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_ASexternalRoutes.size ());
+          m_ASexternalTrie.Remove ((*k)->GetDestNetwork (), (*k)->GetDestNetworkMask (), *k);
           delete *k;
           m_ASexternalRoutes.erase (k);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -390,6 +424,9 @@ Ipv4GlobalRouting::DoDispose (void)
     {
       delete (*l);
     }
+  m_hostTrie.Clear ();
+  m_networkTrie.Clear ();
+  m_ASexternalTrie.Clear ();
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -28,6 +28,7 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/ipv4-prefix-trie.h"
 
 namespace ns3 {
 
@@ -264,6 +265,10 @@ private:
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+  Ipv4PrefixTrie m_hostTrie;       //!< Routes to hosts, by destination
+  Ipv4PrefixTrie m_networkTrie;    //!< Routes to networks, by destination prefix
+  Ipv4PrefixTrie m_ASexternalTrie; //!< External routes, by destination prefix
+
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
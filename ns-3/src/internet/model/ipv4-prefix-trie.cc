@@ -0,0 +1,206 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+
+#include "ipv4-prefix-trie.h"
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+Ipv4PrefixTrie::Ipv4PrefixTrie ()
+  : m_root (CreateNode (0, 0)),
+    m_nRoutes (0),
+    m_nextSequence (0)
+{
+}
+
+Ipv4PrefixTrie::~Ipv4PrefixTrie ()
+{
+  DeleteChildren (m_root);
+  delete m_root;
+}
+
+Ipv4PrefixTrie::Node *
+Ipv4PrefixTrie::CreateNode (uint32_t prefix, uint8_t length)
+{
+  Node *node = new Node;
+  node->prefix = prefix & GetMask (length);
+  node->length = length;
+  node->children[0] = 0;
+  node->children[1] = 0;
+  return node;
+}
+
+void
+Ipv4PrefixTrie::DeleteChildren (Node *node)
+{
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      if (node->children[i] != 0)
+        {
+          DeleteChildren (node->children[i]);
+          delete node->children[i];
+          node->children[i] = 0;
+        }
+    }
+}
+
+uint32_t
+Ipv4PrefixTrie::GetMask (uint8_t length)
+{
+  return length == 0 ? 0 : 0xffffffff << (32 - length);
+}
+
+uint8_t
+Ipv4PrefixTrie::GetBit (uint32_t address, uint8_t index)
+{
+  return (address >> (31 - index)) & 1;
+}
+
+void
+Ipv4PrefixTrie::Insert (Ipv4Address network, Ipv4Mask networkMask,
+                        Ipv4RoutingTableEntry *entry, uint32_t metric)
+{
+  uint8_t length = networkMask.GetPrefixLength ();
+  NS_ASSERT_MSG (networkMask.Get () == GetMask (length), "Non-contiguous network mask " << networkMask);
+  uint32_t prefix = network.Get () & GetMask (length);
+
+  // find the node of the prefix, splitting an edge or adding a leaf if
+  // it does not exist yet.
+  Node *node = m_root;
+  while (node->length != length)
+    {
+      Node **link = &node->children[GetBit (prefix, node->length)];
+      Node *child = *link;
+      if (child == 0)
+        {
+          *link = CreateNode (prefix, length);
+          node = *link;
+          break;
+        }
+      uint8_t common = node->length + 1;
+      uint8_t limit = std::min (child->length, length);
+      while (common < limit && GetBit (child->prefix, common) == GetBit (prefix, common))
+        {
+          common++;
+        }
+      if (common == child->length)
+        {
+          node = child;
+          continue;
+        }
+      Node *split = CreateNode (prefix, common);
+      split->children[GetBit (child->prefix, common)] = child;
+      *link = split;
+      if (common == length)
+        {
+          node = split;
+        }
+      else
+        {
+          node = CreateNode (prefix, length);
+          split->children[GetBit (prefix, common)] = node;
+        }
+    }
+
+  Route route;
+  route.entry = entry;
+  route.metric = metric;
+  route.sequence = m_nextSequence++;
+  node->routes.push_back (route);
+  m_nRoutes++;
+}
+
+void
+Ipv4PrefixTrie::Remove (Ipv4Address network, Ipv4Mask networkMask,
+                        Ipv4RoutingTableEntry *entry)
+{
+  uint8_t length = networkMask.GetPrefixLength ();
+  uint32_t prefix = network.Get () & GetMask (length);
+
+  Node *parent = 0;
+  Node *grandParent = 0;
+  Node *node = m_root;
+  while (node != 0 && node->length < length)
+    {
+      grandParent = parent;
+      parent = node;
+      node = node->children[GetBit (prefix, node->length)];
+    }
+  NS_ASSERT_MSG (node != 0 && node->length == length && node->prefix == prefix,
+                 "No route to " << network << "/" << (uint32_t) length);
+
+  Routes::iterator i = node->routes.begin ();
+  while (i != node->routes.end () && i->entry != entry)
+    {
+      i++;
+    }
+  NS_ASSERT_MSG (i != node->routes.end (), "No such route to " << network << "/" << (uint32_t) length);
+  node->routes.erase (i);
+  m_nRoutes--;
+
+  // remove the prefixes which are neither routes nor branches anymore
+  if (node == m_root || !node->routes.empty () || (node->children[0] != 0 && node->children[1] != 0))
+    {
+      return;
+    }
+  Node *child = node->children[0] != 0 ? node->children[0] : node->children[1];
+  parent->children[parent->children[0] == node ? 0 : 1] = child;
+  delete node;
+  if (child == 0 && parent != m_root && parent->routes.empty ())
+    {
+      child = parent->children[0] != 0 ? parent->children[0] : parent->children[1];
+      grandParent->children[grandParent->children[0] == parent ? 0 : 1] = child;
+      delete parent;
+    }
+}
+
+void
+Ipv4PrefixTrie::Clear (void)
+{
+  DeleteChildren (m_root);
+  m_root->routes.clear ();
+  m_nRoutes = 0;
+}
+
+void
+Ipv4PrefixTrie::Lookup (Ipv4Address dest, Matches &matches) const
+{
+  matches.clear ();
+  uint32_t address = dest.Get ();
+  const Node *node = m_root;
+  while (node != 0 && (address & GetMask (node->length)) == node->prefix)
+    {
+      if (!node->routes.empty ())
+        {
+          matches.push_back (&node->routes);
+        }
+      if (node->length == 32)
+        {
+          break;
+        }
+      node = node->children[GetBit (address, node->length)];
+    }
+}
+
+uint32_t
+Ipv4PrefixTrie::GetNRoutes (void) const
+{
+  return m_nRoutes;
+}
+
+} // namespace ns3
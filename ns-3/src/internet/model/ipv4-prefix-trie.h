@@ -0,0 +1,125 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV4_PREFIX_TRIE_H
+#define IPV4_PREFIX_TRIE_H
+
+#include <vector>
+#include <stdint.h>
+
+#include "ns3/ipv4-address.h"
+
+namespace ns3 {
+
+class Ipv4RoutingTableEntry;
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief A path-compressed binary trie of the routes of a routing
+ * table, keyed by their destination prefix.
+ *
+ * The lookup of a destination visits at most one node per prefix
+ * length, instead of the whole routing table, and returns the routes
+ * of every prefix which matches the destination, from the shortest
+ * prefix to the longest.  The routes of a prefix are kept in insertion
+ * order, so that the routing protocols can resolve the ties exactly as
+ * their route lists did.
+ *
+ * The network masks must be contiguous.
+ */
+class Ipv4PrefixTrie
+{
+public:
+  /**
+   * \brief A route of the trie.
+   */
+  struct Route
+  {
+    Ipv4RoutingTableEntry *entry; //!< the routing table entry
+    uint32_t metric;              //!< the metric of the route
+    uint64_t sequence;            //!< the insertion order of the route
+  };
+  /// The routes of a prefix, in insertion order
+  typedef std::vector<Route> Routes;
+  /// The routes of the prefixes matching a destination, shortest prefix first
+  typedef std::vector<const Routes *> Matches;
+
+  Ipv4PrefixTrie ();
+  ~Ipv4PrefixTrie ();
+
+  /**
+   * \brief Add a route to a network.
+   * \param network the destination network
+   * \param networkMask the contiguous mask of the network
+   * \param entry the routing table entry, which the trie does not own
+   * \param metric the metric of the route
+   */
+  void Insert (Ipv4Address network, Ipv4Mask networkMask,
+               Ipv4RoutingTableEntry *entry, uint32_t metric = 0);
+  /**
+   * \brief Remove a route added with Insert.
+   * \param network the destination network given to Insert
+   * \param networkMask the mask given to Insert
+   * \param entry the routing table entry given to Insert
+   */
+  void Remove (Ipv4Address network, Ipv4Mask networkMask,
+               Ipv4RoutingTableEntry *entry);
+  /**
+   * \brief Remove all the routes.
+   */
+  void Clear (void);
+  /**
+   * \brief Find the routes of the prefixes matching a destination.
+   * \param dest the destination address
+   * \param matches cleared, then filled with the non-empty route lists
+   *        of the matching prefixes, from the shortest to the longest
+   */
+  void Lookup (Ipv4Address dest, Matches &matches) const;
+  /**
+   * \return the number of routes of the trie
+   */
+  uint32_t GetNRoutes (void) const;
+
+private:
+  /**
+   * \brief A prefix of the trie.  Only the prefixes with routes or
+   * with two children are kept.
+   */
+  struct Node
+  {
+    uint32_t prefix;    //!< the prefix, with its host bits cleared
+    uint8_t length;     //!< the length of the prefix
+    Node *children[2];  //!< the longer prefixes, by their next bit
+    Routes routes;      //!< the routes to this prefix
+  };
+
+  Ipv4PrefixTrie (const Ipv4PrefixTrie &);
+  Ipv4PrefixTrie &operator = (const Ipv4PrefixTrie &);
+
+  static Node *CreateNode (uint32_t prefix, uint8_t length);
+  static void DeleteChildren (Node *node);
+  static uint32_t GetMask (uint8_t length);
+  static uint8_t GetBit (uint32_t address, uint8_t index);
+
+  Node *m_root;             //!< the prefix of length 0, always present
+  uint32_t m_nRoutes;       //!< the number of routes
+  uint64_t m_nextSequence;  //!< the sequence of the next route inserted
+};
+
+} // namespace ns3
+
+#endif /* IPV4_PREFIX_TRIE_H */
@@ -31,6 +31,7 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-prefix-trie.h"
 
 namespace ns3 {
 
@@ -430,6 +431,11 @@ private:
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief the routes of m_networkRoutes, by destination prefix.
+   */
+  Ipv4PrefixTrie m_networkTrie;
+
   /**
    * \brief the forwarding table for multicast.
    */
@@ -0,0 +1,304 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/node.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/loopback-net-device.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-end-point.h"
+#include "../src/internet/model/ipv4-end-point-demux.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Compares the lookups of Ipv4EndPointDemux with a linear scan of all
+ * of its end points in allocation order, while end points are
+ * allocated, bound, connected and deallocated at random.
+ */
+class Ipv4EndPointDemuxLookupTestCase : public TestCase
+{
+public:
+  Ipv4EndPointDemuxLookupTestCase ();
+private:
+  virtual void DoRun (void);
+  Ipv4EndPointDemux::EndPoints ReferenceLookup (Ipv4EndPointDemux::EndPoints endPoints,
+                                                Ipv4Address daddr, uint16_t dport,
+                                                Ipv4Address saddr, uint16_t sport,
+                                                Ptr<Ipv4Interface> incomingInterface);
+  Ipv4EndPoint *ReferenceSimpleLookup (Ipv4EndPointDemux::EndPoints endPoints,
+                                       Ipv4Address daddr, uint16_t dport,
+                                       Ipv4Address saddr, uint16_t sport);
+  Ipv4Address RandomAddress (bool any);
+  uint16_t RandomPort (bool any);
+
+  Ptr<UniformRandomVariable> m_random;
+};
+
+Ipv4EndPointDemuxLookupTestCase::Ipv4EndPointDemuxLookupTestCase ()
+  : TestCase ("Indexed lookups match a scan of all end points")
+{
+}
+
+Ipv4EndPointDemux::EndPoints
+Ipv4EndPointDemuxLookupTestCase::ReferenceLookup (Ipv4EndPointDemux::EndPoints endPoints,
+                                                  Ipv4Address daddr, uint16_t dport,
+                                                  Ipv4Address saddr, uint16_t sport,
+                                                  Ptr<Ipv4Interface> incomingInterface)
+{
+  bool subnetDirected = false;
+  Ipv4Address incomingInterfaceAddr = daddr;
+  for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
+    {
+      Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
+      if (addr.GetLocal ().CombineMask (addr.GetMask ()) == daddr.CombineMask (addr.GetMask ()) &&
+          daddr.IsSubnetDirectedBroadcast (addr.GetMask ()))
+        {
+          subnetDirected = true;
+          incomingInterfaceAddr = addr.GetLocal ();
+        }
+    }
+  bool isBroadcast = daddr.IsBroadcast () || subnetDirected;
+  Ipv4Address any = Ipv4Address::GetAny ();
+
+  Ipv4EndPointDemux::EndPoints retval[4];
+  for (Ipv4EndPointDemux::EndPointsI i = endPoints.begin (); i != endPoints.end (); i++)
+    {
+      Ipv4EndPoint *endP = *i;
+      if (endP->GetLocalPort () != dport)
+        {
+          continue;
+        }
+      if (endP->GetBoundNetDevice () && endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
+        {
+          continue;
+        }
+      bool localWildCard = endP->GetLocalAddress () == any;
+      bool localExact = endP->GetLocalAddress () == daddr;
+      if (isBroadcast && !localWildCard)
+        {
+          localExact = endP->GetLocalAddress () == incomingInterfaceAddr;
+        }
+      bool peerExact = endP->GetPeerPort () == sport;
+      bool peerWildCard = endP->GetPeerPort () == 0;
+      bool remoteExact = endP->GetPeerAddress () == saddr;
+      bool remoteWildCard = endP->GetPeerAddress () == any;
+      if (!(localExact || localWildCard) || !(peerExact || peerWildCard) || !(remoteExact || remoteWildCard))
+        {
+          continue;
+        }
+      if (localWildCard && peerWildCard && remoteWildCard)
+        {
+          retval[0].push_back (endP);
+        }
+      if ((localExact || (isBroadcast && localWildCard)) && peerWildCard && remoteWildCard)
+        {
+          retval[1].push_back (endP);
+        }
+      if (localWildCard && peerExact && remoteExact)
+        {
+          retval[2].push_back (endP);
+        }
+      if (localExact && peerExact && remoteExact)
+        {
+          retval[3].push_back (endP);
+        }
+    }
+  for (int i = 3; i > 0; i--)
+    {
+      if (!retval[i].empty ())
+        {
+          return retval[i];
+        }
+    }
+  return retval[0];
+}
+
+Ipv4EndPoint *
+Ipv4EndPointDemuxLookupTestCase::ReferenceSimpleLookup (Ipv4EndPointDemux::EndPoints endPoints,
+                                                        Ipv4Address daddr, uint16_t dport,
+                                                        Ipv4Address saddr, uint16_t sport)
+{
+  uint32_t genericity = 3;
+  Ipv4EndPoint *generic = 0;
+  for (Ipv4EndPointDemux::EndPointsI i = endPoints.begin (); i != endPoints.end (); i++)
+    {
+      if ((*i)->GetLocalPort () != dport)
+        {
+          continue;
+        }
+      if ((*i)->GetLocalAddress () == daddr && (*i)->GetPeerPort () == sport && (*i)->GetPeerAddress () == saddr)
+        {
+          return *i;
+        }
+      uint32_t tmp = 0;
+      if ((*i)->GetLocalAddress () == Ipv4Address::GetAny ())
+        {
+          tmp++;
+        }
+      if ((*i)->GetPeerAddress () == Ipv4Address::GetAny ())
+        {
+          tmp++;
+        }
+      if (tmp < genericity)
+        {
+          generic = (*i);
+          genericity = tmp;
+        }
+    }
+  return generic;
+}
+
+Ipv4Address
+Ipv4EndPointDemuxLookupTestCase::RandomAddress (bool any)
+{
+  // few distinct values, so that the lookups collide often
+  switch (m_random->GetInteger (any ? 0 : 1, 4))
+    {
+    case 0:
+      return Ipv4Address::GetAny ();
+    case 1:
+      return Ipv4Address ("10.0.0.1");
+    case 2:
+      return Ipv4Address ("10.0.0.2");
+    case 3:
+      return Ipv4Address ("10.0.0.255");
+    default:
+      return Ipv4Address ("10.0.1.1");
+    }
+}
+
+uint16_t
+Ipv4EndPointDemuxLookupTestCase::RandomPort (bool any)
+{
+  return m_random->GetInteger (any ? 0 : 1, 4);
+}
+
+void
+Ipv4EndPointDemuxLookupTestCase::DoRun (void)
+{
+  m_random = CreateObject<UniformRandomVariable> ();
+  m_random->SetStream (1);
+
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<LoopbackNetDevice> devices[2];
+  Ptr<Ipv4Interface> interfaces[2];
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      devices[i] = CreateObject<LoopbackNetDevice> ();
+      node->AddDevice (devices[i]);
+      interfaces[i] = CreateObject<Ipv4Interface> ();
+      interfaces[i]->SetNode (node);
+      interfaces[i]->SetDevice (devices[i]);
+    }
+  interfaces[0]->AddAddress (Ipv4InterfaceAddress ("10.0.0.1", "255.255.255.0"));
+  interfaces[1]->AddAddress (Ipv4InterfaceAddress ("10.0.1.1", "255.255.255.0"));
+
+  Ipv4EndPointDemux demux;
+  std::vector<Ipv4EndPoint *> endPoints;
+  for (uint32_t step = 0; step < 5000; step++)
+    {
+      uint32_t action = m_random->GetInteger (0, 9);
+      if (action < 4 || endPoints.empty ())
+        {
+          Ipv4EndPoint *endPoint;
+          switch (action)
+            {
+            case 0:
+              endPoint = demux.Allocate (RandomPort (false));
+              break;
+            case 1:
+              endPoint = demux.Allocate (RandomAddress (true), RandomPort (false));
+              break;
+            default:
+              endPoint = demux.Allocate (RandomAddress (true), RandomPort (false),
+                                         RandomAddress (true), RandomPort (true));
+              break;
+            }
+          if (endPoint != 0)
+            {
+              endPoints.push_back (endPoint);
+            }
+        }
+      else if (action < 6)
+        {
+          uint32_t index = m_random->GetInteger (0, endPoints.size () - 1);
+          demux.DeAllocate (endPoints[index]);
+          endPoints[index] = endPoints.back ();
+          endPoints.pop_back ();
+        }
+      else if (action == 6)
+        {
+          // changes the addresses of an end point as sockets do on
+          // Connect and Bind
+          Ipv4EndPoint *endPoint = endPoints[m_random->GetInteger (0, endPoints.size () - 1)];
+          if (m_random->GetInteger (0, 1))
+            {
+              endPoint->SetPeer (RandomAddress (true), RandomPort (true));
+            }
+          else
+            {
+              endPoint->SetLocalAddress (RandomAddress (true));
+            }
+        }
+      else if (action == 7)
+        {
+          Ipv4EndPoint *endPoint = endPoints[m_random->GetInteger (0, endPoints.size () - 1)];
+          endPoint->BindToNetDevice (devices[m_random->GetInteger (0, 1)]);
+        }
+
+      Ipv4EndPointDemux::EndPoints all = demux.GetAllEndPoints ();
+      NS_TEST_ASSERT_MSG_EQ (all.size (), endPoints.size (), "Unexpected number of end points");
+      for (uint32_t lookup = 0; lookup < 4; lookup++)
+        {
+          Ipv4Address daddr = RandomAddress (false);
+          uint16_t dport = RandomPort (false);
+          Ipv4Address saddr = RandomAddress (false);
+          uint16_t sport = RandomPort (false);
+          Ptr<Ipv4Interface> interface = interfaces[m_random->GetInteger (0, 1)];
+
+          Ipv4EndPointDemux::EndPoints expected = ReferenceLookup (all, daddr, dport, saddr, sport, interface);
+          Ipv4EndPointDemux::EndPoints found = demux.Lookup (daddr, dport, saddr, sport, interface);
+          NS_TEST_ASSERT_MSG_EQ ((found == expected), true, "Lookup differs from a scan at step " << step);
+          NS_TEST_ASSERT_MSG_EQ (demux.SimpleLookup (daddr, dport, saddr, sport),
+                                 ReferenceSimpleLookup (all, daddr, dport, saddr, sport),
+                                 "SimpleLookup differs from a scan at step " << step);
+          bool portUsed = false;
+          bool localUsed = false;
+          for (Ipv4EndPointDemux::EndPointsI i = all.begin (); i != all.end (); i++)
+            {
+              if ((*i)->GetLocalPort () == dport)
+                {
+                  portUsed = true;
+                  localUsed = localUsed || (*i)->GetLocalAddress () == daddr;
+                }
+            }
+          NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (dport), portUsed, "LookupPortLocal differs from a scan");
+          NS_TEST_ASSERT_MSG_EQ (demux.LookupLocal (daddr, dport), localUsed, "LookupLocal differs from a scan");
+        }
+    }
+}
+
+class Ipv4EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  Ipv4EndPointDemuxTestSuite () : TestSuite ("ipv4-end-point-demux", UNIT)
+  {
+    AddTestCase (new Ipv4EndPointDemuxLookupTestCase, TestCase::QUICK);
+  }
+} g_ipv4EndPointDemuxTestSuite;
@@ -15,6 +15,7 @@
  */
 
 #include <vector>
+#include <sstream>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
 #include "ns3/inet-socket-address.h"
@@ -36,6 +37,10 @@
 #include "ns3/simple-channel.h"
 #include "ns3/socket-factory.h"
 #include "ns3/udp-socket-factory.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/global-router-interface.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "ns3/random-variable-stream.h"
 
 using namespace ns3;
 
@@ -440,6 +445,252 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
 }
 
 
+/**
+ * Compares the routes found by Ipv4GlobalRouting with a scan of its
+ * host, network and external routes, while routes are added and
+ * removed at random.
+ */
+class Ipv4GlobalRoutingLookupTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingLookupTestCase ();
+
+private:
+  virtual void DoRun (void);
+  Ipv4RoutingTableEntry *ReferenceLookup (Ptr<Ipv4GlobalRouting> routing, Ptr<Ipv4> ipv4,
+                                          Ipv4Address dest, Ptr<NetDevice> oif);
+  Ipv4Address RandomAddress (void);
+
+  Ptr<UniformRandomVariable> m_random;
+  uint32_t m_nHostRoutes;
+  uint32_t m_nNetworkRoutes;
+};
+
+Ipv4GlobalRoutingLookupTestCase::Ipv4GlobalRoutingLookupTestCase ()
+  : TestCase ("Lookup of global routes")
+{
+}
+
+// the route chosen by the former scan of the routes: the first host
+// route, else the first network route, else the first external route.
+Ipv4RoutingTableEntry *
+Ipv4GlobalRoutingLookupTestCase::ReferenceLookup (Ptr<Ipv4GlobalRouting> routing, Ptr<Ipv4> ipv4,
+                                                  Ipv4Address dest, Ptr<NetDevice> oif)
+{
+  uint32_t first[3] = { 0, m_nHostRoutes, m_nHostRoutes + m_nNetworkRoutes };
+  uint32_t last[3] = { m_nHostRoutes, m_nHostRoutes + m_nNetworkRoutes, routing->GetNRoutes () };
+  for (uint32_t kind = 0; kind < 3; kind++)
+    {
+      for (uint32_t i = first[kind]; i < last[kind]; i++)
+        {
+          Ipv4RoutingTableEntry *route = routing->GetRoute (i);
+          bool match = kind == 0 ? route->GetDest () == dest
+            : route->GetDestNetworkMask ().IsMatch (dest, route->GetDestNetwork ());
+          if (match && (oif == 0 || oif == ipv4->GetNetDevice (route->GetInterface ())))
+            {
+              return route;
+            }
+        }
+    }
+  return 0;
+}
+
+Ipv4Address
+Ipv4GlobalRoutingLookupTestCase::RandomAddress (void)
+{
+  // a few networks, so that the prefixes nest and collide often
+  static const uint32_t bases[] = { 0x0a000000, 0x0a010000, 0x0a010200, 0xac100000 };
+  return Ipv4Address (bases[m_random->GetInteger (0, 3)] | m_random->GetInteger (0, 0x3ff));
+}
+
+void
+Ipv4GlobalRoutingLookupTestCase::DoRun (void)
+{
+  m_random = CreateObject<UniformRandomVariable> ();
+  m_random->SetStream (1);
+  m_nHostRoutes = 0;
+  m_nNetworkRoutes = 0;
+
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  std::vector<Ptr<NetDevice> > devices;
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      node->AddDevice (device);
+      int32_t ifIndex = ipv4->AddInterface (device);
+      ipv4->AddAddress (ifIndex, Ipv4InterfaceAddress (Ipv4Address (0xc0a80001 + (i << 8)), Ipv4Mask ("/24")));
+      ipv4->SetUp (ifIndex);
+      devices.push_back (device);
+    }
+
+  Ptr<Ipv4GlobalRouting> routing = CreateObject<Ipv4GlobalRouting> ();
+  routing->SetIpv4 (ipv4);
+  uint32_t gateway = 0x0b000000;
+  for (uint32_t step = 0; step < 600; step++)
+    {
+      // each route has its own gateway, to tell the routes apart
+      uint32_t action = m_random->GetInteger (0, 5);
+      uint32_t interface = m_random->GetInteger (1, 3);
+      uint32_t length = m_random->GetInteger (8, 26);
+      Ipv4Mask mask (0xffffffff << (32 - length));
+      if (action < 2 || routing->GetNRoutes () == 0)
+        {
+          routing->AddHostRouteTo (RandomAddress (), Ipv4Address (gateway++), interface);
+          m_nHostRoutes++;
+        }
+      else if (action < 4)
+        {
+          routing->AddNetworkRouteTo (RandomAddress (), mask, Ipv4Address (gateway++), interface);
+          m_nNetworkRoutes++;
+        }
+      else if (action < 5)
+        {
+          routing->AddASExternalRouteTo (RandomAddress (), mask, Ipv4Address (gateway++), interface);
+        }
+      else
+        {
+          uint32_t index = m_random->GetInteger (0, routing->GetNRoutes () - 1);
+          routing->RemoveRoute (index);
+          if (index < m_nHostRoutes)
+            {
+              m_nHostRoutes--;
+            }
+          else if (index < m_nHostRoutes + m_nNetworkRoutes)
+            {
+              m_nNetworkRoutes--;
+            }
+        }
+
+      for (uint32_t lookup = 0; lookup < 4; lookup++)
+        {
+          Ipv4Header header;
+          header.SetDestination (RandomAddress ());
+          Ptr<NetDevice> oif = 0;
+          if (m_random->GetInteger (0, 1))
+            {
+              oif = devices[m_random->GetInteger (0, 2)];
+            }
+          Socket::SocketErrno sockerr;
+          Ptr<Ipv4Route> found = routing->RouteOutput (0, header, oif, sockerr);
+          Ipv4RoutingTableEntry *expected = ReferenceLookup (routing, ipv4, header.GetDestination (), oif);
+          NS_TEST_ASSERT_MSG_EQ ((found != 0), (expected != 0), "No route to " << header.GetDestination () << " at step " << step);
+          if (expected != 0)
+            {
+              NS_TEST_ASSERT_MSG_EQ (found->GetGateway (), expected->GetGateway (), "Wrong route to " << header.GetDestination () << " at step " << step);
+            }
+        }
+    }
+
+  Simulator::Destroy ();
+}
+
+class Ipv4GlobalRoutingParallelSpfTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingParallelSpfTestCase ();
+
+private:
+  virtual void DoRun (void);
+  std::vector<std::string> GetRoutes (const NodeContainer &nodes);
+};
+
+Ipv4GlobalRoutingParallelSpfTestCase::Ipv4GlobalRoutingParallelSpfTestCase ()
+  : TestCase ("SPF calculations on several threads")
+{
+}
+
+// the routes of the nodes, in order
+std::vector<std::string>
+Ipv4GlobalRoutingParallelSpfTestCase::GetRoutes (const NodeContainer &nodes)
+{
+  std::vector<std::string> routes;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = nodes.Get (i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+        {
+          std::ostringstream oss;
+          oss << "node " << i << ": " << *routing->GetRoute (j);
+          routes.push_back (oss.str ());
+        }
+    }
+  return routes;
+}
+
+// A grid of routers joined by point-to-point links, with many equal-cost
+// paths and a stub router hanging off each corner, next to a chain of
+// routers across a shared network (which the equal-cost paths must not reach).
+void
+Ipv4GlobalRoutingParallelSpfTestCase::DoRun (void)
+{
+  const uint32_t side = 6;
+  NodeContainer grid;
+  grid.Create (side * side);
+  NodeContainer stubs;
+  stubs.Create (4);
+  NodeContainer chain;
+  chain.Create (5);
+  NodeContainer nodes (grid, stubs, chain);
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper devHelper;
+  devHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.255.255.252");
+  for (uint32_t row = 0; row < side; row++)
+    {
+      for (uint32_t col = 0; col < side; col++)
+        {
+          Ptr<Node> node = grid.Get (row * side + col);
+          if (col + 1 < side)
+            {
+              ipv4.Assign (devHelper.Install (NodeContainer (node, grid.Get (row * side + col + 1))));
+              ipv4.NewNetwork ();
+            }
+          if (row + 1 < side)
+            {
+              ipv4.Assign (devHelper.Install (NodeContainer (node, grid.Get ((row + 1) * side + col))));
+              ipv4.NewNetwork ();
+            }
+        }
+    }
+  uint32_t corners[4] = { 0, side - 1, side * (side - 1), side * side - 1 };
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      ipv4.Assign (devHelper.Install (NodeContainer (grid.Get (corners[i]), stubs.Get (i))));
+      ipv4.NewNetwork ();
+    }
+  ipv4.Assign (devHelper.Install (NodeContainer (chain.Get (0), chain.Get (1))));
+  ipv4.NewNetwork ();
+  ipv4.Assign (devHelper.Install (NodeContainer (chain.Get (3), chain.Get (4))));
+  devHelper.SetNetDevicePointToPointMode (false);
+  ipv4.SetBase ("172.16.1.0", "255.255.255.0");
+  ipv4.Assign (devHelper.Install (NodeContainer (chain.Get (1), chain.Get (2), chain.Get (3))));
+
+  Config::SetGlobal ("GlobalRoutingSpfThreads", UintegerValue (1));
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  std::vector<std::string> serial = GetRoutes (nodes);
+  NS_TEST_ASSERT_MSG_GT (serial.size (), nodes.GetN () * nodes.GetN (), "Too few routes");
+
+  Config::SetGlobal ("GlobalRoutingSpfThreads", UintegerValue (4));
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  std::vector<std::string> parallel = GetRoutes (nodes);
+  NS_TEST_ASSERT_MSG_EQ (parallel.size (), serial.size (), "Not the same number of routes");
+  for (uint32_t i = 0; i < serial.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (parallel[i], serial[i], "Not the same route " << i);
+    }
+
+  Config::SetGlobal ("GlobalRoutingSpfThreads", UintegerValue (0));
+  Simulator::Destroy ();
+}
+
 class Ipv4GlobalRoutingTestSuite : public TestSuite
 {
 public:
@@ -451,6 +702,8 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
 {
   AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
   AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4GlobalRoutingLookupTestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4GlobalRoutingParallelSpfTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
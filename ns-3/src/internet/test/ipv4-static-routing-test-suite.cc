@@ -35,6 +35,9 @@
 #include "ns3/simple-net-device-helper.h"
 #include "ns3/socket-factory.h"
 #include "ns3/udp-socket-factory.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "ns3/random-variable-stream.h"
 
 using namespace ns3;
 
@@ -179,6 +182,145 @@ Ipv4StaticRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * Compares the routes found by Ipv4StaticRouting with a scan of its
+ * routing table, while routes are added and removed at random.
+ */
+class Ipv4StaticRoutingLongestPrefixTestCase : public TestCase
+{
+public:
+  Ipv4StaticRoutingLongestPrefixTestCase ();
+
+private:
+  virtual void DoRun (void);
+  int32_t ReferenceLookup (Ptr<Ipv4StaticRouting> routing, Ptr<Ipv4> ipv4,
+                           Ipv4Address dest, Ptr<NetDevice> oif);
+  Ipv4Address RandomAddress (void);
+
+  Ptr<UniformRandomVariable> m_random;
+};
+
+Ipv4StaticRoutingLongestPrefixTestCase::Ipv4StaticRoutingLongestPrefixTestCase ()
+  : TestCase ("Longest prefix match of static routes")
+{
+}
+
+// the route chosen by the former scan of the routes: the longest
+// prefix, then the smallest metric, then the last route.
+int32_t
+Ipv4StaticRoutingLongestPrefixTestCase::ReferenceLookup (Ptr<Ipv4StaticRouting> routing, Ptr<Ipv4> ipv4,
+                                                         Ipv4Address dest, Ptr<NetDevice> oif)
+{
+  int32_t found = -1;
+  uint16_t longest_mask = 0;
+  uint32_t shortest_metric = 0xffffffff;
+  for (uint32_t i = 0; i < routing->GetNRoutes (); i++)
+    {
+      Ipv4RoutingTableEntry route = routing->GetRoute (i);
+      uint32_t metric = routing->GetMetric (i);
+      Ipv4Mask mask = route.GetDestNetworkMask ();
+      uint16_t masklen = mask.GetPrefixLength ();
+      if (!mask.IsMatch (dest, route.GetDestNetwork ()))
+        {
+          continue;
+        }
+      if (oif != 0 && oif != ipv4->GetNetDevice (route.GetInterface ()))
+        {
+          continue;
+        }
+      if (masklen < longest_mask)
+        {
+          continue;
+        }
+      if (masklen > longest_mask)
+        {
+          shortest_metric = 0xffffffff;
+        }
+      longest_mask = masklen;
+      if (metric > shortest_metric)
+        {
+          continue;
+        }
+      shortest_metric = metric;
+      found = i;
+    }
+  return found;
+}
+
+Ipv4Address
+Ipv4StaticRoutingLongestPrefixTestCase::RandomAddress (void)
+{
+  // a few networks, so that the prefixes nest and collide often
+  static const uint32_t bases[] = { 0x0a000000, 0x0a010000, 0x0a010200, 0xac100000 };
+  return Ipv4Address (bases[m_random->GetInteger (0, 3)] | m_random->GetInteger (0, 0x3ff));
+}
+
+void
+Ipv4StaticRoutingLongestPrefixTestCase::DoRun (void)
+{
+  m_random = CreateObject<UniformRandomVariable> ();
+  m_random->SetStream (1);
+
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  std::vector<Ptr<NetDevice> > devices;
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      node->AddDevice (device);
+      int32_t ifIndex = ipv4->AddInterface (device);
+      ipv4->AddAddress (ifIndex, Ipv4InterfaceAddress (Ipv4Address (0xc0a80001 + (i << 8)), Ipv4Mask ("/24")));
+      ipv4->SetUp (ifIndex);
+      devices.push_back (device);
+    }
+
+  Ptr<Ipv4StaticRouting> routing = CreateObject<Ipv4StaticRouting> ();
+  routing->SetIpv4 (ipv4);
+  uint32_t gateway = 0x0b000000;
+  for (uint32_t step = 0; step < 600; step++)
+    {
+      if (m_random->GetInteger (0, 2) != 0 || routing->GetNRoutes () == 0)
+        {
+          // each route has its own gateway, to tell the routes apart
+          uint32_t length = m_random->GetInteger (0, 3) == 0 ? m_random->GetInteger (0, 32) : m_random->GetInteger (8, 26);
+          routing->AddNetworkRouteTo (RandomAddress (), Ipv4Mask (length == 0 ? 0 : 0xffffffff << (32 - length)),
+                                      Ipv4Address (gateway++), m_random->GetInteger (1, 3),
+                                      m_random->GetInteger (0, 2));
+        }
+      else
+        {
+          routing->RemoveRoute (m_random->GetInteger (0, routing->GetNRoutes () - 1));
+        }
+
+      for (uint32_t lookup = 0; lookup < 4; lookup++)
+        {
+          Ipv4Header header;
+          header.SetDestination (RandomAddress ());
+          Ptr<NetDevice> oif = 0;
+          if (m_random->GetInteger (0, 1))
+            {
+              oif = devices[m_random->GetInteger (0, 2)];
+            }
+          Socket::SocketErrno sockerr;
+          Ptr<Ipv4Route> found = routing->RouteOutput (0, header, oif, sockerr);
+          int32_t expected = ReferenceLookup (routing, ipv4, header.GetDestination (), oif);
+          NS_TEST_ASSERT_MSG_EQ ((found != 0), (expected >= 0), "No route to " << header.GetDestination () << " at step " << step);
+          if (expected >= 0)
+            {
+              Ipv4RoutingTableEntry route = routing->GetRoute (expected);
+              NS_TEST_ASSERT_MSG_EQ (found->GetGateway (), route.GetGateway (), "Wrong route to " << header.GetDestination () << " at step " << step);
+              NS_TEST_ASSERT_MSG_EQ (found->GetDestination (), route.GetDest (), "Wrong route to " << header.GetDestination () << " at step " << step);
+              NS_TEST_ASSERT_MSG_EQ (found->GetOutputDevice (), ipv4->GetNetDevice (route.GetInterface ()), "Wrong device");
+            }
+        }
+    }
+
+  Simulator::Destroy ();
+}
+
 class Ipv4StaticRoutingTestSuite : public TestSuite
 {
 public:
@@ -189,6 +331,7 @@ Ipv4StaticRoutingTestSuite::Ipv4StaticRoutingTestSuite ()
   : TestSuite ("ipv4-static-routing", UNIT)
 {
   AddTestCase (new Ipv4StaticRoutingSlash32TestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4StaticRoutingLongestPrefixTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -520,9 +520,26 @@ NullMessageSimulatorImpl::Remove (const EventId &id)
 void
 NullMessageSimulatorImpl::Cancel (const EventId &id)
 {
-  if (!IsExpired (id))
+  if (IsExpired (id))
+    {
+      return;
+    }
+  id.PeekEventImpl ()->Cancel ();
+  if (id.GetUid () == 2)
+    {
+      // destroy events are not in the event list.
+      return;
+    }
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  if (m_events->Cancel (event))
     {
-      id.PeekEventImpl ()->Cancel ();
+      // the scheduler dropped the event from the event list: unref it now.
+      event.impl->Unref ();
+      m_unscheduledEvents--;
     }
 }
 
@@ -20,6 +20,10 @@
 #include "buffer.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/multithreaded-simulator-impl.h"
+#endif
 
 NS_LOG_COMPONENT_DEFINE ("Buffer");
 
@@ -77,6 +81,10 @@ uint32_t Buffer::g_recommendedStart = 0;
 #define UNINITIALIZED ((Buffer::FreeList*)0)
 uint32_t Buffer::g_maxSize = 0;
 Buffer::FreeList *Buffer::g_freeList = 0;
+#ifdef HAVE_PTHREAD_H
+/// Protects the free list while the nodes run on several threads.
+static SystemMutex g_freeListMutex;
+#endif
 struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
 
 Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
@@ -100,6 +108,9 @@ Buffer::Recycle (struct Buffer::Data *data)
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
   NS_ASSERT (!IS_UNINITIALIZED (g_freeList));
+#ifdef HAVE_PTHREAD_H
+  ParallelCriticalSection cs (g_freeListMutex);
+#endif
   g_maxSize = std::max (g_maxSize, data->m_size);
   /* feed into free list */
   if (data->m_size < g_maxSize ||
@@ -119,6 +130,9 @@ Buffer::Data *
 Buffer::Create (uint32_t dataSize)
 {
   NS_LOG_FUNCTION (dataSize);
+#ifdef HAVE_PTHREAD_H
+  ParallelCriticalSection cs (g_freeListMutex);
+#endif
   /* try to find a buffer correctly sized. */
   if (IS_UNINITIALIZED (g_freeList))
     {
@@ -19,6 +19,10 @@
  */
 #include "byte-tag-list.h"
 #include "ns3/log.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/multithreaded-simulator-impl.h"
+#endif
 #include <vector>
 #include <cstring>
 
@@ -58,6 +62,9 @@ public:
   ~ByteTagListDataFreeList ();
 } g_freeList; //!< Container for struct ByteTagListData
 static uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
+#ifdef HAVE_PTHREAD_H
+static SystemMutex g_freeListMutex; //!< protects the free list while the nodes run on several threads
+#endif
 
 ByteTagListDataFreeList::~ByteTagListDataFreeList ()
 {
@@ -358,6 +365,9 @@ struct ByteTagListData *
 ByteTagList::Allocate (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
+#ifdef HAVE_PTHREAD_H
+  ParallelCriticalSection cs (g_freeListMutex);
+#endif
   while (!g_freeList.empty ())
     {
       struct ByteTagListData *data = g_freeList.back ();
@@ -388,6 +398,9 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
     {
       return;
     }
+#ifdef HAVE_PTHREAD_H
+  ParallelCriticalSection cs (g_freeListMutex);
+#endif
   g_maxSize = std::max (g_maxSize, data->size);
   data->count--;
   if (data->count == 0)
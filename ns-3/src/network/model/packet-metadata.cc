@@ -22,6 +22,10 @@
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/multithreaded-simulator-impl.h"
+#endif
 #include "packet-metadata.h"
 #include "buffer.h"
 #include "header.h"
@@ -37,6 +41,10 @@ bool PacketMetadata::m_metadataSkipped = false;
 uint32_t PacketMetadata::m_maxSize = 0;
 uint16_t PacketMetadata::m_chunkUid = 0;
 PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+#ifdef HAVE_PTHREAD_H
+/// Protects the free list while the nodes run on several threads.
+static SystemMutex g_freeListMutex;
+#endif
 
 PacketMetadata::DataFreeList::~DataFreeList ()
 {
@@ -571,6 +579,9 @@ struct PacketMetadata::Data *
 PacketMetadata::Create (uint32_t size)
 {
   NS_LOG_FUNCTION (size);
+#ifdef HAVE_PTHREAD_H
+  ParallelCriticalSection cs (g_freeListMutex);
+#endif
   NS_LOG_LOGIC ("create size="<<size<<", max="<<m_maxSize);
   if (size > m_maxSize)
     {
@@ -603,6 +614,9 @@ PacketMetadata::Recycle (struct PacketMetadata::Data *data)
       return;
     } 
   NS_LOG_LOGIC ("recycle size="<<data->m_size<<", list="<<m_freeList.size ());
+#ifdef HAVE_PTHREAD_H
+  ParallelCriticalSection cs (g_freeListMutex);
+#endif
   NS_ASSERT (data->m_count == 0);
   if (m_freeList.size () > 1000 ||
       data->m_size < m_maxSize) 
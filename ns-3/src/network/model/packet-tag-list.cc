@@ -20,7 +20,7 @@
 
 /**
 \file   packet-tag-list.cc
-\brief  Implements a linked list of Packet tags, including copy-on-write semantics.
+\brief  Implements a list of Packet tags stored in shared inline slots, including copy-on-write semantics.
 */
 
 #include "packet-tag-list.h"
@@ -28,261 +28,267 @@
 #include "tag.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
-#include <cstring>
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/multithreaded-simulator-impl.h"
+#endif
+#include <vector>
 
 NS_LOG_COMPONENT_DEFINE ("PacketTagList");
 
 namespace ns3 {
 
-bool
-PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
-{
-  TypeId tid = tag.GetInstanceTypeId ();
-  NS_LOG_FUNCTION (this << tid);
-  NS_LOG_INFO     ("looking for " << tid);
+#ifdef HAVE_PTHREAD_H
+/// Protects the slots while the nodes run on several threads.
+static SystemMutex g_slotsMutex;
+#endif
 
-  // trivial case when list is empty
-  if (m_next == 0)
+uint32_t
+PacketTagList::GetSlot (TypeId tid)
+{
+  // slot number + 1 of each TypeId uid, 0 when not allocated yet
+  static std::vector<uint32_t> slots;
+  static uint32_t nSlots = 0;
+#ifdef HAVE_PTHREAD_H
+  ParallelCriticalSection cs (g_slotsMutex);
+#endif
+  uint16_t uid = tid.GetUid ();
+  if (uid >= slots.size ())
     {
-      return false;
+      slots.resize (uid + 1, 0);
     }
+  if (slots[uid] == 0)
+    {
+      slots[uid] = ++nSlots;
+      NS_LOG_INFO ("slot " << nSlots - 1 << " for " << tid);
+    }
+  return slots[uid] - 1;
+}
 
-  bool found = false;
-
-  struct TagData ** prevNext = &m_next; // previous node's next pointer
-  struct TagData  * cur      =  m_next; // cursor to current node
-  struct TagData  * it = 0;             // utility
-
-  // Search from the head of the list until we find tid or a merge
+void
+PacketTagList::Free (struct TagBlock *block)
+{
+  struct TagData *cur = block->overflow;
   while (cur != 0)
     {
-      if (cur->count > 1)
-        {
-          // found merge
-          NS_LOG_INFO ("found initial merge before tid");
-          break;
-        }
-      else if (cur->tid == tid)
-        {
-          NS_LOG_INFO ("found tid before initial merge, calling writer");
-          found = (this->*Writer)(tag, true, cur, prevNext);
-          break;
-        }
-      else
-        {
-          // no merge or tid found yet, move on
-          prevNext = &cur->next;
-          cur      =  cur->next;
-        }
-    }  // while !found && !cow
+      struct TagData *next = cur->next;
+      delete cur;
+      cur = next;
+    }
+  delete block;
+}
 
-  // did we find it or run out of tags?
-  if (cur == 0 || found)
+struct PacketTagList::TagData *
+PacketTagList::Find (TypeId tid, uint32_t slot) const
+{
+  if (m_block == 0)
     {
-      NS_LOG_INFO ("returning after header with found: " << found);
-      return found;
+      return 0;
     }
-
-  // From here on out, we have to copy the list
-  // until we find tid, then link past it
-
-  // Before we do all that work, let's make sure tid really exists
-  for (it = cur; it != 0; it = it->next)
+  if (slot < INLINE_SLOTS)
     {
-      if (it->tid == tid)
+      if (m_block->used & (1 << slot))
         {
-          break;
+          return &m_block->slots[slot];
         }
+      return 0;
     }
-  if (it == 0)
+  for (struct TagData *cur = m_block->overflow; cur != 0; cur = cur->next)
     {
-      // got to end of list without finding tid
-      NS_LOG_INFO ("tid not found after first merge");
-      return found;
+      if (cur->tid == tid)
+        {
+          return cur;
+        }
     }
+  return 0;
+}
 
-  // At this point cur is a merge, but untested for tid
-  NS_ASSERT (cur != 0);
-  NS_ASSERT (cur->count > 1);
-
-  /*
-     Walk the remainder of the list, copying, until we find tid
-     As we put a copy of the cur node onto our list,
-     we move the merge point down the list.
-
-     Starting position                  End position
-       T1 is a merge                     T1.count decremented
-                                         T2 is a merge
-                                         T1' is a copy of T1
-
-          other                             other
-               \                                 \
-      Prev  ->  T1  ->  T2  -> ...                T1  ->  T2  -> ...
-           /   /                                         /|
-      pNext cur                         Prev  ->  T1' --/ |
-                                                     /    |
-                                                pNext   cur
-
-     When we reach tid, we link past it, decrement count, and we're done.
-  */
-
-  // Should normally check for null cur pointer,
-  // but since we know tid exists, we'll skip this test
-  while ( /* cur && */ cur->tid != tid)
+PacketTagList
+PacketTagList::CopyUnshared (void) const
+{
+  PacketTagList copy (*this);
+  if (copy.m_block != 0)
     {
-      NS_ASSERT (cur != 0);
-      NS_ASSERT (cur->count > 1);
-      cur->count--;                       // unmerge cur
-      struct TagData * copy = new struct TagData ();
-      copy->tid = cur->tid;
-      copy->count = 1;
-      memcpy (copy->data, cur->data, TagData::MAX_SIZE);
-      copy->next = cur->next;             // merge into tail
-      copy->next->count++;                // mark new merge
-      *prevNext = copy;                   // point prior list at copy
-      prevNext = &copy->next;             // advance
-      cur      =  copy->next;
+      copy.Unshare ();
     }
-  // Sanity check:
-  NS_ASSERT (cur != 0);                 // cur should be non-zero
-  NS_ASSERT (cur->tid == tid);          // cur->tid should be tid
-  NS_ASSERT (cur->count > 1);           // cur should be a merge
-
-  // link around tid, removing it from our list
-  found = (this->*Writer)(tag, false, cur, prevNext);
-  return found;
+  return copy;
+}
 
+void
+PacketTagList::Unshare (void)
+{
+  if (m_block != 0 && m_block->count == 1)
+    {
+      return;
+    }
+  struct TagBlock *block = new struct TagBlock ();
+  block->overflow = 0;
+  block->head = 0;
+  block->count = 1;
+  block->used = 0;
+  if (m_block != 0)
+    {
+      NS_LOG_INFO ("copying shared block");
+      block->used = m_block->used;
+      for (uint32_t slot = 0; slot < INLINE_SLOTS; ++slot)
+        {
+          if (block->used & (1 << slot))
+            {
+              block->slots[slot] = m_block->slots[slot];
+            }
+        }
+      struct TagData ** prevNext = &block->overflow;
+      for (struct TagData *cur = m_block->overflow; cur != 0; cur = cur->next)
+        {
+          struct TagData * copy = new struct TagData (*cur);
+          *prevNext = copy;
+          prevNext = &copy->next;
+        }
+      *prevNext = 0;
+      m_block->count--;
+    }
+  m_block = block;
+  Relink ();
 }
 
-bool
-PacketTagList::Remove (Tag & tag)
+void
+PacketTagList::Relink (void)
 {
-  return COWTraverse (tag, &PacketTagList::RemoveWriter);
+  struct TagData ** prevNext = &m_block->head;
+  for (uint32_t slot = 0; slot < INLINE_SLOTS; ++slot)
+    {
+      if (m_block->used & (1 << slot))
+        {
+          *prevNext = &m_block->slots[slot];
+          prevNext = &m_block->slots[slot].next;
+        }
+    }
+  *prevNext = m_block->overflow;
 }
 
-// COWWriter implementing Remove
 bool
-PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
-                             struct PacketTagList::TagData  * cur,
-                             struct PacketTagList::TagData ** prevNext)
+PacketTagList::Remove (Tag & tag)
 {
-  NS_LOG_FUNCTION_NOARGS ();
-
-  // found tid
-  bool found = true;
+  TypeId tid = tag.GetInstanceTypeId ();
+  NS_LOG_FUNCTION (this << tid);
+  uint32_t slot = GetSlot (tid);
+  struct TagData *cur = Find (tid, slot);
+  if (cur == 0)
+    {
+      return false;
+    }
   tag.Deserialize (TagBuffer (cur->data,
                               cur->data + TagData::MAX_SIZE));
-  *prevNext = cur->next;            // link around cur
 
-  if (preMerge)
+  bool last;
+  if (slot < INLINE_SLOTS)
     {
-      // found tid before first merge, so delete cur
-      delete cur;
+      last = m_block->used == (1 << slot) && m_block->overflow == 0;
+    }
+  else
+    {
+      last = m_block->used == 0 && m_block->overflow->next == 0;
+    }
+  if (last)
+    {
+      // last tag of the list, no need to copy the block to remove it
+      RemoveAll ();
+      return true;
+    }
+
+  Unshare ();
+  if (slot < INLINE_SLOTS)
+    {
+      m_block->used &= ~(1 << slot);
     }
   else
     {
-      // cur is always a merge at this point
-      // unmerge cur, since we linked around it already
-      cur->count--;
-      if (cur->next != 0)
+      struct TagData ** prevNext = &m_block->overflow;
+      while ((*prevNext)->tid != tid)
         {
-          // there's a next, so make it a merge
-          cur->next->count++;
+          prevNext = &(*prevNext)->next;
         }
+      cur = *prevNext;
+      *prevNext = cur->next;            // link around cur
+      delete cur;
     }
-  return found;
+  Relink ();
+  return true;
 }
 
 bool
 PacketTagList::Replace (Tag & tag)
 {
-  bool found = COWTraverse (tag, &PacketTagList::ReplaceWriter);
-  if (!found)
+  TypeId tid = tag.GetInstanceTypeId ();
+  NS_LOG_FUNCTION (this << tid);
+  uint32_t slot = GetSlot (tid);
+  if (Find (tid, slot) == 0)
     {
       Add (tag);
+      return false;
     }
-  return found;
+  Unshare ();
+  struct TagData *cur = Find (tid, slot);
+  NS_ASSERT (tag.GetSerializedSize () <= TagData::MAX_SIZE);
+  tag.Serialize (TagBuffer (cur->data,
+                            cur->data + tag.GetSerializedSize ()));
+  return true;
 }
 
-// COWWriter implementing Replace
-bool
-PacketTagList::ReplaceWriter (Tag & tag, bool preMerge,
-                              struct PacketTagList::TagData  * cur,
-                              struct PacketTagList::TagData ** prevNext)
+void 
+PacketTagList::Add (const Tag &tag) const
 {
-  NS_LOG_FUNCTION_NOARGS ();
+  TypeId tid = tag.GetInstanceTypeId ();
+  NS_LOG_FUNCTION (this << tid);
+  uint32_t slot = GetSlot (tid);
+  // ensure this id was not yet added
+  NS_ASSERT (Find (tid, slot) == 0);
+  NS_ASSERT (tag.GetSerializedSize () <= TagData::MAX_SIZE);
 
-  // found tid
-  bool found = true;
-  if (preMerge)
+  PacketTagList *self = const_cast<PacketTagList *> (this);
+  self->Unshare ();
+  struct TagData *head;
+  if (slot < INLINE_SLOTS)
     {
-      // found tid before first merge, so just rewrite
-      tag.Serialize (TagBuffer (cur->data,
-                                cur->data + tag.GetSerializedSize ()));
+      head = &m_block->slots[slot];
+      m_block->used |= 1 << slot;
     }
   else
     {
-      // cur is always a merge at this point
-      // need to copy, replace, and link past cur
-      cur->count--;                     // unmerge cur
-      struct TagData * copy = new struct TagData ();
-      copy->tid = tag.GetInstanceTypeId ();
-      copy->count = 1;
-      tag.Serialize (TagBuffer (copy->data,
-                                copy->data + tag.GetSerializedSize ()));
-      copy->next = cur->next;           // merge into tail
-      if (copy->next != 0)
-        {
-          copy->next->count++;          // mark new merge
-        }
-      *prevNext = copy;                 // point prior list at copy
-    }
-  return found;
-}
-
-void 
-PacketTagList::Add (const Tag &tag) const
-{
-  NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
-  // ensure this id was not yet added
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
-    {
-      NS_ASSERT (cur->tid != tag.GetInstanceTypeId ());
+      head = new struct TagData ();
+      head->next = m_block->overflow;
+      m_block->overflow = head;
     }
-  struct TagData * head = new struct TagData ();
   head->count = 1;
-  head->next = 0;
-  head->tid = tag.GetInstanceTypeId ();
-  head->next = m_next;
-  NS_ASSERT (tag.GetSerializedSize () <= TagData::MAX_SIZE);
+  head->tid = tid;
   tag.Serialize (TagBuffer (head->data, head->data + tag.GetSerializedSize ()));
-
-  const_cast<PacketTagList *> (this)->m_next = head;
+  self->Relink ();
 }
 
 bool
 PacketTagList::Peek (Tag &tag) const
 {
-  NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
   TypeId tid = tag.GetInstanceTypeId ();
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
+  NS_LOG_FUNCTION (this << tid);
+  struct TagData *cur = Find (tid, GetSlot (tid));
+  if (cur == 0)
     {
-      if (cur->tid == tid) 
-        {
-          /* found tag */
-          tag.Deserialize (TagBuffer (cur->data, cur->data + TagData::MAX_SIZE));
-          return true;
-        }
+      /* no tag found */
+      return false;
     }
-  /* no tag found */
-  return false;
+  /* found tag */
+  tag.Deserialize (TagBuffer (cur->data, cur->data + TagData::MAX_SIZE));
+  return true;
 }
 
 const struct PacketTagList::TagData *
 PacketTagList::Head (void) const
 {
-  return m_next;
+  if (m_block == 0)
+    {
+      return 0;
+    }
+  return m_block->head;
 }
 
 } /* namespace ns3 */
-
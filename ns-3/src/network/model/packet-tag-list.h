@@ -22,7 +22,7 @@
 
 /**
 \file   packet-tag-list.h
-\brief  Defines a linked list of Packet tags, including copy-on-write semantics.
+\brief  Defines a list of Packet tags stored in shared inline slots, including copy-on-write semantics.
 */
 
 #include <stdint.h>
@@ -43,82 +43,36 @@ class Tag;
  *
  * \internal
  *
- * The implementation of this class is a bit tricky.  Refer to this
- * diagram in the discussion that follows.
+ *   - Tags are stored in serialized form in a TagBlock, which is shared
+ *     by all the copies of a packet.  The block holds a fixed array of
+ *     INLINE_SLOTS \ref TagData, and a heap allocated list of TagData
+ *     for the tags which do not fit in it.
  *
- * \dot
- *    digraph {
- *        rankdir = "LR";
- *        clusterrank = local;
- *        node [ shape = record, fontname="FreeSans", fontsize="10" ];
- *        oth  [ label="<l> Other branch | <n> next | <c> ..." ];
- *        PTL1 [ label="<l> PacketTagList A | <n> m_next" , shape=Mrecord];
- *        PTL2 [ label="<l> PacketTagList B | <n> m_next" , shape=Mrecord];
- *        oth:n  -> T7:l ;
- *        PTL2:n -> T6:l ;
- *        PTL1:n -> T5:l ;
- *        T1   [ label="<l> T1  | <n> next | <c> count = 1" ];
- *        T2   [ label="<l> T2  | <n> next | <c> count = 1" ];
- *        T3   [ label="<l> T3  | <n> next | <c> count = 2" ];
- *        T4   [ label="<l> T4  | <n> next | <c> count = 1" ];
- *        T5   [ label="<l> T5  | <n> next | <c> count = 2" ];
- *        T6   [ label="<l> T6  | <n> next | <c> count = 1" ];
- *        T7   [ label="<l> T7  | <n> next | <c> count = 1" ];
- *        NULL [ label="0", shape = ellipse ];
- *        subgraph cluster_list {
- *          penwidth = 0;
- *          T6:n -> T5:l ;
- *          T5:n -> T4:l ;
- *          T4:n -> T3:l ;
- *          T7:n -> T3:l ;
- *          T3:n -> T2:l ;
- *          T2:n -> T1:l ;
- *          T1:n -> NULL ;
- *        };
- *      };
- * \enddot
+ *   - Each tag TypeId is given a dense slot number the first time a tag
+ *     of this type is added to a packet.  A tag with a slot number below
+ *     INLINE_SLOTS is stored in that slot of the array, so that #Peek,
+ *     #Remove and #Replace find it without walking the list; a bitmap
+ *     tells which slots are used.  The other tags (only when more than
+ *     INLINE_SLOTS tag types are in use in the simulation) go in the
+ *     overflow list, which is searched linearly.
  *
- *   - Tags are stored in serialized form in a tree of TagData
- *     structures. (<tt>T1-T7</tt> in the diagram)
- *
- *   - Each TagData points (\c next pointers in the diagram)
- *     toward the root of the tree, which is a null pointer.
- *
- *   - \c count is the number of incoming pointers to this
- *     TagData.  Branch points, where branches merge or join, have
- *     <tt>count \> 1</tt> (\c T3, \c T5); successive links along
- *     a branch have <tt>count = 1</tt> (\c T1, \c T2, \c T4, \c T6, \c T7).
- *
- *   - Each PacketTagList points to a specific TagData,
- *     which is the most recent Tag added to the packet. (<tt>T5-T7</tt>)
- *
- *   - Conceptually, therefore, each Packet has a PacketTagList which
- *     points to a singly-linked list of TagData.
+ *   - The used slots and the overflow list are chained by their \c next
+ *     pointers, in slot order then overflow order, so that #Head
+ *     returns a singly-linked list of TagData to iterate over.
  *
  * \par <b> Copy-on-write </b> is implemented as follows:
  *
- *   - #Add prepends the new tag to the list (growing that branch of the tree,
- *     as \c T6). This is a constant time operation, and does not affect
- *     any other #PacketTagList's, hence this is a \c const function.
- *
  *   - Copy constructor (PacketTagList(const PacketTagList & o))
- *     and assignment (#operator=(const PacketTagList & o)
- *     simply join the tree at the same place as the original
- *     PacketTagList \c o, incrementing the \c count.
- *     For assignment, the old branch is deleted, up to
- *     the first branch point, which has its \c count decremented.
- *     (PacketTagList \c B started as a copy of PacketTagList \c A,
- *     before \c T6 was added to \c B).
+ *     and assignment (#operator=(const PacketTagList & o)) simply point
+ *     to the same TagBlock as \c o, incrementing its \c count: copying a
+ *     packet never allocates.
+ *
+ *   - #Peek never modifies the block.
  *
- *   - #Remove and #Replace are a little tricky, depending on where the
- *     target tag is found relative to the first branch point:
- *     - \e Target before <em> the first branch point: </em> \n
- *       The target is just dealt with in place (linked around and deleted,
- *       in the case of #Remove; rewritten in the case of #Replace).
- *     - \e Target at or after <em> the first branch point: </em> \n
- *       The portion of the list between the first branch and the target is
- *       shared. This portion is copied before the #Remove or #Replace is
- *       performed.
+ *   - #Add, #Remove and #Replace first copy the block if it is shared
+ *     with another PacketTagList (one allocation, plus one per overflow
+ *     tag), then modify it in place.  #Remove and #Replace of a missing
+ *     tag do not copy anything.
  *
  * \par <b> Memory Management: </b>
  * \n
@@ -130,7 +84,7 @@ class PacketTagList
 {
 public:
   /**
-   * Tree node for sharing serialized tags.
+   * Serialized tag, in an inline slot or in the overflow list.
    *
    * See PacketTagList for a discussion of the data structure.
    *
@@ -164,9 +118,20 @@ public:
     uint8_t data[MAX_SIZE];   /**< Serialization buffer */
     struct TagData * next;   /**< Pointer to next in list */
     TypeId tid;               /**< Type of the tag serialized into #data */
-    uint32_t count;           /**< Number of incoming links */
+    uint32_t count;           /**< Number of incoming links (always 1) */
   };  /* struct TagData */
 
+  /**
+   * \brief Number of tag types stored in inline slots.
+   *
+   * \internal
+   * Must not exceed the number of bits of TagBlock::used.
+   */
+  enum
+  {
+    INLINE_SLOTS = 8
+  };
+
   /**
    * Create a new PacketTagList.
    */
@@ -176,8 +141,8 @@ public:
    *
    * \param [in] o The PacketTagList to copy.
    *
-   * This makes a light-weight copy by #RemoveAll, then
-   * pointing to the same \ref TagData as \pname{o}.
+   * This makes a light-weight copy, pointing to the
+   * same TagBlock as \pname{o}.
    */
   inline PacketTagList (PacketTagList const &o);
   /**
@@ -187,24 +152,24 @@ public:
    * \returns the copied object
    *
    * This makes a light-weight copy by #RemoveAll, then
-   * pointing to the same \ref TagData as \pname{o}.
+   * pointing to the same TagBlock as \pname{o}.
    */
   inline PacketTagList &operator = (PacketTagList const &o);
   /**
    * Destructor
    *
-   * #RemoveAll's the tags up to the first merge.
+   * #RemoveAll's the tags.
    */
   inline ~PacketTagList ();
 
   /**
-   * Add a tag to the head of this branch.
+   * Add a tag to this list.
    *
    * \param [in] tag The tag to add
    */
   void Add (Tag const&tag) const;
   /**
-   * Remove (the first instance of) tag from the list.
+   * Remove tag from the list.
    *
    * \param [in,out] tag The tag type to remove.  If found,
    *          \pname{tag} is set to the value of the tag found.
@@ -230,67 +195,66 @@ public:
    */
   bool Peek (Tag &tag) const;
   /**
-   * Remove all tags from this list (up to the first merge).
+   * Remove all tags from this list.
+   *
+   * The TagBlock is released, and freed if no other list shares it.
    */
   inline void RemoveAll (void);
   /**
    * \returns pointer to head of tag list
    */
   const struct PacketTagList::TagData *Head (void) const;
+  /**
+   * \returns a copy of this list which owns its TagBlock, where the
+   * copy constructor shares it.
+   */
+  PacketTagList CopyUnshared (void) const;
 
 private:
   /**
-   * Typedef of method function pointer for copy-on-write operations
-   *
-   * \param [in] tag The tag type to operate on.
-   * \param [in] preMerge True if \pname{tag} was found before the first merge,
-   *             false otherwise.
-   * \param [in] cur Pointer to the tag.
-   * \param [in] prevNext Pointer to the struct TagData.next pointer
-   *          pointing to \pname{cur}.
-   * \returns True if operation successful, false otherwise
+   * The tags of a list, shared by its copies.
    */
-  typedef bool (PacketTagList::*COWWriter)
-    (Tag       & tag, bool         preMerge,
-    struct TagData * cur, struct TagData ** prevNext);
+  struct TagBlock
+  {
+    TagData slots[INLINE_SLOTS]; /**< Tags, indexed by slot number */
+    TagData *overflow;           /**< Tags with a slot number >= INLINE_SLOTS */
+    TagData *head;               /**< First tag, see #Head */
+    uint32_t count;              /**< Number of PacketTagList sharing this block */
+    uint8_t used;                /**< Bitmap of the used #slots */
+  };
+
   /**
-   * Traverse the list implementing copy-on-write, using \pname{Writer}.
-   *
-   * \param [in] tag The tag type to operate on.
-   * \param [in] Writer The copy-on-write function to use.
-   * \returns True if \pname{tag} found, false otherwise.
+   * \param [in] tid The tag type.
+   * \returns The slot number of \pname{tid}, allocated at the first call.
    */
-  bool COWTraverse   (Tag & tag, PacketTagList::COWWriter Writer);
+  static uint32_t GetSlot (TypeId tid);
   /**
-   * Copy-on-write implementing Remove.
+   * Free a block and its overflow list.
    *
-   * \param [in] tag The target tag type to remove.
-   * \param [in] preMerge True if \pname{tag} was found before the first merge,
-   *             false otherwise.
-   * \param [in] cur Pointer to the tag.
-   * \param [in] prevNext Pointer to the struct TagData.next pointer
-   *          pointing to \pname{cur}.
-   * \returns True, since tag will definitely be removed.
+   * \param [in] block The block to free.
    */
-  bool RemoveWriter  (Tag       & tag, bool         preMerge,
-                      struct TagData * cur, struct TagData ** prevNext);
+  static void Free (struct TagBlock *block);
   /**
-   * Copy-on-write implementing Replace
+   * Find a tag in the block.
    *
-   * \param [in] tag The target tag type to replace
-   * \param [in] preMerge True if \pname{tag} was found before the first merge,
-   *          false otherwise.
-   * \param [in] cur Pointer to the tag
-   * \param [in] prevNext Pointer to the struct TagData.next pointer
-   *          pointing to \pname{cur}.
-   * \returns True, since tag value will definitely be replaced.
+   * \param [in] tid The tag type.
+   * \param [in] slot The slot number of \pname{tid}.
+   * \returns The tag, or 0 if not found.
+   */
+  struct TagData *Find (TypeId tid, uint32_t slot) const;
+  /**
+   * Make sure the block exists and is not shared, copying it if needed.
+   */
+  void Unshare (void);
+  /**
+   * Chain the used slots and the overflow list, starting at \c head.
    */
-  bool ReplaceWriter (Tag & tag, bool preMerge, struct TagData * cur, struct TagData ** prevNext);
+  void Relink (void);
 
   /**
-   * Pointer to first \ref TagData on the list
+   * Pointer to the TagBlock, 0 if the list is empty.
    */
-  struct TagData *m_next;
+  struct TagBlock *m_block;
 };
 
 } // namespace ns3
@@ -302,16 +266,16 @@ private:
 namespace ns3 {
 
 PacketTagList::PacketTagList ()
-  : m_next ()
+  : m_block (0)
 {
 }
 
 PacketTagList::PacketTagList (PacketTagList const &o)
-  : m_next (o.m_next)
+  : m_block (o.m_block)
 {
-  if (m_next != 0)
+  if (m_block != 0)
     {
-      m_next->count++;
+      m_block->count++;
     }
 }
 
@@ -319,15 +283,15 @@ PacketTagList &
 PacketTagList::operator = (PacketTagList const &o)
 {
   // self assignment
-  if (m_next == o.m_next) 
+  if (m_block == o.m_block) 
     {
       return *this;
     }
   RemoveAll ();
-  m_next = o.m_next;
-  if (m_next != 0) 
+  m_block = o.m_block;
+  if (m_block != 0) 
     {
-      m_next->count++;
+      m_block->count++;
     }
   return *this;
 }
@@ -340,25 +304,15 @@ PacketTagList::~PacketTagList ()
 void
 PacketTagList::RemoveAll (void)
 {
-  struct TagData *prev = 0;
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
+  if (m_block != 0)
     {
-      cur->count--;
-      if (cur->count > 0) 
+      m_block->count--;
+      if (m_block->count == 0)
         {
-          break;
+          Free (m_block);
         }
-      if (prev != 0) 
-        {
-	  delete prev;
-        }
-      prev = cur;
-    }
-  if (prev != 0) 
-    {
-      delete prev;
+      m_block = 0;
     }
-  m_next = 0;
 }
 
 } // namespace ns3
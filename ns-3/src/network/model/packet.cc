@@ -21,6 +21,10 @@
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/multithreaded-simulator-impl.h"
+#endif
 #include <string>
 #include <cstdarg>
 
@@ -29,6 +33,10 @@ NS_LOG_COMPONENT_DEFINE ("Packet");
 namespace ns3 {
 
 uint32_t Packet::m_globalUid = 0;
+#ifdef HAVE_PTHREAD_H
+/// Protects the uid counter while the nodes run on several threads.
+static SystemMutex g_globalUidMutex;
+#endif
 
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
@@ -127,6 +135,47 @@ Packet::Copy (void) const
   return Ptr<Packet> (new Packet (*this), false);
 }
 
+Ptr<Packet>
+Packet::CopyUnshared (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Buffer buffer;
+  buffer.AddAtStart (m_buffer.GetSize ());
+  buffer.Begin ().Write (m_buffer.Begin (), m_buffer.End ());
+  // the byte tags are stored with the offsets of the buffer.
+  ByteTagList byteTagList;
+  int32_t adjustment = buffer.GetCurrentStartOffset () - m_buffer.GetCurrentStartOffset ();
+  ByteTagList::Iterator i = m_byteTagList.Begin (m_buffer.GetCurrentStartOffset (), m_buffer.GetCurrentEndOffset ());
+  while (i.HasNext ())
+    {
+      ByteTagList::Iterator::Item item = i.Next ();
+      TagBuffer tag = byteTagList.Add (item.tid, item.size, item.start + adjustment, item.end + adjustment);
+      tag.CopyFrom (item.buf);
+    }
+  uint32_t size = m_metadata.GetSerializedSize ();
+  uint8_t *serialized = new uint8_t [size];
+  m_metadata.Serialize (serialized, size);
+  PacketMetadata metadata (m_metadata.GetUid (), 0);
+  // like in Deserialize, the size counts the length field of Serialize.
+  metadata.Deserialize (serialized, size + 4);
+  delete [] serialized;
+  Ptr<Packet> copy = Ptr<Packet> (new Packet (buffer, byteTagList, m_packetTagList.CopyUnshared (), metadata), false);
+  if (m_nixVector != 0)
+    {
+      copy->SetNixVector (m_nixVector->Copy ());
+    }
+  return copy;
+}
+
+uint32_t
+Packet::AllocateUid (void)
+{
+#ifdef HAVE_PTHREAD_H
+  ParallelCriticalSection cs (g_globalUidMutex);
+#endif
+  return m_globalUid++;
+}
+
 Packet::Packet ()
   : m_buffer (),
     m_byteTagList (),
@@ -137,10 +186,9 @@ Packet::Packet ()
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, 0),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | AllocateUid (), 0),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 
 Packet::Packet (const Packet &o)
@@ -179,10 +227,9 @@ Packet::Packet (uint32_t size)
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | AllocateUid (), size),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 Packet::Packet (uint8_t const *buffer, uint32_t size, bool magic)
   : m_buffer (0, false),
@@ -205,10 +252,9 @@ Packet::Packet (uint8_t const*buffer, uint32_t size)
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | AllocateUid (), size),
     m_nixVector (0)
 {
-  m_globalUid++;
   m_buffer.AddAtStart (size);
   Buffer::Iterator i = m_buffer.Begin ();
   i.Write (buffer, size);
@@ -224,11 +270,10 @@ Packet::Packet (const std::string &buffer)
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, buffer.size ()),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | AllocateUid (), buffer.size ()),
     m_nixVector (0)
 {
   NS_LOG_FUNCTION (this << &buffer);
-  m_globalUid++;
   m_buffer.AddAtStart (buffer.size ());
   Buffer::Iterator i = m_buffer.Begin ();
   i.Write (reinterpret_cast<const uint8_t*> (&buffer[0]), buffer.size ());
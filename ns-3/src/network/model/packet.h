@@ -448,6 +448,16 @@ public:
    */
   Ptr<Packet> Copy (void) const;
 
+  /**
+   * \brief performs a deep copy of the packet.
+   *
+   * \returns a copy of the packet which shares no data with the
+   * original packet, unlike Copy. The copy can thus be handed over to
+   * the thread of another partition of a MultithreadedSimulatorImpl:
+   * the reference counts of the shared data are not atomic.
+   */
+  Ptr<Packet> CopyUnshared (void) const;
+
   /**
    * \brief Returns the packet's Uid.
    *
@@ -683,6 +693,10 @@ private:
           const PacketTagList &packetTagList, const PacketMetadata &metadata);
 
   uint32_t Deserialize (uint8_t const*buffer, uint32_t size);
+  /**
+   * \returns a new uid, unique in the partition of the simulator
+   */
+  static uint32_t AllocateUid (void);
 
   Buffer m_buffer;                //!< the packet buffer (it's actual contents)
   ByteTagList m_byteTagList;      //!< the ByteTag list
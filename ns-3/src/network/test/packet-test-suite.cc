@@ -27,6 +27,8 @@
 #include <iostream>
 #include <iomanip>
 #include <ctime>
+#include <algorithm>
+#include <vector>
 
 using namespace ns3;
 
@@ -334,6 +336,28 @@ PacketTest::DoRun (void)
          E (1, 10, 100), E (2, 10, 100), E (4, 10, 100),
          E (1, 100, 1000), E (2, 100, 1000), E (5, 100, 1000));
 
+  {
+    // a deep copy keeps the bytes, the byte tags and the packet tags.
+    Ptr<Packet> tmp = Create<Packet> (100);
+    tmp->AddByteTag (ATestTag<20> ());
+    tmp->AddHeader (ATestHeader<10> ());
+    tmp->AddByteTag (ATestTag<21> ());
+    tmp->AddPacketTag (ATestTag<5> (7));
+    Ptr<Packet> deep = tmp->CopyUnshared ();
+    NS_TEST_EXPECT_MSG_EQ (deep->GetUid (), tmp->GetUid (), "trivial");
+    CHECK (deep, 2, E (20, 10, 110), E (21, 0, 110));
+    ATestTag<5> tag;
+    NS_TEST_EXPECT_MSG_EQ (deep->RemovePacketTag (tag), true, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (tag.GetData (), 7, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (tmp->PeekPacketTag (tag), true, "The packet tags are not shared");
+    ATestHeader<10> h;
+    deep->RemoveHeader (h);
+    NS_TEST_EXPECT_MSG_EQ (h.m_error, false, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (deep->GetSize (), 100, "trivial");
+    CHECK (deep, 2, E (20, 0, 100), E (21, 0, 100));
+    CHECK (tmp, 2, E (20, 10, 110), E (21, 0, 110));
+  }
+
 
   // force caching a buffer of the right size.
   frag0 = Create<Packet> (1000);
@@ -471,6 +495,7 @@ private:
                   ATestTagBase & t,
                   const char * msg = 0);
   int AddRemoveTime (const bool verbose = false);
+  std::vector<TypeId> GetOrder (const PacketTagList & ptl);
 };
 
 PacketTagListTest::PacketTagListTest ()
@@ -573,6 +598,17 @@ PacketTagListTest::AddRemoveTime (const bool verbose /* = false */)
   return delta;
 }
 
+std::vector<TypeId>
+PacketTagListTest::GetOrder (const PacketTagList & ptl)
+{
+  std::vector<TypeId> order;
+  for (const PacketTagList::TagData *cur = ptl.Head (); cur != 0; cur = cur->next)
+    {
+      order.push_back (cur->tid);
+    }
+  return order;
+}
+
 void
 PacketTagListTest::DoRun (void)
 {
@@ -675,6 +711,105 @@ PacketTagListTest::DoRun (void)
     ReplaceCheck (7);
   }
   
+  { // Iteration
+    std::cout << GetName () << "check iteration over each tag" << std::endl;
+    PacketTagList ptl = ref;
+    ptl.Remove (t4);
+    int nRef = 0;
+    for (const PacketTagList::TagData *cur = ref.Head (); cur != 0; cur = cur->next)
+      {
+        ++nRef;
+      }
+    int nPtl = 0;
+    for (const PacketTagList::TagData *cur = ptl.Head (); cur != 0; cur = cur->next)
+      {
+        NS_TEST_EXPECT_MSG_NE (cur->tid, t4.GetInstanceTypeId (), "iterate removed tag");
+        ++nPtl;
+      }
+    NS_TEST_EXPECT_MSG_EQ (nRef, tagLast, "iterate orig");
+    NS_TEST_EXPECT_MSG_EQ (nPtl, tagLast - 1, "iterate copy");
+  }
+
+  { // Overflow
+    std::cout << GetName () << "check more tag types than inline slots"
+              << std::endl;
+    // with the seven tags of ref, 19 types: whatever the slots taken by
+    // the other tests, at least 11 of them are in the overflow list.
+    ATestTag<8> o8 (1);
+    ATestTag<9> o9 (1);
+    ATestTag<10> o10 (1);
+    ATestTag<11> o11 (1);
+    ATestTag<12> o12 (1);
+    ATestTag<13> o13 (1);
+    ATestTag<14> o14 (1);
+    ATestTag<15> o15 (1);
+    ATestTag<16> o16 (1);
+    ATestTag<17> o17 (1);
+    ATestTag<18> o18 (1);
+    ATestTag<19> o19 (1);
+    ATestTagBase * tags[] = { &t1, &t2, &t3, &t4, &t5, &t6, &t7,
+                              &o8, &o9, &o10, &o11, &o12, &o13,
+                              &o14, &o15, &o16, &o17, &o18, &o19 };
+    const uint32_t nTags = sizeof (tags) / sizeof (tags[0]);
+    for (uint32_t i = 0; i < nTags; ++i)
+      {
+        tags[i]->m_data = 1;
+      }
+    PacketTagList big = ref;
+    for (uint32_t i = tagLast; i < nTags; ++i)
+      {
+        big.Add (*tags[i]);
+      }
+    CheckRefList (ref, "overflow add orig");
+    NS_TEST_EXPECT_MSG_EQ (ref.Peek (o8), false, "overflow add orig");
+    std::vector<TypeId> order = GetOrder (big);
+    NS_TEST_ASSERT_MSG_EQ (order.size (), nTags, "iterate overflow");
+    NS_TEST_EXPECT_MSG_GT (order.size (), PacketTagList::INLINE_SLOTS, "no overflow");
+
+    for (uint32_t i = 0; i < nTags; ++i)
+      {
+        PacketTagList copy = big;
+        copy.Remove (*tags[i]);
+        for (uint32_t j = 0; j < nTags; ++j)
+          {
+            CheckRef (big, *tags[j], "overflow remove orig");
+            CheckRef (copy, *tags[j], "overflow remove copy", j == i);
+          }
+        std::vector<TypeId> expected = order;
+        expected.erase (std::find (expected.begin (), expected.end (), tags[i]->GetInstanceTypeId ()));
+        NS_TEST_EXPECT_MSG_EQ ((GetOrder (copy) == expected), true,
+                               "overflow remove copy order " << tags[i]->GetInstanceTypeId ().GetName ());
+        NS_TEST_EXPECT_MSG_EQ ((GetOrder (big) == order), true, "overflow remove orig order");
+      }
+
+    for (uint32_t i = 0; i < nTags; ++i)
+      {
+        PacketTagList copy = big;
+        tags[i]->m_data = 2;
+        copy.Replace (*tags[i]);
+        CheckRef (copy, *tags[i], "overflow replace copy");
+        tags[i]->m_data = 1;
+        for (uint32_t j = 0; j < nTags; ++j)
+          {
+            CheckRef (big, *tags[j], "overflow replace orig");
+          }
+        NS_TEST_EXPECT_MSG_EQ ((GetOrder (copy) == order), true,
+                               "overflow replace copy order " << tags[i]->GetInstanceTypeId ().GetName ());
+      }
+
+    { // the copy of a shared list owns a copy of the overflow list
+      PacketTagList copy = big;
+      copy.Remove (o19);
+      copy.Add (o19);
+      big.Remove (o8);
+      CheckRef (copy, o8, "overflow re-add copy");
+      CheckRef (copy, o19, "overflow re-add copy");
+      CheckRef (big, o8, "overflow re-add orig", true);
+      NS_TEST_EXPECT_MSG_EQ (GetOrder (copy).size (), nTags, "overflow re-add copy");
+      NS_TEST_EXPECT_MSG_EQ (GetOrder (big).size (), nTags - 1, "overflow re-add orig");
+    }
+  }
+
   { // Timing
     std::cout << GetName () << "add+remove timing" << std::endl;
     int flm = std::numeric_limits<int>::max ();
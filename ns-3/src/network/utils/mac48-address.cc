@@ -291,5 +291,19 @@ std::istream& operator>> (std::istream& is, Mac48Address & address)
   return is;
 }
 
+size_t
+Mac48AddressHash::operator() (Mac48Address const &x) const
+{
+  uint8_t buffer[6];
+  x.CopyTo (buffer);
+  // the allocated addresses differ in their last bytes.
+  size_t hash = 0;
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      hash = hash * 257 + buffer[i];
+    }
+  return hash;
+}
+
 
 } // namespace ns3
@@ -178,6 +178,18 @@ RoutingProtocol::GetTypeId (void)
                                     OLSR_WILL_DEFAULT, "default",
                                     OLSR_WILL_HIGH, "high",
                                     OLSR_WILL_ALWAYS, "always"))
+    .AddAttribute ("IncrementalRouting",
+                   "Repair only the routes and the MPR set affected by the changes of the "
+                   "neighbor, 2-hop neighbor and topology sets, instead of computing them from scratch.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&RoutingProtocol::m_incrementalRouting),
+                   MakeBooleanChecker ())
+    .AddAttribute ("CheckIncrementalRouting",
+                   "Compute the routing table from scratch after each incremental update, "
+                   "and abort the simulation if they differ.  For debugging.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RoutingProtocol::m_checkIncrementalRouting),
+                   MakeBooleanChecker ())
     .AddTraceSource ("Rx", "Receive OLSR packet.",
                      MakeTraceSourceAccessor (&RoutingProtocol::m_rxPacketTrace))
     .AddTraceSource ("Tx", "Send OLSR packet.",
@@ -191,6 +203,8 @@ RoutingProtocol::GetTypeId (void)
 
 RoutingProtocol::RoutingProtocol ()
   : m_routingTableAssociation (0),
+    m_incrementalRouting (true),
+    m_checkIncrementalRouting (false),
     m_ipv4 (0),
     m_helloTimer (Timer::CANCEL_ON_DESTROY),
     m_tcTimer (Timer::CANCEL_ON_DESTROY),
@@ -235,6 +249,8 @@ void RoutingProtocol::DoDispose ()
   m_ipv4 = 0;
   m_hnaRoutingTable = 0;
   m_routingTableAssociation = 0;
+  m_shortestPathTree.Clear ();
+  m_neighborRoutes.clear ();
 
   for (std::map< Ptr<Socket>, Ipv4InterfaceAddress >::iterator iter = m_socketAddresses.begin ();
        iter != m_socketAddresses.end (); iter++)
@@ -569,6 +585,17 @@ RoutingProtocol::MprComputation ()
 {
   NS_LOG_FUNCTION (this);
 
+  // The MPR set only depends on the Neighbor Set and the 2-hop Neighbor Set
+  if (m_incrementalRouting
+      && m_mprNeighbors == m_state.GetNeighbors ()
+      && m_mprTwoHopNeighbors == m_state.GetTwoHopNeighbors ())
+    {
+      NS_LOG_LOGIC ("Neighborhood unchanged, keeping the MPR set.");
+      return;
+    }
+  m_mprNeighbors = m_state.GetNeighbors ();
+  m_mprTwoHopNeighbors = m_state.GetTwoHopNeighbors ();
+
   // MPR computation should be done for each interface. See section 8.3.1
   // (RFC 3626) for details.
   MprSet mprSet;
@@ -878,9 +905,49 @@ RoutingProtocol::RoutingTableComputation ()
   NS_LOG_DEBUG (Simulator::Now ().GetSeconds () << " s: Node " << m_mainAddress
                                                 << ": RoutingTableComputation begin...");
 
+  if (m_incrementalRouting)
+    {
+      UpdateRoutingTable ();
+      if (m_checkIncrementalRouting && !CheckRoutingTable ())
+        {
+          NS_FATAL_ERROR ("Node " << m_mainAddress << ": the incrementally updated routing "
+                          "table differs from the one computed from scratch");
+        }
+    }
+  else
+    {
+      ComputeRoutingTable ();
+      m_shortestPathTree.Invalidate ();
+      m_neighborRoutes.clear ();
+    }
+
+  ComputeHnaRoutes ();
+
+  NS_LOG_DEBUG ("Node " << m_mainAddress << ": RoutingTableComputation end.");
+  m_routingTableChanged (GetSize ());
+}
+
+///
+/// \brief Computes the routing table, except the HNA routes, from scratch.
+///
+void
+RoutingProtocol::ComputeRoutingTable ()
+{
   // 1. All the entries from the routing table are removed.
   Clear ();
 
+  ComputeNeighborRoutes ();
+  ComputeTopologyRoutes ();
+  ComputeIfaceAssocRoutes ();
+}
+
+///
+/// \brief Adds the routes to the neighbors and 2-hop neighbors to the
+/// routing table (steps 2 and 3 of \RFC{3626} section 10).
+///
+void
+RoutingProtocol::ComputeNeighborRoutes ()
+{
   // 2. The new routing entries are added starting with the
   // symmetric neighbors (h=1) as the destination nodes.
   const NeighborSet &neighborSet = m_state.GetNeighbors ();
@@ -1022,7 +1089,15 @@ RoutingProtocol::RoutingTableComputation ()
                         << " not found in the routing table)");
         }
     }
+}
 
+///
+/// \brief Adds the routes to the nodes of the Topology Set, beyond the 2-hop
+/// neighbors, to the routing table (step 3 of \RFC{3626} section 10).
+///
+void
+RoutingProtocol::ComputeTopologyRoutes ()
+{
   for (uint32_t h = 2;; h++)
     {
       bool added = false;
@@ -1075,6 +1150,16 @@ RoutingProtocol::RoutingTableComputation ()
       if (!added)
         break;
     }
+}
+
+///
+/// \brief Adds the routes to the other interfaces of multiple interface
+/// nodes to the routing table (step 4 of \RFC{3626} section 10).
+///
+void
+RoutingProtocol::ComputeIfaceAssocRoutes ()
+{
+  m_ifaceAssocRoutes.clear ();
 
   // 4. For each entry in the multiple interface association base
   // where there exists a routing entry such that:
@@ -1101,9 +1186,17 @@ RoutingProtocol::RoutingTableComputation ()
                     entry1.nextAddr,
                     entry1.interface,
                     entry1.distance);
+          m_ifaceAssocRoutes.push_back (tuple.ifaceAddr);
         }
     }
+}
 
+///
+/// \brief Computes the HNA routing table (step 5 of \RFC{3626} section 10).
+///
+void
+RoutingProtocol::ComputeHnaRoutes ()
+{
   // 5. For each tuple in the association set,
   //    If there is no entry in the routing table with:
   //        R_dest_addr     == A_network_addr/A_netmask
@@ -1181,9 +1274,112 @@ RoutingProtocol::RoutingTableComputation ()
 
         }
     }
+}
 
-  NS_LOG_DEBUG ("Node " << m_mainAddress << ": RoutingTableComputation end.");
-  m_routingTableChanged (GetSize ());
+///
+/// \brief Updates the routing table, except the HNA routes, after the
+/// changes of the state.
+///
+/// The routes to the neighbors and 2-hop neighbors only depend on the
+/// Link, Neighbor and 2-hop Neighbor Sets, so they are computed again and
+/// compared with the previous ones.  The routes of the Topology Set are then
+/// repaired from the changes of these routes and of the Topology Set, and the
+/// routes to the interfaces of multiple interface nodes are added again.
+///
+void
+RoutingProtocol::UpdateRoutingTable ()
+{
+  std::map<Ipv4Address, RoutingTableEntry> neighborRoutes;
+  m_table.swap (neighborRoutes);
+  ComputeNeighborRoutes ();
+  m_table.swap (neighborRoutes);
+
+  if (!m_shortestPathTree.IsValid ())
+    {
+      Clear ();
+      m_neighborRoutes.clear ();
+      m_ifaceAssocRoutes.clear ();
+    }
+  for (std::vector<Ipv4Address>::const_iterator it = m_ifaceAssocRoutes.begin ();
+       it != m_ifaceAssocRoutes.end (); it++)
+    {
+      RemoveEntry (*it);
+    }
+
+  std::map<Ipv4Address, RoutingTableEntry>::const_iterator oldRoute = m_neighborRoutes.begin ();
+  std::map<Ipv4Address, RoutingTableEntry>::const_iterator newRoute = neighborRoutes.begin ();
+  while (oldRoute != m_neighborRoutes.end () || newRoute != neighborRoutes.end ())
+    {
+      if (newRoute == neighborRoutes.end ()
+          || (oldRoute != m_neighborRoutes.end () && oldRoute->first < newRoute->first))
+        {
+          m_shortestPathTree.RemoveRoot (oldRoute->first);
+          oldRoute++;
+          continue;
+        }
+      if (oldRoute != m_neighborRoutes.end () && oldRoute->first == newRoute->first)
+        {
+          oldRoute++;
+        }
+      m_shortestPathTree.SetRoot (newRoute->second);
+      newRoute++;
+    }
+  m_neighborRoutes.swap (neighborRoutes);
+
+  std::vector<Ipv4Address> changed;
+  m_shortestPathTree.Update (changed);
+  NS_LOG_LOGIC (changed.size () << " routes changed");
+  for (std::vector<Ipv4Address>::const_iterator it = changed.begin ();
+       it != changed.end (); it++)
+    {
+      RoutingTableEntry entry;
+      if (m_shortestPathTree.Lookup (*it, entry))
+        {
+          m_table[*it] = entry;
+        }
+      else
+        {
+          RemoveEntry (*it);
+        }
+    }
+
+  ComputeIfaceAssocRoutes ();
+}
+
+///
+/// \brief Computes the routing table from scratch, aside, and compares it
+/// with the current one.
+///
+/// \return true if both are the same
+///
+bool
+RoutingProtocol::CheckRoutingTable ()
+{
+  std::map<Ipv4Address, RoutingTableEntry> table;
+  std::vector<Ipv4Address> ifaceAssocRoutes;
+  m_table.swap (table);
+  m_ifaceAssocRoutes.swap (ifaceAssocRoutes);
+  ComputeRoutingTable ();
+  m_table.swap (table);
+  m_ifaceAssocRoutes.swap (ifaceAssocRoutes);
+
+  bool same = table.size () == m_table.size ();
+  for (std::map<Ipv4Address, RoutingTableEntry>::const_iterator it = table.begin ();
+       it != table.end (); it++)
+    {
+      RoutingTableEntry entry;
+      if (!Lookup (it->first, entry)
+          || entry.nextAddr != it->second.nextAddr
+          || entry.interface != it->second.interface
+          || entry.distance != it->second.distance)
+        {
+          NS_LOG_WARN ("Route to " << it->first << ": " << entry.nextAddr << "/" << entry.interface
+                                   << "/" << entry.distance << " instead of " << it->second.nextAddr
+                                   << "/" << it->second.interface << "/" << it->second.distance);
+          same = false;
+        }
+    }
+  return same;
 }
 
 
@@ -1287,6 +1483,14 @@ RoutingProtocol::ProcessTc (const olsr::MessageHeader &msg,
   //    T_last_addr == originator address AND
   //    T_seq       <  ANSN
   // MUST be removed from the topology set.
+  const TopologySet &topology = m_state.GetTopologySet ();
+  for (TopologySet::const_iterator it = topology.begin (); it != topology.end (); it++)
+    {
+      if (it->lastAddr == msg.GetOriginatorAddress () && it->sequenceNumber < tc.ansn)
+        {
+          m_shortestPathTree.RemoveEdge (it->lastAddr, it->destAddr);
+        }
+    }
   m_state.EraseOlderTopologyTuples (msg.GetOriginatorAddress (), tc.ansn);
 
   // 4. For each of the advertised neighbor main address received in
@@ -2621,6 +2825,7 @@ RoutingProtocol::AddTopologyTuple (const TopologyTuple &tuple)
 //         tuple->seq());
 
   m_state.InsertTopologyTuple (tuple);
+  m_shortestPathTree.AddEdge (tuple.lastAddr, tuple.destAddr);
 }
 
 ///
@@ -2638,6 +2843,7 @@ RoutingProtocol::RemoveTopologyTuple (const TopologyTuple &tuple)
 //         OLSR::node_id(tuple->last_addr()),
 //         tuple->seq());
 
+  m_shortestPathTree.RemoveEdge (tuple.lastAddr, tuple.destAddr);
   m_state.EraseTopologyTuple (tuple);
 }
 
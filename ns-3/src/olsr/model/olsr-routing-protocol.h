@@ -27,6 +27,7 @@
 #include "ns3/test.h"
 #include "olsr-state.h"
 #include "olsr-repositories.h"
+#include "olsr-shortest-path-tree.h"
 
 #include "ns3/object.h"
 #include "ns3/packet.h"
@@ -45,6 +46,8 @@
 
 /// Testcase for MPR computation mechanism
 class OlsrMprTestCase;
+/// Testcase for the incremental routing table and MPR computation
+class OlsrIncrementalRoutingTestCase;
 
 namespace ns3 {
 namespace olsr {
@@ -54,19 +57,6 @@ namespace olsr {
 /// This section documents the API of the ns-3 OLSR module. For a generic 
 /// functional description, please refer to the ns-3 manual.
 
-/// An %OLSR's routing table entry.
-struct RoutingTableEntry
-{
-  Ipv4Address destAddr; ///< Address of the destination node.
-  Ipv4Address nextAddr; ///< Address of the next hop.
-  uint32_t interface; ///< Interface index
-  uint32_t distance; ///< Distance in hops to the destination.
-
-  RoutingTableEntry () : // default values
-                         destAddr (), nextAddr (),
-                         interface (0), distance (0) {};
-};
-
 class RoutingProtocol;
 
 ///
@@ -78,6 +68,7 @@ class RoutingProtocol : public Ipv4RoutingProtocol
 {
 public:
   friend class ::OlsrMprTestCase;
+  friend class ::OlsrIncrementalRoutingTestCase;
   static TypeId GetTypeId (void);
 
   RoutingProtocol ();
@@ -167,6 +158,21 @@ private:
   /// Internal state with all needed data structs.
   OlsrState m_state;
 
+  /// Repair only the routes and MPR set affected by the changes of the state.
+  bool m_incrementalRouting;
+  /// Check each incremental update against the computation from scratch.
+  bool m_checkIncrementalRouting;
+  /// The routes of the Topology Set, for the incremental updates.
+  ShortestPathTree m_shortestPathTree;
+  /// The routes to the neighbors and 2-hop neighbors in the routing table.
+  std::map<Ipv4Address, RoutingTableEntry> m_neighborRoutes;
+  /// The routes to the interfaces of multiple interface nodes in the routing table.
+  std::vector<Ipv4Address> m_ifaceAssocRoutes;
+  /// The Neighbor Set from which the current MPR set was computed.
+  NeighborSet m_mprNeighbors;
+  /// The 2-hop Neighbor Set from which the current MPR set was computed.
+  TwoHopNeighborSet m_mprTwoHopNeighbors;
+
   Ptr<Ipv4> m_ipv4;
 
   void Clear ();
@@ -217,6 +223,13 @@ private:
 
   void MprComputation ();
   void RoutingTableComputation ();
+  void ComputeRoutingTable ();
+  void ComputeNeighborRoutes ();
+  void ComputeTopologyRoutes ();
+  void ComputeIfaceAssocRoutes ();
+  void ComputeHnaRoutes ();
+  void UpdateRoutingTable ();
+  bool CheckRoutingTable ();
   Ipv4Address GetMainAddress (Ipv4Address iface_addr) const;
   bool UsesNonOlsrOutgoingInterface (const Ipv4RoutingTableEntry &route);
 
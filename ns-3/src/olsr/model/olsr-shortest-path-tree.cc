@@ -0,0 +1,576 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+///
+/// \file	olsr-shortest-path-tree.cc
+/// \brief	Repair of the routes of the Topology Set.
+///
+/// An update runs in three passes over the vertices which the changes may
+/// affect, each in the order of the distances:
+///
+/// 1. FindAffected () finds the vertices whose distance may grow: those
+///    which are left without an edge from a vertex of the previous distance.
+/// 2. Propagate () computes their new distance, and the distances which
+///    shrink, as Dijkstra's algorithm would but from the other vertices.
+/// 3. Relabel () chooses the parent of the vertices whose edges, or the
+///    distances of whose last nodes, changed, and passes the next hops down.
+///
+
+#include "olsr-shortest-path-tree.h"
+#include "ns3/assert.h"
+
+namespace ns3 {
+namespace olsr {
+
+ShortestPathTree::Vertex::Vertex ()
+  : root (false),
+    rootDistance (0),
+    distance (0),
+    parent (0),
+    interface (0),
+    affected (false),
+    moved (false),
+    rootChanged (false),
+    reported (false)
+{
+}
+
+ShortestPathTree::ShortestPathTree ()
+  : m_order (0),
+    m_valid (true)
+{
+}
+
+ShortestPathTree::~ShortestPathTree ()
+{
+}
+
+ShortestPathTree::Vertex *
+ShortestPathTree::GetVertex (const Ipv4Address &address)
+{
+  std::pair<Vertices::iterator, bool> result =
+    m_vertices.insert (std::make_pair (address, Vertex ()));
+  if (result.second)
+    {
+      result.first->second.address = address;
+    }
+  return &result.first->second;
+}
+
+void
+ShortestPathTree::AddEdge (const Ipv4Address &lastAddr, const Ipv4Address &destAddr)
+{
+  Vertex *last = GetVertex (lastAddr);
+  Vertex *dest = GetVertex (destAddr);
+  Edge edge;
+  edge.order = m_order++;
+  edge.vertex = last;
+  dest->in.push_back (edge);
+  last->out.push_back (dest);
+  if (m_valid)
+    {
+      m_added.push_back (std::make_pair (last, dest));
+    }
+}
+
+void
+ShortestPathTree::RemoveEdge (const Ipv4Address &lastAddr, const Ipv4Address &destAddr)
+{
+  Vertices::iterator lastIt = m_vertices.find (lastAddr);
+  Vertices::iterator destIt = m_vertices.find (destAddr);
+  if (lastIt == m_vertices.end () || destIt == m_vertices.end ())
+    {
+      return;
+    }
+  Vertex *last = &lastIt->second;
+  Vertex *dest = &destIt->second;
+  std::vector<Edge>::iterator in = dest->in.begin ();
+  while (in != dest->in.end () && in->vertex != last)
+    {
+      in++;
+    }
+  if (in == dest->in.end ())
+    {
+      return;
+    }
+  // The edges in must stay in order, the edges out need not
+  dest->in.erase (in);
+  for (std::vector<Vertex *>::iterator out = last->out.begin ();
+       out != last->out.end (); out++)
+    {
+      if (*out == dest)
+        {
+          *out = last->out.back ();
+          last->out.pop_back ();
+          break;
+        }
+    }
+  if (m_valid)
+    {
+      m_removed.push_back (dest);
+      m_removed.push_back (last);
+    }
+}
+
+void
+ShortestPathTree::SetRoot (const RoutingTableEntry &entry)
+{
+  Vertex *vertex = GetVertex (entry.destAddr);
+  if (vertex->root
+      && vertex->rootDistance == entry.distance
+      && vertex->nextAddr == entry.nextAddr
+      && vertex->interface == entry.interface)
+    {
+      return;
+    }
+  vertex->root = true;
+  vertex->rootDistance = entry.distance;
+  vertex->nextAddr = entry.nextAddr;
+  vertex->interface = entry.interface;
+  if (m_valid && !vertex->rootChanged)
+    {
+      vertex->rootChanged = true;
+      m_roots.push_back (vertex);
+    }
+}
+
+void
+ShortestPathTree::RemoveRoot (const Ipv4Address &destAddr)
+{
+  Vertices::iterator it = m_vertices.find (destAddr);
+  if (it == m_vertices.end () || !it->second.root)
+    {
+      return;
+    }
+  Vertex *vertex = &it->second;
+  vertex->root = false;
+  if (m_valid && !vertex->rootChanged)
+    {
+      vertex->rootChanged = true;
+      m_roots.push_back (vertex);
+    }
+}
+
+bool
+ShortestPathTree::Lookup (const Ipv4Address &dest, RoutingTableEntry &outEntry) const
+{
+  Vertices::const_iterator it = m_vertices.find (dest);
+  if (it == m_vertices.end ())
+    {
+      return false;
+    }
+  const Vertex &vertex = it->second;
+  if (!vertex.root && vertex.distance == 0)
+    {
+      return false;
+    }
+  outEntry.destAddr = dest;
+  outEntry.nextAddr = vertex.nextAddr;
+  outEntry.interface = vertex.interface;
+  outEntry.distance = vertex.root ? vertex.rootDistance : vertex.distance;
+  return true;
+}
+
+void
+ShortestPathTree::Invalidate (void)
+{
+  for (Vertices::iterator it = m_vertices.begin (); it != m_vertices.end (); it++)
+    {
+      it->second.root = false;
+      it->second.rootChanged = false;
+    }
+  m_roots.clear ();
+  m_removed.clear ();
+  m_added.clear ();
+  m_valid = false;
+}
+
+bool
+ShortestPathTree::IsValid (void) const
+{
+  return m_valid;
+}
+
+void
+ShortestPathTree::Clear (void)
+{
+  m_vertices.clear ();
+  m_roots.clear ();
+  m_removed.clear ();
+  m_added.clear ();
+  m_order = 0;
+  m_valid = true;
+}
+
+void
+ShortestPathTree::Move (Vertex *vertex, uint32_t distance)
+{
+  vertex->distance = distance;
+  if (!vertex->moved)
+    {
+      vertex->moved = true;
+      m_moved.push_back (vertex);
+    }
+}
+
+void
+ShortestPathTree::Update (std::vector<Ipv4Address> &changed)
+{
+  if (!m_valid)
+    {
+      Rebuild (changed);
+      m_valid = true;
+      return;
+    }
+
+  FindAffected ();
+
+  // The vertices whose distance may have grown start again from the others.
+  // Those of the new roots, and of the new edges, may shrink.
+  Queue queue;
+  std::vector<Vertex *> restart (m_affected);
+  for (std::vector<Vertex *>::const_iterator it = m_roots.begin (); it != m_roots.end (); it++)
+    {
+      Vertex *vertex = *it;
+      if (vertex->root)
+        {
+          uint32_t distance = vertex->rootDistance == 2 ? 2 : 0;
+          if (vertex->distance != distance)
+            {
+              Move (vertex, distance);
+              if (distance != 0)
+                {
+                  queue.insert (std::make_pair (distance, vertex));
+                }
+            }
+        }
+      else if (vertex->distance == 0)
+        {
+          restart.push_back (vertex);
+        }
+    }
+  for (std::vector<Vertex *>::const_iterator it = restart.begin (); it != restart.end (); it++)
+    {
+      Vertex *vertex = *it;
+      if (vertex->root)
+        {
+          continue;
+        }
+      uint32_t distance = 0;
+      for (std::vector<Edge>::const_iterator in = vertex->in.begin (); in != vertex->in.end (); in++)
+        {
+          uint32_t lastDistance = in->vertex->distance;
+          if (lastDistance != 0 && (distance == 0 || lastDistance + 1 < distance))
+            {
+              distance = lastDistance + 1;
+            }
+        }
+      if (distance != 0 && (vertex->distance == 0 || distance < vertex->distance))
+        {
+          Move (vertex, distance);
+          queue.insert (std::make_pair (distance, vertex));
+        }
+    }
+  for (std::vector<std::pair<Vertex *, Vertex *> >::const_iterator it = m_added.begin ();
+       it != m_added.end (); it++)
+    {
+      Vertex *last = it->first;
+      Vertex *dest = it->second;
+      if (dest->root || last->distance == 0
+          || (dest->distance != 0 && last->distance + 1 >= dest->distance))
+        {
+          continue;
+        }
+      // The edge may have been removed since
+      for (std::vector<Edge>::const_iterator in = dest->in.begin (); in != dest->in.end (); in++)
+        {
+          if (in->vertex == last)
+            {
+              Move (dest, last->distance + 1);
+              queue.insert (std::make_pair (dest->distance, dest));
+              break;
+            }
+        }
+    }
+  Propagate (queue);
+
+  // The parents may change for the vertices whose edges changed, and for
+  // those next to the vertices whose distance changed.
+  Queue relabel;
+  for (std::vector<Vertex *>::const_iterator it = m_moved.begin (); it != m_moved.end (); it++)
+    {
+      Vertex *vertex = *it;
+      relabel.insert (std::make_pair (vertex->distance, vertex));
+      for (std::vector<Vertex *>::const_iterator out = vertex->out.begin ();
+           out != vertex->out.end (); out++)
+        {
+          if (!(*out)->root)
+            {
+              relabel.insert (std::make_pair ((*out)->distance, *out));
+            }
+        }
+    }
+  for (std::vector<Vertex *>::const_iterator it = m_roots.begin (); it != m_roots.end (); it++)
+    {
+      relabel.insert (std::make_pair ((*it)->distance, *it));
+    }
+  for (std::vector<Vertex *>::const_iterator it = m_removed.begin (); it != m_removed.end (); it++)
+    {
+      relabel.insert (std::make_pair ((*it)->distance, *it));
+    }
+  for (std::vector<std::pair<Vertex *, Vertex *> >::const_iterator it = m_added.begin ();
+       it != m_added.end (); it++)
+    {
+      relabel.insert (std::make_pair (it->second->distance, it->second));
+    }
+  Relabel (relabel, changed);
+
+  Finish ();
+}
+
+void
+ShortestPathTree::FindAffected (void)
+{
+  Queue queue;
+  for (std::vector<Vertex *>::const_iterator it = m_roots.begin (); it != m_roots.end (); it++)
+    {
+      if ((*it)->distance != 0)
+        {
+          queue.insert (std::make_pair ((*it)->distance, *it));
+        }
+    }
+  for (std::vector<Vertex *>::const_iterator it = m_removed.begin (); it != m_removed.end (); it++)
+    {
+      if ((*it)->distance != 0 && !(*it)->root)
+        {
+          queue.insert (std::make_pair ((*it)->distance, *it));
+        }
+    }
+
+  // A vertex keeps its distance if an edge still comes to it from a vertex
+  // of the previous distance which keeps its own.  The vertices of lower
+  // distances come first, so the latter is known.
+  while (!queue.empty ())
+    {
+      uint32_t distance = queue.begin ()->first;
+      Vertex *vertex = queue.begin ()->second;
+      queue.erase (queue.begin ());
+
+      bool supported = false;
+      if (vertex->root)
+        {
+          supported = vertex->rootDistance == 2;
+        }
+      else
+        {
+          for (std::vector<Edge>::const_iterator in = vertex->in.begin (); in != vertex->in.end (); in++)
+            {
+              if (!in->vertex->affected && in->vertex->distance == distance - 1)
+                {
+                  supported = true;
+                  break;
+                }
+            }
+        }
+      if (supported)
+        {
+          continue;
+        }
+      vertex->affected = true;
+      m_affected.push_back (vertex);
+      for (std::vector<Vertex *>::const_iterator out = vertex->out.begin ();
+           out != vertex->out.end (); out++)
+        {
+          if ((*out)->parent == vertex && !(*out)->root && (*out)->distance == distance + 1)
+            {
+              queue.insert (std::make_pair (distance + 1, *out));
+            }
+        }
+    }
+
+  for (std::vector<Vertex *>::const_iterator it = m_affected.begin (); it != m_affected.end (); it++)
+    {
+      Move (*it, 0);
+    }
+}
+
+void
+ShortestPathTree::Propagate (Queue &queue)
+{
+  while (!queue.empty ())
+    {
+      uint32_t distance = queue.begin ()->first;
+      Vertex *vertex = queue.begin ()->second;
+      queue.erase (queue.begin ());
+      if (vertex->distance != distance)
+        {
+          continue;
+        }
+      for (std::vector<Vertex *>::const_iterator out = vertex->out.begin ();
+           out != vertex->out.end (); out++)
+        {
+          Vertex *dest = *out;
+          if (!dest->root && (dest->distance == 0 || distance + 1 < dest->distance))
+            {
+              Move (dest, distance + 1);
+              queue.insert (std::make_pair (distance + 1, dest));
+            }
+        }
+    }
+}
+
+void
+ShortestPathTree::Relabel (Queue &queue, std::vector<Ipv4Address> &changed)
+{
+  while (!queue.empty ())
+    {
+      Vertex *vertex = queue.begin ()->second;
+      queue.erase (queue.begin ());
+
+      bool routeChanged = vertex->moved || vertex->rootChanged;
+      if (vertex->root)
+        {
+          // SetRoot has set the next hop
+        }
+      else if (vertex->distance == 0)
+        {
+          vertex->parent = 0;
+        }
+      else
+        {
+          // The first edge from a vertex of the previous distance, in the
+          // order of the Topology Set
+          Vertex *parent = 0;
+          for (std::vector<Edge>::const_iterator in = vertex->in.begin (); in != vertex->in.end (); in++)
+            {
+              if (in->vertex->distance == vertex->distance - 1)
+                {
+                  parent = in->vertex;
+                  break;
+                }
+            }
+          NS_ASSERT (parent != 0);
+          if (parent != vertex->parent
+              || parent->nextAddr != vertex->nextAddr
+              || parent->interface != vertex->interface)
+            {
+              vertex->parent = parent;
+              vertex->nextAddr = parent->nextAddr;
+              vertex->interface = parent->interface;
+              routeChanged = true;
+            }
+        }
+      if (!routeChanged)
+        {
+          continue;
+        }
+      if (!vertex->reported)
+        {
+          vertex->reported = true;
+          m_reported.push_back (vertex);
+          changed.push_back (vertex->address);
+        }
+      if (vertex->distance != 0)
+        {
+          for (std::vector<Vertex *>::const_iterator out = vertex->out.begin ();
+               out != vertex->out.end (); out++)
+            {
+              if (!(*out)->root && (*out)->distance == vertex->distance + 1)
+                {
+                  queue.insert (std::make_pair ((*out)->distance, *out));
+                }
+            }
+        }
+    }
+}
+
+void
+ShortestPathTree::Rebuild (std::vector<Ipv4Address> &changed)
+{
+  Queue queue;
+  for (Vertices::iterator it = m_vertices.begin (); it != m_vertices.end (); )
+    {
+      Vertex *vertex = &it->second;
+      if (!vertex->root && vertex->in.empty () && vertex->out.empty ())
+        {
+          // Only stood for a former root
+          m_vertices.erase (it++);
+          continue;
+        }
+      vertex->parent = 0;
+      Move (vertex, vertex->root && vertex->rootDistance == 2 ? 2 : 0);
+      if (vertex->distance != 0)
+        {
+          queue.insert (std::make_pair (vertex->distance, vertex));
+        }
+      it++;
+    }
+  Propagate (queue);
+
+  Queue relabel;
+  for (std::vector<Vertex *>::const_iterator it = m_moved.begin (); it != m_moved.end (); it++)
+    {
+      relabel.insert (std::make_pair ((*it)->distance, *it));
+    }
+  Relabel (relabel, changed);
+
+  Finish ();
+}
+
+void
+ShortestPathTree::Finish (void)
+{
+  std::vector<Ipv4Address> isolated;
+  for (std::vector<Vertex *>::const_iterator it = m_roots.begin (); it != m_roots.end (); it++)
+    {
+      (*it)->rootChanged = false;
+      if (!(*it)->root && (*it)->in.empty () && (*it)->out.empty ())
+        {
+          isolated.push_back ((*it)->address);
+        }
+    }
+  for (std::vector<Vertex *>::const_iterator it = m_removed.begin (); it != m_removed.end (); it++)
+    {
+      if (!(*it)->root && (*it)->in.empty () && (*it)->out.empty ())
+        {
+          isolated.push_back ((*it)->address);
+        }
+    }
+  for (std::vector<Vertex *>::const_iterator it = m_affected.begin (); it != m_affected.end (); it++)
+    {
+      (*it)->affected = false;
+    }
+  for (std::vector<Vertex *>::const_iterator it = m_moved.begin (); it != m_moved.end (); it++)
+    {
+      (*it)->moved = false;
+    }
+  for (std::vector<Vertex *>::const_iterator it = m_reported.begin (); it != m_reported.end (); it++)
+    {
+      (*it)->reported = false;
+    }
+  m_roots.clear ();
+  m_removed.clear ();
+  m_added.clear ();
+  m_affected.clear ();
+  m_moved.clear ();
+  m_reported.clear ();
+  for (std::vector<Ipv4Address>::const_iterator it = isolated.begin (); it != isolated.end (); it++)
+    {
+      m_vertices.erase (*it);
+    }
+}
+
+}} // namespace olsr,ns3
@@ -0,0 +1,162 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef OLSR_SHORTEST_PATH_TREE_H
+#define OLSR_SHORTEST_PATH_TREE_H
+
+#include "ns3/ipv4-address.h"
+
+#include <stdint.h>
+#include <vector>
+#include <map>
+#include <set>
+
+namespace ns3 {
+namespace olsr {
+
+/// An %OLSR's routing table entry.
+struct RoutingTableEntry
+{
+  Ipv4Address destAddr; ///< Address of the destination node.
+  Ipv4Address nextAddr; ///< Address of the next hop.
+  uint32_t interface; ///< Interface index
+  uint32_t distance; ///< Distance in hops to the destination.
+
+  RoutingTableEntry () : // default values
+                         destAddr (), nextAddr (),
+                         interface (0), distance (0) {};
+};
+
+///
+/// \ingroup olsr
+///
+/// \brief The routes of the Topology Set, repaired as the set changes.
+///
+/// The routing table computation of \RFC{3626} (section 10) first adds the
+/// routes to the neighbors and 2-hop neighbors (the roots of this tree), then
+/// grows the routes to farther nodes from the routes of distance h, one h at
+/// a time, over the tuples of the Topology Set.  Each new destination takes
+/// the next hop of the first tuple, in the order of the Topology Set, which
+/// reaches it from a destination of distance h.
+///
+/// This class keeps the topology tuples as edges and the resulting routes as
+/// a shortest path tree.  When edges or roots change, Update () only repairs
+/// the routes which depend on them, and produces the same routes, next hops
+/// included, as the computation from scratch.
+///
+class ShortestPathTree
+{
+public:
+  ShortestPathTree ();
+  ~ShortestPathTree ();
+
+  /// Adds the edge of a topology tuple, after all the current ones.
+  void AddEdge (const Ipv4Address &lastAddr, const Ipv4Address &destAddr);
+  /// Removes the edge of a topology tuple.
+  void RemoveEdge (const Ipv4Address &lastAddr, const Ipv4Address &destAddr);
+
+  ///
+  /// \brief Sets the route to a neighbor or 2-hop neighbor.
+  ///
+  /// The destination of a root takes no route from the edges, and only the
+  /// roots of distance 2 are extended through the edges, as in \RFC{3626}.
+  ///
+  void SetRoot (const RoutingTableEntry &entry);
+  /// Removes the route to a neighbor or 2-hop neighbor.
+  void RemoveRoot (const Ipv4Address &destAddr);
+
+  ///
+  /// \brief Repairs the routes after the changes of edges and roots.
+  ///
+  /// \param changed receives the destinations whose route changed, appeared
+  ///        or disappeared.  After Invalidate (), all the destinations.
+  ///
+  void Update (std::vector<Ipv4Address> &changed);
+
+  /// \return true and the route to dest if there is one, false otherwise
+  bool Lookup (const Ipv4Address &dest, RoutingTableEntry &outEntry) const;
+
+  ///
+  /// \brief Forgets the roots and the routes, but keeps the edges.
+  ///
+  /// For use while the routing table is computed from scratch: the next
+  /// Update () recomputes all the routes, from the roots set since.
+  ///
+  void Invalidate (void);
+  /// \return false after Invalidate () and until the next Update ()
+  bool IsValid (void) const;
+
+  /// Forgets everything.
+  void Clear (void);
+
+private:
+  struct Vertex;
+
+  /// An edge to a vertex, and its rank in the Topology Set.
+  struct Edge
+  {
+    uint64_t order;
+    Vertex *vertex;
+  };
+
+  struct Vertex
+  {
+    Vertex ();
+
+    Ipv4Address address;
+    std::vector<Edge> in;   ///< The edges from the last nodes, in order.
+    std::vector<Vertex *> out;
+    bool root;
+    uint32_t rootDistance;
+    /// The distance through which the edges extend this vertex, or 0.
+    uint32_t distance;
+    Vertex *parent;
+    Ipv4Address nextAddr;
+    uint32_t interface;
+    // The state of an update
+    bool affected;
+    bool moved;
+    bool rootChanged;
+    bool reported;
+  };
+
+  typedef std::map<Ipv4Address, Vertex> Vertices;
+  typedef std::set<std::pair<uint32_t, Vertex *> > Queue;
+
+  Vertex * GetVertex (const Ipv4Address &address);
+  void Move (Vertex *vertex, uint32_t distance);
+  void FindAffected (void);
+  void Propagate (Queue &queue);
+  void Relabel (Queue &queue, std::vector<Ipv4Address> &changed);
+  void Rebuild (std::vector<Ipv4Address> &changed);
+  void Finish (void);
+
+  Vertices m_vertices;
+  uint64_t m_order;
+  bool m_valid;
+  // The changes since the last update
+  std::vector<Vertex *> m_roots;
+  std::vector<Vertex *> m_removed;
+  std::vector<std::pair<Vertex *, Vertex *> > m_added;
+  // The state of an update
+  std::vector<Vertex *> m_affected;
+  std::vector<Vertex *> m_moved;
+  std::vector<Vertex *> m_reported;
+};
+
+}} // namespace olsr,ns3
+
+#endif /* OLSR_SHORTEST_PATH_TREE_H */
@@ -23,6 +23,11 @@
 #include "ns3/test.h"
 #include "ns3/olsr-routing-protocol.h"
 #include "ns3/ipv4-header.h"
+#include "ns3/node.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/simulator.h"
 
 /********** Willingness **********/
 
@@ -167,6 +172,183 @@ OlsrMprTestCase::DoRun ()
   NS_TEST_EXPECT_MSG_EQ ((mpr.find ("10.0.0.9") == mpr.end ()), true, "Node 1 must NOT select node 8 as MPR");
 }
 
+/// Testcase for the incremental routing table and MPR computation
+class OlsrIncrementalRoutingTestCase : public TestCase {
+public:
+  OlsrIncrementalRoutingTestCase ();
+  /// \brief Run test case
+  virtual void DoRun (void);
+};
+
+OlsrIncrementalRoutingTestCase::OlsrIncrementalRoutingTestCase ()
+  : TestCase ("Check the incremental OLSR routing table computation against the full one")
+{
+}
+
+void
+OlsrIncrementalRoutingTestCase::DoRun ()
+{
+  // A node with two interfaces, 10.0.0.1 (its main address) and 11.0.0.1
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  const char *localAddresses[] = { "10.0.0.1", "11.0.0.1" };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      node->AddDevice (device);
+      uint32_t interface = ipv4->AddInterface (device);
+      ipv4->AddAddress (interface, Ipv4InterfaceAddress (Ipv4Address (localAddresses[i]), Ipv4Mask ("255.0.0.0")));
+      ipv4->SetUp (interface);
+    }
+
+  Ptr<RoutingProtocol> protocol = CreateObject<RoutingProtocol> ();
+  protocol->SetIpv4 (ipv4);
+  protocol->m_mainAddress = Ipv4Address (localAddresses[0]);
+  OlsrState &state = protocol->m_state;
+
+  // Random changes to the sets of the state, among 40 other nodes, each of
+  // them with a main address 10.0.1.x and another interface 11.0.1.x
+  const uint32_t nNodes = 40;
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+  uint32_t maxDistance = 0;
+  for (uint32_t round = 0; round < 1000; round++)
+    {
+      for (uint32_t change = random->GetInteger (1, 4); change > 0; change--)
+        {
+          uint32_t i = random->GetInteger (0, nNodes - 1);
+          uint32_t j = random->GetInteger (0, nNodes);
+          Ipv4Address mainAddr (0x0a000100 + i);
+          Ipv4Address otherAddr (0x0b000100 + i);
+          // The last node may also be this one
+          Ipv4Address dest = j == nNodes ? protocol->m_mainAddress : Ipv4Address (0x0a000100 + j);
+          switch (random->GetInteger (0, 10))
+            {
+            case 0:
+            case 1:
+            case 2:
+            case 3:
+              if (random->GetInteger (0, 9) == 0)
+                {
+                  // A route to an interface which is not a main address
+                  dest = Ipv4Address (0x0b000100 + j % nNodes);
+                }
+              if (state.FindTopologyTuple (dest, mainAddr) == NULL)
+                {
+                  TopologyTuple tuple;
+                  tuple.destAddr = dest;
+                  tuple.lastAddr = mainAddr;
+                  tuple.sequenceNumber = 0;
+                  tuple.expirationTime = Seconds (1000);
+                  protocol->AddTopologyTuple (tuple);
+                }
+              break;
+            case 4:
+            case 5:
+            case 6:
+              if (!state.GetTopologySet ().empty ())
+                {
+                  uint32_t k = random->GetInteger (0, state.GetTopologySet ().size () - 1);
+                  TopologyTuple tuple = state.GetTopologySet ()[k];
+                  protocol->RemoveTopologyTuple (tuple);
+                }
+              break;
+            case 7:
+              {
+                Ipv4Address neighborIfaceAddr = random->GetInteger (0, 1) ? mainAddr : otherAddr;
+                LinkTuple *link = state.FindLinkTuple (neighborIfaceAddr);
+                if (link != NULL)
+                  {
+                    state.EraseLinkTuple (*link);
+                  }
+                else
+                  {
+                    LinkTuple tuple;
+                    tuple.localIfaceAddr = Ipv4Address (localAddresses[random->GetInteger (0, 1)]);
+                    tuple.neighborIfaceAddr = neighborIfaceAddr;
+                    tuple.symTime = Seconds (1000);
+                    tuple.asymTime = Seconds (1000);
+                    tuple.time = random->GetInteger (0, 4) == 0 ? Seconds (-1) : Seconds (1000);
+                    state.InsertLinkTuple (tuple);
+                  }
+              }
+              break;
+            case 8:
+              if (state.FindNeighborTuple (mainAddr) != NULL && random->GetInteger (0, 1) == 0)
+                {
+                  state.EraseNeighborTuple (mainAddr);
+                }
+              else
+                {
+                  const uint8_t willingness[] = { OLSR_WILL_NEVER, OLSR_WILL_LOW, OLSR_WILL_DEFAULT, OLSR_WILL_ALWAYS };
+                  NeighborTuple tuple;
+                  tuple.neighborMainAddr = mainAddr;
+                  tuple.status = random->GetInteger (0, 3) == 0 ? NeighborTuple::STATUS_NOT_SYM : NeighborTuple::STATUS_SYM;
+                  tuple.willingness = willingness[random->GetInteger (0, 3)];
+                  state.InsertNeighborTuple (tuple);
+                }
+              break;
+            case 9:
+              if (state.FindTwoHopNeighborTuple (mainAddr, dest) != NULL)
+                {
+                  state.EraseTwoHopNeighborTuples (mainAddr, dest);
+                }
+              else
+                {
+                  TwoHopNeighborTuple tuple;
+                  tuple.neighborMainAddr = mainAddr;
+                  tuple.twoHopNeighborAddr = dest;
+                  tuple.expirationTime = Seconds (1000);
+                  state.InsertTwoHopNeighborTuple (tuple);
+                }
+              break;
+            case 10:
+              if (state.FindIfaceAssocTuple (otherAddr) != NULL)
+                {
+                  state.EraseIfaceAssocTuple (*state.FindIfaceAssocTuple (otherAddr));
+                }
+              else
+                {
+                  IfaceAssocTuple tuple;
+                  tuple.ifaceAddr = otherAddr;
+                  tuple.mainAddr = mainAddr;
+                  tuple.time = Seconds (1000);
+                  state.InsertIfaceAssocTuple (tuple);
+                }
+              break;
+            }
+        }
+
+      // Now and then, compute the routing table from scratch
+      protocol->m_incrementalRouting = round % 100 != 99;
+      protocol->RoutingTableComputation ();
+      protocol->m_incrementalRouting = true;
+      NS_TEST_ASSERT_MSG_EQ (protocol->CheckRoutingTable (), true,
+                             "Incremental routing table differs in round " << round);
+
+      std::vector<RoutingTableEntry> entries = protocol->GetRoutingTableEntries ();
+      for (std::vector<RoutingTableEntry>::const_iterator it = entries.begin (); it != entries.end (); it++)
+        {
+          maxDistance = std::max (maxDistance, it->distance);
+        }
+
+      protocol->MprComputation ();
+      MprSet mprSet = state.GetMprSet ();
+      protocol->m_incrementalRouting = false;
+      protocol->MprComputation ();
+      protocol->m_incrementalRouting = true;
+      NS_TEST_ASSERT_MSG_EQ ((mprSet == state.GetMprSet ()), true,
+                             "Incremental MPR set differs in round " << round);
+    }
+  NS_TEST_EXPECT_MSG_GT (maxDistance, 4, "The topology routes were not exercised");
+
+  protocol->Dispose ();
+  Simulator::Destroy ();
+}
+
 static class OlsrProtocolTestSuite : public TestSuite
 {
 public:
@@ -177,4 +359,5 @@ OlsrProtocolTestSuite::OlsrProtocolTestSuite()
   : TestSuite ("routing-olsr", UNIT)
 {
   AddTestCase (new OlsrMprTestCase (), TestCase::QUICK);
+  AddTestCase (new OlsrIncrementalRoutingTestCase (), TestCase::QUICK);
 }
@@ -80,6 +80,7 @@ public:
 private:
   virtual double DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsDeterministic (void) const;
   double m_BSAntennaHeight; // in meter
   double m_SSAntennaHeight; // in meter
   double C;
@@ -46,6 +46,18 @@ PropagationDelayModel::AssignStreams (int64_t stream)
   return DoAssignStreams (stream);
 }
 
+bool
+PropagationDelayModel::IsDeterministic (void) const
+{
+  return DoIsDeterministic ();
+}
+
+bool
+PropagationDelayModel::DoIsDeterministic (void) const
+{
+  return false;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (RandomPropagationDelayModel);
@@ -127,5 +139,11 @@ ConstantSpeedPropagationDelayModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+bool
+ConstantSpeedPropagationDelayModel::DoIsDeterministic (void) const
+{
+  return true;
+}
+
 
 } // namespace ns3
@@ -58,12 +58,23 @@ public:
    * \return the number of stream indices assigned by this model
    */
   int64_t AssignStreams (int64_t stream);
+  /**
+   * \returns true if this delay model always computes the same delay for
+   * the same positions: such models draw no random variable and keep no
+   * state between calls.
+   */
+  bool IsDeterministic (void) const;
 private:
   /**
    * Subclasses must implement this; those not using random variables
    * can return zero
    */
   virtual int64_t DoAssignStreams (int64_t stream) = 0;
+  /**
+   * Subclasses which draw no random variable and keep no state between
+   * calls return true; the default is false.
+   */
+  virtual bool DoIsDeterministic (void) const;
 };
 
 /**
@@ -112,6 +123,7 @@ public:
   double GetSpeed (void) const;
 private:
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual bool DoIsDeterministic (void) const;
   double m_speed;
 };
 
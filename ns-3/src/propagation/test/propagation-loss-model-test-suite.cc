@@ -436,6 +436,38 @@ RangePropagationLossModelTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class DeterministicPropagationLossModelTestCase : public TestCase
+{
+public:
+  DeterministicPropagationLossModelTestCase ();
+  virtual ~DeterministicPropagationLossModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DeterministicPropagationLossModelTestCase::DeterministicPropagationLossModelTestCase ()
+  : TestCase ("Test PropagationLossModel::IsDeterministic on chained models")
+{
+}
+
+DeterministicPropagationLossModelTestCase::~DeterministicPropagationLossModelTestCase ()
+{
+}
+
+void
+DeterministicPropagationLossModelTestCase::DoRun (void)
+{
+  Ptr<PropagationLossModel> friis = CreateObject<FriisPropagationLossModel> ();
+  Ptr<PropagationLossModel> range = CreateObject<RangePropagationLossModel> ();
+  NS_TEST_EXPECT_MSG_EQ (friis->IsDeterministic (), true, "Friis draws no random variable");
+  friis->SetNext (range);
+  NS_TEST_EXPECT_MSG_EQ (friis->IsDeterministic (), true, "A chain of deterministic models is deterministic");
+  range->SetNext (CreateObject<NakagamiPropagationLossModel> ());
+  NS_TEST_EXPECT_MSG_EQ (range->IsDeterministic (), false, "Nakagami draws random variables");
+  NS_TEST_EXPECT_MSG_EQ (friis->IsDeterministic (), false, "A random model at the end of the chain makes it random");
+}
+
 class PropagationLossModelsTestSuite : public TestSuite
 {
 public:
@@ -450,6 +482,7 @@ PropagationLossModelsTestSuite::PropagationLossModelsTestSuite ()
   AddTestCase (new LogDistancePropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new MatrixPropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new RangePropagationLossModelTestCase, TestCase::QUICK);
+  AddTestCase (new DeterministicPropagationLossModelTestCase, TestCase::QUICK);
 }
 
 static PropagationLossModelsTestSuite propagationLossModelsTestSuite;
@@ -293,7 +293,12 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
             {
               NS_LOG_LOGIC (" copying signal parameters " << txParams);
               Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
-              rxParams->psd = Copy<SpectrumValue> (convertedTxPowerSpectrum);
+              if (convertedTxPowerSpectrum != txParams->psd)
+                {
+                  // rxParams already holds its own copy of the tx psd,
+                  // only the converted one needs to be copied
+                  rxParams->psd = Copy<SpectrumValue> (convertedTxPowerSpectrum);
+                }
               Time delay = MicroSeconds (0);
 
               Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
@@ -409,6 +409,31 @@ public:
   SpectrumValue& operator= (double rhs);
 
 
+  /**
+   * Add the product of x and a scalar to *this, component by
+   * component. This is the same as *this += x * s, without the
+   * temporary SpectrumValue.
+   *
+   * @param x the values to accumulate
+   * @param s the scalar, e.g., a gain or a duration
+   *
+   * @return a reference to *this
+   */
+  SpectrumValue& MultiplyAdd (const SpectrumValue& x, double s);
+
+  /**
+   * Add the product of x and y to *this, component by component.
+   * This is the same as *this += x * y, without the temporary
+   * SpectrumValue.
+   *
+   * @param x the values to accumulate, e.g., a power spectral density
+   * @param y the factors of x, e.g., a frequency-dependent gain
+   *
+   * @return a reference to *this
+   */
+  SpectrumValue& MultiplyAdd (const SpectrumValue& x, const SpectrumValue& y);
+
+
 
   /**
    *
@@ -429,6 +454,16 @@ public:
    */
   friend double Sum (const SpectrumValue& x);
 
+  /**
+   *
+   * @param x the first operand
+   * @param y the second operand
+   *
+   * @return the sum of the products of the values in x and y, i.e.,
+   * the same as Sum (x * y) without the temporary SpectrumValue
+   */
+  friend double Sum (const SpectrumValue& x, const SpectrumValue& y);
+
 
   /**
    * @param x the operand
@@ -542,6 +577,7 @@ std::ostream& operator << (std::ostream& os, const SpectrumValue& pvf);
 
 double Norm (const SpectrumValue& x);
 double Sum (const SpectrumValue& x);
+double Sum (const SpectrumValue& x, const SpectrumValue& y);
 double Prod (const SpectrumValue& x);
 SpectrumValue Pow (const SpectrumValue& lhs, double rhs);
 SpectrumValue Pow (double lhs, const SpectrumValue& rhs);
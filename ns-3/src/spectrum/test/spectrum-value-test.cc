@@ -225,6 +225,18 @@ SpectrumValueTestSuite::SpectrumValueTestSuite ()
   AddTestCase (new SpectrumValueTestCase (tv10b, v10, "tv10b = doubleValue div v1"), TestCase::QUICK);
 
 
+  SpectrumValue tv11 (f), tv12 (f), tv13 (f), v13 (f);
+  tv11 = v3;
+  tv11.MultiplyAdd (v1, doubleValue);
+  tv12 = v3;
+  tv12.MultiplyAdd (v1, v2);
+  tv13 = Sum (v1, v2);
+  v13 = Sum (v5);
+  AddTestCase (new SpectrumValueTestCase (tv11, v3 + v9, "tv11 = v3; tv11.MultiplyAdd (v1, doubleValue)"), TestCase::QUICK);
+  AddTestCase (new SpectrumValueTestCase (tv12, v3 + v5, "tv12 = v3; tv12.MultiplyAdd (v1, v2)"), TestCase::QUICK);
+  AddTestCase (new SpectrumValueTestCase (tv13, v13, "tv13 = Sum (v1, v2)"), TestCase::QUICK);
+
+
 
 
 
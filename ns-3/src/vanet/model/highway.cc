@@ -21,7 +21,12 @@
 #include <iostream>
 #include "highway.h"
 #include "ns3/simulator.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/multithreaded-simulator-impl.h"
+#endif
 #include <math.h>
+#include <algorithm>
 
 namespace ns3
 {
@@ -67,9 +72,9 @@ namespace ns3
       {
         for(int i=0;i<m_numberOfLanes;i++)
           {
-            m_vehicles[i].sort(ns3::Vehicle::Compare);
+            m_vehicles[i].Sort();
             if(m_twoDirectional==true) 
-              m_vehiclesOpp[i].sort(ns3::Vehicle::Compare);
+              m_vehiclesOpp[i].Sort();
           }
       }
 
@@ -125,9 +130,9 @@ namespace ns3
     return laneChange;
   }
 
-  Ptr<Vehicle> Highway::GetVehicle(std::list<Ptr<Vehicle> > v, int index)
+  Ptr<Vehicle> Highway::GetVehicle(const std::list<Ptr<Vehicle> > &v, int index)
   {
-	std::list<Ptr<Vehicle> >::iterator i=v.begin();
+	std::list<Ptr<Vehicle> >::const_iterator i=v.begin();
     advance(i,index);
     return *i;
   }
@@ -193,14 +198,14 @@ namespace ns3
 	double gap;
 	double vel = 0.0;
 
-	last = m_vehicles[m_currentLaneDirPos].size()-1;
+	last = m_vehicles[m_currentLaneDirPos].GetSize()-1;
 	if (last < 0)
 	  {
         gap = minGap + 1;
 	  }
 	else
 	  {
-        gap = GetVehicle(m_vehicles[m_currentLaneDirPos],last)->GetPosition().x;
+        gap = m_vehicles[m_currentLaneDirPos].Get(last)->GetPosition().x;
         vel = m_velocityDirPos;//GetVehicle(m_vehicles[m_currentLaneDirPos],last)->GetVelocity();
       }
 
@@ -242,7 +247,8 @@ namespace ns3
                 temp->SetPhyTxTraceCallback(m_phyTxTrace);
                 temp->SetPhyStateTraceCallback(m_phyStateTrace);
 				}
-                m_vehicles[m_currentLaneDirPos].push_back(temp);
+                AssignPartition(temp);
+                m_vehicles[m_currentLaneDirPos].PushBack(temp);
               }
             else
               {
@@ -278,7 +284,8 @@ namespace ns3
                 temp->SetPhyTxTraceCallback(m_phyTxTrace);
                 temp->SetPhyStateTraceCallback(m_phyStateTrace);
 				}
-                m_vehicles[m_currentLaneDirPos].push_back(temp);
+                AssignPartition(temp);
+                m_vehicles[m_currentLaneDirPos].PushBack(temp);
 		      }
 	        m_currentLaneDirPos++;
 	        if(m_currentLaneDirPos >= m_numberOfLanes) m_currentLaneDirPos = 0;
@@ -286,14 +293,14 @@ namespace ns3
 
     if(m_twoDirectional==true)
 	  {		
-    	last = m_vehiclesOpp[m_currentLaneDirNeg].size()-1;
+    	last = m_vehiclesOpp[m_currentLaneDirNeg].GetSize()-1;
 	    if (last < 0)
 	      {
             gap = minGap + 1;
 	      }
 	    else
 	      {
-            gap = m_highwayLength - GetVehicle(m_vehiclesOpp[m_currentLaneDirNeg],last)->GetPosition().x;
+            gap = m_highwayLength - m_vehiclesOpp[m_currentLaneDirNeg].Get(last)->GetPosition().x;
             vel = m_velocityDirNeg;//GetVehicle(m_vehiclesOpp[m_currentLaneDirNeg],last)->GetVelocity();
           }
 
@@ -335,7 +342,8 @@ namespace ns3
                 temp->SetPhyTxTraceCallback(m_phyTxTrace);
                 temp->SetPhyStateTraceCallback(m_phyStateTrace);
 				}
-                m_vehiclesOpp[m_currentLaneDirNeg].push_back(temp);
+                AssignPartition(temp);
+                m_vehiclesOpp[m_currentLaneDirNeg].PushBack(temp);
               }
             else
               {
@@ -371,7 +379,8 @@ namespace ns3
                 temp->SetPhyTxTraceCallback(m_phyTxTrace);
                 temp->SetPhyStateTraceCallback(m_phyStateTrace);
 				}
-                m_vehiclesOpp[m_currentLaneDirNeg].push_back(temp);
+                AssignPartition(temp);
+                m_vehiclesOpp[m_currentLaneDirNeg].PushBack(temp);
 		      }
 	        m_currentLaneDirNeg++;
 	        if(m_currentLaneDirNeg >= m_numberOfLanes) m_currentLaneDirNeg = 0;
@@ -403,55 +412,91 @@ namespace ns3
     
     if(m_autoInject==true) 
 	  InjectVehicles(m_injectionSafetyGap, (int)m_sedanTruckPerc);
+
+    // the new vehicles joined the channel: the nodes run in parallel
+    // between the steps, see MultithreadedSimulatorImpl. The channel only
+    // derives the lookahead again when vehicles joined or left.
+    if(m_wifiChannel != 0)
+      m_wifiChannel->PreparePartitions();
  
     loop++;
 	Simulator::Schedule(Seconds(m_dt), &Highway::Step, Ptr<Highway>(this));    
   }
 
-  void Highway::Accelerate(std::list<Ptr<Vehicle> > vehicles[], double dt)
+  void Highway::AssignPartition(Ptr<Vehicle> vehicle)
+  {
+#ifdef HAVE_PTHREAD_H
+    Ptr<MultithreadedSimulatorImpl> impl = DynamicCast<MultithreadedSimulatorImpl>(Simulator::GetImplementation());
+    if(impl==0 || vehicle->IsEquipped==false)
+      return;
+    // the Highway is split in strips of equal length along x, like WifiPartitionHelper
+    // does for the nodes present at the start; the vehicles keep their partition.
+    uint32_t n=impl->GetNPartitions();
+    double x=std::max(0.0, vehicle->GetPosition().x);
+    uint32_t partition=std::min<uint32_t>(n - 1, static_cast<uint32_t>(x / m_highwayLength * n));
+    impl->SetPartition(vehicle->GetDevice()->GetNode()->GetId(), partition);
+#endif
+  }
+
+  void Highway::DetachWifi(Ptr<Vehicle> vehicle)
+  {
+    Ptr<WifiNetDevice> device=DynamicCast<WifiNetDevice>(vehicle->GetDevice());
+    Ptr<YansWifiPhy> phy=DynamicCast<YansWifiPhy>(device->GetPhy());
+    Ptr<YansWifiChannel> channel=DynamicCast<YansWifiChannel>(phy->GetChannel());
+    // the vehicle no longer receives, nor lowers the lookahead of a parallel simulation
+    channel->Detach(phy);
+  }
+
+  void Highway::Accelerate(VehicleLane vehicles[], double dt)
   {
     for (int i = 0; i < m_numberOfLanes; i++)
       {
-        for (uint j = 0; j < vehicles[i].size(); j++)
+        if(m_controlVehicle.IsNull())
           {
-            Ptr<Vehicle> veh=GetVehicle(vehicles[i],j);
-            bool controled=false;
-            if(!m_controlVehicle.IsNull()) 
-		      controled=m_controlVehicle(Ptr<Highway>(this), veh, dt);
+            // all the vehicles follow the IDM rules, in batch
+            vehicles[i].Accelerate();
+            continue;
+          }
+        // the user may look at, or move, the vehicles already processed: keep the
+        // control and the acceleration of each vehicle interleaved, in lane order
+        for (uint j = 0; j < vehicles[i].GetSize(); j++)
+          {
+            Ptr<Vehicle> veh=vehicles[i].Get(j);
+            bool controled=m_controlVehicle(Ptr<Highway>(this), veh, dt);
             if(controled==false)
               {
-                if (j == 0)
-                  {
-                    veh->Accelerate(0);
-                    continue;
-                  }
-                veh->Accelerate(GetVehicle(vehicles[i],j - 1));
+                veh->Accelerate(vehicles[i].GetLeader(j));
               }
-           }
+          }
+        vehicles[i].Update();
       }
   }
 
-  void Highway::TranslatePositionVelocity(std::list<Ptr<Vehicle> > vehicles[], double dt)
+  void Highway::TranslatePositionVelocity(VehicleLane vehicles[], double dt)
   {
-    std::list<Ptr<Vehicle> > reachedEnd;
+    std::vector<uint32_t> reachedEnd;
     for (int i = 0; i < m_numberOfLanes; i++)
       {
-        for (uint j = 0; j < vehicles[i].size(); j++)
+        vehicles[i].Translate(dt);
+        for (uint j = 0; j < vehicles[i].GetSize(); j++)
           {
-            Ptr<Vehicle> veh=GetVehicle(vehicles[i],j);
-            veh->TranslatePosition(dt);
-            veh->TranslateVelocity(dt);
-            if(veh->GetPosition().x > m_highwayLength && veh->GetDirection()==1) 
-			  reachedEnd.push_back(veh);
-            else if(veh->GetPosition().x <0 && veh->GetDirection()==-1) 
-			  reachedEnd.push_back(veh);
+            double x=vehicles[i].GetPositionX(j);
+            if(x > m_highwayLength && vehicles[i].GetDirection()==1) 
+			  reachedEnd.push_back(j);
+            else if(x <0 && vehicles[i].GetDirection()==-1) 
+			  reachedEnd.push_back(j);
           }
 
-        for(uint r=0; r<reachedEnd.size(); r++)
+        // remove from the back so that the remaining indices stay valid
+        for(uint r=reachedEnd.size(); r>0; r--)
           {
-            Ptr<Vehicle> rm=GetVehicle(reachedEnd, r);
-            vehicles[i].remove(rm);
-            if(rm->IsEquipped==true) rm->GetReceiveCallback().Nullify();
+            Ptr<Vehicle> rm=vehicles[i].Get(reachedEnd[r - 1]);
+            vehicles[i].RemoveAt(reachedEnd[r - 1]);
+            if(rm->IsEquipped==true)
+              {
+                rm->GetReceiveCallback().Nullify();
+                DetachWifi(rm);
+              }
             // to put vehicle's node far away from the highway
             // we cannot dispose the vehicle here because its node may still be involved in send and receive process
             rm->SetPosition(Vector(10000, 10000, 10000)); 
@@ -462,7 +507,7 @@ namespace ns3
       }
   }
 
-  void Highway::ChangeLane(std::list<Ptr<Vehicle> > vehicles[])
+  void Highway::ChangeLane(VehicleLane vehicles[])
   {
     if (m_numberOfLanes <= 1)
       {
@@ -486,78 +531,50 @@ namespace ns3
       }     
   }
 
-  void Highway::DoChangeLaneIfPossible(std::list<Ptr<Vehicle> > vehicles[], int curLane, int desLane)
+  void Highway::DoChangeLaneIfPossible(VehicleLane vehicles[], int curLane, int desLane)
   {
-	std::list<Ptr<Vehicle> > canChange;
-    canChange.clear();
+	std::vector<uint32_t> canChange;
     
-	for (uint j = 0; j < vehicles[curLane].size(); j++)
+	for (uint j = 0; j < vehicles[curLane].GetSize(); j++)
       {
-        Ptr<Vehicle> fOld = 0;
-        if (j > 0)
+        Ptr<Vehicle> veh = vehicles[curLane].Get(j);
+        FindSideVehicles(vehicles, veh, desLane);
+        if (veh->CheckLaneChange(vehicles[curLane].GetLeader(j), m_tempVehicles[0], m_tempVehicles[1], (curLane < desLane) ? true : false))
           {
-            fOld = GetVehicle(vehicles[curLane],j - 1);
-          }
-
-        FindSideVehicles(vehicles, GetVehicle(vehicles[curLane],j), desLane);
-        if (GetVehicle(vehicles[curLane],j)->CheckLaneChange(fOld, m_tempVehicles[0], m_tempVehicles[1], (curLane < desLane) ? true : false))
-          {
-            canChange.push_back(GetVehicle(vehicles[curLane],j));
+            canChange.push_back(j);
           }               
       }
 
-    for (uint j = 0; j < canChange.size(); j++)
+    std::vector<Ptr<Vehicle> > changing;
+    for (uint j = canChange.size(); j > 0; j--)
       {
-        Vector position=GetVehicle(canChange,j)->GetPosition();
-        position.y=GetYForLane(desLane, GetVehicle(canChange,j)->GetDirection());
-        GetVehicle(canChange,j)->SetLane(desLane);
-        GetVehicle(canChange,j)->SetPosition(position);
-        vehicles[curLane].remove(GetVehicle(canChange,j));
-        vehicles[desLane].push_back(GetVehicle(canChange,j));
+        changing.push_back(vehicles[curLane].Get(canChange[j - 1]));
+        vehicles[curLane].RemoveAt(canChange[j - 1]);
       }
 
-	m_vehicles[desLane].sort(ns3::Vehicle::Compare);
+    // insert in the original order so that vehicles at the same position keep their order
+    for (uint j = changing.size(); j > 0; j--)
+      {
+        Ptr<Vehicle> veh = changing[j - 1];
+        Vector position=veh->GetPosition();
+        position.y=GetYForLane(desLane, veh->GetDirection());
+        veh->SetLane(desLane);
+        veh->SetPosition(position);
+        vehicles[desLane].Insert(veh);
+      }
   }
 
-  void Highway::FindSideVehicles(std::list<Ptr<Vehicle> > vehicles[], Ptr<Vehicle> veh, int sideLane)
+  void Highway::FindSideVehicles(VehicleLane vehicles[], Ptr<Vehicle> veh, int sideLane)
   {
-    int front=-1, back=-1;
     m_tempVehicles[0] = 0;
 	m_tempVehicles[1] = 0;
-    for (uint i = 0; i < vehicles[sideLane].size(); i++)
+    // the first vehicle of the side lane which is not ahead of veh is behind it, the previous one is in front of it
+    uint32_t back = vehicles[sideLane].LowerBound(veh->GetPosition().x);
+    if (back < vehicles[sideLane].GetSize())
       {
-        if(veh->GetDirection() == 1)
-          {	
-            if (GetVehicle(vehicles[sideLane],i)->GetPosition().x <= veh->GetPosition().x)
-              {
-                back = i;
-                front = back - 1;
-                break;
-              }
-          }
-        else
-          {
-            if (GetVehicle(vehicles[sideLane],i)->GetPosition().x >= veh->GetPosition().x)
-            {
-              back = i;
-              front = back - 1;
-              break;
-            }
-          }
-      }
-
-    if (back < 0)
-      {
-        front = vehicles[sideLane].size()-1;
-      }
-    if (back > -1)
-      {
-        m_tempVehicles[1] = GetVehicle(vehicles[sideLane], back);
-      }
-    if (front > -1)
-      {
-        m_tempVehicles[0] = GetVehicle(vehicles[sideLane], front);
+        m_tempVehicles[1] = vehicles[sideLane].Get(back);
       }
+    m_tempVehicles[0] = vehicles[sideLane].GetLeader(back);
   }
 
   Highway::Highway()
@@ -588,6 +605,11 @@ namespace ns3
 	m_penetrationRate=100;
 	m_RVFlowDirPos = UniformVariable(m_flowDirPos*m_dt, m_flowDirPos*m_dt);
 	m_RVFlowDirNeg = UniformVariable(m_flowDirNeg*m_dt, m_flowDirPos*m_dt);
+    for(int i=0;i<5;i++)
+      {
+        m_vehicles[i].SetDirection(1);
+        m_vehiclesOpp[i].SetDirection(-1);
+      }
 
     // Setup Wifi
     m_wifiHelper = WifiHelper::Default();	
@@ -619,13 +641,13 @@ namespace ns3
 
     for(int i=0;i<m_numberOfLanes;i++)
       {
-        m_vehicles[i].erase(m_vehicles[i].begin(), m_vehicles[i].end());
+        m_vehicles[i].Clear();
       }
     if(m_twoDirectional==true)
       {
         for(int i=0;i<m_numberOfLanes;i++)
         {
-          m_vehiclesOpp[i].erase(m_vehiclesOpp[i].begin(), m_vehiclesOpp[i].end());
+          m_vehiclesOpp[i].Clear();
         }
       }
   }
@@ -724,9 +746,9 @@ namespace ns3
   void Highway::PrintVehicles()
   {
     std::cout << "Lane 2----------------" << Simulator::Now()<< "--------" << std::endl;
-    for(uint i=0; i<m_vehicles[1].size();i++)
+    for(uint i=0; i<m_vehicles[1].GetSize();i++)
       {
-        Ptr<Vehicle> v=GetVehicle(m_vehicles[1],i);
+        Ptr<Vehicle> v=m_vehicles[1].Get(i);
 		std::cout<< v->GetVehicleId() << ":" << v->GetPosition().x 
                  << ":" << v->GetPosition().y << ":" << v->GetVelocity() << std::endl;
       }
@@ -854,10 +876,11 @@ namespace ns3
     int dir=vehicle->GetDirection();
     if(lane < m_numberOfLanes && lane >= 0)
       {
+        AssignPartition(vehicle);
         if(dir==1) 
-		  m_vehicles[lane].push_back(vehicle);
+		  m_vehicles[lane].PushBack(vehicle);
         else if(dir==-1) 
-		  m_vehiclesOpp[lane].push_back(vehicle);
+		  m_vehiclesOpp[lane].PushBack(vehicle);
       }
   }
 
@@ -867,9 +890,9 @@ namespace ns3
 
     for(int i=0;i<m_numberOfLanes;i++)
       {
-        for(uint j=0;j<m_vehicles[i].size();j++)
+        for(uint j=0;j<m_vehicles[i].GetSize();j++)
           {	
-            v=GetVehicle(m_vehicles[i],j);
+            v=m_vehicles[i].Get(j);
             if(v->GetVehicleId()==vid) 
 			  return v;
           }
@@ -878,9 +901,9 @@ namespace ns3
       {
         for(int i=0;i<m_numberOfLanes;i++)
           {
-            for(uint j=0;j<m_vehiclesOpp[i].size();j++)
+            for(uint j=0;j<m_vehiclesOpp[i].GetSize();j++)
               {	
-                v=GetVehicle(m_vehiclesOpp[i],j);
+                v=m_vehiclesOpp[i].Get(j);
                 if(v->GetVehicleId()==vid) 
 				  return v;
               }
@@ -897,13 +920,15 @@ namespace ns3
 
     Ptr<Vehicle> v=0;
     double diff=0;
+    uint32_t first, last;
     Vector pos, p;
     p=vehicle->GetPosition();
     for(int i=0;i<m_numberOfLanes;i++)
       {
-        for(uint j=0;j<m_vehicles[i].size();j++)
+        m_vehicles[i].FindRange(p.x-range, p.x+range, first, last);
+        for(uint j=first;j<last;j++)
           {	
-            v=GetVehicle(m_vehicles[i],j);
+            v=m_vehicles[i].Get(j);
             pos=v->GetPosition();
             if(v->GetVehicleId()==vehicle->GetVehicleId()) 
 			  continue;
@@ -916,9 +941,10 @@ namespace ns3
       {
         for(int i=0;i<m_numberOfLanes;i++)
         {
-          for(uint j=0;j<m_vehiclesOpp[i].size();j++)
+          m_vehiclesOpp[i].FindRange(p.x-range, p.x+range, first, last);
+          for(uint j=first;j<last;j++)
             {	
-              v=GetVehicle(m_vehiclesOpp[i],j);
+              v=m_vehiclesOpp[i].Get(j);
               pos=v->GetPosition();
               if(v->GetVehicleId()==vehicle->GetVehicleId()) 
 			    continue;
@@ -936,21 +962,24 @@ namespace ns3
   {
     std::list<Ptr<Vehicle> > segment;
     Ptr<Vehicle> v=0;
+    uint32_t first, last;
     Vector pos;
     if(dir==1 && lane< 5 && lane>=0)
       {
-        for(uint j=0;j<m_vehicles[lane].size();j++)
+        m_vehicles[lane].FindRange(x1, x2, first, last);
+        for(uint j=first;j<last;j++)
           {	
-            v=GetVehicle(m_vehicles[lane],j);
+            v=m_vehicles[lane].Get(j);
             pos=v->GetPosition();
             if(pos.x >= x1 && pos.x < x2) segment.push_back(v);
           }
       }
     else if(dir==-1 && m_twoDirectional==true && lane < 5 && lane >= 0)
       {
-        for(uint j=0;j<m_vehiclesOpp[lane].size();j++)
+        m_vehiclesOpp[lane].FindRange(x1, x2, first, last);
+        for(uint j=first;j<last;j++)
           { 	
-            v=GetVehicle(m_vehiclesOpp[lane],j);
+            v=m_vehiclesOpp[lane].Get(j);
             pos=v->GetPosition();
             if(pos.x >= x1 && pos.x < x2) 
 			  segment.push_back(v);
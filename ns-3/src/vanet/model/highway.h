@@ -29,6 +29,7 @@
 #include "vehicle.h"
 #include "model.h"
 #include "lane-change.h"
+#include "vehicle-lane.h"
 #include <list>
 #include "ns3/traced-value.h"
 #include "ns3/string.h"
@@ -38,7 +39,7 @@ namespace ns3
   /**
   * \brief Highway is a place holder of the Vehicle (s) which manages each step of the Vehicle mobility.
   * 
-  * A Highway has up to total 10 lists (queue of lanes), maximum 5 (lanes) for each direction. At each step (interval dt), Highway 
+  * A Highway has up to total 10 lanes (VehicleLane), maximum 5 (lanes) for each direction. At each step (interval dt), Highway 
   * browse vehicles of each lane in order of their poistions. Highway moves each Vehicle or does the change of lane based on the
   * required information given by each vehicle and its adjacent vehicles following IDM Model and LaneChange rules. 
   * It is possible to add vehicles to the Highway manually, or we can set the Highway to do so automatically (AutoInjection).
@@ -52,8 +53,8 @@ namespace ns3
   {
     private: 
 
-      std::list<Ptr<Vehicle> > m_vehicles[5];    // list of vehicles in positive direction (+1) up to maximum 5 lanes.
-      std::list<Ptr<Vehicle> > m_vehiclesOpp[5]; // list of vehicles in negative direction (-1) up to maximum 5 lanes.
+      VehicleLane m_vehicles[5];            // lanes of vehicles in positive direction (+1) up to maximum 5 lanes.
+      VehicleLane m_vehiclesOpp[5];         // lanes of vehicles in negative direction (-1) up to maximum 5 lanes.
       bool m_twoDirectional;                // true if it's a two directional roadway, false if one directional.
       int m_numberOfLanes;                  // number of lanes for each direction, maximum value is 5.
       double m_highwayLength;	            // the length of the highway.
@@ -95,16 +96,20 @@ namespace ns3
       void InjectVehicles(double minGap, int p);
       /// Translates the Vehicles to the new position.
       void TranslateVehicles();
+      /// Assigns an equipped Vehicle to the partition of its position along the Highway, see MultithreadedSimulatorImpl.
+      void AssignPartition(Ptr<Vehicle> vehicle);
+      /// Detaches the Wifi of a Vehicle which left the Highway from its channel.
+      void DetachWifi(Ptr<Vehicle> vehicle);
 	  /// Calculates the position and velocity of each vehicle for the passed step and the next step. 
-      void TranslatePositionVelocity(std::list<Ptr<Vehicle> > vehicles[], double dt);
+      void TranslatePositionVelocity(VehicleLane vehicles[], double dt);
 	  /// Calculates the acceleration of the vehicles in passed step and for the next step.
-      void Accelerate(std::list<Ptr<Vehicle> > vehicles[], double dt);
+      void Accelerate(VehicleLane vehicles[], double dt);
 	  /// Changes the vehicle lanes if possible.
-      void ChangeLane(std::list<Ptr<Vehicle> > vehicles[]);
+      void ChangeLane(VehicleLane vehicles[]);
 	  /// Changes the vehicle lanes from current lanes to the destination lane.
-      void DoChangeLaneIfPossible(std::list<Ptr<Vehicle> > vehicles[], int curLane, int desLane);
+      void DoChangeLaneIfPossible(VehicleLane vehicles[], int curLane, int desLane);
 	  /// Find the Vehicles on the Side of the current vehicle veh.
-      void FindSideVehicles(std::list<Ptr<Vehicle> > vehicles[], Ptr<Vehicle> veh, int sideLane);
+      void FindSideVehicles(VehicleLane vehicles[], Ptr<Vehicle> veh, int sideLane);
       /// Prints all vehicles in Highway.
       void PrintVehicles();
 
@@ -357,7 +362,7 @@ namespace ns3
       /**
       * \returns the retrieved Vehicle at the specific Index from the list of highway vehicles.
       */
-      Ptr<Vehicle> GetVehicle(std::list<Ptr<Vehicle> > v, int index);
+      Ptr<Vehicle> GetVehicle(const std::list<Ptr<Vehicle> > &v, int index);
       /**
       * \returns the Vehicle from the Highway given its VehicleId (vid).
       */
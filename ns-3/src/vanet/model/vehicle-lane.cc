@@ -0,0 +1,400 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2005-2009 Old Dominion University [ARBABI]
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Hadi Arbabi <marbabi@cs.odu.edu>
+ */
+
+#include "vehicle-lane.h"
+#include "model.h"
+#include <algorithm>
+#include <math.h>
+
+namespace ns3
+{
+  namespace {
+    /// Orders lane indices front-most first given their position along the driving direction.
+    struct AlongGreater
+    {
+      AlongGreater(const std::vector<double> &along) : m_along(along) {}
+      bool operator()(uint32_t i, uint32_t j) const { return m_along[i] > m_along[j]; }
+      const std::vector<double> &m_along;
+    };
+  }
+
+  VehicleLane::VehicleLane()
+  {
+    m_direction=1;
+  }
+
+  void VehicleLane::SetDirection(int value)
+  {
+    m_direction=value;
+  }
+
+  int VehicleLane::GetDirection() const
+  {
+    return m_direction;
+  }
+
+  uint32_t VehicleLane::GetSize() const
+  {
+    return m_vehicles.size();
+  }
+
+  bool VehicleLane::IsEmpty() const
+  {
+    return m_vehicles.empty();
+  }
+
+  Ptr<Vehicle> VehicleLane::Get(uint32_t index) const
+  {
+    return m_vehicles[index];
+  }
+
+  Ptr<Vehicle> VehicleLane::GetLeader(uint32_t index) const
+  {
+    if(index == 0)
+      return 0;
+    return m_vehicles[index - 1];
+  }
+
+  double VehicleLane::GetPositionX(uint32_t index) const
+  {
+    return m_positionX[index];
+  }
+
+  double VehicleLane::GetVelocity(uint32_t index) const
+  {
+    return m_velocity[index];
+  }
+
+  double VehicleLane::GetAcceleration(uint32_t index) const
+  {
+    return m_acceleration[index];
+  }
+
+  double VehicleLane::GetAlong(uint32_t index) const
+  {
+    return m_direction * m_positionX[index];
+  }
+
+  void VehicleLane::UpdateAt(uint32_t index)
+  {
+    m_positionX[index] = m_vehicles[index]->GetPosition().x;
+    m_velocity[index] = m_vehicles[index]->GetVelocity();
+    m_acceleration[index] = m_vehicles[index]->GetAcceleration();
+  }
+
+  void VehicleLane::PushBack(Ptr<Vehicle> vehicle)
+  {
+    m_vehicles.push_back(vehicle);
+    m_kinematic.push_back(IsKinematic(vehicle));
+    m_positionX.push_back(0);
+    m_velocity.push_back(0);
+    m_acceleration.push_back(0);
+    UpdateAt(m_vehicles.size() - 1);
+  }
+
+  void VehicleLane::Insert(Ptr<Vehicle> vehicle)
+  {
+    double along = m_direction * vehicle->GetPosition().x;
+    // behind every vehicle which is ahead of, or at the same position as, the new one
+    uint32_t index = 0;
+    uint32_t count = m_vehicles.size();
+    while (count > 0)
+      {
+        uint32_t step = count / 2;
+        if (GetAlong(index + step) >= along)
+          {
+            index += step + 1;
+            count -= step + 1;
+          }
+        else
+          {
+            count = step;
+          }
+      }
+    m_vehicles.insert(m_vehicles.begin() + index, vehicle);
+    m_kinematic.insert(m_kinematic.begin() + index, IsKinematic(vehicle));
+    m_positionX.insert(m_positionX.begin() + index, 0);
+    m_velocity.insert(m_velocity.begin() + index, 0);
+    m_acceleration.insert(m_acceleration.begin() + index, 0);
+    UpdateAt(index);
+  }
+
+  void VehicleLane::RemoveAt(uint32_t index)
+  {
+    m_vehicles.erase(m_vehicles.begin() + index);
+    m_kinematic.erase(m_kinematic.begin() + index);
+    m_positionX.erase(m_positionX.begin() + index);
+    m_velocity.erase(m_velocity.begin() + index);
+    m_acceleration.erase(m_acceleration.begin() + index);
+  }
+
+  bool VehicleLane::Remove(Ptr<Vehicle> vehicle)
+  {
+    for(uint32_t i=0; i<m_vehicles.size(); i++)
+      {
+        if(m_vehicles[i] == vehicle)
+          {
+            RemoveAt(i);
+            return true;
+          }
+      }
+    return false;
+  }
+
+  void VehicleLane::Clear()
+  {
+    m_vehicles.clear();
+    m_kinematic.clear();
+    m_positionX.clear();
+    m_velocity.clear();
+    m_acceleration.clear();
+  }
+
+  void VehicleLane::Sort()
+  {
+    for(uint32_t i=0; i<m_vehicles.size(); i++)
+      {
+        UpdateAt(i);
+      }
+
+    std::vector<double> along(m_vehicles.size());
+    std::vector<uint32_t> order(m_vehicles.size());
+    for(uint32_t i=0; i<m_vehicles.size(); i++)
+      {
+        along[i] = GetAlong(i);
+        order[i] = i;
+      }
+    std::stable_sort(order.begin(), order.end(), AlongGreater(along));
+
+    std::vector<Ptr<Vehicle> > vehicles(m_vehicles.size());
+    std::vector<bool> kinematic(m_vehicles.size());
+    std::vector<double> positionX(m_vehicles.size());
+    std::vector<double> velocity(m_vehicles.size());
+    std::vector<double> acceleration(m_vehicles.size());
+    for(uint32_t i=0; i<order.size(); i++)
+      {
+        vehicles[i] = m_vehicles[order[i]];
+        kinematic[i] = m_kinematic[order[i]];
+        positionX[i] = m_positionX[order[i]];
+        velocity[i] = m_velocity[order[i]];
+        acceleration[i] = m_acceleration[order[i]];
+      }
+    m_vehicles.swap(vehicles);
+    m_kinematic.swap(kinematic);
+    m_positionX.swap(positionX);
+    m_velocity.swap(velocity);
+    m_acceleration.swap(acceleration);
+  }
+
+  bool VehicleLane::IsSorted() const
+  {
+    for(uint32_t i=1; i<m_vehicles.size(); i++)
+      {
+        if(GetAlong(i) > GetAlong(i - 1))
+          return false;
+      }
+    return true;
+  }
+
+  bool VehicleLane::IsKinematic(Ptr<Vehicle> vehicle)
+  {
+    return vehicle->GetInstanceTypeId() == Vehicle::GetTypeId();
+  }
+
+  void VehicleLane::Update()
+  {
+    for(uint32_t i=0; i<m_vehicles.size(); i++)
+      {
+        UpdateAt(i);
+      }
+    if(IsSorted()==false)
+      Sort();
+  }
+
+  uint32_t VehicleLane::LowerBound(double x) const
+  {
+    double along = m_direction * x;
+    uint32_t index = 0;
+    uint32_t count = m_vehicles.size();
+    while (count > 0)
+      {
+        uint32_t step = count / 2;
+        if (GetAlong(index + step) > along)
+          {
+            index += step + 1;
+            count -= step + 1;
+          }
+        else
+          {
+            count = step;
+          }
+      }
+    return index;
+  }
+
+  void VehicleLane::FindRange(double xMin, double xMax, uint32_t &first, uint32_t &last) const
+  {
+    if(m_direction == 1)
+      {
+        first = LowerBound(xMax);
+        last = first;
+        while(last < m_vehicles.size() && m_positionX[last] >= xMin)
+          last++;
+      }
+    else
+      {
+        first = LowerBound(xMin);
+        last = first;
+        while(last < m_vehicles.size() && m_positionX[last] <= xMax)
+          last++;
+      }
+  }
+
+  void VehicleLane::Translate(double dt)
+  {
+    uint32_t n = m_vehicles.size();
+    if(n == 0)
+      return;
+
+    m_position.resize(n);
+    for(uint32_t i=0; i<n; i++)
+      {
+        if(m_kinematic[i])
+          {
+            m_position[i] = m_vehicles[i]->GetPosition();
+            m_positionX[i] = m_position[i].x;
+            m_velocity[i] = m_vehicles[i]->GetVelocity();
+            m_acceleration[i] = m_vehicles[i]->GetAcceleration();
+          }
+      }
+
+    // same arithmetic as Vehicle::TranslatePosition() and Vehicle::TranslateVelocity()
+    double direction = m_direction;
+    double *x = &m_positionX[0];
+    double *v = &m_velocity[0];
+    const double *a = &m_acceleration[0];
+    for(uint32_t i=0; i<n; i++)
+      {
+        x[i] += dt * v[i] * direction;
+      }
+    for(uint32_t i=0; i<n; i++)
+      {
+        double velocity = v[i] + (a[i] * dt);
+        v[i] = (velocity <= 0.0) ? 0.0 : velocity;
+      }
+
+    for(uint32_t i=0; i<n; i++)
+      {
+        if(m_kinematic[i])
+          {
+            m_position[i].x = m_positionX[i];
+            m_vehicles[i]->SetPosition(m_position[i]);
+            m_vehicles[i]->SetVelocity(m_velocity[i]);
+          }
+        else
+          {
+            m_vehicles[i]->TranslatePosition(dt);
+            m_vehicles[i]->TranslateVelocity(dt);
+            UpdateAt(i);
+          }
+      }
+
+    if(IsSorted()==false)
+      Sort();
+  }
+
+  void VehicleLane::Accelerate()
+  {
+    uint32_t n = m_vehicles.size();
+    if(n == 0)
+      return;
+
+    m_length.resize(n);
+    m_desiredVelocity.resize(n);
+    m_deltaV.resize(n);
+    m_maxAcceleration.resize(n);
+    m_minimumGap.resize(n);
+    m_timeHeadway.resize(n);
+    m_sqrtAccDec.resize(n);
+    m_nextAcceleration.resize(n);
+    for(uint32_t i=0; i<n; i++)
+      {
+        Ptr<Vehicle> vehicle = m_vehicles[i];
+        m_positionX[i] = vehicle->GetPosition().x;
+        m_velocity[i] = vehicle->GetVelocity();
+        m_length[i] = vehicle->GetLength();
+        Ptr<Model> model = vehicle->GetModel();
+        if(m_kinematic[i] && model != 0)
+          {
+            m_desiredVelocity[i] = model->GetDesiredVelocity();
+            m_deltaV[i] = model->GetDeltaV();
+            m_maxAcceleration[i] = model->GetAcceleration();
+            m_minimumGap[i] = model->GetMinimumGap();
+            m_timeHeadway[i] = model->GetTimeHeadway();
+            m_sqrtAccDec[i] = model->GetSqrtAccelerationDeceleration();
+          }
+        else
+          {
+            // unused, only keeps the kernel free of undefined values
+            m_desiredVelocity[i] = 1.0;
+            m_deltaV[i] = 1.0;
+            m_maxAcceleration[i] = 0.0;
+            m_minimumGap[i] = 1.0;
+            m_timeHeadway[i] = 0.0;
+            m_sqrtAccDec[i] = 1.0;
+          }
+      }
+
+    // same arithmetic as Model::CalculateAcceleration(), the vehicle in front
+    // of the leader of the lane being replaced by a free road of 500 m at 25 m/s.
+    double direction = m_direction;
+    const double *x = &m_positionX[0];
+    const double *v = &m_velocity[0];
+    double *acc = &m_nextAcceleration[0];
+    for(uint32_t i=0; i<n; i++)
+      {
+        double delta_v;
+        double s;
+        if(i == 0)
+          {
+            delta_v = v[i] - 25.0;
+            s = 500;
+          }
+        else
+          {
+            delta_v = v[i] - v[i - 1];
+            s = direction * (x[i - 1] - x[i]) - m_length[i];
+          }
+        double vel = v[i];
+        double s_star_raw = m_minimumGap[i] + vel * m_timeHeadway[i] + (vel * delta_v) / (2 * m_sqrtAccDec[i]);
+        double s_star = (s_star_raw > m_minimumGap[i]) ? s_star_raw : m_minimumGap[i];
+        acc[i] = m_maxAcceleration[i] * (1 - pow(vel / m_desiredVelocity[i], m_deltaV[i]) - (s_star * s_star) / (s * s));
+      }
+
+    for(uint32_t i=0; i<n; i++)
+      {
+        if(m_kinematic[i] && m_vehicles[i]->GetModel() != 0)
+          m_vehicles[i]->SetAcceleration(acc[i]);
+        else
+          m_vehicles[i]->Accelerate(GetLeader(i));
+        m_acceleration[i] = m_vehicles[i]->GetAcceleration();
+      }
+  }
+}
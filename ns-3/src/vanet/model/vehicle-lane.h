@@ -0,0 +1,162 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2005-2009 Old Dominion University [ARBABI]
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Hadi Arbabi <marbabi@cs.odu.edu>
+ */
+
+#ifndef CLASS_VEHICLE_LANE_
+#define CLASS_VEHICLE_LANE_
+
+#include "ns3/ptr.h"
+#include "vehicle.h"
+#include <vector>
+
+namespace ns3
+{
+  /**
+  * \brief VehicleLane holds the Vehicle (s) of one lane of the Highway, sorted in driving order.
+  *
+  * The Vehicles are stored in a contiguous array where index 0 is the front-most Vehicle (the leader of the lane)
+  * and index i-1 is the leader of the Vehicle at index i. Alongside, the lane keeps a structure-of-arrays copy of
+  * the position (x), velocity and acceleration of its Vehicles, which is refreshed by Update() after each mobility step,
+  * so that leader/follower lookups are done by neighbouring index and range queries by binary search on x.
+  *
+  * The lane also runs the kinematics of its Vehicles in batch (Translate() and Accelerate()): the state of the
+  * Vehicles is gathered into the packed arrays, updated in tight loops following the same equations as
+  * Vehicle::TranslatePosition(), Vehicle::TranslateVelocity() and Model::CalculateAcceleration(), and written back.
+  * Only plain Vehicle (s) with a Model take the batch path; subclasses such as Obstacle, which override the
+  * mobility methods, are still handled one by one through their virtual methods.
+  */
+  class VehicleLane
+  {
+    public:
+
+      VehicleLane();
+      /**
+      * \param value the direction of the Vehicles in this lane (1 or -1).
+      */
+      void SetDirection(int value);
+      /**
+      * \returns the direction of the Vehicles in this lane (1 or -1).
+      */
+      int GetDirection() const;
+      /**
+      * \returns the number of Vehicles in the lane.
+      */
+      uint32_t GetSize() const;
+      /**
+      * \returns true if there is no Vehicle in the lane.
+      */
+      bool IsEmpty() const;
+      /**
+      * \returns the Vehicle at the given index, 0 being the front-most Vehicle.
+      */
+      Ptr<Vehicle> Get(uint32_t index) const;
+      /**
+      * \returns the Vehicle just in front of the Vehicle at the given index, or 0 if it is the leader of the lane.
+      */
+      Ptr<Vehicle> GetLeader(uint32_t index) const;
+      /**
+      * \returns the cached position x of the Vehicle at the given index.
+      */
+      double GetPositionX(uint32_t index) const;
+      /**
+      * \returns the cached velocity of the Vehicle at the given index.
+      */
+      double GetVelocity(uint32_t index) const;
+      /**
+      * \returns the cached acceleration of the Vehicle at the given index.
+      */
+      double GetAcceleration(uint32_t index) const;
+      /**
+      * Appends the Vehicle at the back of the lane, without sorting (used at the entrance of the Highway).
+      */
+      void PushBack(Ptr<Vehicle> vehicle);
+      /**
+      * Inserts the Vehicle at its position in the lane, behind the Vehicles at the same position.
+      */
+      void Insert(Ptr<Vehicle> vehicle);
+      /**
+      * Removes the Vehicle at the given index.
+      */
+      void RemoveAt(uint32_t index);
+      /**
+      * \returns true if the Vehicle was found in the lane and removed.
+      */
+      bool Remove(Ptr<Vehicle> vehicle);
+      /// Removes all the Vehicles of the lane.
+      void Clear();
+      /// Sorts the Vehicles in driving order (stable), see Vehicle::Compare.
+      void Sort();
+      /**
+      * Refreshes the cached position, velocity and acceleration of the Vehicles,
+      * and sorts the lane again if some Vehicles passed each other.
+      */
+      void Update();
+      /**
+      * \returns the index of the first Vehicle (from the front) which is not ahead of position x,
+      * or GetSize() if all Vehicles are ahead of x.
+      */
+      uint32_t LowerBound(double x) const;
+      /**
+      * \param xMin the lower bound of the x range.
+      * \param xMax the upper bound of the x range.
+      * \param first set to the index of the first Vehicle with xMin <= x <= xMax.
+      * \param last set to one past the index of the last Vehicle with xMin <= x <= xMax.
+      */
+      void FindRange(double xMin, double xMax, uint32_t &first, uint32_t &last) const;
+      /**
+      * Translates the position and the velocity of every Vehicle of the lane for the interval dt,
+      * leaving the cached values up to date and the lane sorted.
+      */
+      void Translate(double dt);
+      /**
+      * Calculates the IDM acceleration of every Vehicle of the lane from the Vehicle in front of it,
+      * leaving the cached values up to date.
+      */
+      void Accelerate();
+
+    private:
+
+      /// Refreshes the cached values of the Vehicle at the given index.
+      void UpdateAt(uint32_t index);
+      /// \returns the cached position along the driving direction (grows toward the front of the lane).
+      double GetAlong(uint32_t index) const;
+      /// \returns true if the cached positions are in driving order.
+      bool IsSorted() const;
+      /// \returns true if the mobility of the Vehicle can be computed by the batch kernels.
+      static bool IsKinematic(Ptr<Vehicle> vehicle);
+
+      int m_direction;                          // the direction of the Vehicles of this lane.
+      std::vector<Ptr<Vehicle> > m_vehicles;    // the Vehicles of this lane, front-most first.
+      std::vector<double> m_positionX;          // the position x of each Vehicle.
+      std::vector<double> m_velocity;           // the velocity of each Vehicle.
+      std::vector<double> m_acceleration;       // the acceleration of each Vehicle.
+      std::vector<bool> m_kinematic;            // true for each Vehicle handled by the batch kernels.
+      // scratch arrays of the batch kernels.
+      std::vector<Vector> m_position;           // the full position of each Vehicle.
+      std::vector<double> m_length;             // the length of each Vehicle.
+      std::vector<double> m_desiredVelocity;    // the IDM desired velocity of each Vehicle.
+      std::vector<double> m_deltaV;             // the IDM acceleration exponent of each Vehicle.
+      std::vector<double> m_maxAcceleration;    // the IDM maximum acceleration of each Vehicle.
+      std::vector<double> m_minimumGap;         // the IDM minimum gap of each Vehicle.
+      std::vector<double> m_timeHeadway;        // the IDM time headway of each Vehicle.
+      std::vector<double> m_sqrtAccDec;         // the IDM sqrt(acceleration * deceleration) of each Vehicle.
+      std::vector<double> m_nextAcceleration;   // the acceleration calculated by Accelerate().
+  };
+};
+#endif
@@ -287,6 +287,11 @@ namespace ns3
     return m_device->GetBroadcast();
   }
 
+  Ptr<NetDevice> Vehicle::GetDevice()
+  {
+    return m_device;
+  }
+
   bool Vehicle::SendTo(Address address, Ptr<Packet> packet)
   {
     return m_device->Send(packet, address, 1);
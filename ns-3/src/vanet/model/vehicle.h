@@ -262,6 +262,10 @@ namespace ns3
       */
       Address GetBroadcastAddress();
       /**
+      * \returns the Wifi device of the Vehicle, 0 when it is not equipped.
+      */
+      Ptr<NetDevice> GetDevice();
+      /**
       * \param address the destination address. (Wifi address of the target Vehicle)
       * \param packet the packet to send.
       * \returns ture if the enqueuing/sending was successful, otherwise false.
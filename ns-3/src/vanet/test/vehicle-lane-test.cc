@@ -0,0 +1,330 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/vehicle.h"
+#include "ns3/vehicle-lane.h"
+#include "ns3/obstacle.h"
+#include "ns3/model.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+using namespace ns3;
+
+static Ptr<Vehicle>
+CreateVehicle (double x, int direction)
+{
+  Ptr<Vehicle> vehicle = CreateObject<Vehicle> ();
+  vehicle->SetDirection (direction);
+  vehicle->SetPosition (Vector (x, 0, 0));
+  vehicle->SetLength (4);
+  return vehicle;
+}
+
+/**
+ * Checks that the Vehicles are kept front-most first, and the binary
+ * searches on the position, in both directions.
+ */
+class VehicleLaneOrderTestCase : public TestCase
+{
+public:
+  VehicleLaneOrderTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+VehicleLaneOrderTestCase::VehicleLaneOrderTestCase ()
+  : TestCase ("Check the order, LowerBound and FindRange of a VehicleLane")
+{
+}
+
+void
+VehicleLaneOrderTestCase::DoRun (void)
+{
+  VehicleLane lane;
+  lane.SetDirection (1);
+  Ptr<Vehicle> v10 = CreateVehicle (10, 1);
+  Ptr<Vehicle> v30 = CreateVehicle (30, 1);
+  Ptr<Vehicle> v30b = CreateVehicle (30, 1);
+  Ptr<Vehicle> v50 = CreateVehicle (50, 1);
+  Ptr<Vehicle> v70 = CreateVehicle (70, 1);
+  lane.Insert (v30);
+  lane.Insert (v70);
+  lane.Insert (v10);
+  lane.Insert (v50);
+  lane.Insert (v30b);
+
+  NS_TEST_ASSERT_MSG_EQ (lane.GetSize (), 5, "every inserted vehicle is in the lane");
+  NS_TEST_EXPECT_MSG_EQ (lane.Get (0), v70, "the front-most vehicle comes first");
+  NS_TEST_EXPECT_MSG_EQ (lane.Get (1), v50, "the vehicles are sorted by decreasing x");
+  NS_TEST_EXPECT_MSG_EQ (lane.Get (2), v30, "a vehicle is inserted behind the one at the same position");
+  NS_TEST_EXPECT_MSG_EQ (lane.Get (3), v30b, "a vehicle is inserted behind the one at the same position");
+  NS_TEST_EXPECT_MSG_EQ (lane.Get (4), v10, "the last vehicle of the lane comes last");
+  NS_TEST_EXPECT_MSG_EQ (lane.GetPositionX (1), 50, "the cached position is the one of the vehicle");
+
+  NS_TEST_EXPECT_MSG_EQ (lane.LowerBound (100), 0, "no vehicle is ahead of x = 100");
+  NS_TEST_EXPECT_MSG_EQ (lane.LowerBound (50), 1, "the vehicle at x = 50 is not ahead of x = 50");
+  NS_TEST_EXPECT_MSG_EQ (lane.LowerBound (40), 2, "two vehicles are ahead of x = 40");
+  NS_TEST_EXPECT_MSG_EQ (lane.LowerBound (30), 2, "the vehicles at x = 30 are not ahead of x = 30");
+  NS_TEST_EXPECT_MSG_EQ (lane.LowerBound (0), 5, "every vehicle is ahead of x = 0");
+
+  uint32_t first;
+  uint32_t last;
+  lane.FindRange (25, 55, first, last);
+  NS_TEST_EXPECT_MSG_EQ (first, 1, "the range [25, 55] starts at the vehicle at x = 50");
+  NS_TEST_EXPECT_MSG_EQ (last, 4, "the range [25, 55] ends after the vehicles at x = 30");
+  lane.FindRange (30, 30, first, last);
+  NS_TEST_EXPECT_MSG_EQ (last - first, 2, "the bounds of a range are inclusive");
+  lane.FindRange (80, 90, first, last);
+  NS_TEST_EXPECT_MSG_EQ (last - first, 0, "no vehicle lies in [80, 90]");
+
+  // the vehicles of the negative direction drive toward x = 0
+  VehicleLane back;
+  back.SetDirection (-1);
+  Ptr<Vehicle> w10 = CreateVehicle (10, -1);
+  Ptr<Vehicle> w30 = CreateVehicle (30, -1);
+  Ptr<Vehicle> w50 = CreateVehicle (50, -1);
+  back.Insert (w50);
+  back.Insert (w10);
+  back.Insert (w30);
+  NS_TEST_EXPECT_MSG_EQ (back.Get (0), w10, "the front-most vehicle of the negative direction has the lowest x");
+  NS_TEST_EXPECT_MSG_EQ (back.Get (2), w50, "the last vehicle of the negative direction has the highest x");
+  NS_TEST_EXPECT_MSG_EQ (back.LowerBound (30), 1, "one vehicle is ahead of x = 30 in the negative direction");
+  back.FindRange (20, 60, first, last);
+  NS_TEST_EXPECT_MSG_EQ (first, 1, "the range [20, 60] starts at the vehicle at x = 30");
+  NS_TEST_EXPECT_MSG_EQ (last, 3, "the range [20, 60] ends at the back of the lane");
+
+  // vehicles which pass each other are sorted again by Update
+  v10->SetPosition (Vector (60, 0, 0));
+  lane.Update ();
+  NS_TEST_EXPECT_MSG_EQ (lane.Get (1), v10, "Update sorts the vehicles which moved");
+  NS_TEST_EXPECT_MSG_EQ (lane.GetPositionX (1), 60, "Update refreshes the cached positions");
+  NS_TEST_EXPECT_MSG_EQ (lane.Get (4), v30b, "Update keeps the order of the vehicles at the same position");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * Checks the leaders of the Vehicles when they change lane or leave the
+ * lane, as done by the Highway.
+ */
+class VehicleLaneLeaderTestCase : public TestCase
+{
+public:
+  VehicleLaneLeaderTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+VehicleLaneLeaderTestCase::VehicleLaneLeaderTestCase ()
+  : TestCase ("Check the leaders and followers of a VehicleLane across lane changes and removals")
+{
+}
+
+void
+VehicleLaneLeaderTestCase::DoRun (void)
+{
+  VehicleLane right;
+  VehicleLane left;
+  Ptr<Vehicle> r10 = CreateVehicle (10, 1);
+  Ptr<Vehicle> r50 = CreateVehicle (50, 1);
+  Ptr<Vehicle> r70 = CreateVehicle (70, 1);
+  Ptr<Vehicle> l40 = CreateVehicle (40, 1);
+  Ptr<Vehicle> l60 = CreateVehicle (60, 1);
+  right.PushBack (r70);
+  right.PushBack (r50);
+  right.PushBack (r10);
+  left.PushBack (l60);
+  left.PushBack (l40);
+
+  NS_TEST_EXPECT_MSG_EQ (right.GetLeader (0), 0, "the front-most vehicle has no leader");
+  NS_TEST_EXPECT_MSG_EQ (right.GetLeader (2), r50, "the leader of x = 10 is x = 50");
+
+  // the side vehicles of x = 50 in the left lane, as found by the Highway
+  uint32_t back = left.LowerBound (r50->GetPosition ().x);
+  NS_TEST_EXPECT_MSG_EQ (left.GetLeader (back), l60, "the side leader of x = 50 is x = 60");
+  NS_TEST_EXPECT_MSG_EQ (left.Get (back), l40, "the side follower of x = 50 is x = 40");
+
+  // x = 50 changes to the left lane
+  NS_TEST_ASSERT_MSG_EQ (right.Remove (r50), true, "the vehicle which changes lane is found");
+  left.Insert (r50);
+  NS_TEST_EXPECT_MSG_EQ (right.GetSize (), 2, "the vehicle left the right lane");
+  NS_TEST_EXPECT_MSG_EQ (right.GetLeader (1), r70, "the leader of x = 10 becomes x = 70");
+  NS_TEST_EXPECT_MSG_EQ (left.GetSize (), 3, "the vehicle entered the left lane");
+  NS_TEST_EXPECT_MSG_EQ (left.GetLeader (1), l60, "the leader of the vehicle which changed lane is x = 60");
+  NS_TEST_EXPECT_MSG_EQ (left.GetLeader (2), r50, "the vehicle which changed lane leads x = 40");
+  NS_TEST_EXPECT_MSG_EQ (right.Remove (r50), false, "a vehicle is not removed twice");
+
+  // the leader of the right lane reaches the end of the highway
+  right.RemoveAt (0);
+  NS_TEST_EXPECT_MSG_EQ (right.Get (0), r10, "x = 10 becomes the front-most vehicle");
+  NS_TEST_EXPECT_MSG_EQ (right.GetLeader (0), 0, "the new front-most vehicle has no leader");
+  NS_TEST_EXPECT_MSG_EQ (right.GetPositionX (0), 10, "the cached positions follow the removal");
+
+  left.Clear ();
+  NS_TEST_EXPECT_MSG_EQ (left.IsEmpty (), true, "Clear removes every vehicle");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * Checks that the batch kinematics of a VehicleLane (Accelerate and
+ * Translate) move the Vehicles exactly as their own virtual methods do,
+ * step by step, on a lane of mixed Models which runs into an Obstacle.
+ */
+class VehicleLaneKinematicsTestCase : public TestCase
+{
+public:
+  VehicleLaneKinematicsTestCase (int direction);
+private:
+  virtual void DoRun (void);
+  /// Creates the vehicles of the scenario, front-most first.
+  std::vector<Ptr<Vehicle> > CreateScenario (void) const;
+  int m_direction;
+};
+
+/// Orders the reference vehicles front-most first, as VehicleLane::Sort does.
+struct VehicleAheadOf
+{
+  VehicleAheadOf (int direction) : m_direction (direction) {}
+  bool operator() (Ptr<Vehicle> a, Ptr<Vehicle> b) const
+  {
+    return m_direction * a->GetPosition ().x > m_direction * b->GetPosition ().x;
+  }
+  int m_direction;
+};
+
+static std::string
+KinematicsName (int direction)
+{
+  std::ostringstream oss;
+  oss << "Check the batch kinematics of a VehicleLane against the per-vehicle code, direction " << direction;
+  return oss.str ();
+}
+
+VehicleLaneKinematicsTestCase::VehicleLaneKinematicsTestCase (int direction)
+  : TestCase (KinematicsName (direction)),
+    m_direction (direction)
+{
+}
+
+std::vector<Ptr<Vehicle> >
+VehicleLaneKinematicsTestCase::CreateScenario (void) const
+{
+  std::vector<Ptr<Vehicle> > vehicles;
+  double start = (m_direction == 1) ? 0 : 1000;
+
+  Ptr<Obstacle> obstacle = CreateObject<Obstacle> ();
+  obstacle->SetVehicleId (0);
+  obstacle->SetDirection (m_direction);
+  obstacle->SetPosition (Vector (start + m_direction * 400, 0, 0));
+  obstacle->SetLength (4);
+  vehicles.push_back (obstacle);
+
+  for (int i = 1; i <= 8; i++)
+    {
+      Ptr<Model> model = CreateObject<Model> ();
+      model->SetDesiredVelocity (20.0 + i);
+      model->SetDeltaV (4.0);
+      model->SetAcceleration ((i % 2) ? 0.5 : 0.2);
+      model->SetDeceleration ((i % 2) ? 3.0 : 4.0);
+      model->SetMinimumGap (2.0);
+      model->SetTimeHeadway ((i % 2) ? 0.1 : 0.5);
+      model->SetSqrtAccelerationDeceleration (std::sqrt (model->GetAcceleration () * model->GetDeceleration ()));
+
+      Ptr<Vehicle> vehicle = CreateObject<Vehicle> ();
+      vehicle->SetVehicleId (i);
+      vehicle->SetDirection (m_direction);
+      vehicle->SetPosition (Vector (start + m_direction * (300 - 30 * i), 0, 0));
+      vehicle->SetLength ((i % 3) ? 4 : 8);
+      vehicle->SetVelocity (15.0 + i % 4);
+      vehicle->SetModel (model);
+      vehicles.push_back (vehicle);
+    }
+  return vehicles;
+}
+
+void
+VehicleLaneKinematicsTestCase::DoRun (void)
+{
+  VehicleLane lane;
+  lane.SetDirection (m_direction);
+  std::vector<Ptr<Vehicle> > batch = CreateScenario ();
+  for (uint32_t i = 0; i < batch.size (); i++)
+    {
+      lane.PushBack (batch[i]);
+    }
+  std::vector<Ptr<Vehicle> > reference = CreateScenario ();
+
+  double dt = 0.1;
+  for (uint32_t step = 0; step < 600; step++)
+    {
+      lane.Accelerate ();
+      lane.Translate (dt);
+
+      // as Highway::Accelerate and Highway::TranslatePositionVelocity did
+      for (uint32_t j = 0; j < reference.size (); j++)
+        {
+          reference[j]->Accelerate ((j == 0) ? Ptr<Vehicle> (0) : reference[j - 1]);
+        }
+      for (uint32_t j = 0; j < reference.size (); j++)
+        {
+          reference[j]->TranslatePosition (dt);
+          reference[j]->TranslateVelocity (dt);
+        }
+      std::stable_sort (reference.begin (), reference.end (), VehicleAheadOf (m_direction));
+
+      NS_TEST_ASSERT_MSG_EQ (lane.GetSize (), reference.size (), "no vehicle is lost");
+      for (uint32_t j = 0; j < reference.size (); j++)
+        {
+          Ptr<Vehicle> vehicle = lane.Get (j);
+          NS_TEST_ASSERT_MSG_EQ (vehicle->GetVehicleId (), reference[j]->GetVehicleId (),
+                                 "same order at step " << step);
+          NS_TEST_ASSERT_MSG_EQ (vehicle->GetPosition ().x, reference[j]->GetPosition ().x,
+                                 "same position of vehicle " << vehicle->GetVehicleId () << " at step " << step);
+          NS_TEST_ASSERT_MSG_EQ (vehicle->GetVelocity (), reference[j]->GetVelocity (),
+                                 "same velocity of vehicle " << vehicle->GetVehicleId () << " at step " << step);
+          NS_TEST_ASSERT_MSG_EQ (vehicle->GetAcceleration (), reference[j]->GetAcceleration (),
+                                 "same acceleration of vehicle " << vehicle->GetVehicleId () << " at step " << step);
+          NS_TEST_ASSERT_MSG_EQ (lane.GetPositionX (j), vehicle->GetPosition ().x,
+                                 "the cached position is up to date at step " << step);
+        }
+    }
+  // the vehicles caught up with the obstacle
+  NS_TEST_EXPECT_MSG_LT (lane.GetVelocity (1), 1.0, "the vehicle behind the obstacle stopped");
+
+  Simulator::Destroy ();
+}
+
+class VanetTestSuite : public TestSuite
+{
+public:
+  VanetTestSuite ();
+};
+
+VanetTestSuite::VanetTestSuite ()
+  : TestSuite ("vanet-vehicle-lane", UNIT)
+{
+  AddTestCase (new VehicleLaneOrderTestCase, TestCase::QUICK);
+  AddTestCase (new VehicleLaneLeaderTestCase, TestCase::QUICK);
+  AddTestCase (new VehicleLaneKinematicsTestCase (1), TestCase::QUICK);
+  AddTestCase (new VehicleLaneKinematicsTestCase (-1), TestCase::QUICK);
+}
+
+static VanetTestSuite g_vanetTestSuite;
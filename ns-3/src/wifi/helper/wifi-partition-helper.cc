@@ -0,0 +1,81 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "wifi-partition-helper.h"
+#include "ns3/yans-wifi-channel.h"
+#include "ns3/mobility-model.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/multithreaded-simulator-impl.h"
+#endif
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+NS_LOG_COMPONENT_DEFINE ("WifiPartitionHelper");
+
+namespace ns3 {
+
+WifiPartitionHelper::WifiPartitionHelper ()
+  : m_lookahead (Seconds (0))
+{
+}
+
+void
+WifiPartitionHelper::SetLookahead (Time lookahead)
+{
+  m_lookahead = lookahead;
+}
+
+void
+WifiPartitionHelper::Install (NodeContainer nodes, Ptr<YansWifiChannel> channel) const
+{
+#ifdef HAVE_PTHREAD_H
+  Ptr<MultithreadedSimulatorImpl> impl = DynamicCast<MultithreadedSimulatorImpl> (Simulator::GetImplementation ());
+  if (impl != 0)
+    {
+      std::vector<std::pair<double, uint32_t> > nodesByX;
+      for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); i++)
+        {
+          Ptr<MobilityModel> mobility = (*i)->GetObject<MobilityModel> ();
+          NS_ASSERT_MSG (mobility != 0, "The node " << (*i)->GetId () << " has no MobilityModel");
+          nodesByX.push_back (std::make_pair (mobility->GetPosition ().x, (*i)->GetId ()));
+        }
+      std::sort (nodesByX.begin (), nodesByX.end ());
+      uint32_t nPartitions = impl->GetNPartitions ();
+      for (uint32_t i = 0; i < nodesByX.size (); i++)
+        {
+          uint32_t partition = static_cast<uint64_t> (i) * nPartitions / nodesByX.size ();
+          NS_LOG_DEBUG ("node " << nodesByX[i].second << " at x=" << nodesByX[i].first <<
+                        " in partition " << partition);
+          impl->SetPartition (nodesByX[i].second, partition);
+        }
+      if (m_lookahead.IsStrictlyPositive ())
+        {
+          impl->SetLookahead (m_lookahead);
+        }
+    }
+  else
+    {
+      NS_LOG_WARN ("The simulator is not a MultithreadedSimulatorImpl: the nodes run sequentially");
+    }
+#endif
+  channel->PreparePartitions ();
+}
+
+} // namespace ns3
@@ -0,0 +1,72 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef WIFI_PARTITION_HELPER_H
+#define WIFI_PARTITION_HELPER_H
+
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class YansWifiChannel;
+
+/**
+ * \brief assign the wifi nodes to the partitions of a MultithreadedSimulatorImpl
+ *
+ * The nodes are split in strips along the x axis, each strip holding
+ * the same number of nodes, so that the partitions have similar loads
+ * and most of the transmissions are received by the nodes of the same
+ * partition. The positions are read once, when Install is called: the
+ * nodes keep their partition when they move.
+ *
+ * The lookahead of the simulator is the delay after which the channel
+ * delivers a transmission to the other partitions (see YansWifiChannel).
+ * By default, the helper leaves the Lookahead attribute of the simulator
+ * alone, and the channel derives the lookahead from the shortest
+ * propagation delay between two PHYs of distinct partitions; a lookahead
+ * given to the helper can only be lowered by the channel.
+ */
+class WifiPartitionHelper
+{
+public:
+  WifiPartitionHelper ();
+
+  /**
+   * \param lookahead the lookahead of the simulator, 0 (the default) to
+   *      let the channel derive it.
+   */
+  void SetLookahead (Time lookahead);
+
+  /**
+   * Assign the nodes to the partitions, set the lookahead of the
+   * simulator and prepare the channel for the parallel simulation.
+   * When the simulator is not a MultithreadedSimulatorImpl, only the
+   * channel is prepared.
+   *
+   * \param nodes the nodes, which must have a MobilityModel
+   * \param channel the channel of the nodes
+   */
+  void Install (NodeContainer nodes, Ptr<YansWifiChannel> channel) const;
+
+private:
+  Time m_lookahead;
+};
+
+} // namespace ns3
+
+#endif /* WIFI_PARTITION_HELPER_H */
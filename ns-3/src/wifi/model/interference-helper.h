@@ -21,7 +21,7 @@
 #define INTERFERENCE_HELPER_H
 
 #include <stdint.h>
-#include <vector>
+#include <map>
 #include <list>
 #include "wifi-mode.h"
 #include "wifi-preamble.h"
@@ -203,45 +203,12 @@ private:
   void EraseEvents (void);
 private:
   /**
-   * Noise and Interference (thus Ni) event.
+   * Noise and Interference (thus Ni) changes, sorted by time.  Each
+   * entry maps the time of a change to the amount (W) by which the
+   * observed power changes at that time.  Changes which happen at the
+   * same time are kept in insertion order.
    */
-  class NiChange
-  {
-public:
-    /**
-     * Create a NiChange at the given time and the amount of NI change.
-     *
-     * \param time time of the event
-     * \param delta the power
-     */
-    NiChange (Time time, double delta);
-    /**
-     * Return the event time.
-     *
-     * \return the event time.
-     */
-    Time GetTime (void) const;
-    /**
-     * Return the power
-     *
-     * \return the power
-     */
-    double GetDelta (void) const;
-    /**
-     * Compare the event time of two NiChange objects (a < o).
-     *
-     * \param o
-     * \return true if a < o.time, false otherwise
-     */
-    bool operator < (const NiChange& o) const;
-private:
-    Time m_time;
-    double m_delta;
-  };
-  /**
-   * typedef for a vector of NiChanges
-   */
-  typedef std::vector <NiChange> NiChanges;
+  typedef std::multimap<Time, double> NiChanges;
   /**
    * typedef for a list of Events
    */
@@ -259,10 +226,13 @@ private:
    * Calculate noise and interference power in W.
    *
    * \param event
-   * \param ni
-   * \return noise and interference power
+   * \param first set to the first change which happens during the event
+   * \param last set to the change which marks the end of the event
+   * \return noise and interference power at the start of the event
    */
-  double CalculateNoiseInterferenceW (Ptr<Event> event, NiChanges *ni) const;
+  double CalculateNoiseInterferenceW (Ptr<Event> event,
+                                      NiChanges::const_iterator *first,
+                                      NiChanges::const_iterator *last) const;
   /**
    * Calculate SNR (linear ratio) from the given signal power and noise+interference power.
    * (Mode is not currently used)
@@ -288,25 +258,29 @@ private:
    * multiple chunks (e.g. due to interference from other transmissions).
    *
    * \param event
-   * \param ni
+   * \param noiseInterferenceW noise and interference power at the start of the event
+   * \param first the first change which happens during the event
+   * \param last the change which marks the end of the event
    * \return the error rate of the packet
    */
-  double CalculatePer (Ptr<const Event> event, NiChanges *ni) const;
+  double CalculatePer (Ptr<const Event> event, double noiseInterferenceW,
+                       NiChanges::const_iterator first,
+                       NiChanges::const_iterator last) const;
+  /**
+   * Fold the changes which precede the given position into m_firstPower
+   * and drop them.
+   *
+   * \param end the first change to keep
+   */
+  void FoldNiChanges (NiChanges::iterator end);
 
   double m_noiseFigure; /**< noise figure (linear) */
   Ptr<ErrorRateModel> m_errorRateModel;
   /// Experimental: needed for energy duration calculation
   NiChanges m_niChanges;
+  /// power (W) observed once all the folded changes have happened
   double m_firstPower;
   bool m_rxing;
-  /// Returns an iterator to the first nichange, which is later than moment
-  NiChanges::iterator GetPosition (Time moment);
-  /**
-   * Add NiChange to the list at the appropriate position.
-   *
-   * \param change
-   */
-  void AddNiChangeEvent (NiChange change);
 };
 
 } // namespace ns3
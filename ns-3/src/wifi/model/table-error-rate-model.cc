@@ -0,0 +1,307 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "table-error-rate-model.h"
+#include "nist-error-rate-model.h"
+#include "ns3/double.h"
+#include "ns3/pointer.h"
+#include "ns3/log.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/multithreaded-simulator-impl.h"
+#endif
+#include <cmath>
+#include <map>
+#include <sstream>
+
+NS_LOG_COMPONENT_DEFINE ("TableErrorRateModel");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (TableErrorRateModel);
+
+/// The lowest SNR (dB) of the tables.
+static const double MIN_SNR_DB = -10.0;
+/// The highest SNR (dB) of the tables.
+static const double MAX_SNR_DB = 60.0;
+/// The initial spacing (dB) of the samples.
+static const double MAX_STEP_DB = 0.5;
+/// The spacing (dB) below which the tables are not refined.
+static const double MIN_STEP_DB = 1.0 / 1024;
+/// The largest chunk, in bits.
+static const double MAX_CHUNK_BITS = 65535 * 8.0;
+
+#ifdef HAVE_PTHREAD_H
+/// Protects the tables shared by the instances while the nodes run on several threads.
+static SystemMutex g_tablesMutex;
+#endif
+
+TypeId
+TableErrorRateModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TableErrorRateModel")
+    .SetParent<ErrorRateModel> ()
+    .AddConstructor<TableErrorRateModel> ()
+    .AddAttribute ("ErrorRateModel",
+                   "The error rate model to tabulate.",
+                   PointerValue (),
+                   MakePointerAccessor (&TableErrorRateModel::SetErrorRateModel,
+                                        &TableErrorRateModel::GetErrorRateModel),
+                   MakePointerChecker<ErrorRateModel> ())
+    .AddAttribute ("MaxError",
+                   "The largest error of the interpolated chunk success rates "
+                   "in the middle of the intervals of the tables.",
+                   DoubleValue (1e-6),
+                   MakeDoubleAccessor (&TableErrorRateModel::SetMaxError,
+                                       &TableErrorRateModel::GetMaxError),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+  ;
+  return tid;
+}
+
+TableErrorRateModel::TableErrorRateModel ()
+  : m_errorRateModel (0),
+    m_maxError (1e-6)
+{
+}
+
+TableErrorRateModel::~TableErrorRateModel ()
+{
+  m_errorRateModel = 0;
+  m_tables.clear ();
+}
+
+void
+TableErrorRateModel::SetErrorRateModel (Ptr<ErrorRateModel> model)
+{
+  m_errorRateModel = model;
+  m_tables.clear ();
+}
+
+void
+TableErrorRateModel::SetMaxError (double maxError)
+{
+  m_maxError = maxError;
+  m_tables.clear ();
+}
+
+double
+TableErrorRateModel::GetMaxError (void) const
+{
+  return m_maxError;
+}
+
+Ptr<ErrorRateModel>
+TableErrorRateModel::GetErrorRateModel (void) const
+{
+  if (m_errorRateModel == 0)
+    {
+      m_errorRateModel = CreateObject<NistErrorRateModel> ();
+    }
+  return m_errorRateModel;
+}
+
+double
+TableErrorRateModel::GetLogError (WifiMode mode, double snrDb) const
+{
+  double success = m_errorRateModel->GetChunkSuccessRate (mode, std::pow (10.0, snrDb / 10.0), 1);
+  return std::log (std::max (1.0 - success, 0.0));
+}
+
+bool
+TableErrorRateModel::IsInterpolated (const Table *table, uint32_t i)
+{
+  // the error rates saturate at 0 and 1 with a kink: the intervals which
+  // end on one are handed to the wrapped model.
+  double a = table->logError[i];
+  double b = table->logError[i + 1];
+  return a > table->noError && a < 0 && b > table->noError && b < 0;
+}
+
+double
+TableErrorRateModel::Interpolate (const Table *table, uint32_t i, double t)
+{
+  // the bit error rates span many orders of magnitude, which are
+  // sampled on a log scale of the SNR: interpolate the log of the error.
+  double a = table->logError[i];
+  double b = table->logError[i + 1];
+  return std::exp (a + t * (b - a));
+}
+
+double
+TableErrorRateModel::GetErrorBound (double exact, double approx)
+{
+  // with l and l' the logs of the success rates of a bit, the error of
+  // the success rate of n bits is below n * |l - l'| * exp (-n * c),
+  // with c = -max (l, l'), which is the largest for n = 1 / c.
+  double l = std::log (1.0 - exact);
+  double la = std::log (1.0 - approx);
+  double d = std::fabs (l - la);
+  double c = -std::max (l, la);
+  if (d == 0)
+    {
+      return 0;
+    }
+  double n = MAX_CHUNK_BITS;
+  if (c * n > 1.0)
+    {
+      n = std::max (1.0 / c, 1.0);
+    }
+  return n * d * std::exp (-n * c);
+}
+
+std::string
+TableErrorRateModel::GetModelKey (void) const
+{
+  std::ostringstream oss;
+  TypeId tid = m_errorRateModel->GetInstanceTypeId ();
+  TypeId nextTid = tid;
+  oss << tid.GetName ();
+  do
+    {
+      tid = nextTid;
+      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+        {
+          struct TypeId::AttributeInformation info = tid.GetAttribute (i);
+          if (!(info.flags & TypeId::ATTR_GET) || !info.accessor->HasGetter ())
+            {
+              continue;
+            }
+          Ptr<AttributeValue> value = info.checker->Create ();
+          m_errorRateModel->GetAttribute (info.name, *value);
+          oss << ";" << info.name << "=" << value->SerializeToString (info.checker);
+        }
+      nextTid = tid.GetParent ();
+    }
+  while (nextTid != tid);
+  return oss.str ();
+}
+
+Ptr<TableErrorRateModel::Table>
+TableErrorRateModel::BuildTable (WifiMode mode) const
+{
+  NS_LOG_FUNCTION (this << mode);
+  double step = MAX_STEP_DB;
+  uint32_t n = static_cast<uint32_t> ((MAX_SNR_DB - MIN_SNR_DB) / step) + 1;
+  std::vector<double> samples;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      samples.push_back (GetLogError (mode, MIN_SNR_DB + i * step));
+    }
+  Ptr<Table> table = Create<Table> ();
+  table->noError = std::log (0.0);
+  while (true)
+    {
+      table->invStep = 1.0 / step;
+      table->logError = samples;
+      // the samples at the middle of the intervals are the odd samples
+      // of the next table, if this one is not accurate enough.
+      std::vector<double> middles;
+      bool accurate = true;
+      for (uint32_t i = 0; i + 1 < samples.size (); i++)
+        {
+          double exact = GetLogError (mode, MIN_SNR_DB + (i + 0.5) * step);
+          middles.push_back (exact);
+          if (samples[i] == samples[i + 1] && !IsInterpolated (PeekPointer (table), i))
+            {
+              // never or always received
+              accurate = accurate && exact == samples[i];
+            }
+          else if (IsInterpolated (PeekPointer (table), i))
+            {
+              double error = GetErrorBound (std::exp (exact), Interpolate (PeekPointer (table), i, 0.5));
+              accurate = accurate && error <= m_maxError;
+            }
+        }
+      if (accurate || step <= MIN_STEP_DB)
+        {
+          NS_LOG_DEBUG ("mode=" << mode << " samples=" << samples.size () << " step=" << step << "dB accurate=" << accurate);
+          return table;
+        }
+      std::vector<double> refined;
+      for (uint32_t i = 0; i < middles.size (); i++)
+        {
+          refined.push_back (samples[i]);
+          refined.push_back (middles[i]);
+        }
+      refined.push_back (samples.back ());
+      samples.swap (refined);
+      step /= 2;
+    }
+}
+
+TableErrorRateModel::Table *
+TableErrorRateModel::GetTable (WifiMode mode) const
+{
+  uint32_t uid = mode.GetUid ();
+  if (uid < m_tables.size () && m_tables[uid] != 0)
+    {
+      return PeekPointer (m_tables[uid]);
+    }
+  GetErrorRateModel ();
+  typedef std::pair<std::pair<std::string, uint32_t>, double> Key;
+  static std::map<Key, Ptr<Table> > tables;
+  Key key = std::make_pair (std::make_pair (GetModelKey (), uid), m_maxError);
+  Ptr<Table> table;
+  {
+#ifdef HAVE_PTHREAD_H
+    ParallelCriticalSection cs (g_tablesMutex);
+#endif
+    std::map<Key, Ptr<Table> >::const_iterator i = tables.find (key);
+    if (i == tables.end ())
+      {
+        table = BuildTable (mode);
+        tables[key] = table;
+      }
+    else
+      {
+        table = i->second;
+      }
+  }
+  if (uid >= m_tables.size ())
+    {
+      m_tables.resize (uid + 1);
+    }
+  m_tables[uid] = table;
+  return PeekPointer (table);
+}
+
+double
+TableErrorRateModel::GetChunkSuccessRate (WifiMode mode, double snr, uint32_t nbits) const
+{
+  if (snr > 0)
+    {
+      const Table *table = GetTable (mode);
+      double x = (10.0 * std::log10 (snr) - MIN_SNR_DB) * table->invStep;
+      if (x >= 0 && x < table->logError.size () - 1)
+        {
+          uint32_t i = static_cast<uint32_t> (x);
+          if (IsInterpolated (table, i))
+            {
+              double ber = Interpolate (table, i, x - i);
+              return std::pow (1 - ber, static_cast<double> (nbits));
+            }
+          if (table->logError[i] == table->logError[i + 1])
+            {
+              // never or always received
+              return std::pow (1 - std::exp (table->logError[i]), static_cast<double> (nbits));
+            }
+        }
+    }
+  return GetErrorRateModel ()->GetChunkSuccessRate (mode, snr, nbits);
+}
+
+} // namespace ns3
@@ -0,0 +1,137 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TABLE_ERROR_RATE_MODEL_H
+#define TABLE_ERROR_RATE_MODEL_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "wifi-mode.h"
+#include "error-rate-model.h"
+#include "ns3/simple-ref-count.h"
+
+namespace ns3 {
+
+/**
+ * \brief Tabulate the chunk success rate of another error rate model.
+ * \ingroup wifi
+ *
+ * The error rate models of this module compute the success rate of a
+ * chunk of n bits as (1 - p(snr))^n, where p is the error rate of a
+ * single bit.  This model samples log(p) for each mode on a grid of SNR
+ * values evenly spaced in dB, and interpolates between the samples.  The grid
+ * of a mode is refined until the error of the interpolated chunk success
+ * rate at the middle of each interval, bounded over all the chunk sizes
+ * of up to 65535 bytes, is below the MaxError attribute.
+ *
+ * The tables are built the first time a mode is used, and are shared by
+ * all the TableErrorRateModel instances which wrap a model of the same
+ * TypeId and the same attribute values with the same MaxError: the wrapped
+ * model must be configured through its attributes, before its first use.
+ * SNR values outside of [-10, 60] dB are handed to the wrapped model.
+ */
+class TableErrorRateModel : public ErrorRateModel
+{
+public:
+  static TypeId GetTypeId (void);
+
+  TableErrorRateModel ();
+  virtual ~TableErrorRateModel ();
+
+  /**
+   * \param model the error rate model to tabulate.
+   */
+  void SetErrorRateModel (Ptr<ErrorRateModel> model);
+  /**
+   * \return the error rate model which is tabulated.  A
+   *         NistErrorRateModel is created if none was set.
+   */
+  Ptr<ErrorRateModel> GetErrorRateModel (void) const;
+  /**
+   * \param maxError the largest error of the interpolated chunk success
+   *        rates in the middle of the intervals of the tables.
+   */
+  void SetMaxError (double maxError);
+  /**
+   * \return the largest error of the interpolated chunk success rates in
+   *         the middle of the intervals of the tables.
+   */
+  double GetMaxError (void) const;
+
+  virtual double GetChunkSuccessRate (WifiMode mode, double snr, uint32_t nbits) const;
+
+private:
+  /**
+   * The samples of the error rate of a single bit for a mode.
+   */
+  struct Table : public SimpleRefCount<Table>
+  {
+    double invStep;                //!< number of samples per dB
+    double noError;                //!< the log of 0
+    std::vector<double> logError;  //!< log of the error rate of a bit
+  };
+
+  /**
+   * \param mode the mode of the chunk
+   * \return the table of the mode, built on first use
+   */
+  Table *GetTable (WifiMode mode) const;
+  /**
+   * \return the TypeId and the attribute values of the wrapped model,
+   *         which identify the tables it shares with other instances
+   */
+  std::string GetModelKey (void) const;
+  /**
+   * \param mode the mode to tabulate
+   * \return the table of the mode
+   */
+  Ptr<Table> BuildTable (WifiMode mode) const;
+  /**
+   * \param mode the mode of the bit
+   * \param snrDb the SNR (dB)
+   * \return the log of the error rate of a bit computed by the wrapped model
+   */
+  double GetLogError (WifiMode mode, double snrDb) const;
+  /**
+   * \param table the table to search
+   * \param i the index of the first sample of an interval
+   * \return true if the error rates of the interval can be interpolated
+   */
+  static bool IsInterpolated (const Table *table, uint32_t i);
+  /**
+   * \param table the table to search
+   * \param i the index of the first sample of the interval
+   * \param t the position in the interval, in [0, 1)
+   * \return the interpolated error rate of a bit
+   */
+  static double Interpolate (const Table *table, uint32_t i, double t);
+  /**
+   * \param exact the exact error rate of a bit
+   * \param approx the interpolated error rate of a bit
+   * \return a bound of the error of the chunk success rate, over all
+   *         the chunk sizes
+   */
+  static double GetErrorBound (double exact, double approx);
+
+  mutable Ptr<ErrorRateModel> m_errorRateModel; //!< the tabulated model
+  double m_maxError;                             //!< the accuracy of the tables
+  mutable std::vector<Ptr<Table> > m_tables;     //!< the tables, indexed by mode uid
+};
+
+} // namespace ns3
+
+#endif /* TABLE_ERROR_RATE_MODEL_H */
@@ -298,6 +298,14 @@ WifiRemoteStationManager::GetTypeId (void)
                    UintegerValue (0),
                    MakeUintegerAccessor (&WifiRemoteStationManager::m_defaultTxPowerLevel),
                    MakeUintegerChecker<uint8_t> ())
+    .AddAttribute ("StationLifetime", "The time after which the state of a remote station which was not "
+                   "used to send or receive any frame is forgotten, to bound the memory of the devices "
+                   "which see many transient peers (e.g., ad hoc vehicular networks). Forgetting a station "
+                   "also forgets its association state, so this should be left to zero (never forget) "
+                   "on infrastructure networks.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&WifiRemoteStationManager::m_stationLifetime),
+                   MakeTimeChecker ())
     .AddTraceSource ("MacTxRtsFailed",
                      "The transmission of a RTS by the MAC layer has failed",
                      MakeTraceSourceAccessor (&WifiRemoteStationManager::m_macTxRtsFailed))
@@ -315,6 +323,7 @@ WifiRemoteStationManager::GetTypeId (void)
 }
 
 WifiRemoteStationManager::WifiRemoteStationManager ()
+  : m_nextEviction (Seconds (0))
 {
 }
 
@@ -326,12 +335,12 @@ WifiRemoteStationManager::DoDispose (void)
 {
   for (StationStates::const_iterator i = m_states.begin (); i != m_states.end (); i++)
     {
-      delete (*i);
+      delete i->second;
     }
   m_states.clear ();
   for (Stations::const_iterator i = m_stations.begin (); i != m_stations.end (); i++)
     {
-      delete (*i);
+      delete i->second;
     }
   m_stations.clear ();
 }
@@ -1135,12 +1144,15 @@ WifiRemoteStationManager::GetInfo (Mac48Address address)
 WifiRemoteStationState *
 WifiRemoteStationManager::LookupState (Mac48Address address) const
 {
-  for (StationStates::const_iterator i = m_states.begin (); i != m_states.end (); i++)
+  StationStates::const_iterator i = m_states.find (address);
+  if (i != m_states.end ())
     {
-      if ((*i)->m_address == address)
-        {
-          return (*i);
-        }
+      i->second->m_lastUse = Simulator::Now ();
+      return i->second;
+    }
+  if (!m_stationLifetime.IsZero () && Simulator::Now () >= m_nextEviction)
+    {
+      const_cast<WifiRemoteStationManager *> (this)->EvictStations ();
     }
   WifiRemoteStationState *state = new WifiRemoteStationState ();
   state->m_state = WifiRemoteStationState::BRAND_NEW;
@@ -1152,7 +1164,8 @@ WifiRemoteStationManager::LookupState (Mac48Address address) const
   state->m_rx=1;
   state->m_tx=1;
   state->m_stbc=false;
-  const_cast<WifiRemoteStationManager *> (this)->m_states.push_back (state);
+  state->m_lastUse = Simulator::Now ();
+  const_cast<WifiRemoteStationManager *> (this)->m_states[address] = state;
   return state;
 }
 WifiRemoteStation *
@@ -1172,13 +1185,11 @@ WifiRemoteStationManager::Lookup (Mac48Address address, const WifiMacHeader *hea
 WifiRemoteStation *
 WifiRemoteStationManager::Lookup (Mac48Address address, uint8_t tid) const
 {
-  for (Stations::const_iterator i = m_stations.begin (); i != m_stations.end (); i++)
+  Stations::const_iterator i = m_stations.find (StationKey (address, tid));
+  if (i != m_stations.end ())
     {
-      if ((*i)->m_tid == tid
-          && (*i)->m_state->m_address == address)
-        {
-          return (*i);
-        }
+      i->second->m_state->m_lastUse = Simulator::Now ();
+      return i->second;
     }
   WifiRemoteStationState *state = LookupState (address);
 
@@ -1188,10 +1199,49 @@ WifiRemoteStationManager::Lookup (Mac48Address address, uint8_t tid) const
   station->m_ssrc = 0;
   station->m_slrc = 0;
   // XXX
-  const_cast<WifiRemoteStationManager *> (this)->m_stations.push_back (station);
+  const_cast<WifiRemoteStationManager *> (this)->m_stations[StationKey (address, tid)] = station;
   return station;
 
 }
+void
+WifiRemoteStationManager::EvictStations (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now ();
+  for (Stations::iterator i = m_stations.begin (); i != m_stations.end (); )
+    {
+      if (now - i->second->m_state->m_lastUse > m_stationLifetime)
+        {
+          delete i->second;
+          m_stations.erase (i++);
+        }
+      else
+        {
+          i++;
+        }
+    }
+  for (StationStates::iterator i = m_states.begin (); i != m_states.end (); )
+    {
+      if (now - i->second->m_lastUse > m_stationLifetime)
+        {
+          NS_LOG_DEBUG ("forget station " << i->first);
+          delete i->second;
+          m_states.erase (i++);
+        }
+      else
+        {
+          i++;
+        }
+    }
+  // sweep at most twice per lifetime so that the cost of the sweeps
+  // stays proportional to the number of new stations.
+  m_nextEviction = now + m_stationLifetime / 2;
+}
+size_t
+WifiRemoteStationManager::StationKeyHash::operator() (StationKey const &key) const
+{
+  return Mac48AddressHash () (key.first) * 16 + key.second;
+}
 //Used by all stations to record HT capabilities of remote stations
 void
 WifiRemoteStationManager::AddStationHtCapabilities (Mac48Address from, HtCapabilities htcapabilities)
@@ -1223,7 +1273,7 @@ WifiRemoteStationManager::Reset (void)
 {
   for (Stations::const_iterator i = m_stations.begin (); i != m_stations.end (); i++)
     {
-      delete (*i);
+      delete i->second;
     }
   m_stations.clear ();
   m_bssBasicRateSet.clear ();
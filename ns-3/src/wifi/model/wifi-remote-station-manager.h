@@ -23,6 +23,7 @@
 #include <vector>
 #include <utility>
 #include "ns3/mac48-address.h"
+#include "ns3/sgi-hashmap.h"
 #include "ns3/traced-callback.h"
 #include "ns3/packet.h"
 #include "ns3/object.h"
@@ -875,16 +876,40 @@ private:
   uint32_t GetNFragments (const WifiMacHeader *header, Ptr<const Packet> packet);
 
   /**
-   * A vector of WifiRemoteStations
+   * Forget the stations which were not looked up during the last
+   * StationLifetime.
    */
-  typedef std::vector <WifiRemoteStation *> Stations;
+  void EvictStations (void);
+
+  /**
+   * The key of a WifiRemoteStation: its address and TID
+   */
+  typedef std::pair<Mac48Address, uint8_t> StationKey;
+  /**
+   * Class providing an hash for StationKey
+   */
+  class StationKeyHash : public std::unary_function<StationKey, size_t>
+  {
+public:
+    /**
+     * \param key the key
+     * \return the hash of the key
+     */
+    size_t operator() (StationKey const &key) const;
+  };
+  /**
+   * A hash table of WifiRemoteStations, indexed by address and TID
+   */
+  typedef sgi::hash_map<StationKey, WifiRemoteStation *, StationKeyHash> Stations;
   /**
-   * A vector of WifiRemoteStationStates
+   * A hash table of WifiRemoteStationStates, indexed by address
    */
-  typedef std::vector <WifiRemoteStationState *> StationStates;
+  typedef sgi::hash_map<Mac48Address, WifiRemoteStationState *, Mac48AddressHash> StationStates;
 
   StationStates m_states;  //!< States of known stations
   Stations m_stations;  //!< Information for each known stations
+  Time m_stationLifetime;  //!< Time after which the unused stations are forgotten (0 to never forget them)
+  Time m_nextEviction;  //!< Time after which the next new station looks for unused ones
   /**
    * This is a pointer to the WifiPhy associated with this
    * WifiRemoteStationManager that is set on call to
@@ -971,6 +996,7 @@ struct WifiRemoteStationState
   uint32_t m_tx;  //!< Number of TX antennae of the remote station
   bool m_stbc;  //!< Flag if STBC is used by the remote station
   bool m_greenfield;  //!< Flag if green field is used by the remote station
+  Time m_lastUse;  //!< Last time the station was looked up, to send to or receive from it
 
 };
 
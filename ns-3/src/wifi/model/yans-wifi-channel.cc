@@ -24,11 +24,20 @@
 #include "ns3/node.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
 #include "ns3/object-factory.h"
 #include "yans-wifi-channel.h"
 #include "yans-wifi-phy.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/propagation-delay-model.h"
+#include "ns3/constant-position-mobility-model.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/multithreaded-simulator-impl.h"
+#endif
+#include <algorithm>
+#include <cmath>
 
 NS_LOG_COMPONENT_DEFINE ("YansWifiChannel");
 
@@ -50,16 +59,69 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("MaxRange",
+                   "Distance (meters) beyond which PHYs cannot receive the transmissions of this channel. "
+                   "A positive value enables a spatial grid index so that only the PHYs located near the "
+                   "sender are evaluated; 0 evaluates every PHY attached to the channel.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_maxRange),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("PropagationCache",
+                   "Whether the loss and the delay computed by the propagation models are cached for each "
+                   "(sender, receiver) pair. Only for deterministic propagation models.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansWifiChannel::m_cacheEnabled),
+                   MakeBooleanChecker ())
+    .AddAttribute ("PropagationCacheThreshold",
+                   "Distance (meters) either end of a pair may move, without changing course, before its cached "
+                   "propagation is recomputed. With 0, the cached propagation is used only while neither end moved.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_cacheThreshold),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("PropagationCacheSize",
+                   "The number of (sender, receiver) pairs the propagation cache can hold: a pair replaces "
+                   "the pair stored in the same slot of the cache.",
+                   UintegerValue (65536),
+                   MakeUintegerAccessor (&YansWifiChannel::m_cacheSize),
+                   MakeUintegerChecker<uint32_t> (1))
   ;
   return tid;
 }
 
+YansWifiChannel::PartitionState::PartitionState ()
+  : partition (0xffffffff),
+    gridDirty (true),
+    gridCourses (0),
+    gridMaxSpeed (0.0),
+    courseChanges (0),
+    nReceptions (0),
+    nPacketCopies (0),
+    nCacheHits (0),
+    nCacheMisses (0),
+    late (false)
+{
+}
+
 YansWifiChannel::YansWifiChannel ()
+  : m_partitionsDirty (true),
+    m_maxRange (0.0),
+    m_states (1),
+    m_cacheEnabled (false),
+    m_cacheThreshold (0.0),
+    m_cacheSize (65536)
 {
 }
 YansWifiChannel::~YansWifiChannel ()
 {
   NS_LOG_FUNCTION_NOARGS ();
+  for (Tracked::const_iterator i = m_tracked.begin (); i != m_tracked.end (); i++)
+    {
+      i->first->TraceDisconnectWithoutContext ("CourseChange",
+                                              MakeCallback (&YansWifiChannel::NotifyCourseChange, this));
+    }
+  m_tracked.clear ();
+  m_states.clear ();
+  m_phyIndex.clear ();
   m_phyList.clear ();
 }
 
@@ -80,45 +142,526 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
 {
   Ptr<MobilityModel> senderMobility = sender->GetMobility ()->GetObject<MobilityModel> ();
   NS_ASSERT (senderMobility != 0);
-  uint32_t j = 0;
-  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++, j++)
+  std::map<Ptr<YansWifiPhy>, uint32_t>::const_iterator index = m_phyIndex.find (sender);
+  NS_ASSERT_MSG (index != m_phyIndex.end (), "The sender is not attached to this channel");
+  if (m_detached[index->second])
+    {
+      NS_LOG_DEBUG ("PHY " << index->second << " is detached: the packet is lost");
+      return;
+    }
+  Transmission tx;
+  tx.sender = index->second;
+  tx.senderPosition = senderMobility->GetPosition ();
+  tx.senderCourse = m_cacheEnabled ? Track (senderMobility) : 0;
+  tx.channelNumber = sender->GetChannelNumber ();
+  tx.elapsed = Seconds (0);
+  tx.txPowerDbm = txPowerDbm;
+  tx.txVector = txVector;
+  tx.preamble = preamble;
+#ifdef HAVE_PTHREAD_H
+  if (MultithreadedSimulatorImpl::IsParallel ())
+    {
+      SendParallel (senderMobility, packet, tx);
+      return;
+    }
+#endif
+  // A single copy, isolated from the sender, shared by all the receivers;
+  // each PHY copies it again only if it synchronizes on it.
+  ScheduleReceptions (GetState (), senderMobility, packet->Copy (), tx);
+}
+
+void
+YansWifiChannel::ScheduleReceptions (PartitionState &state, Ptr<MobilityModel> senderMobility,
+                                     Ptr<const Packet> packet, const Transmission &tx) const
+{
+  if (m_maxRange > 0.0)
     {
-      if (sender != (*i))
+      std::vector<uint32_t> candidates;
+      FindCandidates (state, tx.senderPosition, candidates);
+      for (std::vector<uint32_t>::const_iterator i = candidates.begin (); i != candidates.end (); i++)
         {
-          // For now don't account for inter channel interference
-          if ((*i)->GetChannelNumber () != sender->GetChannelNumber ())
+          if (*i == tx.sender || m_detached[*i]
+              || m_phyList[*i]->GetChannelNumber () != tx.channelNumber)
             {
               continue;
             }
+          Ptr<MobilityModel> receiverMobility = m_phyList[*i]->GetMobility ()->GetObject<MobilityModel> ();
+          if (CalculateDistance (tx.senderPosition, receiverMobility->GetPosition ()) > m_maxRange)
+            {
+              continue;
+            }
+          ScheduleReceive (state, *i, senderMobility, packet, tx);
+        }
+      return;
+    }
+  for (uint32_t i = 0; i < m_phyList.size (); i++)
+    {
+#ifdef HAVE_PTHREAD_H
+      if (state.partition != 0xffffffff
+          && (i >= m_phyPartitions.size () || m_phyPartitions[i] != state.partition))
+        {
+          continue;
+        }
+#endif
+      // For now don't account for inter channel interference
+      if (i != tx.sender && !m_detached[i] && m_phyList[i]->GetChannelNumber () == tx.channelNumber)
+        {
+          ScheduleReceive (state, i, senderMobility, packet, tx);
+        }
+    }
+}
+
+void
+YansWifiChannel::ScheduleReceive (PartitionState &state, uint32_t i, Ptr<MobilityModel> senderMobility,
+                                  Ptr<const Packet> packet, const Transmission &tx) const
+{
+  Ptr<MobilityModel> receiverMobility = m_phyList[i]->GetMobility ()->GetObject<MobilityModel> ();
+  Time delay;
+  double rxPowerDbm;
+  GetPropagation (state, tx, senderMobility, i, receiverMobility, rxPowerDbm, delay);
+  NS_LOG_DEBUG ("propagation: txPower=" << tx.txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
+                "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
+  Ptr<Object> dstNetDevice = m_phyList[i]->GetDevice ();
+  uint32_t dstNode;
+  if (dstNetDevice == 0)
+    {
+      dstNode = 0xffffffff;
+    }
+  else
+    {
+      dstNode = dstNetDevice->GetObject<NetDevice> ()->GetNode ()->GetId ();
+    }
+  if (delay < tx.elapsed)
+    {
+      NS_LOG_WARN ("PHY " << i << " receives " << (tx.elapsed - delay) << " late: it is closer to the sender "
+                   "than the lookahead of the simulator, until the next call to PreparePartitions");
+      delay = tx.elapsed;
+      state.late = true;
+    }
+  state.nReceptions++;
+  Simulator::ScheduleWithContext (dstNode,
+                                  delay - tx.elapsed, &YansWifiChannel::Receive, this,
+                                  i, packet, rxPowerDbm, tx.txVector, tx.preamble);
+}
+
+void
+YansWifiChannel::GetPropagation (PartitionState &state, const Transmission &tx, Ptr<MobilityModel> senderMobility,
+                                 uint32_t receiver, Ptr<MobilityModel> receiverMobility,
+                                 double &rxPowerDbm, Time &delay) const
+{
+  if (!m_cacheEnabled)
+    {
+      CalcPropagation (senderMobility, receiverMobility, tx.txPowerDbm, rxPowerDbm, delay);
+      return;
+    }
+  if (state.cache.size () != m_cacheSize)
+    {
+      PropagationEntry empty;
+      empty.sender = 0xffffffff;
+      state.cache.assign (m_cacheSize, empty);
+    }
+  uint32_t receiverCourse = Track (receiverMobility);
+  Vector receiverPosition = receiverMobility->GetPosition ();
+  PropagationEntry &entry = state.cache[(static_cast<uint64_t> (tx.sender) * 2654435761U + receiver) % m_cacheSize];
+  if (entry.sender == tx.sender
+      && entry.receiver == receiver
+      && entry.senderCourse == tx.senderCourse
+      && entry.receiverCourse == receiverCourse
+      && entry.txPowerDbm == tx.txPowerDbm
+      && CalculateDistance (entry.senderPosition, tx.senderPosition) <= m_cacheThreshold
+      && CalculateDistance (entry.receiverPosition, receiverPosition) <= m_cacheThreshold)
+    {
+      state.nCacheHits++;
+      delay = entry.delay;
+      rxPowerDbm = entry.rxPowerDbm;
+      return;
+    }
+  if (!m_loss->IsDeterministic () || !m_delay->IsDeterministic ())
+    {
+      NS_FATAL_ERROR ("The PropagationCache of a YansWifiChannel requires deterministic propagation models");
+    }
+  state.nCacheMisses++;
+  CalcPropagation (senderMobility, receiverMobility, tx.txPowerDbm, rxPowerDbm, delay);
+  entry.sender = tx.sender;
+  entry.receiver = receiver;
+  entry.senderPosition = tx.senderPosition;
+  entry.receiverPosition = receiverPosition;
+  entry.senderCourse = tx.senderCourse;
+  entry.receiverCourse = receiverCourse;
+  entry.txPowerDbm = tx.txPowerDbm;
+  entry.rxPowerDbm = rxPowerDbm;
+  entry.delay = delay;
+}
+
+void
+YansWifiChannel::CalcPropagation (Ptr<MobilityModel> senderMobility, Ptr<MobilityModel> receiverMobility,
+                                  double txPowerDbm, double &rxPowerDbm, Time &delay) const
+{
+#ifdef HAVE_PTHREAD_H
+  if (MultithreadedSimulatorImpl::IsParallel ()
+      && (!m_loss->IsDeterministic () || !m_delay->IsDeterministic ()))
+    {
+      CriticalSection cs (m_mutex);
+      delay = m_delay->GetDelay (senderMobility, receiverMobility);
+      rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
+      return;
+    }
+#endif
+  delay = m_delay->GetDelay (senderMobility, receiverMobility);
+  rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
+}
+
+uint32_t
+YansWifiChannel::Track (Ptr<MobilityModel> mobility) const
+{
+  Tracked::const_iterator i = m_tracked.find (mobility);
+  if (i != m_tracked.end ())
+    {
+      return i->second;
+    }
+#ifdef HAVE_PTHREAD_H
+  NS_ASSERT_MSG (!MultithreadedSimulatorImpl::IsParallel (),
+                 "YansWifiChannel::PreparePartitions was not called since a PHY was added");
+#endif
+  mobility->TraceConnectWithoutContext ("CourseChange",
+                                        MakeCallback (&YansWifiChannel::NotifyCourseChange, this));
+  m_tracked[mobility] = 0;
+  return 0;
+}
+
+YansWifiChannel::PartitionState &
+YansWifiChannel::GetState (void) const
+{
+#ifdef HAVE_PTHREAD_H
+  if (MultithreadedSimulatorImpl::IsParallel ())
+    {
+      NS_ASSERT_MSG (m_states.size () > 1,
+                     "YansWifiChannel::PreparePartitions was not called before the parallel simulation");
+      return m_states[1 + Simulator::GetSystemId ()];
+    }
+#endif
+  return m_states.front ();
+}
+
+uint64_t
+YansWifiChannel::GetCourseChanges (const PartitionState &state) const
+{
+  if (state.partition != 0xffffffff)
+    {
+      // the PHYs of a partition only change course on its own thread, or
+      // while the partitions do not run (see NotifyCourseChange).
+      return state.courseChanges;
+    }
+  uint64_t courseChanges = 0;
+  for (std::vector<PartitionState>::const_iterator i = m_states.begin (); i != m_states.end (); i++)
+    {
+      courseChanges += i->courseChanges;
+    }
+  return courseChanges;
+}
+
+YansWifiChannel::GridCell
+YansWifiChannel::GetGridCell (const Vector &position) const
+{
+  return GridCell (static_cast<int64_t> (std::floor (position.x / m_maxRange)),
+                   static_cast<int64_t> (std::floor (position.y / m_maxRange)));
+}
+
+void
+YansWifiChannel::RebuildGrid (PartitionState &state) const
+{
+  NS_LOG_FUNCTION (this << state.partition);
+  state.grid.clear ();
+  state.gridMaxSpeed = 0.0;
+  for (uint32_t i = 0; i < m_phyList.size (); i++)
+    {
+#ifdef HAVE_PTHREAD_H
+      if (state.partition != 0xffffffff
+          && (i >= m_phyPartitions.size () || m_phyPartitions[i] != state.partition))
+        {
+          continue;
+        }
+#endif
+      if (m_detached[i])
+        {
+          continue;
+        }
+      Ptr<MobilityModel> mobility = m_phyList[i]->GetMobility ()->GetObject<MobilityModel> ();
+      NS_ASSERT (mobility != 0);
+      Track (mobility);
+      Vector velocity = mobility->GetVelocity ();
+      double speed = std::sqrt (velocity.x * velocity.x + velocity.y * velocity.y);
+      state.gridMaxSpeed = std::max (state.gridMaxSpeed, speed);
+      state.grid[GetGridCell (mobility->GetPosition ())].push_back (i);
+    }
+  state.gridTime = Simulator::Now ();
+  state.gridCourses = GetCourseChanges (state);
+  state.gridDirty = false;
+}
+
+void
+YansWifiChannel::FindCandidates (PartitionState &state, const Vector &position, std::vector<uint32_t> &candidates) const
+{
+  // The PHYs moved by at most gridMaxSpeed * elapsed since they were
+  // binned, as long as none of them changed course in the meantime.
+  double drift = state.gridMaxSpeed * (Simulator::Now () - state.gridTime).GetSeconds ();
+  if (state.gridDirty || state.gridCourses != GetCourseChanges (state) || drift > m_maxRange / 2)
+    {
+      RebuildGrid (state);
+      drift = 0.0;
+    }
+  GridCell low = GetGridCell (Vector (position.x - m_maxRange - drift, position.y - m_maxRange - drift, 0.0));
+  GridCell high = GetGridCell (Vector (position.x + m_maxRange + drift, position.y + m_maxRange + drift, 0.0));
+  for (int64_t x = low.first; x <= high.first; x++)
+    {
+      Grid::const_iterator cell = state.grid.lower_bound (GridCell (x, low.second));
+      for (; cell != state.grid.end () && cell->first.first == x && cell->first.second <= high.second; cell++)
+        {
+          candidates.insert (candidates.end (), cell->second.begin (), cell->second.end ());
+        }
+    }
+  // keep the receive events in the same order as the full scan
+  std::sort (candidates.begin (), candidates.end ());
+}
+
+void
+YansWifiChannel::NotifyCourseChange (Ptr<const MobilityModel> mobility) const
+{
+  Tracked::iterator i = m_tracked.find (ConstCast<MobilityModel> (mobility));
+  if (i != m_tracked.end ())
+    {
+      i->second++;
+    }
+#ifdef HAVE_PTHREAD_H
+  MultithreadedSimulatorImpl *impl = MultithreadedSimulatorImpl::PeekRunning ();
+  if (impl != 0 && impl->GetSystemId () < impl->GetNPartitions ())
+    {
+      // the PHY belongs to the partition of this thread.
+      GetState ().courseChanges++;
+      return;
+    }
+#endif
+  for (std::vector<PartitionState>::iterator j = m_states.begin (); j != m_states.end (); j++)
+    {
+      j->courseChanges++;
+    }
+}
+
+void
+YansWifiChannel::Receive (uint32_t i, Ptr<const Packet> packet, double rxPowerDbm,
+                          WifiTxVector txVector, WifiPreamble preamble) const
+{
+  if (m_phyList[i]->StartReceivePacket (packet, rxPowerDbm, txVector, preamble))
+    {
+      GetState ().nPacketCopies++;
+    }
+}
+
+void
+YansWifiChannel::PreparePartitions (void)
+{
+  NS_LOG_FUNCTION (this);
+#ifdef HAVE_PTHREAD_H
+  NS_ASSERT_MSG (!MultithreadedSimulatorImpl::IsParallel () || Simulator::GetContext () == 0xffffffff,
+                 "The partitions of the channel can only change while the nodes do not run");
+  Ptr<MultithreadedSimulatorImpl> impl = DynamicCast<MultithreadedSimulatorImpl> (Simulator::GetImplementation ());
+  for (uint32_t i = m_phyNodes.size (); i < m_phyList.size (); i++)
+    {
+      Ptr<Object> device = m_phyList[i]->GetDevice ();
+      m_phyNodes.push_back (device == 0 ? 0xffffffff : device->GetObject<NetDevice> ()->GetNode ()->GetId ());
+      // the partitions cannot subscribe to the CourseChange while they run.
+      Ptr<MobilityModel> mobility = m_phyList[i]->GetMobility ()->GetObject<MobilityModel> ();
+      NS_ASSERT_MSG (mobility != 0, "The PHY " << i << " has no MobilityModel");
+      Track (mobility);
+    }
+  uint32_t nPartitions = impl == 0 ? 0 : impl->GetNPartitions ();
+  std::vector<uint32_t> phyPartitions;
+  for (uint32_t i = 0; i < m_phyNodes.size (); i++)
+    {
+      phyPartitions.push_back (impl == 0 ? 0 : impl->GetPartition (m_phyNodes[i]));
+    }
+  bool late = false;
+  for (std::vector<PartitionState>::iterator i = m_states.begin (); i != m_states.end (); i++)
+    {
+      late = late || i->late;
+      i->late = false;
+    }
+  if (!m_partitionsDirty && !late && phyPartitions == m_phyPartitions
+      && m_partitionPhys.size () == nPartitions + 1)
+    {
+      return;
+    }
+  m_partitionsDirty = false;
+  m_phyPartitions.swap (phyPartitions);
+  m_partitionPhys.assign (nPartitions + 1, 0xffffffff);
+  for (uint32_t i = 0; i < m_phyNodes.size (); i++)
+    {
+      if (!m_detached[i] && m_partitionPhys[m_phyPartitions[i]] == 0xffffffff)
+        {
+          m_partitionPhys[m_phyPartitions[i]] = i;
+        }
+    }
+  if (impl == 0)
+    {
+      return;
+    }
+  // the sequential state, then one state per partition, the global one included.
+  m_states.resize (nPartitions + 2);
+  for (uint32_t i = 0; i < m_states.size (); i++)
+    {
+      m_states[i].gridDirty = true;
+      if (i > 0)
+        {
+          m_states[i].partition = i - 1;
+          if (m_states[i].remoteSender == 0)
+            {
+              m_states[i].remoteSender = CreateObject<ConstantPositionMobilityModel> ();
+            }
+        }
+    }
+  LimitLookahead (impl);
+#endif
+}
 
-          Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
-          Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
-          double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
-          NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
-                        "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
-          Ptr<Packet> copy = packet->Copy ();
-          Ptr<Object> dstNetDevice = m_phyList[j]->GetDevice ();
-          uint32_t dstNode;
-          if (dstNetDevice == 0)
+#ifdef HAVE_PTHREAD_H
+void
+YansWifiChannel::LimitLookahead (Ptr<MultithreadedSimulatorImpl> impl) const
+{
+  if (!m_delay->IsDeterministic ())
+    {
+      NS_LOG_WARN ("The lookahead cannot be derived from a random propagation delay model: "
+                   "the receptions shorter than the lookahead of the simulator are late");
+      impl->UnlimitLookahead (this);
+      return;
+    }
+  std::vector<uint32_t> all;
+  for (uint32_t j = 0; j < m_phyNodes.size (); j++)
+    {
+      all.push_back (j);
+    }
+  bool found = false;
+  Time shortest;
+  for (uint32_t i = 0; i < m_phyNodes.size (); i++)
+    {
+      if (m_detached[i])
+        {
+          continue;
+        }
+      Ptr<MobilityModel> mobility = m_phyList[i]->GetMobility ()->GetObject<MobilityModel> ();
+      std::vector<uint32_t> candidates;
+      if (m_maxRange > 0.0)
+        {
+          FindCandidates (m_states.front (), mobility->GetPosition (), candidates);
+        }
+      const std::vector<uint32_t> &others = m_maxRange > 0.0 ? candidates : all;
+      for (std::vector<uint32_t>::const_iterator j = others.begin (); j != others.end (); j++)
+        {
+          if (*j >= m_phyNodes.size () || m_detached[*j] || m_phyPartitions[*j] == m_phyPartitions[i])
+            {
+              continue;
+            }
+          Ptr<MobilityModel> other = m_phyList[*j]->GetMobility ()->GetObject<MobilityModel> ();
+          if (m_maxRange > 0.0 && mobility->GetDistanceFrom (other) > m_maxRange)
             {
-              dstNode = 0xffffffff;
+              continue;
             }
-          else
+          Time delay = m_delay->GetDelay (mobility, other);
+          if (!found || delay < shortest)
             {
-              dstNode = dstNetDevice->GetObject<NetDevice> ()->GetNode ()->GetId ();
+              shortest = delay;
+              found = true;
             }
-          Simulator::ScheduleWithContext (dstNode,
-                                          delay, &YansWifiChannel::Receive, this,
-                                          j, copy, rxPowerDbm, txVector, preamble);
         }
     }
+  if (found)
+    {
+      NS_LOG_DEBUG ("shortest delay between two partitions: " << shortest);
+      if (shortest.IsZero ())
+        {
+          NS_LOG_WARN ("Two PHYs of distinct partitions share a position: their receptions are one time step late");
+        }
+      impl->LimitLookahead (this, shortest);
+    }
+  else
+    {
+      impl->UnlimitLookahead (this);
+    }
 }
 
 void
-YansWifiChannel::Receive (uint32_t i, Ptr<Packet> packet, double rxPowerDbm,
-                          WifiTxVector txVector, WifiPreamble preamble) const
+YansWifiChannel::SendParallel (Ptr<MobilityModel> senderMobility, Ptr<const Packet> packet, Transmission tx) const
+{
+  NS_ASSERT_MSG (tx.sender < m_phyNodes.size (),
+                 "YansWifiChannel::PreparePartitions was not called since the sender was added");
+  MultithreadedSimulatorImpl *impl = MultithreadedSimulatorImpl::PeekRunning ();
+  uint32_t local = Simulator::GetSystemId ();
+  ScheduleReceptions (m_states[1 + local], senderMobility, packet->Copy (), tx);
+  tx.elapsed = impl->GetLookahead ();
+  for (uint32_t partition = 0; partition < m_partitionPhys.size (); partition++)
+    {
+      uint32_t first = m_partitionPhys[partition];
+      if (partition == local || first == 0xffffffff)
+        {
+          continue;
+        }
+      // the first PHY of the partition gives its context to the event.
+      Simulator::ScheduleWithContext (m_phyNodes[first], tx.elapsed,
+                                      &YansWifiChannel::Deliver, this,
+                                      Ptr<const Packet> (packet->CopyUnshared ()), tx);
+    }
+}
+
+void
+YansWifiChannel::Deliver (Ptr<const Packet> packet, Transmission tx) const
+{
+  PartitionState &state = GetState ();
+  state.remoteSender->SetPosition (tx.senderPosition);
+  ScheduleReceptions (state, state.remoteSender, packet, tx);
+}
+#endif
+
+uint64_t
+YansWifiChannel::GetNReceptions (void) const
+{
+  uint64_t nReceptions = 0;
+  for (std::vector<PartitionState>::const_iterator i = m_states.begin (); i != m_states.end (); i++)
+    {
+      nReceptions += i->nReceptions;
+    }
+  return nReceptions;
+}
+
+uint64_t
+YansWifiChannel::GetNPacketCopies (void) const
+{
+  uint64_t nPacketCopies = 0;
+  for (std::vector<PartitionState>::const_iterator i = m_states.begin (); i != m_states.end (); i++)
+    {
+      nPacketCopies += i->nPacketCopies;
+    }
+  return nPacketCopies;
+}
+
+uint64_t
+YansWifiChannel::GetNCacheHits (void) const
+{
+  uint64_t nCacheHits = 0;
+  for (std::vector<PartitionState>::const_iterator i = m_states.begin (); i != m_states.end (); i++)
+    {
+      nCacheHits += i->nCacheHits;
+    }
+  return nCacheHits;
+}
+
+uint64_t
+YansWifiChannel::GetNCacheMisses (void) const
 {
-  m_phyList[i]->StartReceivePacket (packet, rxPowerDbm, txVector, preamble);
+  uint64_t nCacheMisses = 0;
+  for (std::vector<PartitionState>::const_iterator i = m_states.begin (); i != m_states.end (); i++)
+    {
+      nCacheMisses += i->nCacheMisses;
+    }
+  return nCacheMisses;
 }
 
 uint32_t
@@ -135,7 +678,32 @@ YansWifiChannel::GetDevice (uint32_t i) const
 void
 YansWifiChannel::Add (Ptr<YansWifiPhy> phy)
 {
+  m_phyIndex[phy] = m_phyList.size ();
   m_phyList.push_back (phy);
+  m_detached.push_back (false);
+  m_partitionsDirty = true;
+  for (std::vector<PartitionState>::iterator i = m_states.begin (); i != m_states.end (); i++)
+    {
+      i->gridDirty = true;
+    }
+}
+
+void
+YansWifiChannel::Detach (Ptr<YansWifiPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+#ifdef HAVE_PTHREAD_H
+  NS_ASSERT_MSG (!MultithreadedSimulatorImpl::IsParallel () || Simulator::GetContext () == 0xffffffff,
+                 "The PHYs can only be detached while the nodes do not run");
+#endif
+  std::map<Ptr<YansWifiPhy>, uint32_t>::const_iterator index = m_phyIndex.find (phy);
+  NS_ASSERT_MSG (index != m_phyIndex.end (), "The PHY is not attached to this channel");
+  m_detached[index->second] = true;
+  m_partitionsDirty = true;
+  for (std::vector<PartitionState>::iterator i = m_states.begin (); i != m_states.end (); i++)
+    {
+      i->gridDirty = true;
+    }
 }
 
 int64_t
@@ -21,8 +21,15 @@
 #define YANS_WIFI_CHANNEL_H
 
 #include <vector>
+#include <map>
 #include <stdint.h>
 #include "ns3/packet.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-mutex.h"
+#endif
 #include "wifi-channel.h"
 #include "wifi-mode.h"
 #include "wifi-preamble.h"
@@ -31,9 +38,11 @@
 namespace ns3 {
 
 class NetDevice;
+class MobilityModel;
 class PropagationLossModel;
 class PropagationDelayModel;
 class YansWifiPhy;
+class MultithreadedSimulatorImpl;
 
 /**
  * \brief A Yans wifi channel
@@ -46,6 +55,64 @@ class YansWifiPhy;
  * class and contains a ns3::PropagationLossModel and a ns3::PropagationDelayModel.
  * By default, no propagation models are set so, it is the caller's responsability
  * to set them before using the channel.
+ *
+ * When the MaxRange attribute is set to a positive value, the channel keeps
+ * a uniform grid of the PHY positions (cells of MaxRange meters on the x/y
+ * plane) and only evaluates the propagation models for the PHYs found in
+ * the cells around the sender; PHYs further than MaxRange from the sender
+ * do not receive the packet at all. MaxRange should thus match the range
+ * beyond which the loss model makes reception impossible (e.g., the MaxRange
+ * of a ns3::RangePropagationLossModel). The grid is rebuilt lazily, on the
+ * first transmission following a CourseChange of any PHY, or when the
+ * displacement of the PHYs since the last rebuild (bounded by their speed)
+ * exceeds half a cell.
+ *
+ * A transmission is copied once by the channel, and this copy is shared
+ * by all the receive events: a YansWifiPhy only takes its own copy of the
+ * packet when it synchronizes on it, which is the first time the packet
+ * may be modified (by the MAC removing its headers). The receptions which
+ * are dropped (PHY busy, signal too weak, ...) never copy the packet;
+ * see GetNReceptions and GetNPacketCopies.
+ *
+ * When the PropagationCache attribute is true, the channel keeps the rx
+ * power and the delay computed by the propagation models for each (sender,
+ * receiver) pair, and reuses them for the next transmissions on this pair
+ * until the mobility model of either end fires its CourseChange trace, or
+ * either end moves by more than PropagationCacheThreshold meters, or the
+ * sender uses another tx power: the rx power is not always the tx power
+ * minus a loss, see ns3::FixedRssLossModel. The pairs are identified by
+ * the index of their PHYs in the channel, and the cache is a table of
+ * PropagationCacheSize entries: a pair replaces the entry of the pair
+ * which maps to the same slot, so that the memory used does not grow with
+ * the square of the number of PHYs. The whole chain of loss models is
+ * evaluated on a miss, so the cache works with chained models, but caching
+ * is only valid for deterministic models (see
+ * PropagationLossModel::IsDeterministic): the simulation stops with an
+ * error if the cache is enabled with random models such as
+ * ns3::NakagamiPropagationLossModel or ns3::RandomPropagationDelayModel.
+ *
+ * When the nodes run in parallel on the partitions of a
+ * ns3::MultithreadedSimulatorImpl (see ns3::WifiPartitionHelper, which
+ * calls PreparePartitions), the channel never touches the PHYs of another
+ * partition from the thread of the sender. A transmission is copied
+ * once, with Packet::CopyUnshared, for each other partition which has
+ * PHYs on the channel, and delivered to this partition after the lookahead
+ * L of the simulator, with the position of the sender at the start of the
+ * transmission; the receptions are then scheduled with the remaining
+ * propagation delay. Each partition has its own grid, propagation cache
+ * and counters, and evaluates the deterministic propagation models
+ * without any lock; the random models are called under a lock, so that
+ * their random variables are drawn in a non-deterministic order.
+ * PreparePartitions limits L to the shortest propagation delay between
+ * two PHYs of distinct partitions (within MaxRange), so that the
+ * receptions happen at the same time as in a sequential simulation; a
+ * PHY which later moves closer to another partition than L times the
+ * propagation speed receives its packets up to L too late (a warning is
+ * logged), until the next call to PreparePartitions derives L again. L
+ * cannot be derived from a random delay model. The PHYs which leave the
+ * simulation, such as the vehicles which reached the end of a highway,
+ * should be detached from the channel: they no longer send nor receive,
+ * and they no longer lower L.
  */
 class YansWifiChannel : public WifiChannel
 {
@@ -65,6 +132,16 @@ public:
    * \param phy the YansWifiPhy to be added to the PHY list
    */
   void Add (Ptr<YansWifiPhy> phy);
+  /**
+   * Detach the given YansWifiPhy from the channel: it neither sends nor
+   * receives anymore. The PHY stays in the PHY list, so that the other
+   * PHYs keep their index. In a parallel simulation, this method must be
+   * called from an event without context, like PreparePartitions, which
+   * then no longer counts the PHY when it derives the lookahead.
+   *
+   * \param phy the YansWifiPhy to detach
+   */
+  void Detach (Ptr<YansWifiPhy> phy);
 
   /**
    * \param loss the new propagation loss model.
@@ -100,6 +177,43 @@ public:
   */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * \return the number of receptions scheduled on the PHYs of this channel
+   */
+  uint64_t GetNReceptions (void) const;
+  /**
+   * \return the number of packet copies taken by the PHYs which synchronized
+   * on a packet. The difference with GetNReceptions is the number of copies
+   * avoided; each transmission is also copied once, for all its receivers.
+   */
+  uint64_t GetNPacketCopies (void) const;
+  /**
+   * \return the number of receptions whose propagation was found in the cache
+   */
+  uint64_t GetNCacheHits (void) const;
+  /**
+   * \return the number of receptions whose propagation was computed by the
+   * propagation models while the cache was enabled
+   */
+  uint64_t GetNCacheMisses (void) const;
+
+  /**
+   * Record the node and the partition of each PHY, which are needed to
+   * deliver the transmissions to the other partitions of a
+   * MultithreadedSimulatorImpl. This method must be called once the PHYs
+   * are attached to their device and the nodes to their partition, before
+   * the simulation runs; it can be called again, from an event without
+   * context, for the PHYs added since. The PHYs added after the last call
+   * neither send nor receive in the parallel simulation. The call also
+   * sets the lookahead of the channel to the shortest propagation delay
+   * between two attached PHYs of distinct partitions, within MaxRange (see
+   * MultithreadedSimulatorImpl::LimitLookahead), but only when PHYs were
+   * added or detached, or moved to another partition, or when a reception
+   * was late, since the last call: calling it at each step of a mobility
+   * model is cheap.
+   */
+  void PreparePartitions (void);
+
 private:
   //YansWifiChannel& operator = (const YansWifiChannel &);
   //YansWifiChannel (const YansWifiChannel &);
@@ -108,24 +222,233 @@ private:
    * A vector of pointers to YansWifiPhy.
    */
   typedef std::vector<Ptr<YansWifiPhy> > PhyList;
+  /**
+   * A grid cell, identified by its integer (x, y) coordinates.
+   */
+  typedef std::pair<int64_t, int64_t> GridCell;
+  /**
+   * The indices of the PHYs located in each non-empty cell.
+   */
+  typedef std::map<GridCell, std::vector<uint32_t> > Grid;
+  /**
+   * The number of CourseChange seen for each tracked mobility model.
+   */
+  typedef std::map<Ptr<MobilityModel>, uint32_t> Tracked;
+  /**
+   * The propagation computed for a (sender, receiver) pair.
+   */
+  struct PropagationEntry
+  {
+    uint32_t sender; //!< Index of the sending PHY, 0xffffffff for an empty entry
+    uint32_t receiver; //!< Index of the receiving PHY
+    Vector senderPosition; //!< Position of the sender when the entry was computed
+    Vector receiverPosition; //!< Position of the receiver when the entry was computed
+    uint32_t senderCourse; //!< CourseChange count of the sender when the entry was computed
+    uint32_t receiverCourse; //!< CourseChange count of the receiver when the entry was computed
+    double txPowerDbm; //!< Tx power of the sender when the entry was computed
+    double rxPowerDbm; //!< Rx power computed for this tx power
+    Time delay; //!< Propagation delay
+  };
+  /**
+   * The cached propagation of the (sender, receiver) pairs, each pair
+   * stored in the slot given by its PHY indices.
+   */
+  typedef std::vector<PropagationEntry> PropagationCache;
+  /**
+   * A transmission, as seen by its receivers. The partitions of a parallel
+   * simulation receive it in a Deliver event, after some time elapsed.
+   */
+  struct Transmission
+  {
+    uint32_t sender; //!< Index of the sending PHY in the PHY list
+    Vector senderPosition; //!< Position of the sender at the start of the transmission
+    uint32_t senderCourse; //!< CourseChange count of the sender, when the propagation cache is enabled
+    uint16_t channelNumber; //!< Channel number of the sender
+    Time elapsed; //!< Time elapsed since the start of the transmission
+    double txPowerDbm; //!< Tx power associated to the packet
+    WifiTxVector txVector; //!< TXVECTOR associated to the packet
+    WifiPreamble preamble; //!< Preamble associated to the packet
+  };
+  /**
+   * The receivers evaluated by a thread, with their grid, their cached
+   * propagation and their counters: all the PHYs in a sequential
+   * simulation, the PHYs of one partition in a parallel simulation.
+   */
+  struct PartitionState
+  {
+    PartitionState ();
+
+    uint32_t partition; //!< Partition of the PHYs, 0xffffffff for all the PHYs
+    Grid grid; //!< PHY indices per grid cell
+    bool gridDirty; //!< Whether the grid must be rebuilt before the next lookup
+    uint64_t gridCourses; //!< CourseChange count (see GetCourseChanges) at the last grid rebuild
+    Time gridTime; //!< Time of the last grid rebuild
+    double gridMaxSpeed; //!< Highest PHY speed (m/s) seen at the last grid rebuild
+    PropagationCache cache; //!< Cached propagation per (sender, receiver) pair
+    Ptr<MobilityModel> remoteSender; //!< Stands for the sender of the transmissions of other partitions
+    uint64_t courseChanges; //!< Number of CourseChange seen by this thread
+    uint64_t nReceptions; //!< Number of receptions scheduled
+    uint64_t nPacketCopies; //!< Number of packet copies taken by the receiving PHYs
+    uint64_t nCacheHits; //!< Number of receptions found in the cache
+    uint64_t nCacheMisses; //!< Number of receptions computed while the cache is enabled
+    bool late; //!< Whether a reception was late since the last PreparePartitions
+  };
+
   /**
    * This method is scheduled by Send for each associated YansWifiPhy.
    * The method then calls the corresponding YansWifiPhy that the first
    * bit of the packet has arrived.
    *
    * \param i index of the corresponding YansWifiPhy in the PHY list
-   * \param packet the packet being sent
+   * \param packet the packet being sent, shared by all the receivers
    * \param rxPowerDbm the received power of the packet
    * \param txVector the TXVECTOR of the packet
    * \param preamble the type of preamble being used to send the packet
    */
-  void Receive (uint32_t i, Ptr<Packet> packet, double rxPowerDbm,
+  void Receive (uint32_t i, Ptr<const Packet> packet, double rxPowerDbm,
                 WifiTxVector txVector, WifiPreamble preamble) const;
+  /**
+   * Schedule the receptions of the PHYs of the given state which are on
+   * the channel of the transmission: the PHYs found in the grid around the
+   * sender when MaxRange is positive, all of them otherwise.
+   *
+   * \param state the receivers
+   * \param senderMobility the mobility model of the sender
+   * \param packet the copy of the packet shared by the receivers
+   * \param tx the transmission
+   */
+  void ScheduleReceptions (PartitionState &state, Ptr<MobilityModel> senderMobility,
+                           Ptr<const Packet> packet, const Transmission &tx) const;
+  /**
+   * Compute the propagation to the i-th PHY of the list and schedule
+   * the corresponding Receive event.
+   *
+   * \param state the receivers, which include the i-th PHY
+   * \param i index of the receiving YansWifiPhy in the PHY list
+   * \param senderMobility the mobility model of the sender
+   * \param packet the copy of the packet shared by the receivers
+   * \param tx the transmission
+   */
+  void ScheduleReceive (PartitionState &state, uint32_t i, Ptr<MobilityModel> senderMobility,
+                        Ptr<const Packet> packet, const Transmission &tx) const;
+  /**
+   * Compute the propagation between two PHYs, or find it in the cache
+   * of the state when the PropagationCache attribute is true.
+   *
+   * \param state the receivers, which include the receiver
+   * \param tx the transmission
+   * \param senderMobility the mobility model of the sender
+   * \param receiver index of the receiving YansWifiPhy in the PHY list
+   * \param receiverMobility the mobility model of the receiver
+   * \param rxPowerDbm set to the rx power of the packet
+   * \param delay set to the propagation delay of the packet
+   */
+  void GetPropagation (PartitionState &state, const Transmission &tx, Ptr<MobilityModel> senderMobility,
+                       uint32_t receiver, Ptr<MobilityModel> receiverMobility,
+                       double &rxPowerDbm, Time &delay) const;
+  /**
+   * Evaluate the propagation models. The deterministic models are called
+   * by the partitions at the same time; the random ones share their random
+   * variables, so they are called under the lock of the channel.
+   *
+   * \param senderMobility the mobility model of the sender
+   * \param receiverMobility the mobility model of the receiver
+   * \param txPowerDbm the tx power associated to the packet
+   * \param rxPowerDbm set to the rx power of the packet
+   * \param delay set to the propagation delay of the packet
+   */
+  void CalcPropagation (Ptr<MobilityModel> senderMobility, Ptr<MobilityModel> receiverMobility,
+                        double txPowerDbm, double &rxPowerDbm, Time &delay) const;
+  /**
+   * Subscribe to the CourseChange of the given mobility model, if not yet done.
+   *
+   * \param mobility the mobility model
+   * \return the number of CourseChange of the mobility model seen so far
+   */
+  uint32_t Track (Ptr<MobilityModel> mobility) const;
+  /**
+   * \returns the receivers evaluated by the calling thread
+   */
+  PartitionState &GetState (void) const;
+  /**
+   * \param state the receivers
+   * \returns the number of CourseChange which may have moved the PHYs of the state
+   */
+  uint64_t GetCourseChanges (const PartitionState &state) const;
+  /**
+   * \param position a position
+   * \return the grid cell which contains the given position
+   */
+  GridCell GetGridCell (const Vector &position) const;
+  /**
+   * Fill the grid of the state with the current position of its PHYs.
+   *
+   * \param state the receivers
+   */
+  void RebuildGrid (PartitionState &state) const;
+  /**
+   * Collect, in increasing order, the indices of the PHYs of the state
+   * which may be located within MaxRange of the given position.
+   *
+   * \param state the receivers
+   * \param position the position of the sender
+   * \param candidates the vector to fill with the indices
+   */
+  void FindCandidates (PartitionState &state, const Vector &position, std::vector<uint32_t> &candidates) const;
+  /**
+   * Invalidate the grids, and the cached propagation of the mobility
+   * model, when any tracked PHY changes course.
+   *
+   * \param mobility the mobility model which changed course
+   */
+  void NotifyCourseChange (Ptr<const MobilityModel> mobility) const;
 
+#ifdef HAVE_PTHREAD_H
+  /**
+   * Send the packet while the partitions of the nodes run in parallel:
+   * schedule the receptions of the PHYs of the partition of the sender,
+   * and one Deliver event for each other partition.
+   *
+   * \param senderMobility the mobility model of the sender
+   * \param packet the packet to send
+   * \param tx the transmission
+   */
+  void SendParallel (Ptr<MobilityModel> senderMobility, Ptr<const Packet> packet, Transmission tx) const;
+  /**
+   * Schedule the receptions of the PHYs of the partition which runs this event.
+   *
+   * \param packet the copy of the packet owned by this partition
+   * \param tx the transmission
+   */
+  void Deliver (Ptr<const Packet> packet, Transmission tx) const;
+  /**
+   * Set the lookahead of the channel to the shortest propagation delay
+   * between two attached PHYs of distinct partitions, within MaxRange.
+   *
+   * \param impl the simulator
+   */
+  void LimitLookahead (Ptr<MultithreadedSimulatorImpl> impl) const;
+
+  std::vector<uint32_t> m_phyNodes; //!< Node of each PHY, set by PreparePartitions
+  std::vector<uint32_t> m_phyPartitions; //!< Partition of each PHY, set by PreparePartitions
+  std::vector<uint32_t> m_partitionPhys; //!< First PHY of each partition, 0xffffffff if none
+  mutable SystemMutex m_mutex; //!< Protects the random propagation models in parallel
+#endif
 
   PhyList m_phyList; //!< List of YansWifiPhys connected to this YansWifiChannel
+  std::map<Ptr<YansWifiPhy>, uint32_t> m_phyIndex; //!< Index of each PHY in the PHY list
+  std::vector<bool> m_detached; //!< Whether each PHY of the PHY list was detached
+  bool m_partitionsDirty; //!< Whether PHYs were added or detached since PreparePartitions
   Ptr<PropagationLossModel> m_loss; //!< Propagation loss model
   Ptr<PropagationDelayModel> m_delay; //!< Propagation delay model
+  double m_maxRange; //!< Reception cutoff and grid cell size (meters), 0 disables the grid
+
+  mutable Tracked m_tracked; //!< Mobility models whose CourseChange is tracked
+  mutable std::vector<PartitionState> m_states; //!< All the PHYs, then the PHYs of each partition
+
+  bool m_cacheEnabled; //!< Whether the propagation of each pair is cached
+  double m_cacheThreshold; //!< Distance (meters) an end of a pair may move before its entry is recomputed
+  uint32_t m_cacheSize; //!< Number of entries of the propagation cache of each partition
 };
 
 } // namespace ns3
@@ -497,8 +497,8 @@ YansWifiPhy::SetReceiveErrorCallback (RxErrorCallback callback)
 {
   m_state->SetReceiveErrorCallback (callback);
 }
-void
-YansWifiPhy::StartReceivePacket (Ptr<Packet> packet,
+bool
+YansWifiPhy::StartReceivePacket (Ptr<const Packet> packet,
                                  double rxPowerDbm,
                                  WifiTxVector txVector,
                                  enum WifiPreamble preamble)
@@ -572,9 +572,12 @@ YansWifiPhy::StartReceivePacket (Ptr<Packet> packet,
               NS_ASSERT (m_endRxEvent.IsExpired ());
               NotifyRxBegin (packet);
               m_interference.NotifyRxStart ();
+              // the packet is shared with the other receivers: copy it
+              // before handing it to the MAC.
               m_endRxEvent = Simulator::Schedule (rxDuration, &YansWifiPhy::EndReceive, this,
-                                                  packet,
+                                                  packet->Copy (),
                                                   event);
+              return true;
             }
           else
             {
@@ -597,7 +600,7 @@ YansWifiPhy::StartReceivePacket (Ptr<Packet> packet,
       break;
     }
 
-  return;
+  return false;
 
 maybeCcaBusy:
   // We are here because we have received the first bit of a packet and we are
@@ -610,6 +613,7 @@ maybeCcaBusy:
     {
       m_state->SwitchMaybeToCcaBusy (delayUntilCcaEnd);
     }
+  return false;
 }
 
 void
@@ -0,0 +1,218 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/pointer.h"
+#include "ns3/object-factory.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/error-rate-model.h"
+#include "ns3/table-error-rate-model.h"
+#include "ns3/nist-error-rate-model.h"
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+NS_LOG_COMPONENT_DEFINE ("TableErrorRateModelTest");
+
+using namespace ns3;
+
+/**
+ * Compare the chunk success rates of a TableErrorRateModel with those of
+ * the model it tabulates, for all the 802.11a/b modes and chunk sizes.
+ */
+class TableErrorRateModelTest : public TestCase
+{
+public:
+  TableErrorRateModelTest (std::string model, double maxError);
+
+  virtual void DoRun (void);
+private:
+  static std::string GetName (std::string model, double maxError);
+
+  std::string m_model;
+  double m_maxError;
+};
+
+TableErrorRateModelTest::TableErrorRateModelTest (std::string model, double maxError)
+  : TestCase (GetName (model, maxError)),
+    m_model (model),
+    m_maxError (maxError)
+{
+}
+
+std::string
+TableErrorRateModelTest::GetName (std::string model, double maxError)
+{
+  std::ostringstream oss;
+  oss << "Tabulated " << model << " with MaxError=" << maxError;
+  return oss.str ();
+}
+
+void
+TableErrorRateModelTest::DoRun (void)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (m_model);
+  Ptr<ErrorRateModel> model = factory.Create<ErrorRateModel> ();
+  Ptr<TableErrorRateModel> table = CreateObject<TableErrorRateModel> ();
+  table->SetAttribute ("ErrorRateModel", PointerValue (model));
+  table->SetAttribute ("MaxError", DoubleValue (m_maxError));
+
+  std::vector<WifiMode> modes;
+  modes.push_back (WifiPhy::GetDsssRate1Mbps ());
+  modes.push_back (WifiPhy::GetDsssRate2Mbps ());
+  modes.push_back (WifiPhy::GetDsssRate5_5Mbps ());
+  modes.push_back (WifiPhy::GetDsssRate11Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate6Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate9Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate12Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate18Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate24Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate36Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate48Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate54Mbps ());
+  uint32_t nbits[] = { 1, 8, 100, 1000, 12000, 65535 * 8 };
+
+  for (uint32_t i = 0; i < modes.size (); i++)
+    {
+      double maxError = 0.0;
+      // the SNR values fall anywhere in the intervals of the tables.
+      for (double snrDb = -12.0; snrDb < 62.0; snrDb += 0.00917)
+        {
+          double snr = std::pow (10.0, snrDb / 10.0);
+          for (uint32_t j = 0; j < sizeof (nbits) / sizeof (nbits[0]); j++)
+            {
+              double exact = model->GetChunkSuccessRate (modes[i], snr, nbits[j]);
+              double approx = table->GetChunkSuccessRate (modes[i], snr, nbits[j]);
+              maxError = std::max (maxError, std::fabs (exact - approx));
+            }
+        }
+      NS_LOG_DEBUG (modes[i] << " max error=" << maxError);
+      NS_TEST_EXPECT_MSG_LT_OR_EQ (maxError, m_maxError, "Inaccurate chunk success rate for " << modes[i]);
+    }
+}
+
+/**
+ * A NistErrorRateModel whose SNR is shifted by the Offset attribute.
+ */
+class OffsetErrorRateModel : public ErrorRateModel
+{
+public:
+  static TypeId GetTypeId (void);
+
+  OffsetErrorRateModel ();
+
+  virtual double GetChunkSuccessRate (WifiMode mode, double snr, uint32_t nbits) const;
+private:
+  double m_offsetDb;
+  Ptr<ErrorRateModel> m_nist;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (OffsetErrorRateModel);
+
+TypeId
+OffsetErrorRateModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::OffsetErrorRateModel")
+    .SetParent<ErrorRateModel> ()
+    .AddConstructor<OffsetErrorRateModel> ()
+    .AddAttribute ("Offset",
+                   "The offset (dB) added to the SNR.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&OffsetErrorRateModel::m_offsetDb),
+                   MakeDoubleChecker<double> ())
+  ;
+  return tid;
+}
+
+OffsetErrorRateModel::OffsetErrorRateModel ()
+  : m_offsetDb (0.0),
+    m_nist (CreateObject<NistErrorRateModel> ())
+{
+}
+
+double
+OffsetErrorRateModel::GetChunkSuccessRate (WifiMode mode, double snr, uint32_t nbits) const
+{
+  return m_nist->GetChunkSuccessRate (mode, snr * std::pow (10.0, m_offsetDb / 10.0), nbits);
+}
+
+/**
+ * Make sure that the TableErrorRateModel instances which wrap models of
+ * the same TypeId with other attribute values do not share their tables.
+ */
+class TableErrorRateModelSharingTest : public TestCase
+{
+public:
+  TableErrorRateModelSharingTest ();
+
+  virtual void DoRun (void);
+};
+
+TableErrorRateModelSharingTest::TableErrorRateModelSharingTest ()
+  : TestCase ("Tables shared by the wrapped models with the same attributes")
+{
+}
+
+void
+TableErrorRateModelSharingTest::DoRun (void)
+{
+  double offsets[] = { 0.0, 10.0, 10.0 };
+  std::vector<Ptr<ErrorRateModel> > models;
+  std::vector<Ptr<TableErrorRateModel> > tables;
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Ptr<ErrorRateModel> model = CreateObject<OffsetErrorRateModel> ();
+      model->SetAttribute ("Offset", DoubleValue (offsets[i]));
+      Ptr<TableErrorRateModel> table = CreateObject<TableErrorRateModel> ();
+      table->SetAttribute ("ErrorRateModel", PointerValue (model));
+      models.push_back (model);
+      tables.push_back (table);
+    }
+  WifiMode mode = WifiPhy::GetOfdmRate6Mbps ();
+  for (double snrDb = -5.0; snrDb < 15.0; snrDb += 0.25)
+    {
+      double snr = std::pow (10.0, snrDb / 10.0);
+      for (uint32_t i = 0; i < 3; i++)
+        {
+          double exact = models[i]->GetChunkSuccessRate (mode, snr, 12000);
+          double approx = tables[i]->GetChunkSuccessRate (mode, snr, 12000);
+          NS_TEST_EXPECT_MSG_EQ_TOL (approx, exact, 1e-6, "Model " << i << " uses the table of another Offset at " <<
+                                     snrDb << " dB");
+        }
+    }
+}
+
+class TableErrorRateModelTestSuite : public TestSuite
+{
+public:
+  TableErrorRateModelTestSuite ();
+};
+
+TableErrorRateModelTestSuite::TableErrorRateModelTestSuite ()
+  : TestSuite ("devices-wifi-table-error-rate-model", UNIT)
+{
+  AddTestCase (new TableErrorRateModelTest ("ns3::YansErrorRateModel", 1e-6), TestCase::QUICK);
+  AddTestCase (new TableErrorRateModelTest ("ns3::NistErrorRateModel", 1e-6), TestCase::QUICK);
+  AddTestCase (new TableErrorRateModelTest ("ns3::YansErrorRateModel", 1e-3), TestCase::QUICK);
+  AddTestCase (new TableErrorRateModelSharingTest, TestCase::QUICK);
+}
+
+static TableErrorRateModelTestSuite g_tableErrorRateModelTestSuite;
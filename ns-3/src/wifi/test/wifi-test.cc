@@ -25,6 +25,7 @@
 #include "ns3/adhoc-wifi-mac.h"
 #include "ns3/yans-wifi-phy.h"
 #include "ns3/arf-wifi-manager.h"
+#include "ns3/constant-rate-wifi-manager.h"
 #include "ns3/propagation-delay-model.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/error-rate-model.h"
@@ -41,6 +42,21 @@
 #include "ns3/edca-txop-n.h"
 #include "ns3/config.h"
 #include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/node-container.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/interference-helper.h"
+#include "ns3/wifi-partition-helper.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/multithreaded-simulator-impl.h"
+#endif
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <sstream>
 
 using namespace ns3;
 
@@ -323,6 +339,625 @@ InterferenceHelperSequenceTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+//-----------------------------------------------------------------------------
+/**
+ * \internal
+ * The noise and interference tracker of InterferenceHelper as it was
+ * before the changes were kept in a multimap: the functions below are
+ * copied verbatim from the original interference-helper.cc, as the
+ * reference of InterferenceHelperDifferentialTest.
+ */
+class OriginalInterferenceHelper
+{
+public:
+  struct SnrPer
+  {
+    double snr;
+    double per;
+  };
+
+  OriginalInterferenceHelper (double noiseFigure, Ptr<ErrorRateModel> errorRateModel);
+
+  Time GetEnergyDuration (double energyW);
+  void AppendEvent (Ptr<InterferenceHelper::Event> event);
+  struct OriginalInterferenceHelper::SnrPer CalculateSnrPer (Ptr<InterferenceHelper::Event> event);
+  void NotifyRxStart ();
+  void NotifyRxEnd ();
+private:
+  class NiChange
+  {
+public:
+    NiChange (Time time, double delta);
+    Time GetTime (void) const;
+    double GetDelta (void) const;
+    bool operator < (const NiChange& o) const;
+private:
+    Time m_time;
+    double m_delta;
+  };
+  typedef std::vector <NiChange> NiChanges;
+
+  double CalculateNoiseInterferenceW (Ptr<InterferenceHelper::Event> event, NiChanges *ni) const;
+  double CalculateSnr (double signal, double noiseInterference, WifiMode mode) const;
+  double CalculateChunkSuccessRate (double snir, Time duration, WifiMode mode) const;
+  double CalculatePer (Ptr<const InterferenceHelper::Event> event, NiChanges *ni) const;
+  NiChanges::iterator GetPosition (Time moment);
+  void AddNiChangeEvent (NiChange change);
+
+  double m_noiseFigure;
+  Ptr<ErrorRateModel> m_errorRateModel;
+  NiChanges m_niChanges;
+  double m_firstPower;
+  bool m_rxing;
+};
+
+OriginalInterferenceHelper::OriginalInterferenceHelper (double noiseFigure, Ptr<ErrorRateModel> errorRateModel)
+  : m_noiseFigure (noiseFigure),
+    m_errorRateModel (errorRateModel),
+    m_firstPower (0.0),
+    m_rxing (false)
+{
+}
+
+OriginalInterferenceHelper::NiChange::NiChange (Time time, double delta)
+  : m_time (time),
+    m_delta (delta)
+{
+}
+
+Time
+OriginalInterferenceHelper::NiChange::GetTime (void) const
+{
+  return m_time;
+}
+
+double
+OriginalInterferenceHelper::NiChange::GetDelta (void) const
+{
+  return m_delta;
+}
+
+bool
+OriginalInterferenceHelper::NiChange::operator < (const OriginalInterferenceHelper::NiChange& o) const
+{
+  return (m_time < o.m_time);
+}
+
+Time
+OriginalInterferenceHelper::GetEnergyDuration (double energyW)
+{
+  Time now = Simulator::Now ();
+  double noiseInterferenceW = 0.0;
+  Time end = now;
+  noiseInterferenceW = m_firstPower;
+  for (NiChanges::const_iterator i = m_niChanges.begin (); i != m_niChanges.end (); i++)
+    {
+      noiseInterferenceW += i->GetDelta ();
+      end = i->GetTime ();
+      if (end < now)
+        {
+          continue;
+        }
+      if (noiseInterferenceW < energyW)
+        {
+          break;
+        }
+    }
+  return end > now ? end - now : MicroSeconds (0);
+}
+
+void
+OriginalInterferenceHelper::AppendEvent (Ptr<InterferenceHelper::Event> event)
+{
+  Time now = Simulator::Now ();
+  if (!m_rxing)
+    {
+      NiChanges::iterator nowIterator = GetPosition (now);
+      for (NiChanges::iterator i = m_niChanges.begin (); i != nowIterator; i++)
+        {
+          m_firstPower += i->GetDelta ();
+        }
+      m_niChanges.erase (m_niChanges.begin (), nowIterator);
+      m_niChanges.insert (m_niChanges.begin (), NiChange (event->GetStartTime (), event->GetRxPowerW ()));
+    }
+  else
+    {
+      AddNiChangeEvent (NiChange (event->GetStartTime (), event->GetRxPowerW ()));
+    }
+  AddNiChangeEvent (NiChange (event->GetEndTime (), -event->GetRxPowerW ()));
+
+}
+
+double
+OriginalInterferenceHelper::CalculateSnr (double signal, double noiseInterference, WifiMode mode) const
+{
+  // thermal noise at 290K in J/s = W
+  static const double BOLTZMANN = 1.3803e-23;
+  // Nt is the power of thermal noise in W
+  double Nt = BOLTZMANN * 290.0 * mode.GetBandwidth ();
+  // receiver noise Floor (W) which accounts for thermal noise and non-idealities of the receiver
+  double noiseFloor = m_noiseFigure * Nt;
+  double noise = noiseFloor + noiseInterference;
+  double snr = signal / noise;
+  return snr;
+}
+
+double
+OriginalInterferenceHelper::CalculateNoiseInterferenceW (Ptr<InterferenceHelper::Event> event, NiChanges *ni) const
+{
+  double noiseInterference = m_firstPower;
+  NS_ASSERT (m_rxing);
+  for (NiChanges::const_iterator i = m_niChanges.begin () + 1; i != m_niChanges.end (); i++)
+    {
+      if ((event->GetEndTime () == i->GetTime ()) && event->GetRxPowerW () == -i->GetDelta ())
+        {
+          break;
+        }
+      ni->push_back (*i);
+    }
+  ni->insert (ni->begin (), NiChange (event->GetStartTime (), noiseInterference));
+  ni->push_back (NiChange (event->GetEndTime (), 0));
+  return noiseInterference;
+}
+
+double
+OriginalInterferenceHelper::CalculateChunkSuccessRate (double snir, Time duration, WifiMode mode) const
+{
+  if (duration == NanoSeconds (0))
+    {
+      return 1.0;
+    }
+  uint32_t rate = mode.GetPhyRate ();
+  uint64_t nbits = (uint64_t)(rate * duration.GetSeconds ());
+  double csr = m_errorRateModel->GetChunkSuccessRate (mode, snir, (uint32_t)nbits);
+  return csr;
+}
+
+double
+OriginalInterferenceHelper::CalculatePer (Ptr<const InterferenceHelper::Event> event, NiChanges *ni) const
+{
+  double psr = 1.0; /* Packet Success Rate */
+  NiChanges::iterator j = ni->begin ();
+  Time previous = (*j).GetTime ();
+  WifiMode payloadMode = event->GetPayloadMode ();
+  WifiPreamble preamble = event->GetPreambleType ();
+ WifiMode MfHeaderMode ;
+ if (preamble==WIFI_PREAMBLE_HT_MF)
+   {
+    MfHeaderMode = WifiPhy::GetMFPlcpHeaderMode (payloadMode, preamble); //return L-SIG mode
+
+   }
+  WifiMode headerMode = WifiPhy::GetPlcpHeaderMode (payloadMode, preamble);
+  Time plcpHeaderStart = (*j).GetTime () + MicroSeconds (WifiPhy::GetPlcpPreambleDurationMicroSeconds (payloadMode, preamble)); //packet start time+ preamble
+  Time plcpHsigHeaderStart=plcpHeaderStart+ MicroSeconds (WifiPhy::GetPlcpHeaderDurationMicroSeconds (payloadMode, preamble));//packet start time+ preamble+L SIG
+  Time plcpHtTrainingSymbolsStart = plcpHsigHeaderStart + MicroSeconds (WifiPhy::GetPlcpHtSigHeaderDurationMicroSeconds (payloadMode, preamble));//packet start time+ preamble+L SIG+HT SIG
+  Time plcpPayloadStart =plcpHtTrainingSymbolsStart + MicroSeconds (WifiPhy::GetPlcpHtTrainingSymbolDurationMicroSeconds (payloadMode, preamble,event->GetTxVector())); //packet start time+ preamble+L SIG+HT SIG+Training
+  double noiseInterferenceW = (*j).GetDelta ();
+  double powerW = event->GetRxPowerW ();
+    j++;
+  while (ni->end () != j)
+    {
+      Time current = (*j).GetTime ();
+      NS_ASSERT (current >= previous);
+      //Case 1: Both prev and curr point to the payload
+      if (previous >= plcpPayloadStart)
+        {
+          psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                          noiseInterferenceW,
+                                                          payloadMode),
+                                            current - previous,
+                                            payloadMode);
+        }
+      //Case 2: previous is before payload
+      else if (previous >= plcpHtTrainingSymbolsStart)
+        {
+          //Case 2a: current is after payload
+          if (current >= plcpPayloadStart)
+            { 
+               //Case 2ai and 2aii: All formats
+               psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                              noiseInterferenceW,
+                                                              payloadMode),
+                                                current - plcpPayloadStart,
+                                                payloadMode);
+                
+              }
+        }
+      //Case 3: previous is in HT-SIG: Non HT will not enter here since it didn't enter in the last two and they are all the same for non HT
+      else if (previous >=plcpHsigHeaderStart)
+        {
+          //Case 3a: cuurent after payload start
+          if (current >=plcpPayloadStart)
+             {
+                   psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                              noiseInterferenceW,
+                                                              payloadMode),
+                                                current - plcpPayloadStart,
+                                                payloadMode);
+                 
+                    psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                              noiseInterferenceW,
+                                                              headerMode),
+                                               plcpHtTrainingSymbolsStart - previous,
+                                                headerMode);
+              }
+          //case 3b: current after HT training symbols start
+          else if (current >=plcpHtTrainingSymbolsStart)
+             {
+                psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                                noiseInterferenceW,
+                                                                headerMode),
+                                                   plcpHtTrainingSymbolsStart - previous,
+                                                   headerMode);  
+                   
+             }
+         //Case 3c: current is with previous in HT sig
+         else
+            {
+                psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                                noiseInterferenceW,
+                                                                headerMode),
+                                                   current- previous,
+                                                   headerMode);  
+                   
+            }
+      }
+      //Case 4: previous in L-SIG: GF will not reach here because it will execute the previous if and exit
+      else if (previous >= plcpHeaderStart)
+        {
+          //Case 4a: current after payload start  
+          if (current >=plcpPayloadStart)
+             {
+                   psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                              noiseInterferenceW,
+                                                              payloadMode),
+                                                      current - plcpPayloadStart,
+                                                      payloadMode);
+                    //Case 4ai: Non HT format (No HT-SIG or Training Symbols)
+              if (preamble == WIFI_PREAMBLE_LONG || preamble == WIFI_PREAMBLE_SHORT) //plcpHtTrainingSymbolsStart==plcpHeaderStart)
+                {
+                    psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                              noiseInterferenceW,
+                                                              headerMode),
+                                                plcpPayloadStart - previous,
+                                                headerMode);
+                }
+
+               else{
+                    psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                              noiseInterferenceW,
+                                                              headerMode),
+                                                      plcpHtTrainingSymbolsStart - plcpHsigHeaderStart,
+                                                      headerMode);
+                    psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                                    noiseInterferenceW,
+                                                                    MfHeaderMode),
+                                                      plcpHsigHeaderStart - previous,
+                                                      MfHeaderMode);
+                 }
+              }
+           //Case 4b: current in HT training symbol. non HT will not come here since it went in previous if or if the previous ifis not true this will be not true        
+          else if (current >=plcpHtTrainingSymbolsStart)
+             {
+                psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                              noiseInterferenceW,
+                                                              headerMode),
+                                                  plcpHtTrainingSymbolsStart - plcpHsigHeaderStart,
+                                                  headerMode);
+                psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                                noiseInterferenceW,
+                                                                MfHeaderMode),
+                                                   plcpHsigHeaderStart - previous,
+                                                   MfHeaderMode);
+              }
+          //Case 4c: current in H sig.non HT will not come here since it went in previous if or if the previous ifis not true this will be not true
+          else if (current >=plcpHsigHeaderStart)
+             {
+                psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                                noiseInterferenceW,
+                                                                headerMode),
+                                                  current - plcpHsigHeaderStart,
+                                                  headerMode);
+                 psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                                 noiseInterferenceW,
+                                                                 MfHeaderMode),
+                                                   plcpHsigHeaderStart - previous,
+                                                   MfHeaderMode);
+
+             }
+         //Case 4d: Current with prev in L SIG
+         else 
+            {
+                //Case 4di: Non HT format (No HT-SIG or Training Symbols)
+              if (preamble == WIFI_PREAMBLE_LONG || preamble == WIFI_PREAMBLE_SHORT) //plcpHtTrainingSymbolsStart==plcpHeaderStart)
+                {
+                    psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                              noiseInterferenceW,
+                                                              headerMode),
+                                                current - previous,
+                                                headerMode);
+                }
+               else
+                {
+                psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                               noiseInterferenceW,
+                                                               MfHeaderMode),
+                                                 current - previous,
+                                                 MfHeaderMode);
+                }
+            }
+        }
+      //Case 5: previous is in the preamble works for all cases
+      else
+        {
+          if (current >= plcpPayloadStart)
+            {
+              //for all
+              psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                              noiseInterferenceW,
+                                                              payloadMode),
+                                                current - plcpPayloadStart,
+                                                payloadMode); 
+             
+               // Non HT format (No HT-SIG or Training Symbols)
+              if (preamble == WIFI_PREAMBLE_LONG || preamble == WIFI_PREAMBLE_SHORT)
+                 psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                                 noiseInterferenceW,
+                                                                  headerMode),
+                                                    plcpPayloadStart - plcpHeaderStart,
+                                                    headerMode);
+              else
+              // Greenfield or Mixed format
+                psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                                noiseInterferenceW,
+                                                                headerMode),
+                                                  plcpHtTrainingSymbolsStart - plcpHsigHeaderStart,
+                                                  headerMode);
+              if (preamble == WIFI_PREAMBLE_HT_MF)
+                 psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                                 noiseInterferenceW,
+                                                                 MfHeaderMode),
+                                                   plcpHsigHeaderStart-plcpHeaderStart,
+                                                   MfHeaderMode);             
+            }
+          else if (current >=plcpHtTrainingSymbolsStart )
+          { 
+              // Non HT format will not come here since it will execute prev if
+              // Greenfield or Mixed format
+                psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                                noiseInterferenceW,
+                                                                headerMode),
+                                                  plcpHtTrainingSymbolsStart - plcpHsigHeaderStart,
+                                                  headerMode);
+              if (preamble == WIFI_PREAMBLE_HT_MF)
+                 psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                                 noiseInterferenceW,
+                                                                 MfHeaderMode),
+                                                   plcpHsigHeaderStart-plcpHeaderStart,
+                                                   MfHeaderMode);       
+           }
+          //non HT will not come here     
+          else if (current >=plcpHsigHeaderStart)
+             { 
+                psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                                noiseInterferenceW,
+                                                                headerMode),
+                                                  current- plcpHsigHeaderStart,
+                                                  headerMode); 
+                if  (preamble != WIFI_PREAMBLE_HT_GF)
+                 {
+                   psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                                   noiseInterferenceW,
+                                                                   MfHeaderMode),
+                                                     plcpHsigHeaderStart-plcpHeaderStart,
+                                                     MfHeaderMode);    
+                  }          
+             }
+          // GF will not come here
+          else if (current >= plcpHeaderStart)
+            {
+               if (preamble == WIFI_PREAMBLE_LONG || preamble == WIFI_PREAMBLE_SHORT)
+                 {
+                 psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                                 noiseInterferenceW,
+                                                                  headerMode),
+                                                    current - plcpHeaderStart,
+                                                    headerMode);
+                 }
+              else
+                 {
+              psr *= CalculateChunkSuccessRate (CalculateSnr (powerW,
+                                                              noiseInterferenceW,
+                                                             MfHeaderMode),
+                                               current - plcpHeaderStart,
+                                               MfHeaderMode);
+                       }
+            }
+        }
+
+      noiseInterferenceW += (*j).GetDelta ();
+      previous = (*j).GetTime ();
+      j++;
+    }
+
+  double per = 1 - psr;
+  return per;
+}
+
+struct OriginalInterferenceHelper::SnrPer
+OriginalInterferenceHelper::CalculateSnrPer (Ptr<InterferenceHelper::Event> event)
+{
+  NiChanges ni;
+  double noiseInterferenceW = CalculateNoiseInterferenceW (event, &ni);
+  double snr = CalculateSnr (event->GetRxPowerW (),
+                             noiseInterferenceW,
+                             event->GetPayloadMode ());
+
+  /* calculate the SNIR at the start of the packet and accumulate
+   * all SNIR changes in the snir vector.
+   */
+  double per = CalculatePer (event, &ni);
+
+  struct SnrPer snrPer;
+  snrPer.snr = snr;
+  snrPer.per = per;
+  return snrPer;
+}
+
+OriginalInterferenceHelper::NiChanges::iterator
+OriginalInterferenceHelper::GetPosition (Time moment)
+{
+  return std::upper_bound (m_niChanges.begin (), m_niChanges.end (), NiChange (moment, 0));
+
+}
+
+void
+OriginalInterferenceHelper::AddNiChangeEvent (NiChange change)
+{
+  m_niChanges.insert (GetPosition (change.GetTime ()), change);
+}
+
+void
+OriginalInterferenceHelper::NotifyRxStart ()
+{
+  m_rxing = true;
+}
+
+void
+OriginalInterferenceHelper::NotifyRxEnd ()
+{
+  m_rxing = false;
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * \internal
+ * Make sure that the noise and interference tracked by InterferenceHelper
+ * are exactly those of the original tracker, over random sequences of
+ * overlapping signals.
+ */
+class InterferenceHelperDifferentialTest : public TestCase
+{
+public:
+  InterferenceHelperDifferentialTest ();
+
+  virtual void DoRun (void);
+private:
+  void AddSignal (void);
+  void EndRx (Ptr<InterferenceHelper::Event> event);
+  void AbortRx (void);
+  void CheckEnergyDuration (void);
+
+  InterferenceHelper m_interference;
+  OriginalInterferenceHelper *m_reference;
+  bool m_rxing;
+  EventId m_endRx;
+  Ptr<UniformRandomVariable> m_random;
+  std::vector<WifiMode> m_modes;
+  uint32_t m_nRx;
+};
+
+InterferenceHelperDifferentialTest::InterferenceHelperDifferentialTest ()
+  : TestCase ("InterferenceHelperDifferential")
+{
+}
+
+void
+InterferenceHelperDifferentialTest::AddSignal (void)
+{
+  // signals start and end on a 10us grid so that many changes coincide.
+  Time duration = MicroSeconds (10 * m_random->GetInteger (1, 300));
+  double rxPowerW = std::pow (10.0, m_random->GetValue (-13.0, -8.0));
+  WifiMode mode = m_modes[m_random->GetInteger (0, m_modes.size () - 1)];
+  WifiPreamble preamble = mode.GetModulationClass () == WIFI_MOD_CLASS_DSSS ? WIFI_PREAMBLE_SHORT : WIFI_PREAMBLE_LONG;
+  WifiTxVector txVector (mode, 0, 0, false, 1, 1, false);
+  Ptr<InterferenceHelper::Event> event = m_interference.Add (m_random->GetInteger (1, 1500), mode, preamble,
+                                                             duration, rxPowerW, txVector);
+  m_reference->AppendEvent (event);
+  if (!m_rxing && m_random->GetValue () < 0.4)
+    {
+      m_interference.NotifyRxStart ();
+      m_reference->NotifyRxStart ();
+      m_rxing = true;
+      m_endRx = Simulator::Schedule (duration, &InterferenceHelperDifferentialTest::EndRx, this, event);
+    }
+  else
+    {
+      CheckEnergyDuration ();
+    }
+}
+
+void
+InterferenceHelperDifferentialTest::EndRx (Ptr<InterferenceHelper::Event> event)
+{
+  struct InterferenceHelper::SnrPer snrPer = m_interference.CalculateSnrPer (event);
+  struct OriginalInterferenceHelper::SnrPer reference = m_reference->CalculateSnrPer (event);
+  NS_TEST_EXPECT_MSG_EQ (snrPer.snr, reference.snr, "SNR differs from the original tracker at " << Simulator::Now ());
+  NS_TEST_EXPECT_MSG_EQ (snrPer.per, reference.per, "PER differs from the original tracker at " << Simulator::Now ());
+
+  m_interference.NotifyRxEnd ();
+  m_reference->NotifyRxEnd ();
+  m_rxing = false;
+  m_nRx++;
+  CheckEnergyDuration ();
+}
+
+void
+InterferenceHelperDifferentialTest::AbortRx (void)
+{
+  if (m_rxing)
+    {
+      m_endRx.Cancel ();
+      m_interference.NotifyRxEnd ();
+      m_reference->NotifyRxEnd ();
+      m_rxing = false;
+    }
+}
+
+void
+InterferenceHelperDifferentialTest::CheckEnergyDuration (void)
+{
+  double energyW = std::pow (10.0, m_random->GetValue (-13.0, -8.0));
+  NS_TEST_EXPECT_MSG_EQ (m_interference.GetEnergyDuration (energyW), m_reference->GetEnergyDuration (energyW),
+                         "Energy duration differs from the original tracker at " << Simulator::Now ());
+}
+
+void
+InterferenceHelperDifferentialTest::DoRun (void)
+{
+  double noiseFigure = std::pow (10.0, 0.7);
+  Ptr<ErrorRateModel> errorRateModel = CreateObject<YansErrorRateModel> ();
+  m_interference.SetNoiseFigure (noiseFigure);
+  m_interference.SetErrorRateModel (errorRateModel);
+  OriginalInterferenceHelper reference (noiseFigure, errorRateModel);
+  m_reference = &reference;
+  m_rxing = false;
+  m_nRx = 0;
+  m_random = CreateObject<UniformRandomVariable> ();
+  m_random->SetStream (1);
+  m_modes.push_back (WifiPhy::GetDsssRate1Mbps ());
+  m_modes.push_back (WifiPhy::GetDsssRate11Mbps ());
+  m_modes.push_back (WifiPhy::GetOfdmRate6Mbps ());
+  m_modes.push_back (WifiPhy::GetOfdmRate24Mbps ());
+  m_modes.push_back (WifiPhy::GetOfdmRate54Mbps ());
+
+  Time now = Seconds (1.0);
+  for (uint32_t i = 0; i < 5000; i++)
+    {
+      now += MicroSeconds (10 * m_random->GetInteger (0, 40));
+      Simulator::Schedule (now, &InterferenceHelperDifferentialTest::AddSignal, this);
+      if (m_random->GetValue () < 0.02)
+        {
+          Simulator::Schedule (now + MicroSeconds (5), &InterferenceHelperDifferentialTest::AbortRx, this);
+        }
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_EXPECT_MSG_GT (m_nRx, 400, "Too few receptions to compare the trackers");
+  m_interference.EraseEvents ();
+  m_reference = 0;
+}
+
 //-----------------------------------------------------------------------------
 /**
  * Make sure that when multiple broadcast packets are queued on the same
@@ -478,6 +1113,468 @@ Bug555TestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_secondTransmissionTime, expectedSecondTransmissionTime, "The second transmission time not correct!");
 }
 
+//-----------------------------------------------------------------------------
+/**
+ * Make sure that the spatial grid of the YansWifiChannel (MaxRange
+ * attribute) delivers a broadcast to the same PHYs as a full scan of
+ * the channel, including after a receiver moved into range, and that
+ * only the PHYs which synchronize on the broadcast copy it. The same
+ * receivers must be reached with the propagation cache, which must be
+ * invalidated by the CourseChange of the receiver which moved, and
+ * whose pairs must replace each other when the cache is too small. A
+ * cached rx power must not be reused for another tx power, which a
+ * model like FixedRssLossModel ignores.
+ */
+class YansWifiChannelGridTest : public TestCase
+{
+public:
+  YansWifiChannelGridTest ();
+
+  virtual void DoRun (void);
+private:
+  uint32_t RunOne (double maxRange, uint64_t expectedReceptions, bool cache = false, uint32_t cacheSize = 65536);
+  void RunTxPower (void);
+  Ptr<WifiNetDevice> CreateOne (Vector pos, Ptr<YansWifiChannel> channel);
+  void SendOnePacket (Ptr<WifiNetDevice> dev);
+  void NotifyPhyRxBegin (Ptr<const Packet> p);
+  void NotifyMonitorSniffRx (Ptr<const Packet> p, uint16_t channelFreqMhz, uint16_t channelNumber, uint32_t rate,
+                             bool isShortPreamble, double signalDbm, double noiseDbm);
+
+  uint32_t m_received;
+  std::vector<double> m_signalDbm; //!< the signal power of each successful reception
+  uint64_t m_cacheHits;
+  uint64_t m_cacheMisses;
+};
+
+YansWifiChannelGridTest::YansWifiChannelGridTest ()
+  : TestCase ("YansWifiChannel spatial grid")
+{
+}
+
+void
+YansWifiChannelGridTest::SendOnePacket (Ptr<WifiNetDevice> dev)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  dev->Send (p, dev->GetBroadcast (), 1);
+}
+
+void
+YansWifiChannelGridTest::NotifyPhyRxBegin (Ptr<const Packet> p)
+{
+  m_received++;
+}
+
+void
+YansWifiChannelGridTest::NotifyMonitorSniffRx (Ptr<const Packet> p, uint16_t channelFreqMhz, uint16_t channelNumber,
+                                               uint32_t rate, bool isShortPreamble, double signalDbm, double noiseDbm)
+{
+  m_signalDbm.push_back (signalDbm);
+}
+
+Ptr<WifiNetDevice>
+YansWifiChannelGridTest::CreateOne (Vector pos, Ptr<YansWifiChannel> channel)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<WifiNetDevice> dev = CreateObject<WifiNetDevice> ();
+  ObjectFactory mac;
+  mac.SetTypeId ("ns3::AdhocWifiMac");
+  Ptr<WifiMac> wifiMac = mac.Create<WifiMac> ();
+  wifiMac->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  phy->SetErrorRateModel (CreateObject<YansErrorRateModel> ());
+  phy->SetChannel (channel);
+  phy->SetDevice (dev);
+  phy->SetMobility (node);
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  phy->TraceConnectWithoutContext ("PhyRxBegin", MakeCallback (&YansWifiChannelGridTest::NotifyPhyRxBegin, this));
+
+  mobility->SetPosition (pos);
+  node->AggregateObject (mobility);
+  wifiMac->SetAddress (Mac48Address::Allocate ());
+  dev->SetMac (wifiMac);
+  dev->SetPhy (phy);
+  dev->SetRemoteStationManager (CreateObject<ConstantRateWifiManager> ());
+  node->AddDevice (dev);
+  return dev;
+}
+
+uint32_t
+YansWifiChannelGridTest::RunOne (double maxRange, uint64_t expectedReceptions, bool cache, uint32_t cacheSize)
+{
+  m_received = 0;
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetAttribute ("MaxRange", DoubleValue (maxRange));
+  channel->SetAttribute ("PropagationCache", BooleanValue (cache));
+  channel->SetAttribute ("PropagationCacheSize", UintegerValue (cacheSize));
+  Ptr<RangePropagationLossModel> propLoss = CreateObject<RangePropagationLossModel> ();
+  propLoss->SetAttribute ("MaxRange", DoubleValue (100.0));
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  channel->SetPropagationLossModel (propLoss);
+
+  Ptr<WifiNetDevice> sender = CreateOne (Vector (0.0, 0.0, 0.0), channel);
+  CreateOne (Vector (50.0, 0.0, 0.0), channel);
+  CreateOne (Vector (0.0, -90.0, 0.0), channel);
+  Ptr<WifiNetDevice> far = CreateOne (Vector (500.0, 0.0, 0.0), channel);
+
+  Simulator::Schedule (Seconds (1.0), &YansWifiChannelGridTest::SendOnePacket, this, sender);
+  Simulator::Schedule (Seconds (1.5), &MobilityModel::SetPosition,
+                       far->GetNode ()->GetObject<MobilityModel> (), Vector (80.0, 0.0, 0.0));
+  Simulator::Schedule (Seconds (2.0), &YansWifiChannelGridTest::SendOnePacket, this, sender);
+
+  Simulator::Stop (Seconds (3.0));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (channel->GetNReceptions (), expectedReceptions, "Unexpected number of scheduled receptions");
+  NS_TEST_EXPECT_MSG_EQ (channel->GetNPacketCopies (), m_received, "Only the synchronized PHYs must copy the packet");
+  m_cacheHits = channel->GetNCacheHits ();
+  m_cacheMisses = channel->GetNCacheMisses ();
+  Simulator::Destroy ();
+  return m_received;
+}
+
+void
+YansWifiChannelGridTest::RunTxPower (void)
+{
+  m_signalDbm.clear ();
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetAttribute ("PropagationCache", BooleanValue (true));
+  Ptr<FixedRssLossModel> propLoss = CreateObject<FixedRssLossModel> ();
+  propLoss->SetRss (-50.0);
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  channel->SetPropagationLossModel (propLoss);
+
+  Ptr<WifiNetDevice> sender = CreateOne (Vector (0.0, 0.0, 0.0), channel);
+  Ptr<WifiNetDevice> receiver = CreateOne (Vector (10.0, 0.0, 0.0), channel);
+  receiver->GetPhy ()->TraceConnectWithoutContext ("MonitorSnifferRx",
+                                                   MakeCallback (&YansWifiChannelGridTest::NotifyMonitorSniffRx, this));
+  Ptr<YansWifiPhy> senderPhy = DynamicCast<YansWifiPhy> (sender->GetPhy ());
+
+  Simulator::Schedule (Seconds (1.0), &YansWifiChannelGridTest::SendOnePacket, this, sender);
+  Simulator::Schedule (Seconds (1.5), &YansWifiPhy::SetTxPowerStart, senderPhy, 5.0);
+  Simulator::Schedule (Seconds (1.5), &YansWifiPhy::SetTxPowerEnd, senderPhy, 5.0);
+  Simulator::Schedule (Seconds (2.0), &YansWifiChannelGridTest::SendOnePacket, this, sender);
+  Simulator::Schedule (Seconds (3.0), &YansWifiChannelGridTest::SendOnePacket, this, sender);
+
+  Simulator::Stop (Seconds (4.0));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_signalDbm.size (), 3, "The receiver must receive the three broadcasts");
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_signalDbm[1], m_signalDbm[0], 1e-9, "The rx power must not follow the tx power");
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_signalDbm[2], m_signalDbm[0], 1e-9, "The rx power must not follow the tx power");
+  NS_TEST_EXPECT_MSG_EQ (channel->GetNCacheMisses (), 2, "A new tx power must miss the cache");
+  NS_TEST_EXPECT_MSG_EQ (channel->GetNCacheHits (), 1, "The same tx power must hit the cache");
+  Simulator::Destroy ();
+}
+
+void
+YansWifiChannelGridTest::DoRun (void)
+{
+  uint32_t fullScan = RunOne (0.0, 6);
+  NS_TEST_ASSERT_MSG_EQ (fullScan, 5, "Unexpected number of receptions without the grid");
+  NS_TEST_ASSERT_MSG_EQ (RunOne (100.0, 5), fullScan, "The grid must reach the same receivers as the full scan");
+  NS_TEST_ASSERT_MSG_EQ (RunOne (60.0, 2), 2, "Receivers beyond MaxRange must be skipped");
+  NS_TEST_ASSERT_MSG_EQ (m_cacheHits + m_cacheMisses, 0, "The propagation cache is disabled by default");
+  NS_TEST_ASSERT_MSG_EQ (RunOne (0.0, 6, true), fullScan, "The cache must reach the same receivers as the full scan");
+  // the static pairs hit at the second broadcast, the receiver which moved misses again
+  NS_TEST_ASSERT_MSG_EQ (m_cacheHits, 2, "Unexpected number of cache hits");
+  NS_TEST_ASSERT_MSG_EQ (m_cacheMisses, 4, "Unexpected number of cache misses");
+  // with a single entry, each pair replaces the previous one
+  NS_TEST_ASSERT_MSG_EQ (RunOne (0.0, 6, true, 1), fullScan, "A full cache must reach the same receivers");
+  NS_TEST_ASSERT_MSG_EQ (m_cacheHits, 0, "The pairs must replace each other in a cache of one entry");
+  NS_TEST_ASSERT_MSG_EQ (m_cacheMisses, 6, "Unexpected number of cache misses with a cache of one entry");
+  RunTxPower ();
+}
+
+#ifdef HAVE_PTHREAD_H
+//-----------------------------------------------------------------------------
+/**
+ * Make sure that the YansWifiChannel delivers the broadcasts to the PHYs
+ * of the other partitions of a MultithreadedSimulatorImpl at the same
+ * time as a sequential simulation: the channel must lower the lookahead,
+ * whether derived or given to the WifiPartitionHelper, to the propagation
+ * delay between the closest PHYs of distinct partitions. The partitions
+ * must reach the same receivers with the spatial grid and the propagation
+ * cache. The lookahead must be derived again, and grow back, when PHYs
+ * are detached or change partition, and only then; a detached PHY must
+ * neither receive nor lower the lookahead.
+ */
+class YansWifiChannelParallelTest : public TestCase
+{
+public:
+  YansWifiChannelParallelTest ();
+
+  virtual void DoRun (void);
+private:
+  /// The start of the reception of each broadcast by each node.
+  typedef std::vector<std::vector<Time> > Receptions;
+
+  void RunOne (std::string simulatorType, Time lookahead, bool indexed, Receptions &receptions);
+  void RunDetach (void);
+  Ptr<WifiNetDevice> CreateOne (Vector pos, Ptr<YansWifiChannel> channel, uint32_t index);
+  void SendOnePacket (Ptr<WifiNetDevice> dev);
+  void NotifyPhyRxBegin (std::string index, Ptr<const Packet> p);
+
+  Receptions *m_receptions;
+  Time m_lookahead; //!< the lookahead of the last parallel simulation
+  Time m_closest; //!< the propagation delay between the nodes 2 and 3
+};
+
+YansWifiChannelParallelTest::YansWifiChannelParallelTest ()
+  : TestCase ("YansWifiChannel in a parallel simulation")
+{
+}
+
+void
+YansWifiChannelParallelTest::SendOnePacket (Ptr<WifiNetDevice> dev)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  dev->Send (p, dev->GetBroadcast (), 1);
+}
+
+void
+YansWifiChannelParallelTest::NotifyPhyRxBegin (std::string index, Ptr<const Packet> p)
+{
+  // each node only touches its own receptions.
+  (*m_receptions)[std::atoi (index.c_str ())].push_back (Simulator::Now ());
+}
+
+Ptr<WifiNetDevice>
+YansWifiChannelParallelTest::CreateOne (Vector pos, Ptr<YansWifiChannel> channel, uint32_t index)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<WifiNetDevice> dev = CreateObject<WifiNetDevice> ();
+  ObjectFactory mac;
+  mac.SetTypeId ("ns3::AdhocWifiMac");
+  Ptr<WifiMac> wifiMac = mac.Create<WifiMac> ();
+  wifiMac->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  phy->SetErrorRateModel (CreateObject<YansErrorRateModel> ());
+  phy->SetChannel (channel);
+  phy->SetDevice (dev);
+  phy->SetMobility (node);
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  std::ostringstream oss;
+  oss << index;
+  phy->TraceConnect ("PhyRxBegin", oss.str (), MakeCallback (&YansWifiChannelParallelTest::NotifyPhyRxBegin, this));
+
+  mobility->SetPosition (pos);
+  node->AggregateObject (mobility);
+  wifiMac->SetAddress (Mac48Address::Allocate ());
+  dev->SetMac (wifiMac);
+  dev->SetPhy (phy);
+  dev->SetRemoteStationManager (CreateObject<ConstantRateWifiManager> ());
+  node->AddDevice (dev);
+  return dev;
+}
+
+void
+YansWifiChannelParallelTest::RunOne (std::string simulatorType, Time lookahead, bool indexed, Receptions &receptions)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue (simulatorType));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::Partitions", UintegerValue (2));
+  receptions.clear ();
+  receptions.resize (6);
+  m_receptions = &receptions;
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  if (indexed)
+    {
+      channel->SetAttribute ("MaxRange", DoubleValue (2000.0));
+      channel->SetAttribute ("PropagationCache", BooleanValue (true));
+    }
+  Ptr<RangePropagationLossModel> propLoss = CreateObject<RangePropagationLossModel> ();
+  propLoss->SetAttribute ("MaxRange", DoubleValue (2000.0));
+  Ptr<ConstantSpeedPropagationDelayModel> propDelay = CreateObject<ConstantSpeedPropagationDelayModel> ();
+  channel->SetPropagationDelayModel (propDelay);
+  channel->SetPropagationLossModel (propLoss);
+
+  // the partitions are {0, 1, 2} and {3, 4, 5}: the nodes 2 and 3 are 100 meters apart.
+  double x[] = { 0.0, 100.0, 400.0, 500.0, 900.0, 1000.0 };
+  NodeContainer nodes;
+  std::vector<Ptr<WifiNetDevice> > devices;
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      devices.push_back (CreateOne (Vector (x[i], 0.0, 0.0), channel, i));
+      nodes.Add (devices.back ()->GetNode ());
+    }
+  WifiPartitionHelper partition;
+  partition.SetLookahead (lookahead);
+  partition.Install (nodes, channel);
+  Ptr<MultithreadedSimulatorImpl> impl = DynamicCast<MultithreadedSimulatorImpl> (Simulator::GetImplementation ());
+  if (impl != 0)
+    {
+      m_lookahead = impl->GetLookahead ();
+    }
+  m_closest = propDelay->GetDelay (nodes.Get (2)->GetObject<MobilityModel> (),
+                                   nodes.Get (3)->GetObject<MobilityModel> ());
+
+  Simulator::ScheduleWithContext (0, Seconds (1.0), &YansWifiChannelParallelTest::SendOnePacket, this, devices[0]);
+  Simulator::ScheduleWithContext (5, Seconds (2.0), &YansWifiChannelParallelTest::SendOnePacket, this, devices[5]);
+  Simulator::ScheduleWithContext (2, Seconds (3.0), &YansWifiChannelParallelTest::SendOnePacket, this, devices[2]);
+
+  Simulator::Stop (Seconds (4.0));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (channel->GetNReceptions (), 15, "Unexpected number of scheduled receptions");
+  NS_TEST_EXPECT_MSG_EQ (channel->GetNPacketCopies (), 15, "Unexpected number of packet copies");
+  Simulator::Destroy ();
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+}
+
+void
+YansWifiChannelParallelTest::RunDetach (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::MultithreadedSimulatorImpl"));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::Partitions", UintegerValue (2));
+  Receptions receptions (4);
+  m_receptions = &receptions;
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  Ptr<RangePropagationLossModel> propLoss = CreateObject<RangePropagationLossModel> ();
+  propLoss->SetAttribute ("MaxRange", DoubleValue (2000.0));
+  Ptr<ConstantSpeedPropagationDelayModel> propDelay = CreateObject<ConstantSpeedPropagationDelayModel> ();
+  channel->SetPropagationDelayModel (propDelay);
+  channel->SetPropagationLossModel (propLoss);
+
+  // the partitions are {0, 1} and {2, 3}.
+  double x[] = { 0.0, 100.0, 400.0, 1000.0 };
+  NodeContainer nodes;
+  std::vector<Ptr<WifiNetDevice> > devices;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      devices.push_back (CreateOne (Vector (x[i], 0.0, 0.0), channel, i));
+      nodes.Add (devices.back ()->GetNode ());
+    }
+  WifiPartitionHelper partition;
+  partition.Install (nodes, channel);
+  Ptr<MultithreadedSimulatorImpl> impl = DynamicCast<MultithreadedSimulatorImpl> (Simulator::GetImplementation ());
+  NS_TEST_ASSERT_MSG_NE (impl, 0, "The simulator must be a MultithreadedSimulatorImpl");
+  std::vector<Ptr<MobilityModel> > mobility;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      mobility.push_back (nodes.Get (i)->GetObject<MobilityModel> ());
+    }
+  NS_TEST_EXPECT_MSG_EQ (impl->GetLookahead (), propDelay->GetDelay (mobility[1], mobility[2]),
+                         "The lookahead must be the delay between the nodes 1 and 2");
+
+  // park the nodes 1 and 2 at the same position, as the Highway does
+  mobility[1]->SetPosition (Vector (10000.0, 10000.0, 10000.0));
+  mobility[2]->SetPosition (Vector (10000.0, 10000.0, 10000.0));
+  channel->Detach (DynamicCast<YansWifiPhy> (devices[1]->GetPhy ()));
+  channel->Detach (DynamicCast<YansWifiPhy> (devices[2]->GetPhy ()));
+  channel->PreparePartitions ();
+  Time farthest = propDelay->GetDelay (mobility[0], mobility[3]);
+  NS_TEST_EXPECT_MSG_EQ (impl->GetLookahead (), farthest, "The lookahead must grow back when PHYs are detached");
+
+  mobility[3]->SetPosition (Vector (10.0, 0.0, 0.0));
+  channel->PreparePartitions ();
+  NS_TEST_EXPECT_MSG_EQ (impl->GetLookahead (), farthest, "The lookahead must not be derived again without change");
+
+  impl->SetPartition (nodes.Get (3)->GetId (), 0);
+  channel->PreparePartitions ();
+  NS_TEST_EXPECT_MSG_EQ (impl->GetLookahead (), TimeStep (1), "The channel must lift its limit with a single partition");
+  impl->SetPartition (nodes.Get (3)->GetId (), 1);
+  channel->PreparePartitions ();
+  NS_TEST_EXPECT_MSG_EQ (impl->GetLookahead (), propDelay->GetDelay (mobility[0], mobility[3]),
+                         "The lookahead must be derived again when a PHY changes partition");
+
+  Simulator::ScheduleWithContext (0, Seconds (1.0), &YansWifiChannelParallelTest::SendOnePacket, this, devices[0]);
+  Simulator::ScheduleWithContext (1, Seconds (2.0), &YansWifiChannelParallelTest::SendOnePacket, this, devices[1]);
+  Simulator::Stop (Seconds (3.0));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (channel->GetNReceptions (), 1, "Only the node 3 must receive, from the node 0");
+  NS_TEST_EXPECT_MSG_EQ (receptions[3].size (), 1, "The node 3 must receive the packet of the node 0");
+  NS_TEST_EXPECT_MSG_EQ (receptions[1].size () + receptions[2].size (), 0, "A detached PHY must not receive");
+  Simulator::Destroy ();
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+}
+
+void
+YansWifiChannelParallelTest::DoRun (void)
+{
+  Receptions expected;
+  RunOne ("ns3::DefaultSimulatorImpl", Seconds (0), false, expected);
+  NS_TEST_ASSERT_MSG_LT (m_closest, MicroSeconds (1), "The nodes 2 and 3 must be closer than the given lookahead");
+  Time lookaheads[] = { Seconds (0), MicroSeconds (1), Seconds (0) };
+  bool indexed[] = { false, false, true };
+  for (uint32_t k = 0; k < 3; k++)
+    {
+      Receptions receptions;
+      RunOne ("ns3::MultithreadedSimulatorImpl", lookaheads[k], indexed[k], receptions);
+      NS_TEST_EXPECT_MSG_EQ (m_lookahead, m_closest, "The lookahead must be the delay between the closest partitions");
+      for (uint32_t i = 0; i < 6; i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (receptions[i].size (), expected[i].size (), "Bad number of receptions for node " << i);
+          for (uint32_t j = 0; j < receptions[i].size (); j++)
+            {
+              NS_TEST_EXPECT_MSG_EQ (receptions[i][j], expected[i][j], "Bad reception " << j << " of node " << i <<
+                                     " in the parallel run " << k);
+            }
+        }
+    }
+  RunDetach ();
+}
+#endif
+
+//-----------------------------------------------------------------------------
+/**
+ * \internal
+ * Check that the StationLifetime of a WifiRemoteStationManager forgets
+ * the stations which are not used anymore, and only those.
+ */
+class StationLifetimeTest : public TestCase
+{
+public:
+  StationLifetimeTest ();
+
+  virtual void DoRun (void);
+private:
+  /**
+   * Run the scenario with the given lifetime
+   * \param lifetime the StationLifetime of the manager
+   * \param forget whether the idle station must be forgotten
+   */
+  void RunOne (Time lifetime, bool forget);
+};
+
+StationLifetimeTest::StationLifetimeTest ()
+  : TestCase ("StationLifetime")
+{
+}
+
+void
+StationLifetimeTest::RunOne (Time lifetime, bool forget)
+{
+  Ptr<WifiRemoteStationManager> manager = CreateObject<ConstantRateWifiManager> ();
+  manager->SetAttribute ("StationLifetime", TimeValue (lifetime));
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  manager->SetupPhy (phy);
+  Mac48Address idle ("00:00:00:00:00:01");
+  Mac48Address busy ("00:00:00:00:00:02");
+  Mac48Address late ("00:00:00:00:00:03");
+
+  manager->RecordGotAssocTxOk (idle);
+  manager->RecordGotAssocTxOk (busy);
+  Simulator::Schedule (Seconds (5.0), &WifiRemoteStationManager::IsAssociated, manager, busy);
+  Simulator::Schedule (Seconds (11.0), &WifiRemoteStationManager::IsBrandNew, manager, late);
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (manager->IsAssociated (busy), true, "A station used within the lifetime must be kept");
+  NS_TEST_EXPECT_MSG_EQ (manager->IsAssociated (late), false,
+                         "A station first looked up after the others were evicted must start unassociated");
+  NS_TEST_EXPECT_MSG_EQ (manager->IsAssociated (idle), !forget,
+                         "An idle station must be evicted once StationLifetime has elapsed, and only then");
+
+  manager->Dispose ();
+  Simulator::Destroy ();
+}
+
+void
+StationLifetimeTest::DoRun (void)
+{
+  RunOne (Seconds (0.0), false);
+  RunOne (Seconds (20.0), false);
+  RunOne (Seconds (10.0), true);
+}
+
 //-----------------------------------------------------------------------------
 class WifiTestSuite : public TestSuite
 {
@@ -491,7 +1588,13 @@ WifiTestSuite::WifiTestSuite ()
   AddTestCase (new WifiTest, TestCase::QUICK);
   AddTestCase (new QosUtilsIsOldPacketTest, TestCase::QUICK);
   AddTestCase (new InterferenceHelperSequenceTest, TestCase::QUICK); // Bug 991
+  AddTestCase (new InterferenceHelperDifferentialTest, TestCase::QUICK);
   AddTestCase (new Bug555TestCase, TestCase::QUICK); // Bug 555
+  AddTestCase (new YansWifiChannelGridTest, TestCase::QUICK);
+  AddTestCase (new StationLifetimeTest, TestCase::QUICK);
+#ifdef HAVE_PTHREAD_H
+  AddTestCase (new YansWifiChannelParallelTest, TestCase::QUICK);
+#endif
 }
 
 static WifiTestSuite g_wifiTestSuite;
@@ -0,0 +1,146 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "ns3/core-module.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/error-rate-model.h"
+#include "ns3/table-error-rate-model.h"
+
+using namespace ns3;
+
+std::string g_me;
+#define LOG(x)   std::cout << x << std::endl
+#define LOGME(x) LOG (g_me << x)
+
+// Output field width
+int g_fwidth = 14;
+
+/**
+ * A chunk, as seen by InterferenceHelper: the error rate models are
+ * queried with the same chunks, which are drawn before the clock starts.
+ */
+struct BenchChunk
+{
+  WifiMode mode;
+  double snr;
+  uint32_t nbits;
+};
+
+/**
+ * Query the model with the chunks, and return the success rates.  The
+ * largest difference with the reference success rates, if any, is
+ * reported.
+ */
+static std::vector<double>
+Run (std::string name, Ptr<ErrorRateModel> model, const std::vector<BenchChunk> &chunks,
+     const std::vector<double> *reference)
+{
+  // the first query of a mode builds the table of a TableErrorRateModel.
+  SystemWallClockMs time;
+  time.Start ();
+  for (std::vector<BenchChunk>::const_iterator i = chunks.begin (); i != chunks.end (); ++i)
+    {
+      model->GetChunkSuccessRate (i->mode, i->snr, i->nbits);
+    }
+  double setup = time.End () / 1000.0;
+
+  std::vector<double> rates (chunks.size ());
+  time.Start ();
+  for (uint32_t i = 0; i < chunks.size (); i++)
+    {
+      rates[i] = model->GetChunkSuccessRate (chunks[i].mode, chunks[i].snr, chunks[i].nbits);
+    }
+  double seconds = time.End () / 1000.0;
+
+  double maxError = 0.0;
+  for (uint32_t i = 0; reference != 0 && i < rates.size (); i++)
+    {
+      maxError = std::max (maxError, std::fabs (rates[i] - (*reference)[i]));
+    }
+  LOG (std::left << std::setw (3 * g_fwidth) << name <<
+       std::setw (g_fwidth) << setup <<
+       std::setw (g_fwidth) << seconds <<
+       std::setw (g_fwidth) << (seconds > 0 ? chunks.size () / seconds : 0) <<
+       std::setw (g_fwidth) << maxError);
+  return rates;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 1000000;
+  double minSnrDb = -5.0;
+  double maxSnrDb = 35.0;
+  double maxError = 1e-6;
+
+  CommandLine cmd;
+  cmd.Usage ("Compare the cost of the chunk success rate of the error rate models\n"
+             "with the cost of their tabulation by ns3::TableErrorRateModel.\n"
+             "\n"
+             "The setup time includes the first query of each mode, which\n"
+             "builds the tables.  The error is the largest difference between\n"
+             "the success rates of a tabulated model and of the model above it.");
+  cmd.AddValue ("n",        "number of chunks",                         n);
+  cmd.AddValue ("minSnr",   "lowest SNR of the chunks (dB)",            minSnrDb);
+  cmd.AddValue ("maxSnr",   "highest SNR of the chunks (dB)",           maxSnrDb);
+  cmd.AddValue ("maxError", "MaxError attribute of the tabulated models", maxError);
+  cmd.Parse (argc, argv);
+  g_me = cmd.GetName () + ": ";
+
+  std::vector<WifiMode> modes;
+  modes.push_back (WifiPhy::GetDsssRate1Mbps ());
+  modes.push_back (WifiPhy::GetDsssRate11Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate6Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate12Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate24Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate54Mbps ());
+
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  std::vector<BenchChunk> chunks (n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      chunks[i].mode = modes[random->GetInteger (0, modes.size () - 1)];
+      chunks[i].snr = std::pow (10.0, random->GetValue (minSnrDb, maxSnrDb) / 10.0);
+      chunks[i].nbits = random->GetInteger (1, 1500 * 8);
+    }
+  LOGME ("chunks: " << n << ", SNR: [" << minSnrDb << ", " << maxSnrDb << "] dB, modes: " << modes.size ());
+
+  LOG ("");
+  LOG (std::left << std::setw (3 * g_fwidth) << "Model" <<
+       std::setw (g_fwidth) << "Setup (s)" <<
+       std::setw (g_fwidth) << "Time (s)" <<
+       std::setw (g_fwidth) << "Rate (ch/s)" <<
+       std::setw (g_fwidth) << "Max error");
+  std::string models[] = { "ns3::YansErrorRateModel", "ns3::NistErrorRateModel" };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      ObjectFactory factory (models[i]);
+      Ptr<ErrorRateModel> model = factory.Create<ErrorRateModel> ();
+      std::vector<double> rates = Run (models[i], model, chunks, 0);
+      Ptr<TableErrorRateModel> table = CreateObject<TableErrorRateModel> ();
+      table->SetAttribute ("ErrorRateModel", PointerValue (model));
+      table->SetAttribute ("MaxError", DoubleValue (maxError));
+      Run ("  tabulated", table, chunks, &rates);
+    }
+  return 0;
+}
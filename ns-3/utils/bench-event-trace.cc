@@ -0,0 +1,216 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+#include "ns3/core-module.h"
+#include "ns3/event-trace-simulator-impl.h"
+
+using namespace ns3;
+
+std::string g_me;
+#define LOG(x)   std::cout << x << std::endl
+#define LOGME(x) LOG (g_me << x)
+
+// Output field width
+int g_fwidth = 14;
+
+static void
+Nothing (void)
+{
+}
+
+/**
+ * Replays the records of an event trace against a scheduler: the
+ * insertions, removals and cancellations are applied as the simulator
+ * applies them, and each RUN record dequeues the next event which was
+ * not cancelled. No model code runs.
+ */
+class Replay
+{
+public:
+  Replay (const std::vector<EventTraceReader::Record> &records);
+  void Run (std::string scheduler);
+
+private:
+  const std::vector<EventTraceReader::Record> &m_records;
+  uint32_t m_nInserts;
+  uint32_t m_nRuns;
+};
+
+Replay::Replay (const std::vector<EventTraceReader::Record> &records)
+  : m_records (records),
+    m_nInserts (0),
+    m_nRuns (0)
+{
+  for (std::vector<EventTraceReader::Record>::const_iterator i = m_records.begin (); i != m_records.end (); ++i)
+    {
+      m_nInserts += (i->type == EventTraceSimulatorImpl::INSERT) ? 1 : 0;
+      m_nRuns += (i->type == EventTraceSimulatorImpl::RUN) ? 1 : 0;
+    }
+}
+
+void
+Replay::Run (std::string scheduler)
+{
+  ObjectFactory factory (scheduler);
+  Ptr<Scheduler> events = factory.Create<Scheduler> ();
+  // the events are allocated before the clock starts.
+  std::vector<Scheduler::Event> inserted (m_nInserts);
+  for (uint32_t i = 0; i < m_nInserts; i++)
+    {
+      inserted[i].impl = MakeEvent (&Nothing);
+      inserted[i].key.m_uid = i + 4;
+    }
+
+  uint64_t now = 0;
+  uint32_t size = 0;
+  uint32_t peak = 0;
+  uint32_t mismatches = 0;
+  SystemWallClockMs time;
+  time.Start ();
+  for (std::vector<EventTraceReader::Record>::const_iterator i = m_records.begin (); i != m_records.end (); ++i)
+    {
+      Scheduler::Event &ev = inserted[i->index];
+      switch (i->type)
+        {
+        case EventTraceSimulatorImpl::INSERT:
+          ev.key.m_ts = now + i->delay;
+          ev.key.m_context = i->context;
+          events->Insert (ev);
+          size++;
+          peak = std::max (peak, size);
+          break;
+        case EventTraceSimulatorImpl::REMOVE:
+          events->Remove (ev);
+          size--;
+          break;
+        case EventTraceSimulatorImpl::CANCEL:
+          ev.impl->Cancel ();
+          if (events->Cancel (ev))
+            {
+              size--;
+            }
+          break;
+        case EventTraceSimulatorImpl::RUN:
+          {
+            Scheduler::Event next;
+            do
+              {
+                NS_ABORT_MSG_IF (events->IsEmpty (), "The trace runs an event which was not inserted");
+                next = events->RemoveNext ();
+                size--;
+              }
+            while (next.impl->IsCancelled ());
+            now = next.key.m_ts;
+            mismatches += (next.impl != ev.impl) ? 1 : 0;
+          }
+          break;
+        }
+    }
+  double seconds = time.End () / 1000.0;
+
+  LOG (std::left << std::setw (3 * g_fwidth) << scheduler <<
+       std::setw (g_fwidth) << seconds <<
+       std::setw (g_fwidth) << (m_nRuns / seconds) <<
+       std::setw (g_fwidth) << peak <<
+       std::setw (g_fwidth) << mismatches);
+  for (uint32_t i = 0; i < m_nInserts; i++)
+    {
+      inserted[i].impl->Unref ();
+    }
+}
+
+int main (int argc, char *argv[])
+{
+  std::string filename = "";
+  std::string scheduler = "ns3::MapScheduler";
+  bool all = false;
+  uint32_t runs = 1;
+
+  CommandLine cmd;
+  cmd.Usage ("Replay an event trace against the schedulers.\n"
+             "\n"
+             "The trace is recorded by running a scenario with the\n"
+             "ns3::EventTraceSimulatorImpl simulator implementation.\n"
+             "For each scheduler, the run rate counts the events which\n"
+             "were not cancelled, and the peak is the largest number of\n"
+             "events held by the scheduler, cancelled ones included.\n"
+             "A mismatch is an event run out of the recorded order.");
+  cmd.AddValue ("file",      "the event trace to replay",                  filename);
+  cmd.AddValue ("scheduler", "the scheduler to use (default MapScheduler)", scheduler);
+  cmd.AddValue ("all",       "replay the trace with each scheduler",       all);
+  cmd.AddValue ("runs",      "number of runs (default 1)",                 runs);
+  cmd.Parse (argc, argv);
+  g_me = cmd.GetName () + ": ";
+
+  EventTraceReader reader;
+  if (!reader.Open (filename))
+    {
+      LOGME ("could not read an event trace from \"" << filename << "\"");
+      return 1;
+    }
+  std::vector<EventTraceReader::Record> records;
+  EventTraceReader::Record record;
+  uint64_t counts[4] = { 0, 0, 0, 0 };
+  while (reader.Read (record))
+    {
+      records.push_back (record);
+      counts[record.type]++;
+    }
+  uint64_t inserts = counts[EventTraceSimulatorImpl::INSERT];
+  LOGME ("file: " << filename);
+  LOGME ("records: " << records.size ());
+  LOGME ("inserted: " << inserts <<
+         ", removed: " << counts[EventTraceSimulatorImpl::REMOVE] <<
+         ", cancelled: " << counts[EventTraceSimulatorImpl::CANCEL] <<
+         ", run: " << counts[EventTraceSimulatorImpl::RUN]);
+  LOGME ("cancel ratio: " << (inserts > 0 ? double (counts[EventTraceSimulatorImpl::CANCEL]) / inserts : 0));
+
+  std::vector<std::string> schedulers;
+  if (all)
+    {
+      schedulers.push_back ("ns3::ListScheduler");
+      schedulers.push_back ("ns3::MapScheduler");
+      schedulers.push_back ("ns3::HeapScheduler");
+      schedulers.push_back ("ns3::CalendarScheduler");
+      schedulers.push_back ("ns3::IndexedHeapScheduler");
+      schedulers.push_back ("ns3::LadderScheduler");
+    }
+  else
+    {
+      schedulers.push_back (scheduler);
+    }
+
+  LOG ("");
+  LOG (std::left << std::setw (3 * g_fwidth) << "Scheduler" <<
+       std::setw (g_fwidth) << "Time (s)" <<
+       std::setw (g_fwidth) << "Rate (ev/s)" <<
+       std::setw (g_fwidth) << "Peak queue" <<
+       std::setw (g_fwidth) << "Mismatches");
+  Replay replay (records);
+  for (std::vector<std::string>::const_iterator i = schedulers.begin (); i != schedulers.end (); ++i)
+    {
+      for (uint32_t run = 0; run < runs; run++)
+        {
+          replay.Run (*i);
+        }
+    }
+  return 0;
+}
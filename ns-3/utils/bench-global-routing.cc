@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "ns3/global-router-interface.h"
+
+using namespace ns3;
+
+std::string g_me;
+#define LOG(x)   std::cout << x << std::endl
+#define LOGME(x) LOG (g_me << x)
+
+// Output field width
+int g_fwidth = 14;
+
+/**
+ * Hash the routing tables of the routers, in order.
+ */
+static uint64_t
+HashRoutes (const NodeContainer &routers, uint32_t &nRoutes)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  nRoutes = 0;
+  for (uint32_t i = 0; i < routers.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = routers.Get (i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+        {
+          Ipv4RoutingTableEntry *route = routing->GetRoute (j);
+          uint32_t fields[5] = { i, route->GetDest ().Get (), route->GetDestNetworkMask ().Get (),
+                                 route->GetGateway ().Get (), route->GetInterface () };
+          for (uint32_t k = 0; k < 5; k++)
+            {
+              hash = (hash ^ fields[k]) * 1099511628211ULL;
+            }
+          nRoutes++;
+        }
+    }
+  return hash;
+}
+
+/**
+ * Compute the routes on the given number of threads.
+ */
+static uint64_t
+Run (const NodeContainer &routers, uint32_t threads, bool first)
+{
+  Config::SetGlobalFailSafe ("GlobalRoutingSpfThreads", UintegerValue (threads));
+  SystemWallClockMs time;
+  time.Start ();
+  if (first)
+    {
+      Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+    }
+  else
+    {
+      Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+    }
+  int64_t elapsed = time.End ();
+  uint32_t nRoutes;
+  uint64_t hash = HashRoutes (routers, nRoutes);
+  LOG (std::left << std::setw (g_fwidth) << threads <<
+       std::setw (g_fwidth) << elapsed <<
+       std::setw (g_fwidth) << nRoutes <<
+       std::hex << hash << std::dec);
+  return hash;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t routers = 500;
+  uint32_t links = 2;
+  uint32_t threads = 0;
+  bool phases = false;
+
+  CommandLine cmd;
+  cmd.Usage ("Compare the cost of the global routing setup with its SPF\n"
+             "calculations on one thread and on several threads.\n"
+             "\n"
+             "The routers are joined by point-to-point links, each router to\n"
+             "as many routers created before it, chosen at random.  The routes\n"
+             "are computed on one thread first, then on the given number of\n"
+             "threads, and the routing tables of both must hash the same.");
+  cmd.AddValue ("routers", "number of routers",                                    routers);
+  cmd.AddValue ("links",   "number of links of each new router",                   links);
+  cmd.AddValue ("threads", "number of threads, one per online processor if zero",  threads);
+  cmd.AddValue ("phases",  "log the time spent in each phase of the setup",        phases);
+  cmd.Parse (argc, argv);
+  g_me = cmd.GetName () + ": ";
+  if (phases)
+    {
+      LogComponentEnable ("GlobalRouteManagerImpl", LOG_LEVEL_INFO);
+    }
+
+  NodeContainer nodes;
+  nodes.Create (routers);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  SimpleNetDeviceHelper devHelper;
+  devHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.255.255.252");
+  uint32_t nLinks = 0;
+  for (uint32_t i = 1; i < routers; i++)
+    {
+      std::vector<uint32_t> peers;
+      while (peers.size () < std::min (i, links))
+        {
+          uint32_t peer = random->GetInteger (0, i - 1);
+          if (std::find (peers.begin (), peers.end (), peer) == peers.end ())
+            {
+              peers.push_back (peer);
+            }
+        }
+      for (uint32_t j = 0; j < peers.size (); j++)
+        {
+          ipv4.Assign (devHelper.Install (NodeContainer (nodes.Get (i), nodes.Get (peers[j]))));
+          ipv4.NewNetwork ();
+          nLinks++;
+        }
+    }
+  LOGME ("routers: " << routers << ", links: " << nLinks);
+
+  LOG ("");
+  LOG (std::left << std::setw (g_fwidth) << "Threads" <<
+       std::setw (g_fwidth) << "Setup (ms)" <<
+       std::setw (g_fwidth) << "Routes" <<
+       "Hash");
+  uint64_t serial = Run (nodes, 1, true);
+  uint64_t parallel = Run (nodes, threads, false);
+
+  Simulator::Destroy ();
+  if (serial != parallel)
+    {
+      LOGME ("the routing tables computed on one and on several threads differ");
+      return 1;
+    }
+  return 0;
+}
@@ -0,0 +1,198 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/node.h"
+#include "ns3/loopback-net-device.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-end-point.h"
+#include "../src/internet/model/ipv4-end-point-demux.h"
+
+using namespace ns3;
+
+std::string g_me;
+#define LOG(x)   std::cout << x << std::endl
+#define LOGME(x) LOG (g_me << x)
+
+// Output field width
+int g_fwidth = 14;
+
+/**
+ * A received segment, drawn before the clock starts.
+ */
+struct Segment
+{
+  Ipv4Address daddr;
+  uint16_t dport;
+  Ipv4Address saddr;
+  uint16_t sport;
+};
+
+/**
+ * The lookup as done by Ipv4EndPointDemux before its end points were
+ * indexed: a scan of every end point, keeping the four classes of match.
+ * The destinations of the benchmark are never broadcast addresses.
+ */
+static Ipv4EndPointDemux::EndPoints
+ScanLookup (const Ipv4EndPointDemux::EndPoints &endPoints,
+            Ipv4Address daddr, uint16_t dport, Ipv4Address saddr, uint16_t sport)
+{
+  Ipv4EndPointDemux::EndPoints retval1;
+  Ipv4EndPointDemux::EndPoints retval2;
+  Ipv4EndPointDemux::EndPoints retval3;
+  Ipv4EndPointDemux::EndPoints retval4;
+  for (Ipv4EndPointDemux::EndPoints::const_iterator i = endPoints.begin (); i != endPoints.end (); i++)
+    {
+      Ipv4EndPoint *endP = *i;
+      if (endP->GetLocalPort () != dport)
+        {
+          continue;
+        }
+      bool localWildCard = endP->GetLocalAddress () == Ipv4Address::GetAny ();
+      bool localExact = endP->GetLocalAddress () == daddr;
+      bool peerExact = endP->GetPeerPort () == sport;
+      bool peerWildCard = endP->GetPeerPort () == 0;
+      bool remoteExact = endP->GetPeerAddress () == saddr;
+      bool remoteWildCard = endP->GetPeerAddress () == Ipv4Address::GetAny ();
+      if (!(localExact || localWildCard) || !(peerExact || peerWildCard) || !(remoteExact || remoteWildCard))
+        {
+          continue;
+        }
+      if (localWildCard && peerWildCard && remoteWildCard)
+        {
+          retval1.push_back (endP);
+        }
+      if (localExact && peerWildCard && remoteWildCard)
+        {
+          retval2.push_back (endP);
+        }
+      if (localWildCard && peerExact && remoteExact)
+        {
+          retval3.push_back (endP);
+        }
+      if (localExact && peerExact && remoteExact)
+        {
+          retval4.push_back (endP);
+        }
+    }
+  if (!retval4.empty ()) return retval4;
+  if (!retval3.empty ()) return retval3;
+  if (!retval2.empty ()) return retval2;
+  return retval1;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t endPoints = 10000;
+  uint32_t listeners = 100;
+  uint32_t segments = 100000;
+  uint32_t rounds = 10;
+
+  CommandLine cmd;
+  cmd.Usage ("Compare the cost of Ipv4EndPointDemux::Lookup with the scan of\n"
+             "every end point it replaces.\n"
+             "\n"
+             "The demux holds listening end points on distinct ports and\n"
+             "connected end points accepted on them; the segments are received\n"
+             "on random connections.  The costs are given per segment (ns),\n"
+             "averaged over the rounds.");
+  cmd.AddValue ("endpoints", "number of connected end points",            endPoints);
+  cmd.AddValue ("listeners", "number of listening end points",            listeners);
+  cmd.AddValue ("segments",  "number of segments looked up per round",    segments);
+  cmd.AddValue ("rounds",    "number of times the segments are looked up", rounds);
+  cmd.Parse (argc, argv);
+  g_me = cmd.GetName () + ": ";
+
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<LoopbackNetDevice> device = CreateObject<LoopbackNetDevice> ();
+  node->AddDevice (device);
+  Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface> ();
+  interface->SetNode (node);
+  interface->SetDevice (device);
+  interface->AddAddress (Ipv4InterfaceAddress ("10.0.0.1", "255.0.0.0"));
+  Ipv4Address local ("10.0.0.1");
+
+  // the connections are accepted by random listeners, from random peers
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  Ipv4EndPointDemux demux;
+  for (uint32_t i = 0; i < listeners; i++)
+    {
+      demux.Allocate (1000 + i);
+    }
+  std::vector<Segment> connections;
+  while (connections.size () < endPoints)
+    {
+      Segment segment;
+      segment.daddr = local;
+      segment.dport = 1000 + random->GetInteger (0, listeners - 1);
+      segment.saddr = Ipv4Address (0x0b000000 + random->GetInteger (0, 0xffffff));
+      segment.sport = random->GetInteger (1024, 65535);
+      if (demux.Allocate (segment.daddr, segment.dport, segment.saddr, segment.sport) != 0)
+        {
+          connections.push_back (segment);
+        }
+    }
+  std::vector<Segment> received (segments);
+  for (uint32_t i = 0; i < segments; i++)
+    {
+      received[i] = connections[random->GetInteger (0, connections.size () - 1)];
+    }
+  LOGME ("endpoints: " << endPoints << ", listeners: " << listeners <<
+         ", segments: " << segments << ", rounds: " << rounds);
+
+  // the clock ticks are coarse: accumulate over the rounds.
+  Ipv4EndPointDemux::EndPoints all = demux.GetAllEndPoints ();
+  SystemWallClockMs time;
+  int64_t scan = 0;
+  int64_t lookup = 0;
+  uint32_t mismatches = 0;
+  for (uint32_t round = 0; round < rounds; round++)
+    {
+      uint32_t found = 0;
+      time.Start ();
+      for (uint32_t i = 0; i < segments; i++)
+        {
+          const Segment &s = received[i];
+          found += ScanLookup (all, s.daddr, s.dport, s.saddr, s.sport).size ();
+        }
+      scan += time.End ();
+
+      time.Start ();
+      for (uint32_t i = 0; i < segments; i++)
+        {
+          const Segment &s = received[i];
+          found -= demux.Lookup (s.daddr, s.dport, s.saddr, s.sport, interface).size ();
+        }
+      lookup += time.End ();
+      mismatches += found != 0;
+    }
+
+  LOG ("");
+  LOG (std::left << std::setw (g_fwidth) << "Lookup" << std::setw (g_fwidth) << "Segment (ns)");
+  LOG (std::left << std::setw (g_fwidth) << "scan" << std::setw (g_fwidth) << (scan * 1e6 / segments / rounds));
+  LOG (std::left << std::setw (g_fwidth) << "indexed" << std::setw (g_fwidth) << (lookup * 1e6 / segments / rounds));
+  if (mismatches != 0)
+    {
+      LOGME ("the two lookups found different end points");
+      return 1;
+    }
+  return 0;
+}
@@ -0,0 +1,248 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <list>
+#include <utility>
+
+#include "ns3/core-module.h"
+#include "ns3/node.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-global-routing.h"
+
+using namespace ns3;
+
+std::string g_me;
+#define LOG(x)   std::cout << x << std::endl
+#define LOGME(x) LOG (g_me << x)
+
+// Output field width
+int g_fwidth = 14;
+
+/**
+ * The routes of the routing protocols as the former lookups scanned
+ * them: a list of (entry, metric).
+ */
+typedef std::list<std::pair<Ipv4RoutingTableEntry *, uint32_t> > RouteList;
+
+/**
+ * The longest prefix match of Ipv4StaticRouting before its routes were
+ * kept in an Ipv4PrefixTrie.
+ */
+static Ptr<Ipv4Route>
+ScanStatic (const RouteList &routes, Ptr<Ipv4> ipv4, Ipv4Address dest)
+{
+  Ipv4RoutingTableEntry *found = 0;
+  uint16_t longest_mask = 0;
+  uint32_t shortest_metric = 0xffffffff;
+  for (RouteList::const_iterator i = routes.begin (); i != routes.end (); i++)
+    {
+      Ipv4Mask mask = i->first->GetDestNetworkMask ();
+      uint16_t masklen = mask.GetPrefixLength ();
+      if (!mask.IsMatch (dest, i->first->GetDestNetwork ()) || masklen < longest_mask)
+        {
+          continue;
+        }
+      if (masklen > longest_mask)
+        {
+          shortest_metric = 0xffffffff;
+        }
+      longest_mask = masklen;
+      if (i->second > shortest_metric)
+        {
+          continue;
+        }
+      shortest_metric = i->second;
+      found = i->first;
+    }
+  if (found == 0)
+    {
+      return 0;
+    }
+  Ptr<Ipv4Route> route = Create<Ipv4Route> ();
+  route->SetDestination (found->GetDest ());
+  route->SetSource (ipv4->GetAddress (found->GetInterface (), 0).GetLocal ());
+  route->SetGateway (found->GetGateway ());
+  route->SetOutputDevice (ipv4->GetNetDevice (found->GetInterface ()));
+  return route;
+}
+
+/**
+ * The lookup of the network routes of Ipv4GlobalRouting before its
+ * routes were kept in an Ipv4PrefixTrie: the first matching route.
+ */
+static Ptr<Ipv4Route>
+ScanGlobal (const RouteList &routes, Ptr<Ipv4> ipv4, Ipv4Address dest)
+{
+  for (RouteList::const_iterator i = routes.begin (); i != routes.end (); i++)
+    {
+      if (i->first->GetDestNetworkMask ().IsMatch (dest, i->first->GetDestNetwork ()))
+        {
+          Ptr<Ipv4Route> route = Create<Ipv4Route> ();
+          route->SetDestination (i->first->GetDest ());
+          route->SetSource (ipv4->GetAddress (i->first->GetInterface (), 0).GetLocal ());
+          route->SetGateway (i->first->GetGateway ());
+          route->SetOutputDevice (ipv4->GetNetDevice (i->first->GetInterface ()));
+          return route;
+        }
+    }
+  return 0;
+}
+
+/**
+ * Look the destinations up with the routing protocol, then with the
+ * scan, and check that both found the same gateways.
+ */
+template <typename Scan>
+bool
+Run (std::string name, Ptr<Ipv4RoutingProtocol> routing, Scan scan, const RouteList &routes,
+     Ptr<Ipv4> ipv4, const std::vector<Ipv4Address> &destinations, uint32_t rounds)
+{
+  // the clock ticks are coarse: accumulate over the rounds.
+  SystemWallClockMs time;
+  int64_t scanned = 0;
+  int64_t indexed = 0;
+  bool same = true;
+  for (uint32_t round = 0; round < rounds; round++)
+    {
+      std::vector<Ipv4Address> gateways (destinations.size ());
+      time.Start ();
+      for (uint32_t i = 0; i < destinations.size (); i++)
+        {
+          Ptr<Ipv4Route> route = scan (routes, ipv4, destinations[i]);
+          gateways[i] = route == 0 ? Ipv4Address::GetAny () : route->GetGateway ();
+        }
+      scanned += time.End ();
+
+      time.Start ();
+      for (uint32_t i = 0; i < destinations.size (); i++)
+        {
+          Ipv4Header header;
+          header.SetDestination (destinations[i]);
+          Socket::SocketErrno sockerr;
+          Ptr<Ipv4Route> route = routing->RouteOutput (0, header, 0, sockerr);
+          same = same && gateways[i] == (route == 0 ? Ipv4Address::GetAny () : route->GetGateway ());
+        }
+      indexed += time.End ();
+    }
+
+  LOG (std::left << std::setw (g_fwidth) << name <<
+       std::setw (g_fwidth) << (scanned * 1e6 / destinations.size () / rounds) <<
+       std::setw (g_fwidth) << (indexed * 1e6 / destinations.size () / rounds));
+  return same;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t routes = 5000;
+  uint32_t lookups = 20000;
+  uint32_t rounds = 10;
+
+  CommandLine cmd;
+  cmd.Usage ("Compare the cost of the route lookups of Ipv4StaticRouting and\n"
+             "Ipv4GlobalRouting with the scans of their route lists they replace.\n"
+             "\n"
+             "The routes go to random networks of 10.0.0.0/8 with prefixes of\n"
+             "16 to 30 bits, as on the routers of a large generated topology,\n"
+             "and the destinations are random addresses of 10.0.0.0/8.  The costs\n"
+             "are given per lookup (ns), averaged over the rounds.");
+  cmd.AddValue ("routes",  "number of network routes",                routes);
+  cmd.AddValue ("lookups", "number of destinations looked up",        lookups);
+  cmd.AddValue ("rounds",  "number of times the lookups are repeated", rounds);
+  cmd.Parse (argc, argv);
+  g_me = cmd.GetName () + ": ";
+
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      node->AddDevice (device);
+      int32_t ifIndex = ipv4->AddInterface (device);
+      ipv4->AddAddress (ifIndex, Ipv4InterfaceAddress (Ipv4Address (0xc0a80001 + (i << 8)), Ipv4Mask ("/24")));
+      ipv4->SetUp (ifIndex);
+    }
+
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  Ptr<Ipv4StaticRouting> staticRouting = CreateObject<Ipv4StaticRouting> ();
+  staticRouting->SetIpv4 (ipv4);
+  Ptr<Ipv4GlobalRouting> globalRouting = CreateObject<Ipv4GlobalRouting> ();
+  globalRouting->SetIpv4 (ipv4);
+  for (uint32_t i = 0; i < routes; i++)
+    {
+      uint32_t length = random->GetInteger (16, 30);
+      Ipv4Mask mask (0xffffffff << (32 - length));
+      Ipv4Address network = Ipv4Address (0x0a000000 | random->GetInteger (0, 0xffffff)).CombineMask (mask);
+      Ipv4Address gateway (0xc0a80002 + (i % 4 << 8));
+      staticRouting->AddNetworkRouteTo (network, mask, gateway, 1 + i % 4);
+      globalRouting->AddNetworkRouteTo (network, mask, gateway, 1 + i % 4);
+    }
+  staticRouting->SetDefaultRoute (Ipv4Address ("192.168.0.2"), 1);
+
+  // the scans run on copies of the routes, in the same order
+  RouteList staticRoutes;
+  for (uint32_t i = 0; i < staticRouting->GetNRoutes (); i++)
+    {
+      Ipv4RoutingTableEntry *entry = new Ipv4RoutingTableEntry (staticRouting->GetRoute (i));
+      staticRoutes.push_back (std::make_pair (entry, staticRouting->GetMetric (i)));
+    }
+  RouteList globalRoutes;
+  for (uint32_t i = 0; i < globalRouting->GetNRoutes (); i++)
+    {
+      globalRoutes.push_back (std::make_pair (new Ipv4RoutingTableEntry (*globalRouting->GetRoute (i)), 0));
+    }
+
+  std::vector<Ipv4Address> destinations (lookups);
+  for (uint32_t i = 0; i < lookups; i++)
+    {
+      destinations[i] = Ipv4Address (0x0a000000 | random->GetInteger (0, 0xffffff));
+    }
+  LOGME ("routes: " << routes << ", lookups: " << lookups << ", rounds: " << rounds);
+
+  LOG ("");
+  LOG (std::left << std::setw (g_fwidth) << "Routing" <<
+       std::setw (g_fwidth) << "Scan (ns)" <<
+       std::setw (g_fwidth) << "Trie (ns)");
+  bool same = Run ("static", staticRouting, ScanStatic, staticRoutes, ipv4, destinations, rounds);
+  same = Run ("global", globalRouting, ScanGlobal, globalRoutes, ipv4, destinations, rounds) && same;
+
+  for (RouteList::iterator i = staticRoutes.begin (); i != staticRoutes.end (); i++)
+    {
+      delete i->first;
+    }
+  for (RouteList::iterator i = globalRoutes.begin (); i != globalRoutes.end (); i++)
+    {
+      delete i->first;
+    }
+  Simulator::Destroy ();
+  if (!same)
+    {
+      LOGME ("the routes found by the lookups and the scans differ");
+      return 1;
+    }
+  return 0;
+}
@@ -0,0 +1,344 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <set>
+#include <list>
+#include <utility>
+#include <algorithm>
+
+#include "ns3/core-module.h"
+#include "ns3/PieceRarityIndex.h"
+
+using namespace ns3;
+using namespace ns3::bittorrent;
+
+std::string g_me;
+#define LOG(x)   std::cout << x << std::endl
+#define LOGME(x) LOG (g_me << x)
+
+// Output field width
+int g_fwidth = 14;
+
+/**
+ * The bitfields of the peers, and the HAVE messages they send after
+ * announcing their bitfields.  They are drawn before the clock starts.
+ */
+struct Swarm
+{
+  std::vector<std::vector<bool> > bitfields;
+  std::vector<std::pair<uint32_t, uint32_t> > haves;  // (peer, piece)
+};
+
+/**
+ * The rarity buckets as they were kept by RarestFirstPartSelectionStrategy
+ * before PieceRarityIndex: one std::set per rarity, and a scan of every
+ * bucket with temporary move lists per bitfield or departure.
+ */
+class SetBuckets
+{
+public:
+  SetBuckets (uint32_t pieces, uint16_t maxPeers)
+    : m_maxPeers (maxPeers),
+      m_raritiesByPiece (pieces, 0)
+  {
+    m_piecesByRarity = new std::set<uint32_t>[maxPeers + 2];
+    for (uint32_t i = 0; i < pieces; ++i)
+      {
+        m_piecesByRarity[0].insert (i);
+      }
+  }
+  ~SetBuckets ()
+  {
+    delete[] m_piecesByRarity;
+  }
+  void Bitfield (const std::vector<bool> &bitfield)
+  {
+    Move (bitfield, 0, m_maxPeers - 1, 1);
+  }
+  void Close (const std::vector<bool> &bitfield)
+  {
+    Move (bitfield, 1, m_maxPeers, -1);
+  }
+  void Have (uint32_t piece)
+  {
+    uint16_t rarity = m_raritiesByPiece[piece];
+    if (rarity < m_maxPeers)
+      {
+        m_piecesByRarity[rarity].erase (piece);
+        m_piecesByRarity[rarity + 1].insert (piece);
+        m_raritiesByPiece[piece] = rarity + 1;
+      }
+  }
+  uint16_t GetRarity (uint32_t piece) const
+  {
+    return m_raritiesByPiece[piece];
+  }
+  std::vector<uint32_t> GetBucket (uint16_t rarity) const
+  {
+    return std::vector<uint32_t> (m_piecesByRarity[rarity].begin (), m_piecesByRarity[rarity].end ());
+  }
+private:
+  typedef std::list<std::pair<uint16_t, std::set<uint32_t>::iterator> > MoveList;
+  void Move (const std::vector<bool> &bitfield, uint16_t first, uint16_t last, int shift)
+  {
+    MoveList *toMove = new MoveList[m_maxPeers];
+    for (uint16_t i = first; i <= last; ++i)
+      {
+        for (std::set<uint32_t>::iterator it = m_piecesByRarity[i].begin (); it != m_piecesByRarity[i].end (); ++it)
+          {
+            if (bitfield[*it])
+              {
+                toMove[i - first].push_back (std::make_pair (i, it));
+              }
+          }
+      }
+    for (uint16_t i = first; i <= last; ++i)
+      {
+        for (MoveList::const_iterator it = toMove[i - first].begin (); it != toMove[i - first].end (); ++it)
+          {
+            m_piecesByRarity[it->first + shift].insert (*it->second);
+            m_raritiesByPiece[*it->second] += shift;
+            m_piecesByRarity[it->first].erase (it->second);
+          }
+      }
+    delete[] toMove;
+  }
+
+  uint16_t m_maxPeers;
+  std::set<uint32_t> *m_piecesByRarity;
+  std::vector<uint16_t> m_raritiesByPiece;
+};
+
+/**
+ * The rarity buckets as kept by RarestFirstPartSelectionStrategy.
+ */
+class IndexBuckets
+{
+public:
+  IndexBuckets (uint32_t pieces, uint16_t maxPeers)
+    : m_maxPeers (maxPeers)
+  {
+    m_index.Assign (std::vector<uint16_t> (pieces, 0), maxPeers + 1);
+  }
+  void Bitfield (const std::vector<bool> &bitfield)
+  {
+    for (uint32_t i = 0; i < m_index.GetNumberOfPieces (); ++i)
+      {
+        if (m_index.GetRarity (i) < m_maxPeers && bitfield[i])
+          {
+            m_index.Increment (i);
+          }
+      }
+  }
+  void Close (const std::vector<bool> &bitfield)
+  {
+    for (uint32_t i = 0; i < m_index.GetNumberOfPieces (); ++i)
+      {
+        uint16_t rarity = m_index.GetRarity (i);
+        if (rarity >= 1 && rarity <= m_maxPeers && bitfield[i])
+          {
+            m_index.Decrement (i);
+          }
+      }
+  }
+  void Have (uint32_t piece)
+  {
+    if (m_index.GetRarity (piece) < m_maxPeers)
+      {
+        m_index.Increment (piece);
+      }
+  }
+  uint16_t GetRarity (uint32_t piece) const
+  {
+    return m_index.GetRarity (piece);
+  }
+  std::vector<uint32_t> GetBucket (uint16_t rarity) const
+  {
+    // sorted, as RarestFirstPartSelectionStrategy does before its random choice.
+    std::vector<uint32_t> bucket (m_index.BucketBegin (rarity), m_index.BucketEnd (rarity));
+    std::sort (bucket.begin (), bucket.end ());
+    return bucket;
+  }
+private:
+  uint16_t m_maxPeers;
+  PieceRarityIndex m_index;
+};
+
+/**
+ * Let every peer announce its bitfield, then send the HAVE messages,
+ * then close every connection, as many times as there are rounds, and
+ * return the rarities seen after the HAVE messages. The pieces of the
+ * buckets at that time, bucket after bucket, are stored in order.
+ */
+template <typename Buckets>
+std::vector<uint16_t>
+Run (std::string name, uint32_t pieces, const Swarm &swarm, uint32_t rounds, std::vector<uint32_t> &order)
+{
+  uint32_t peers = swarm.bitfields.size ();
+  Buckets buckets (pieces, peers);
+  std::vector<uint16_t> rarities (pieces);
+
+  // the departing peers hold the pieces they announced since their bitfield.
+  std::vector<std::vector<bool> > bitfields = swarm.bitfields;
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator i = swarm.haves.begin (); i != swarm.haves.end (); ++i)
+    {
+      bitfields[i->first][i->second] = true;
+    }
+
+  // the clock ticks are coarse: accumulate over the rounds.
+  SystemWallClockMs time;
+  int64_t bitfield = 0;
+  int64_t have = 0;
+  int64_t close = 0;
+  for (uint32_t round = 0; round < rounds; round++)
+    {
+      time.Start ();
+      for (uint32_t i = 0; i < peers; i++)
+        {
+          buckets.Bitfield (swarm.bitfields[i]);
+        }
+      bitfield += time.End ();
+
+      time.Start ();
+      for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator i = swarm.haves.begin (); i != swarm.haves.end (); ++i)
+        {
+          buckets.Have (i->second);
+        }
+      have += time.End ();
+
+      for (uint32_t i = 0; round == 0 && i < pieces; i++)
+        {
+          rarities[i] = buckets.GetRarity (i);
+        }
+      for (uint32_t i = 0; round == 0 && i <= peers; i++)
+        {
+          std::vector<uint32_t> bucket = buckets.GetBucket (i);
+          order.insert (order.end (), bucket.begin (), bucket.end ());
+        }
+
+      time.Start ();
+      for (uint32_t i = 0; i < peers; i++)
+        {
+          buckets.Close (bitfields[i]);
+        }
+      close += time.End ();
+    }
+
+  LOG (std::left << std::setw (g_fwidth) << name <<
+       std::setw (g_fwidth) << (bitfield * 1e3 / peers / rounds) <<
+       std::setw (g_fwidth) << (swarm.haves.empty () ? 0 : have * 1e6 / swarm.haves.size () / rounds) <<
+       std::setw (g_fwidth) << (close * 1e3 / peers / rounds));
+  return rarities;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t pieces = 5000;
+  uint32_t peers = 100;
+  double density = 0.3;
+  uint32_t haves = 1000000;
+  uint32_t rounds = 50;
+
+  CommandLine cmd;
+  cmd.Usage ("Compare the cost of the rarity updates of RarestFirstPartSelectionStrategy\n"
+             "with a PieceRarityIndex and with the former std::set buckets.\n"
+             "\n"
+             "Each peer announces a random bitfield, then the peers send HAVE\n"
+             "messages for pieces they did not have, then every connection closes.\n"
+             "The costs are given per bitfield (us), per HAVE message (ns) and per\n"
+             "closed connection (us), averaged over the rounds.");
+  cmd.AddValue ("pieces",  "number of pieces of the torrent",                     pieces);
+  cmd.AddValue ("peers",   "number of peers (and maximum number of peers)",       peers);
+  cmd.AddValue ("density", "fraction of the pieces announced in the bitfields",   density);
+  cmd.AddValue ("haves",   "number of HAVE messages",                             haves);
+  cmd.AddValue ("rounds",  "number of times the swarm is replayed",               rounds);
+  cmd.Parse (argc, argv);
+  g_me = cmd.GetName () + ": ";
+
+  // draw the bitfields, and the pieces each peer misses in a random order
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  Swarm swarm;
+  swarm.bitfields.resize (peers, std::vector<bool> (pieces, false));
+  std::vector<std::vector<uint32_t> > missing (peers);
+  for (uint32_t i = 0; i < peers; i++)
+    {
+      for (uint32_t j = 0; j < pieces; j++)
+        {
+          if (random->GetValue () < density)
+            {
+              swarm.bitfields[i][j] = true;
+            }
+          else
+            {
+              missing[i].push_back (j);
+            }
+        }
+      for (uint32_t j = missing[i].size (); j > 1; j--)
+        {
+          std::swap (missing[i][j - 1], missing[i][random->GetInteger (0, j - 1)]);
+        }
+    }
+  // the HAVE messages come from random peers, until they run out of missing pieces
+  std::vector<uint32_t> senders;
+  for (uint32_t i = 0; i < peers; i++)
+    {
+      if (!missing[i].empty ())
+        {
+          senders.push_back (i);
+        }
+    }
+  while (swarm.haves.size () < haves && !senders.empty ())
+    {
+      uint32_t k = random->GetInteger (0, senders.size () - 1);
+      uint32_t peer = senders[k];
+      swarm.haves.push_back (std::make_pair (peer, missing[peer].back ()));
+      missing[peer].pop_back ();
+      if (missing[peer].empty ())
+        {
+          senders[k] = senders.back ();
+          senders.pop_back ();
+        }
+    }
+  LOGME ("pieces: " << pieces << ", peers: " << peers << ", density: " << density <<
+         ", haves: " << swarm.haves.size () << ", rounds: " << rounds);
+
+  LOG ("");
+  LOG (std::left << std::setw (g_fwidth) << "Buckets" <<
+       std::setw (g_fwidth) << "Bitfield (us)" <<
+       std::setw (g_fwidth) << "Have (ns)" <<
+       std::setw (g_fwidth) << "Close (us)");
+  std::vector<uint32_t> setsOrder;
+  std::vector<uint32_t> indexOrder;
+  std::vector<uint16_t> sets = Run<SetBuckets> ("std::set", pieces, swarm, rounds, setsOrder);
+  std::vector<uint16_t> index = Run<IndexBuckets> ("index", pieces, swarm, rounds, indexOrder);
+  if (sets != index)
+    {
+      LOGME ("the rarities of the two structures differ");
+      return 1;
+    }
+  if (setsOrder != indexOrder)
+    {
+      LOGME ("the sorted buckets of the two structures differ");
+      return 1;
+    }
+  return 0;
+}
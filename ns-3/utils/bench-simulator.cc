@@ -80,6 +80,7 @@ Bench::RunBench (void)
   double init, simu;
 
   DEB ("initializing");
+  m_count = 0;
 
   time.Start ();
   for (uint32_t i = 0; i < m_population; ++i)
@@ -124,12 +125,51 @@ Bench::Cb (void)
 }
 
 
+/**
+ * Draws the event intervals of a wireless scenario: most events follow
+ * a transmission by less than a microsecond (PHY and MAC delays), the
+ * others are application timers, of a few seconds.
+ */
+void
+DrawBurstyIntervals (uint32_t count, std::vector<double> &nsValues)
+{
+  Ptr<UniformRandomVariable> choice = CreateObject<UniformRandomVariable> ();
+  Ptr<ExponentialRandomVariable> phy = CreateObject<ExponentialRandomVariable> ();
+  phy->SetAttribute ("Mean", DoubleValue (300));
+  Ptr<UniformRandomVariable> timer = CreateObject<UniformRandomVariable> ();
+  timer->SetAttribute ("Min", DoubleValue (1e9));
+  timer->SetAttribute ("Max", DoubleValue (4e9));
+
+  nsValues.resize (count);
+  for (uint32_t i = 0; i < count; i++)
+    {
+      if (choice->GetValue () < 0.9)
+        {
+          nsValues[i] = (uint64_t) phy->GetValue ();
+        }
+      else
+        {
+          nsValues[i] = (uint64_t) timer->GetValue ();
+        }
+    }
+}
+
+/**
+ * The intervals drawn or read are returned in nsValues as well, so that
+ * they can be replayed from the start for each scheduler.
+ */
 Ptr<RandomVariableStream>
-GetRandomStream (std::string filename)
+GetRandomStream (std::string filename, bool bursty, std::vector<double> &nsValues)
 {
   Ptr<RandomVariableStream> stream = 0;
   
-  if (filename == "")
+  if (bursty)
+    {
+      LOGME ("using bursty distribution: 90% exponential with mean 300 ns, "
+             "10% uniform in [1, 4] s");
+      DrawBurstyIntervals (1000003, nsValues);
+    }
+  else if (filename == "")
     {
       LOGME ("using default exponential distribution");
       Ptr<ExponentialRandomVariable> erv = CreateObject<ExponentialRandomVariable> ();
@@ -152,7 +192,6 @@ GetRandomStream (std::string filename)
         }
 
       double value;
-      std::vector<double> nsValues;
       
       while (!input->eof ()) 
         {
@@ -169,6 +208,9 @@ GetRandomStream (std::string filename)
             }
         }
       LOGME ("found " << nsValues.size () << " entries");
+    }
+  if (!nsValues.empty ())
+    {
       Ptr<DeterministicRandomVariable> drv = CreateObject<DeterministicRandomVariable> ();
       drv->SetValueArray (&nsValues[0], nsValues.size ());
       stream = drv;
@@ -186,6 +228,10 @@ int main (int argc, char *argv[])
   bool schedHeap = false;
   bool schedList = false;
   bool schedMap  = true;
+  bool schedLadder  = false;
+  bool schedIndexed = false;
+  bool schedAll  = false;
+  bool bursty    = false;
 
   uint32_t pop   =  100000;
   uint32_t total = 1000000;
@@ -197,14 +243,20 @@ int main (int argc, char *argv[])
              "\n"
              "Event intervals are taken from one of:\n"
              "  an exponential distribution, with mean 100 ns,\n"
+             "  a bursty distribution, given by the --bursty argument,\n"
              "  an ascii file, given by the --file=\"<filename>\" argument,\n"
              "  or standard input, by the argument --file=\"-\"\n"
              "In the case of either --file form, the input is expected\n"
-             "to be ascii, giving the relative event times in ns.");
+             "to be ascii, giving the relative event times in ns.\n"
+             "The same intervals are replayed for each scheduler of --all.");
   cmd.AddValue ("cal",   "use CalendarSheduler",          schedCal);
   cmd.AddValue ("heap",  "use HeapScheduler",             schedHeap);
   cmd.AddValue ("list",  "use ListSheduler",              schedList);
   cmd.AddValue ("map",   "use MapScheduler (default)",    schedMap);
+  cmd.AddValue ("ladder",  "use LadderScheduler",         schedLadder);
+  cmd.AddValue ("indexed", "use IndexedHeapScheduler",    schedIndexed);
+  cmd.AddValue ("all",   "run the benchmark with each scheduler in turn", schedAll);
+  cmd.AddValue ("bursty", "mix sub-microsecond delays with timers of seconds", bursty);
   cmd.AddValue ("debug", "enable debugging output",       g_debug);
   cmd.AddValue ("pop",   "event population size (default 1E5)",         pop);
   cmd.AddValue ("total", "total number of events to run (default 1E6)", total);
@@ -215,58 +267,85 @@ int main (int argc, char *argv[])
   g_me = cmd.GetName () + ": ";
   g_fwidth += 6;  // 5 extra chars in '2.000002e+07 ': . e+0 _
 
-  ObjectFactory factory ("ns3::MapScheduler");
-  if (schedCal)  { factory.SetTypeId ("ns3::CalendarScheduler"); }
-  if (schedHeap) { factory.SetTypeId ("ns3::HeapScheduler");     }
-  if (schedList) { factory.SetTypeId ("ns3::ListScheduler");     }  
-  Simulator::SetScheduler (factory);
+  std::vector<std::string> schedulers;
+  if (schedAll)
+    {
+      schedulers.push_back ("ns3::ListScheduler");
+      schedulers.push_back ("ns3::MapScheduler");
+      schedulers.push_back ("ns3::HeapScheduler");
+      schedulers.push_back ("ns3::CalendarScheduler");
+      schedulers.push_back ("ns3::IndexedHeapScheduler");
+      schedulers.push_back ("ns3::LadderScheduler");
+    }
+  else if (schedCal)     { schedulers.push_back ("ns3::CalendarScheduler");    }
+  else if (schedHeap)    { schedulers.push_back ("ns3::HeapScheduler");        }
+  else if (schedList)    { schedulers.push_back ("ns3::ListScheduler");        }
+  else if (schedLadder)  { schedulers.push_back ("ns3::LadderScheduler");      }
+  else if (schedIndexed) { schedulers.push_back ("ns3::IndexedHeapScheduler"); }
+  else                   { schedulers.push_back ("ns3::MapScheduler");         }
 
   LOGME (std::setprecision (g_fwidth - 6));
   DEB ("debugging is ON");
 
-  LOGME ("scheduler: " << factory.GetTypeId ().GetName ());
   LOGME ("population: " << pop);
   LOGME ("total events: " << total);
   LOGME ("runs: " << runs);
   
   Bench *bench = new Bench (pop, total);
-  bench->SetRandomStream (GetRandomStream (filename));
+  std::vector<double> nsValues;
+  Ptr<RandomVariableStream> stream = GetRandomStream (filename, bursty, nsValues);
+  bench->SetRandomStream (stream);
 
-  // table header
-  LOG ("");
-  LOG (std::left << std::setw (g_fwidth) << "Run #" <<
-       std::left << std::setw (3 * g_fwidth) << "Inititialization:" <<
-       std::left << std::setw (3 * g_fwidth) << "Simulation:");
-  LOG (std::left << std::setw (g_fwidth) << "" <<
-       std::left << std::setw (g_fwidth) << "Time (s)" <<
-       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
-       std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
-       std::left << std::setw (g_fwidth) << "Time (s)" <<
-       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
-       std::left << std::setw (g_fwidth) << "Per (s/ev)" );
-  LOG (std::setfill ('-') <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<
-       std::setfill (' ')
-       );
-       
-  // prime
-  DEB ("priming");
-  std::cout << std::left << std::setw (g_fwidth) << "(prime)";
-  bench->RunBench ();
-
-  bench->SetPopulation (pop);
-  bench->SetTotal (total);
-  for (uint32_t i = 0; i < runs; i++)
+  for (std::vector<std::string>::const_iterator s = schedulers.begin ();
+       s != schedulers.end (); ++s)
     {
-      std::cout << std::setw (g_fwidth) << i;
-      
+      // Simulator::Destroy forgets a scheduler set by Simulator::SetScheduler,
+      // while the global value holds for all the runs.
+      GlobalValue::Bind ("SchedulerType", StringValue (*s));
+      Ptr<DeterministicRandomVariable> drv = DynamicCast<DeterministicRandomVariable> (stream);
+      if (drv != 0)
+        {
+          // restart from the first interval, so that each scheduler sees the same events.
+          drv->SetValueArray (&nsValues[0], nsValues.size ());
+        }
+      LOGME ("scheduler: " << *s);
+
+      // table header
+      LOG ("");
+      LOG (std::left << std::setw (g_fwidth) << "Run #" <<
+           std::left << std::setw (3 * g_fwidth) << "Inititialization:" <<
+           std::left << std::setw (3 * g_fwidth) << "Simulation:");
+      LOG (std::left << std::setw (g_fwidth) << "" <<
+           std::left << std::setw (g_fwidth) << "Time (s)" <<
+           std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+           std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
+           std::left << std::setw (g_fwidth) << "Time (s)" <<
+           std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+           std::left << std::setw (g_fwidth) << "Per (s/ev)" );
+      LOG (std::setfill ('-') <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::setfill (' ')
+           );
+
+      // prime
+      DEB ("priming");
+      std::cout << std::left << std::setw (g_fwidth) << "(prime)";
       bench->RunBench ();
+
+      bench->SetPopulation (pop);
+      bench->SetTotal (total);
+      for (uint32_t i = 0; i < runs; i++)
+        {
+          std::cout << std::setw (g_fwidth) << i;
+
+          bench->RunBench ();
+        }
     }
 
   LOG ("");
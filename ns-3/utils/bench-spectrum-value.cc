@@ -0,0 +1,158 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "ns3/core-module.h"
+#include "ns3/spectrum-model.h"
+#include "ns3/spectrum-value.h"
+
+using namespace ns3;
+
+std::string g_me;
+#define LOG(x)   std::cout << x << std::endl
+#define LOGME(x) LOG (g_me << x)
+
+// Output field width
+int g_fwidth = 14;
+
+/**
+ * The work of a receiver for one signal, as done by the spectrum
+ * channels, the interference and the chunk processors: the signal is
+ * scaled by the path gain and accumulated into the interference, the
+ * SINR is computed and averaged over the chunk.
+ */
+struct BenchState
+{
+  BenchState (Ptr<const SpectrumModel> model)
+    : allSignals (model),
+      sumSinr (model)
+  {
+  }
+  SpectrumValue allSignals;
+  SpectrumValue sumSinr;
+};
+
+/// With the arithmetic operators, which return a new SpectrumValue each.
+static void
+RunOperators (BenchState &state, const SpectrumValue &txPsd, const SpectrumValue &noise,
+              double gain, double duration)
+{
+  SpectrumValue rxPsd = txPsd * gain;
+  state.allSignals += rxPsd;
+  SpectrumValue sinr = rxPsd / (state.allSignals - rxPsd + noise);
+  state.sumSinr += sinr * duration;
+  state.allSignals -= rxPsd;
+}
+
+/// With the in-place and fused kernels.
+static void
+RunKernels (BenchState &state, const SpectrumValue &txPsd, const SpectrumValue &noise,
+            double gain, double duration)
+{
+  SpectrumValue rxPsd = txPsd;
+  rxPsd *= gain;
+  state.allSignals += rxPsd;
+  SpectrumValue interf = state.allSignals;
+  interf -= rxPsd;
+  interf += noise;
+  SpectrumValue sinr = rxPsd;
+  sinr /= interf;
+  state.sumSinr.MultiplyAdd (sinr, duration);
+  state.allSignals -= rxPsd;
+}
+
+typedef void (*BenchFunction)(BenchState &, const SpectrumValue &, const SpectrumValue &, double, double);
+
+static SpectrumValue
+Run (std::string name, BenchFunction function, Ptr<const SpectrumModel> model,
+     const SpectrumValue &txPsd, const SpectrumValue &noise,
+     const std::vector<double> &gains, const SpectrumValue *reference)
+{
+  BenchState state (model);
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t i = 0; i < gains.size (); i++)
+    {
+      function (state, txPsd, noise, gains[i], 1e-3);
+    }
+  double seconds = time.End () / 1000.0;
+
+  double maxError = 0.0;
+  for (uint32_t i = 0; reference != 0 && i < model->GetNumBands (); i++)
+    {
+      maxError = std::max (maxError, std::fabs (state.sumSinr[i] - (*reference)[i]));
+    }
+  LOG (std::left << std::setw (2 * g_fwidth) << name <<
+       std::setw (g_fwidth) << seconds <<
+       std::setw (g_fwidth) << (seconds > 0 ? gains.size () / seconds : 0) <<
+       std::setw (g_fwidth) << maxError);
+  return state.sumSinr;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 1000000;
+  uint32_t bands = 100;
+
+  CommandLine cmd;
+  cmd.Usage ("Compare the cost of the SpectrumValue arithmetic operators with\n"
+             "the cost of the in-place and fused kernels, on the work of a\n"
+             "receiver for each signal.\n"
+             "\n"
+             "The error is the largest difference between the averaged SINRs\n"
+             "of the kernels and of the operators.");
+  cmd.AddValue ("n",     "number of signals",                       n);
+  cmd.AddValue ("bands", "number of bands, e.g., resource blocks", bands);
+  cmd.Parse (argc, argv);
+  g_me = cmd.GetName () + ": ";
+
+  std::vector<double> freqs;
+  for (uint32_t i = 0; i < bands; i++)
+    {
+      freqs.push_back (2.1e9 + i * 180e3);
+    }
+  Ptr<SpectrumModel> model = Create<SpectrumModel> (freqs);
+
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  SpectrumValue txPsd (model);
+  SpectrumValue noise (model);
+  for (uint32_t i = 0; i < bands; i++)
+    {
+      txPsd[i] = random->GetValue (0.0, 1e-6);
+      noise[i] = random->GetValue (0.0, 1e-19);
+    }
+  std::vector<double> gains (n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      gains[i] = std::pow (10.0, random->GetValue (-120.0, -60.0) / 10.0);
+    }
+  LOGME ("signals: " << n << ", bands: " << bands);
+
+  LOG ("");
+  LOG (std::left << std::setw (2 * g_fwidth) << "Arithmetic" <<
+       std::setw (g_fwidth) << "Time (s)" <<
+       std::setw (g_fwidth) << "Rate (sig/s)" <<
+       std::setw (g_fwidth) << "Max error");
+  SpectrumValue reference = Run ("operators", &RunOperators, model, txPsd, noise, gains, 0);
+  Run ("kernels", &RunKernels, model, txPsd, noise, gains, &reference);
+  return 0;
+}